@@ -398,157 +398,130 @@ Window {
     // Temporary list for background scanning (keeps UI responsive with cached data)
     property var scanningBooksList: []
 
+    // Folders waiting to be listed. Each listing is a temporary
+    // FolderListModel that enumerates, filters and sorts in its own worker
+    // thread, so only a few run at once.
+    property var scanQueue: []
+    property int activeListings: 0
+    property int maxListings: 4
+    property bool scanning: false
+
+    property var audioFilters: ["*.mp3", "*.m4a", "*.m4b", "*.ogg", "*.flac", "*.wav", "*.aac"]
+
     function scanAudiobooks() {
         scanningBooksList = []  // Use separate list while scanning
-        currentLibraryIndex = 0
+        scanQueue = []
+        scanning = true
         console.log("Starting audiobook scan, " + libraryPaths.length + " library paths")
-        scanNextLibrary()
+        for (var i = 0; i < libraryPaths.length; i++) {
+            var libPath = libraryPaths[i]
+            // Audio files directly in the library folder, then its book folders
+            scanQueue.push({ path: libPath, name: "Loose Files in " + libPath.split("/").pop(), dirs: false })
+            scanQueue.push({ path: libPath, dirs: true })
+        }
+        pumpScan()
     }
 
-    property int currentLibraryIndex: 0
-
-    function scanNextLibrary() {
-        if (currentLibraryIndex >= libraryPaths.length) {
-            // Done scanning - update main list with scanned results
+    function pumpScan() {
+        while (activeListings < maxListings && scanQueue.length > 0) {
+            listFolder(scanQueue.shift())
+        }
+        if (scanning && activeListings === 0 && scanQueue.length === 0) {
+            scanning = false
+            // Listings finish in any order; a library's loose files sort
+            // ahead of its book folders
+            scanningBooksList.sort(function(a, b) { return a.path.localeCompare(b.path) })
             booksList = scanningBooksList
-            syncTimer.start()
-            return
+            booksListModel.sync()
+            saveCache()  // Save to cache for next startup
+            console.log("Found " + booksList.length + " audiobooks total")
         }
-
-        var libPath = libraryPaths[currentLibraryIndex]
-        console.log("Scanning library: " + libPath)
-
-        // First, scan for audio files directly in the library folder
-        scanBookFolderAsync(libPath, "Loose Files in " + libPath.split("/").pop())
-
-        // Then scan for subdirectories (book folders)
-        scanLibraryForBookFolders(libPath)
-
-        currentLibraryIndex++
     }
 
-    function scanLibraryForBookFolders(libPath) {
-        var dirModel = Qt.createQmlObject('
+    function listFolder(item) {
+        var model = Qt.createQmlObject('
             import QtQuick 2.15
             import Qt.labs.folderlistmodel 2.15
             FolderListModel {
-                showDirs: true
-                showFiles: false
                 showDotAndDotDot: false
+                caseSensitive: false
             }
         ', root)
-
-        dirModel.folder = "file://" + libPath
-
-        var checkTimer = Qt.createQmlObject('import QtQuick 2.15; Timer { interval: 100; repeat: true }', root)
-        var checkCount = 0
-
-        checkTimer.triggered.connect(function() {
-            checkCount++
-            if (dirModel.status === 2 || checkCount > 20) {
-                checkTimer.stop()
-
-                console.log("Found " + dirModel.count + " folders in " + libPath)
-                for (var i = 0; i < dirModel.count; i++) {
-                    var folderName = dirModel.get(i, "fileName")
-                    var folderPath = dirModel.get(i, "filePath")
-                    if (folderName && folderName !== "." && folderName !== "..") {
-                        console.log("Found book folder: " + folderName)
-                        scanBookFolderAsync(folderPath, folderName)
-                    }
-                }
-
-                dirModel.destroy()
-                checkTimer.destroy()
-
-                // Continue to next library after a short delay
-                scanNextLibraryTimer.start()
+        model.showDirs = item.dirs
+        model.showFiles = !item.dirs
+        if (!item.dirs) model.nameFilters = audioFilters
+
+        activeListings++
+        var finished = false
+        function finish() {
+            if (finished) return
+            finished = true
+            if (item.dirs) {
+                addBookFolders(model)
+            } else {
+                addBook(model, item.path, item.name)
             }
+            model.destroy()
+            activeListings--
+            pumpScan()
+        }
+        model.statusChanged.connect(function() {
+            if (model.status === FolderListModel.Ready) finish()
         })
-        checkTimer.start()
+        model.folder = "file://" + item.path
+        // A missing folder leaves the model Null and never becomes Ready
+        if (model.status === FolderListModel.Null) finish()
     }
 
-    Timer {
-        id: scanNextLibraryTimer
-        interval: 200
-        onTriggered: scanNextLibrary()
-    }
-
-    Timer {
-        id: syncTimer
-        interval: 1000
-        onTriggered: {
-            booksListModel.sync()
-            saveCache()  // Save to cache for next startup
-            console.log("Found " + booksList.length + " audiobooks total")
+    function addBookFolders(dirModel) {
+        console.log("Found " + dirModel.count + " folders in " + dirModel.folder)
+        for (var i = 0; i < dirModel.count; i++) {
+            var folderName = dirModel.get(i, "fileName")
+            if (folderName) {
+                scanQueue.push({ path: dirModel.get(i, "filePath"), name: folderName, dirs: false })
+            }
         }
     }
 
-    function scanBookFolderAsync(folderPath, folderName) {
-        // Create a temporary folder model to scan for audio files
-        var scanModel = Qt.createQmlObject('
-            import QtQuick 2.15
-            import Qt.labs.folderlistmodel 2.15
-            FolderListModel {
-                showDirs: false
-                showFiles: true
-                nameFilters: ["*.mp3", "*.m4a", "*.m4b", "*.ogg", "*.flac", "*.wav", "*.aac", "*.MP3", "*.M4A", "*.M4B", "*.OGG", "*.FLAC", "*.WAV", "*.AAC"]
+    function addBook(scanModel, folderPath, folderName) {
+        var chapters = []
+        for (var i = 0; i < scanModel.count; i++) {
+            var fileName = scanModel.get(i, "fileName")
+            var filePath = scanModel.get(i, "filePath")
+            if (fileName) {
+                chapters.push({
+                    title: fileName,
+                    path: filePath
+                })
             }
-        ', root)
+        }
+        if (chapters.length === 0) return
 
-        scanModel.folder = "file://" + folderPath
-
-        // Use a timer to wait for the model to populate
-        var checkTimer = Qt.createQmlObject('import QtQuick 2.15; Timer { interval: 100; repeat: true }', root)
-
-        var checkCount = 0
-        checkTimer.triggered.connect(function() {
-            checkCount++
-            if (scanModel.status === 2 || checkCount > 10) { // Ready or timeout
-                checkTimer.stop()
-                var chapters = []
-                for (var i = 0; i < scanModel.count; i++) {
-                    var fileName = scanModel.get(i, "fileName")
-                    var filePath = scanModel.get(i, "filePath")
-                    if (fileName) {
-                        chapters.push({
-                            title: fileName,
-                            path: filePath
-                        })
-                    }
-                }
-                if (chapters.length > 0) {
-                    // Check if most files start with numbers
-                    var numericCount = 0
-                    for (var j = 0; j < chapters.length; j++) {
-                        if (/^\d+/.test(chapters[j].title)) numericCount++
-                    }
-                    var useNumericSort = (numericCount > chapters.length / 2)
-
-                    chapters.sort(function(a, b) {
-                        if (useNumericSort) {
-                            // Extract numbers anywhere in filename for numeric sort
-                            var matchA = a.title.match(/\d+/)
-                            var matchB = b.title.match(/\d+/)
-                            var numA = matchA ? parseInt(matchA[0]) : 0
-                            var numB = matchB ? parseInt(matchB[0]) : 0
-                            if (numA !== numB) return numA - numB
-                        }
-                        // Alphabetic fallback
-                        return a.title < b.title ? -1 : (a.title > b.title ? 1 : 0)
-                    })
-                    scanningBooksList.push({
-                        title: folderName,
-                        path: folderPath,
-                        chapters: chapters
-                    })
-                    console.log("Added book: " + folderName + " with " + chapters.length + " chapters")
-                }
-                scanModel.destroy()
-                checkTimer.destroy()
+        // Check if most files start with numbers
+        var numericCount = 0
+        for (var j = 0; j < chapters.length; j++) {
+            if (/^\d+/.test(chapters[j].title)) numericCount++
+        }
+        var useNumericSort = (numericCount > chapters.length / 2)
+
+        chapters.sort(function(a, b) {
+            if (useNumericSort) {
+                // Extract numbers anywhere in filename for numeric sort
+                var matchA = a.title.match(/\d+/)
+                var matchB = b.title.match(/\d+/)
+                var numA = matchA ? parseInt(matchA[0]) : 0
+                var numB = matchB ? parseInt(matchB[0]) : 0
+                if (numA !== numB) return numA - numB
             }
+            // Alphabetic fallback
+            return a.title < b.title ? -1 : (a.title > b.title ? 1 : 0)
+        })
+        scanningBooksList.push({
+            title: folderName,
+            path: folderPath,
+            chapters: chapters
         })
-        checkTimer.start()
+        console.log("Added book: " + folderName + " with " + chapters.length + " chapters")
     }
 
     ListModel {
@@ -0,0 +1,672 @@
+#!/usr/bin/env python3
+"""
+Flick Calendar Engine - recurrence index for the Calendar app
+
+Events come from two kinds of source:
+- calendar.json, written by the Calendar app. It is keyed by date, and an
+  event may carry "repeat": daily|weekly|monthly|yearly.
+- *.ics files in ~/.local/state/flick/calendars/ (VEVENT with RRULE,
+  EXDATE and RECURRENCE-ID overrides).
+
+Instead of expanding recurrences every time a view is shown, the engine
+materialises every instance that falls in a sliding window (a month back,
+about a year ahead) into a SQLite table indexed by start time. Month/day
+views and "what's next" then become a single range query.
+
+Work is incremental at three levels:
+- a source is re-parsed only when its mtime/size changes
+- within a re-parsed source, only events whose content hash changed have
+  their instances deleted and regenerated
+- when the window slides forward, recurring events are expanded for the
+  newly uncovered days only, and instances that fell off the back are dropped
+
+Times are local wall-clock; TZID parameters are treated as local time.
+
+    python3 calendar_engine.py serve [--port 7658]
+    GET /range?from=2025-12-01&to=2026-01-01   instances overlapping [from, to)
+    GET /next?limit=1                          upcoming instances from now
+    GET /status                                index stats
+
+    python3 calendar_engine.py next [N]
+    python3 calendar_engine.py range FROM TO
+"""
+
+import calendar
+import hashlib
+import json
+import os
+import re
+import sqlite3
+import sys
+import threading
+import time
+from datetime import date, datetime, timedelta
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from pathlib import Path
+from urllib.parse import parse_qs, urlparse
+
+DEFAULT_PORT = 7658
+SCHEMA_VERSION = 1
+
+WINDOW_PAST_DAYS = 31
+WINDOW_FUTURE_DAYS = 400
+# Only slide the window once it has drifted this far, so a day-to-day
+# refresh doesn't touch every recurring event
+SLIDE_STEP_DAYS = 7
+# Guards against pathological rules (FREQ=DAILY with a huge COUNT, etc.)
+MAX_INSTANCES_PER_EVENT = 2000
+DEFAULT_EVENT_MINUTES = 60
+
+REPEAT_FREQS = {"daily": "DAILY", "weekly": "WEEKLY", "monthly": "MONTHLY", "yearly": "YEARLY"}
+WEEKDAYS = {"MO": 0, "TU": 1, "WE": 2, "TH": 3, "FR": 4, "SA": 5, "SU": 6}
+
+
+def log(msg):
+    print(f"[Calendar] {msg}", file=sys.stderr, flush=True)
+
+
+def get_state_dir():
+    home = os.environ.get("FLICK_HOME") or str(Path.home())
+    return Path(home) / ".local/state/flick"
+
+
+def epoch(dt):
+    return int(time.mktime(dt.timetuple()))
+
+
+def from_epoch(ts):
+    return datetime.fromtimestamp(ts)
+
+
+def display_time(dt):
+    """Same "h:mm AM" format the Calendar app writes"""
+    h = dt.hour % 12 or 12
+    return f"{h}:{dt.minute:02d} {'AM' if dt.hour < 12 else 'PM'}"
+
+
+# ---- Parsing ----------------------------------------------------------------
+
+def parse_json_time(text):
+    """'10:30 AM' -> (10, 30); '' -> None (all day)"""
+    m = re.match(r"\s*(\d{1,2}):(\d{2})\s*([AaPp][Mm])?", text or "")
+    if not m:
+        return None
+    hour, minute = int(m.group(1)), int(m.group(2))
+    if m.group(3):
+        hour = hour % 12 + (12 if m.group(3).upper() == "PM" else 0)
+    return hour, minute
+
+
+def events_from_json(path):
+    """Events from the Calendar app's date-keyed calendar.json"""
+    try:
+        with open(path) as f:
+            data = json.load(f)
+    except FileNotFoundError:
+        return []
+    except ValueError as e:
+        log(f"calendar.json unreadable: {e}")
+        return []
+
+    events = []
+    for key, items in (data.items() if isinstance(data, dict) else []):
+        try:
+            day = datetime.strptime(key, "%Y-%m-%d")
+        except ValueError:
+            continue
+        for i, item in enumerate(items or []):
+            hm = parse_json_time(item.get("time", ""))
+            start = day.replace(hour=hm[0], minute=hm[1]) if hm else day
+            repeat = REPEAT_FREQS.get((item.get("repeat") or "").lower())
+            events.append({
+                # Position in the day's list keeps duplicate titles apart
+                "uid": f"json:{key}:{i}",
+                "title": item.get("title") or "Untitled",
+                "start": start.isoformat(),
+                "minutes": DEFAULT_EVENT_MINUTES if hm else 24 * 60,
+                "all_day": hm is None,
+                "time": item.get("time", ""),
+                "rrule": {"FREQ": repeat} if repeat else None,
+                "exdates": [],
+                "origin": key,
+            })
+    return events
+
+
+def unfold(text):
+    lines = []
+    for raw in text.splitlines():
+        if raw[:1] in (" ", "\t") and lines:
+            lines[-1] += raw[1:]
+        else:
+            lines.append(raw)
+    return lines
+
+
+def parse_ics_datetime(value, params):
+    """DTSTART/DTEND/EXDATE value -> (naive local datetime, is_date)"""
+    value = value.strip()
+    if params.get("VALUE") == "DATE" or re.fullmatch(r"\d{8}", value):
+        return datetime.strptime(value[:8], "%Y%m%d"), True
+    utc = value.endswith("Z")
+    dt = datetime.strptime(value.rstrip("Z")[:15], "%Y%m%dT%H%M%S")
+    if utc:
+        dt = from_epoch(calendar.timegm(dt.timetuple()))
+    return dt, False
+
+
+def parse_duration(value):
+    m = re.fullmatch(r"([+-])?P(?:(\d+)W)?(?:(\d+)D)?(?:T(?:(\d+)H)?(?:(\d+)M)?(?:(\d+)S)?)?", value.strip())
+    if not m:
+        return None
+    weeks, days, hours, minutes, seconds = (int(g or 0) for g in m.groups()[1:])
+    return ((weeks * 7 + days) * 24 + hours) * 60 + minutes + seconds // 60
+
+
+def parse_rrule(value):
+    rule = {}
+    for part in value.split(";"):
+        if "=" in part:
+            k, v = part.split("=", 1)
+            rule[k.strip().upper()] = v.strip()
+    return rule if rule.get("FREQ") in ("DAILY", "WEEKLY", "MONTHLY", "YEARLY") else None
+
+
+def events_from_ics(path):
+    """VEVENTs from an .ics file; RECURRENCE-ID overrides become single events"""
+    try:
+        with open(path, encoding="utf-8", errors="replace") as f:
+            lines = unfold(f.read())
+    except OSError as e:
+        log(f"cannot read {path}: {e}")
+        return []
+
+    source = Path(path).name
+    events, overrides = [], []
+    props = None
+    for line in lines:
+        upper = line.strip().upper()
+        if upper == "BEGIN:VEVENT":
+            props = []
+            continue
+        if upper == "END:VEVENT" and props is not None:
+            ev = _ics_event(source, props)
+            if ev:
+                (overrides if ev.pop("recurrence_id", None) else events).append(ev)
+            props = None
+            continue
+        if props is not None and ":" in line:
+            key, value = line.split(":", 1)
+            name, *param_parts = key.split(";")
+            params = dict(p.split("=", 1) for p in param_parts if "=" in p)
+            props.append((name.upper(), {k.upper(): v for k, v in params.items()}, value))
+
+    # An override replaces one instance of its master
+    masters = {ev["uid"]: ev for ev in events}
+    for ov in overrides:
+        master = masters.get(ov["master_uid"])
+        if master is not None:
+            master["exdates"].append(ov["replaces"])
+        events.append(ov)
+    for ev in events:
+        ev.pop("master_uid", None)
+        ev.pop("replaces", None)
+    return events
+
+
+def _ics_event(source, props):
+    ev = {"title": "Untitled", "exdates": [], "rrule": None, "time": ""}
+    uid, start, is_date, end, minutes, recurrence_id = None, None, False, None, None, None
+    for name, params, value in props:
+        try:
+            if name == "UID":
+                uid = value.strip()
+            elif name == "SUMMARY":
+                ev["title"] = value.replace("\\,", ",").replace("\\;", ";").replace("\\n", " ").strip()
+            elif name == "DTSTART":
+                start, is_date = parse_ics_datetime(value, params)
+            elif name == "DTEND":
+                end, _ = parse_ics_datetime(value, params)
+            elif name == "DURATION":
+                minutes = parse_duration(value)
+            elif name == "RRULE":
+                ev["rrule"] = parse_rrule(value)
+            elif name == "EXDATE":
+                for v in value.split(","):
+                    ev["exdates"].append(parse_ics_datetime(v, params)[0].isoformat())
+            elif name == "RECURRENCE-ID":
+                recurrence_id = parse_ics_datetime(value, params)[0].isoformat()
+            elif name == "STATUS" and value.strip().upper() == "CANCELLED":
+                return None
+        except ValueError:
+            continue
+    if start is None:
+        return None
+
+    if minutes is None:
+        minutes = int((end - start).total_seconds() // 60) if end else (24 * 60 if is_date else 0)
+    uid = uid or hashlib.sha1(repr(props).encode()).hexdigest()
+    ev.update({
+        "uid": f"{source}:{uid}",
+        "start": start.isoformat(),
+        "minutes": max(minutes, 0),
+        "all_day": is_date,
+        "origin": source,
+    })
+    if recurrence_id:
+        ev.update({
+            "uid": f"{source}:{uid}@{recurrence_id}",
+            "master_uid": f"{source}:{uid}",
+            "replaces": recurrence_id,
+            "recurrence_id": recurrence_id,
+            "rrule": None,
+        })
+    return ev
+
+
+def event_hash(ev):
+    return hashlib.sha1(json.dumps(ev, sort_keys=True).encode()).hexdigest()
+
+
+# ---- Recurrence expansion ---------------------------------------------------
+
+def _add_months(dt, months, day):
+    """dt moved by `months`, on `day`; None if that month has no such day"""
+    y, m = divmod(dt.month - 1 + months, 12)
+    year, month = dt.year + y, m + 1
+    if day > calendar.monthrange(year, month)[1]:
+        return None
+    return dt.replace(year=year, month=month, day=day)
+
+
+def _candidates(start, rule, first_period):
+    """Rule-generated start times in order, beginning at period `first_period`"""
+    freq = rule["FREQ"]
+    interval = max(int(rule.get("INTERVAL", "1") or 1), 1)
+    period = first_period
+    while True:
+        if freq == "DAILY":
+            yield start + timedelta(days=period * interval)
+        elif freq == "WEEKLY":
+            byday = sorted(WEEKDAYS[d[-2:]] for d in rule.get("BYDAY", "").split(",") if d[-2:] in WEEKDAYS)
+            week = start - timedelta(days=start.weekday()) + timedelta(weeks=period * interval)
+            for wd in byday or [start.weekday()]:
+                dt = week + timedelta(days=wd)
+                if dt >= start:
+                    yield dt
+        elif freq == "MONTHLY":
+            day = int(rule.get("BYMONTHDAY", str(start.day)).split(",")[0])
+            dt = _add_months(start, period * interval, day) if day > 0 else None
+            if dt is not None and dt >= start:
+                yield dt
+        else:  # YEARLY - Feb 29 only occurs in leap years
+            dt = _add_months(start, period * interval * 12, start.day)
+            if dt is not None:
+                yield dt
+        period += 1
+
+
+def _first_period(start, rule, lo):
+    """Earliest period that can reach `lo`; only valid when there's no COUNT"""
+    if lo <= start:
+        return 0
+    interval = max(int(rule.get("INTERVAL", "1") or 1), 1)
+    days = (lo - start).days
+    freq = rule["FREQ"]
+    if freq == "DAILY":
+        return max(days // interval - 1, 0)
+    if freq == "WEEKLY":
+        return max(days // (7 * interval) - 1, 0)
+    months = (lo.year - start.year) * 12 + lo.month - start.month
+    if freq == "MONTHLY":
+        return max(months // interval - 1, 0)
+    return max(months // (12 * interval) - 1, 0)
+
+
+def occurrences(ev, lo, hi):
+    """Instance start times of `ev` overlapping [lo, hi)"""
+    start = datetime.fromisoformat(ev["start"])
+    duration = timedelta(minutes=ev["minutes"])
+    rule = ev["rrule"]
+    if not rule:
+        if start < hi and start + duration > lo:
+            yield start
+        return
+
+    until = None
+    if rule.get("UNTIL"):
+        try:
+            until, is_date = parse_ics_datetime(rule["UNTIL"], {})
+            if is_date:
+                until += timedelta(days=1, seconds=-1)
+        except ValueError:
+            pass
+    count = int(rule["COUNT"]) if rule.get("COUNT", "").isdigit() else None
+    exdates = set(ev["exdates"])
+
+    # COUNT is defined from DTSTART, so only rules without it can skip ahead
+    first = 0 if count else _first_period(start, rule, lo - duration)
+    produced = emitted = 0
+    for dt in _candidates(start, rule, first):
+        if (until and dt > until) or dt >= hi:
+            break
+        produced += 1
+        if count and produced > count:
+            break
+        if dt + duration <= lo or dt.isoformat() in exdates:
+            continue
+        yield dt
+        emitted += 1
+        if emitted >= MAX_INSTANCES_PER_EVENT:
+            break
+
+
+# ---- Index ------------------------------------------------------------------
+
+def _locked(method):
+    def wrapper(self, *args, **kwargs):
+        with self.lock:
+            return method(self, *args, **kwargs)
+    wrapper.__name__ = method.__name__
+    wrapper.__doc__ = method.__doc__
+    return wrapper
+
+
+class CalendarEngine:
+    """SQLite instance index.
+
+    The server shares one instance between its request threads; the public
+    methods serialise on the connection's lock.
+    """
+
+    def __init__(self, state_dir=None):
+        self.state_dir = Path(state_dir) if state_dir else get_state_dir()
+        self.json_path = self.state_dir / "calendar.json"
+        self.ics_dir = self.state_dir / "calendars"
+        self.state_dir.mkdir(parents=True, exist_ok=True)
+
+        self.lock = threading.RLock()
+        self.db = sqlite3.connect(str(self.state_dir / "calendar_index.db"), timeout=5,
+                                  isolation_level=None, check_same_thread=False)
+        self.db.row_factory = sqlite3.Row
+        self.db.execute("PRAGMA journal_mode=WAL")
+        self.db.execute("PRAGMA synchronous=NORMAL")
+        self._create_schema()
+
+    def _create_schema(self):
+        if self.db.execute("PRAGMA user_version").fetchone()[0] == SCHEMA_VERSION:
+            return
+        self.db.executescript("""
+            DROP TABLE IF EXISTS sources;
+            DROP TABLE IF EXISTS events;
+            DROP TABLE IF EXISTS instances;
+            DROP TABLE IF EXISTS meta;
+            CREATE TABLE sources (path TEXT PRIMARY KEY, stamp TEXT);
+            CREATE TABLE events (
+                uid TEXT PRIMARY KEY, source TEXT NOT NULL, hash TEXT NOT NULL,
+                recurring INTEGER NOT NULL, data TEXT NOT NULL
+            );
+            CREATE INDEX events_source ON events(source);
+            CREATE TABLE instances (
+                uid TEXT NOT NULL, start INTEGER NOT NULL, end INTEGER NOT NULL,
+                recurring INTEGER NOT NULL
+            );
+            CREATE INDEX instances_start ON instances(start);
+            CREATE INDEX instances_uid ON instances(uid);
+            CREATE TABLE meta (key TEXT PRIMARY KEY, value INTEGER);
+        """)
+        self.db.execute(f"PRAGMA user_version={SCHEMA_VERSION}")
+
+    def _meta(self, key, default=None):
+        row = self.db.execute("SELECT value FROM meta WHERE key = ?", (key,)).fetchone()
+        return row[0] if row else default
+
+    def _set_meta(self, key, value):
+        self.db.execute("INSERT OR REPLACE INTO meta VALUES (?, ?)", (key, value))
+
+    def _sources(self):
+        sources = {str(self.json_path): events_from_json}
+        if self.ics_dir.is_dir():
+            for p in sorted(self.ics_dir.glob("*.ics")):
+                sources[str(p)] = events_from_ics
+        return sources
+
+    @staticmethod
+    def _stamp(path):
+        try:
+            st = os.stat(path)
+            return f"{st.st_mtime_ns}:{st.st_size}"
+        except FileNotFoundError:
+            return "missing"
+
+    def _window(self):
+        today = datetime.combine(date.today(), datetime.min.time())
+        return (today - timedelta(days=WINDOW_PAST_DAYS),
+                today + timedelta(days=WINDOW_FUTURE_DAYS))
+
+    @_locked
+    def refresh(self):
+        """Bring the index up to date with sources and today's window."""
+        sources = self._sources()
+        stamps = {p: self._stamp(p) for p in sources}
+        known = {r["path"]: r["stamp"] for r in self.db.execute("SELECT * FROM sources")}
+        changed = [p for p in sources if known.get(p) != stamps[p]]
+        removed = [p for p in known if p not in sources]
+
+        lo, hi = self._window()
+        old_lo, old_hi = self._meta("window_lo"), self._meta("window_hi")
+        slide = old_lo is None or abs(epoch(lo) - old_lo) >= SLIDE_STEP_DAYS * 86400
+        if not (changed or removed or slide):
+            return
+
+        self.db.execute("BEGIN IMMEDIATE")
+        try:
+            if slide:
+                self._slide(lo, hi, old_lo, old_hi)
+            else:
+                lo, hi = from_epoch(old_lo), from_epoch(old_hi)
+            for path in removed:
+                self._replace_source(path, [], lo, hi)
+                self.db.execute("DELETE FROM sources WHERE path = ?", (path,))
+            for path in changed:
+                self._replace_source(path, sources[path](path), lo, hi)
+                self.db.execute("INSERT OR REPLACE INTO sources VALUES (?, ?)", (path, stamps[path]))
+            self.db.execute("COMMIT")
+        except Exception:
+            self.db.execute("ROLLBACK")
+            raise
+
+    def _replace_source(self, path, events, lo, hi):
+        """Diff a re-parsed source against the index; regenerate only what changed"""
+        old = {r["uid"]: r["hash"] for r in self.db.execute(
+            "SELECT uid, hash FROM events WHERE source = ?", (path,))}
+        new = {ev["uid"]: ev for ev in events}
+
+        stale = [uid for uid, h in old.items() if uid not in new or event_hash(new[uid]) != h]
+        for uid in stale:
+            self.db.execute("DELETE FROM instances WHERE uid = ?", (uid,))
+            self.db.execute("DELETE FROM events WHERE uid = ?", (uid,))
+
+        added = 0
+        for uid, ev in new.items():
+            if uid in old and uid not in stale:
+                continue
+            self.db.execute("INSERT INTO events VALUES (?, ?, ?, ?, ?)",
+                            (uid, path, event_hash(ev), 1 if ev["rrule"] else 0, json.dumps(ev)))
+            # Single events are indexed wherever they fall; only recurrences are windowed
+            if ev["rrule"]:
+                self._materialise(ev, lo, hi)
+            else:
+                self._materialise(ev, datetime.min, datetime.max)
+            added += 1
+        if stale or added:
+            log(f"{Path(path).name}: {len(stale)} removed/changed, {added} (re)indexed")
+
+    def _materialise(self, ev, lo, hi):
+        duration = ev["minutes"] * 60
+        recurring = 1 if ev["rrule"] else 0
+        rows = []
+        for dt in occurrences(ev, lo, hi):
+            start = epoch(dt)
+            rows.append((ev["uid"], start, start + duration, recurring))
+        self.db.executemany("INSERT INTO instances VALUES (?, ?, ?, ?)", rows)
+        if duration > self._meta("max_duration", 0):
+            self._set_meta("max_duration", duration)
+
+    def _slide(self, lo, hi, old_lo, old_hi):
+        recurring = [json.loads(r["data"]) for r in self.db.execute(
+            "SELECT data FROM events WHERE recurring = 1")]
+        if old_lo is not None and old_lo <= epoch(lo) < old_hi <= epoch(hi):
+            # Forward slide: drop what fell off the back, expand only the new tail
+            self.db.execute("DELETE FROM instances WHERE recurring = 1 AND end <= ?", (epoch(lo),))
+            new_from = from_epoch(old_hi)
+            for ev in recurring:
+                # Instances starting before new_from were already indexed
+                for dt in occurrences(ev, new_from, hi):
+                    if dt >= new_from:
+                        start = epoch(dt)
+                        self.db.execute("INSERT INTO instances VALUES (?, ?, ?, 1)",
+                                        (ev["uid"], start, start + ev["minutes"] * 60))
+        else:
+            # First run, clock went backwards, or a long gap - redo the window
+            self.db.execute("DELETE FROM instances WHERE recurring = 1")
+            for ev in recurring:
+                self._materialise(ev, lo, hi)
+        self._set_meta("window_lo", epoch(lo))
+        self._set_meta("window_hi", epoch(hi))
+
+    # ---- Queries -----------------------------------------------------------
+
+    @_locked
+    def range(self, lo, hi):
+        """Instances overlapping [lo, hi), ordered by start."""
+        self.refresh()
+        # Interval query on the start index: anything overlapping must start
+        # within max_duration before lo
+        max_duration = self._meta("max_duration", 0)
+        rows = self.db.execute(
+            "SELECT i.start, i.end, e.data FROM instances i JOIN events e ON e.uid = i.uid "
+            "WHERE i.start >= ? AND i.start < ? AND i.end > ? ORDER BY i.start",
+            (epoch(lo) - max_duration, epoch(hi), epoch(lo)))
+        return [self._instance(r) for r in rows]
+
+    @_locked
+    def next(self, after=None, limit=1):
+        """Upcoming instances starting at or after `after` (default: now)."""
+        self.refresh()
+        after = after or datetime.now()
+        rows = self.db.execute(
+            "SELECT i.start, i.end, e.data FROM instances i JOIN events e ON e.uid = i.uid "
+            "WHERE i.start >= ? ORDER BY i.start LIMIT ?", (epoch(after), limit))
+        return [self._instance(r) for r in rows]
+
+    @_locked
+    def stats(self):
+        self.refresh()
+        return {
+            "events": self.db.execute("SELECT COUNT(*) FROM events").fetchone()[0],
+            "instances": self.db.execute("SELECT COUNT(*) FROM instances").fetchone()[0],
+            "window_from": from_epoch(self._meta("window_lo", 0)).date().isoformat(),
+            "window_to": from_epoch(self._meta("window_hi", 0)).date().isoformat(),
+        }
+
+    @staticmethod
+    def _instance(row):
+        ev = json.loads(row["data"])
+        start, end = from_epoch(row["start"]), from_epoch(row["end"])
+        return {
+            "title": ev["title"],
+            "date": start.date().isoformat(),
+            "start": start.isoformat(timespec="minutes"),
+            "end": end.isoformat(timespec="minutes"),
+            "all_day": ev["all_day"],
+            "time": "" if ev["all_day"] else (ev.get("time") or display_time(start)),
+            "recurring": bool(ev["rrule"]),
+            "origin": ev["origin"],
+        }
+
+
+# ---- Localhost HTTP interface for QML --------------------------------------
+
+_shared_engine = None
+_shared_lock = threading.Lock()
+
+
+def _engine():
+    """The engine shared by all request threads, opened on first use"""
+    global _shared_engine
+    with _shared_lock:
+        if _shared_engine is None:
+            _shared_engine = CalendarEngine()
+        return _shared_engine
+
+
+def _parse_day(value):
+    return datetime.strptime(value, "%Y-%m-%d")
+
+
+class Handler(BaseHTTPRequestHandler):
+    # No CORS headers: QML's XMLHttpRequest doesn't need them, and they would
+    # let any web page read the user's calendar
+    def do_GET(self):
+        url = urlparse(self.path)
+        params = {k: v[0] for k, v in parse_qs(url.query).items()}
+        try:
+            engine = _engine()
+            if url.path == "/range":
+                lo, hi = _parse_day(params["from"]), _parse_day(params["to"])
+                self._json(200, {"instances": engine.range(lo, hi)})
+            elif url.path == "/next":
+                self._json(200, {"instances": engine.next(limit=int(params.get("limit", 1)))})
+            elif url.path == "/status":
+                self._json(200, engine.stats())
+            else:
+                self._json(404, {"error": "not found"})
+        except (KeyError, ValueError) as e:
+            self._json(400, {"error": str(e)})
+        except (OSError, sqlite3.Error) as e:
+            self._json(500, {"error": str(e)})
+
+    def _json(self, status, payload):
+        body = json.dumps(payload).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, fmt, *args):
+        pass
+
+
+def serve(port):
+    _engine().refresh()
+    server = ThreadingHTTPServer(("127.0.0.1", port), Handler)
+    server.daemon_threads = True
+    log(f"Listening on 127.0.0.1:{port}")
+    server.serve_forever()
+
+
+def main():
+    args = sys.argv[1:]
+    if not args:
+        print(__doc__)
+        return 1
+
+    cmd = args[0]
+    if cmd == "serve":
+        port = int(args[2]) if len(args) > 2 and args[1] == "--port" else DEFAULT_PORT
+        serve(port)
+    elif cmd == "next":
+        limit = int(args[1]) if len(args) > 1 else 1
+        print(json.dumps(CalendarEngine().next(limit=limit), indent=2))
+    elif cmd == "range" and len(args) > 2:
+        print(json.dumps(CalendarEngine().range(_parse_day(args[1]), _parse_day(args[2])), indent=2))
+    else:
+        print(__doc__)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main() or 0)
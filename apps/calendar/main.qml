@@ -21,11 +21,21 @@ Window {
     property string viewMode: "month"  // "month" or "week"
     property int currentWeekStart: 0  // Day of month for week view start
 
+    // Pre-expanded instances from calendar_engine.py (includes repeats and .ics calendars)
+    readonly property string engineUrl: "http://127.0.0.1:7658"
+    property bool engineAvailable: false
+    property var dayInstances: ({})  // "YYYY-MM-DD" -> [instance]
+    property int rangeGeneration: 0
+
     Component.onCompleted: {
         loadEvents()
         updateCurrentWeek()
+        loadMonthInstances()
     }
 
+    onCurrentMonthChanged: loadMonthInstances()
+    onCurrentYearChanged: loadMonthInstances()
+
     function loadEvents() {
         var eventsPath = Theme.stateDir + "/calendar.json"
         var xhr = new XMLHttpRequest()
@@ -53,6 +63,56 @@ Window {
         } catch (e) {
             console.log("Failed to save events: " + e)
         }
+        // The engine notices the new file and re-indexes only the changed events
+        loadMonthInstances()
+    }
+
+    function dateKey(d) {
+        return d.getFullYear() + "-" +
+               String(d.getMonth() + 1).padStart(2, '0') + "-" +
+               String(d.getDate()).padStart(2, '0')
+    }
+
+    // "YYYY-MM-DDTHH:MM" as local time (Date() may read a bare ISO string as UTC)
+    function parseLocal(iso) {
+        var p = iso.split(/[-T:]/)
+        return new Date(+p[0], +p[1] - 1, +p[2], +(p[3] || 0), +(p[4] || 0))
+    }
+
+    // Fetch every instance overlapping the visible month in one indexed query
+    function loadMonthInstances() {
+        var generation = ++rangeGeneration
+        var from = new Date(currentYear, currentMonth, 1)
+        var to = new Date(currentYear, currentMonth + 1, 1)
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            if (generation !== rangeGeneration) return
+            if (xhr.status !== 200) {
+                // Engine not running - fall back to calendar.json as stored
+                engineAvailable = false
+                return
+            }
+            var byDay = {}
+            var instances = JSON.parse(xhr.responseText).instances
+            for (var i = 0; i < instances.length; i++) {
+                var inst = instances[i]
+                // Multi-day events show on each day they cover within the month
+                var day = parseLocal(inst.start)
+                var end = parseLocal(inst.end)
+                do {
+                    var key = dateKey(day)
+                    if (!byDay[key]) byDay[key] = []
+                    byDay[key].push(inst)
+                    day = new Date(day.getFullYear(), day.getMonth(), day.getDate() + 1)
+                } while (day < end && day < to)
+            }
+            dayInstances = byDay
+            engineAvailable = true
+            if (selectedDay > 0) updateEventsList()
+        }
+        xhr.open("GET", engineUrl + "/range?from=" + dateKey(from) + "&to=" + dateKey(to))
+        xhr.send()
     }
 
     function updateCurrentWeek() {
@@ -90,19 +150,17 @@ Window {
     }
 
     function hasEvents(day) {
-        var key = getDateKey(day)
-        var result = events[key] && events[key].length > 0
-        return result
+        return getEventCount(day) > 0
     }
 
     function getEventsForDay(day) {
         var key = getDateKey(day)
+        if (engineAvailable) return dayInstances[key] || []
         return events[key] || []
     }
 
     function getEventCount(day) {
-        var key = getDateKey(day)
-        return events[key] ? events[key].length : 0
+        return getEventsForDay(day).length
     }
 
     function previousMonth() {
@@ -588,7 +646,7 @@ Window {
                                 }
 
                                 Text {
-                                    text: model.time || "All day"
+                                    text: (model.time || "All day") + (model.repeat ? "  ↻ " + model.repeat : "")
                                     font.pixelSize: 14
                                     color: accentColor
                                 }
@@ -600,6 +658,7 @@ Window {
                                 radius: 22
                                 color: delMouse.pressed ? accentColor : "#2a2a3e"
                                 anchors.verticalCenter: parent.verticalCenter
+                                visible: model.deletable
 
                                 Text {
                                     anchors.centerIn: parent
@@ -661,12 +720,28 @@ Window {
     function updateEventsList() {
         eventsModel.clear()
         if (selectedDay > 0) {
-            var dayEvents = getEventsForDay(selectedDay)
+            var key = getDateKey(selectedDay)
+            // Events stored on this day come first so row index == position in events[key]
+            var dayEvents = events[key] || []
             for (var i = 0; i < dayEvents.length; i++) {
                 eventsModel.append({
                     title: dayEvents[i].title || "Untitled",
                     time: dayEvents[i].time || "",
-                    index: i
+                    repeat: dayEvents[i].repeat || "",
+                    index: i,
+                    deletable: true
+                })
+            }
+            // Then repeats of events from other days and .ics calendar entries
+            var instances = engineAvailable ? (dayInstances[key] || []) : []
+            for (var j = 0; j < instances.length; j++) {
+                if (instances[j].origin === key) continue
+                eventsModel.append({
+                    title: instances[j].title,
+                    time: instances[j].time,
+                    repeat: instances[j].recurring ? "repeats" : "",
+                    index: -1,
+                    deletable: false
                 })
             }
         }
@@ -685,7 +760,7 @@ Window {
         updateEventsList()
     }
 
-    function addEvent(title, hour, minute) {
+    function addEvent(title, hour, minute, repeat) {
         var key = getDateKey(selectedDay)
         if (!events[key]) {
             events[key] = []
@@ -697,11 +772,13 @@ Window {
             var ampm = hour < 12 ? "AM" : "PM"
             timeStr = h + ":" + String(minute).padStart(2, '0') + " " + ampm
         }
-        events[key].push({
+        var event = {
             title: title,
             time: timeStr,
             date: key
-        })
+        }
+        if (repeat) event.repeat = repeat
+        events[key].push(event)
         saveEvents()
         updateEventsList()
     }
@@ -718,6 +795,7 @@ Window {
             titleInput.text = ""
             selectedHour = -1
             selectedMinute = 0
+            selectedRepeat = ""
             visible = true
             titleInput.forceActiveFocus()
         }
@@ -728,6 +806,7 @@ Window {
 
         property int selectedHour: -1
         property int selectedMinute: 0
+        property string selectedRepeat: ""  // "", daily, weekly, monthly, yearly
 
         MouseArea {
             anchors.fill: parent
@@ -737,7 +816,7 @@ Window {
         Rectangle {
             anchors.centerIn: parent
             width: parent.width - 60
-            height: 520
+            height: 600
             radius: 24
             color: "#1a1a2e"
             border.color: accentColor
@@ -970,6 +1049,49 @@ Window {
                     }
                 }
 
+                // Repeat picker
+                Column {
+                    width: parent.width
+                    spacing: 8
+
+                    Text {
+                        text: "Repeat"
+                        font.pixelSize: 14
+                        color: "#888899"
+                    }
+
+                    Row {
+                        spacing: 8
+
+                        Repeater {
+                            model: [["", "Never"], ["daily", "Daily"], ["weekly", "Weekly"],
+                                    ["monthly", "Monthly"], ["yearly", "Yearly"]]
+
+                            Rectangle {
+                                width: 80
+                                height: 32
+                                radius: 16
+                                color: eventPopup.selectedRepeat === modelData[0] ? accentColor : "#2a2a3e"
+
+                                Text {
+                                    anchors.centerIn: parent
+                                    text: modelData[1]
+                                    font.pixelSize: 14
+                                    color: "#ffffff"
+                                }
+
+                                MouseArea {
+                                    anchors.fill: parent
+                                    onClicked: {
+                                        Haptic.tap()
+                                        eventPopup.selectedRepeat = modelData[0]
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+
                 // Buttons
                 Row {
                     width: parent.width
@@ -1016,7 +1138,7 @@ Window {
                             onClicked: {
                                 if (titleInput.text.trim() !== "") {
                                     Haptic.click()
-                                    addEvent(titleInput.text.trim(), eventPopup.selectedHour, eventPopup.selectedMinute)
+                                    addEvent(titleInput.text.trim(), eventPopup.selectedHour, eventPopup.selectedMinute, eventPopup.selectedRepeat)
                                     eventPopup.close()
                                 }
                             }
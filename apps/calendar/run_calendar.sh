@@ -29,6 +29,13 @@ export QT_WAYLAND_DISABLE_WINDOWDECORATION=1
 # Allow QML to read local files (for config and events loading)
 export QML_XHR_ALLOW_FILE_READ=1
 
+# Recurrence index normally runs from start.sh; start it if it isn't up.
+# Left running on exit so other apps can ask for the next event.
+if ! pgrep -f "calendar_engine.py serve" > /dev/null; then
+    echo "Starting calendar engine" >> "$LOG_FILE"
+    python3 "$SCRIPT_DIR/calendar_engine.py" serve 2>> "$LOG_FILE" &
+fi
+
 # Run the calendar and capture save events
 stdbuf -oL -eL /usr/lib/qt5/bin/qmlscene "$SCRIPT_DIR/main.qml" 2>> "$LOG_FILE" | tee -a "$LOG_FILE" | while IFS= read -r line; do
     # Check for event save messages
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""Tests for calendar_engine.py: python3 -m unittest test_calendar_engine (from apps/calendar)"""
+
+import json
+import tempfile
+import unittest
+from datetime import date, datetime, timedelta
+from pathlib import Path
+
+import calendar_engine
+
+
+def event(start, rrule=None, minutes=60, exdates=(), all_day=False):
+    return {
+        "uid": "test", "title": "Test", "start": start, "minutes": minutes,
+        "all_day": all_day, "time": "", "rrule": rrule, "exdates": list(exdates), "origin": "test",
+    }
+
+
+def starts(ev, lo, hi):
+    return [dt.isoformat() for dt in calendar_engine.occurrences(ev, datetime.fromisoformat(lo),
+                                                                 datetime.fromisoformat(hi))]
+
+
+def ics(*vevents):
+    body = "".join(f"BEGIN:VEVENT\r\n{v.strip()}\r\nEND:VEVENT\r\n" for v in vevents)
+    return f"BEGIN:VCALENDAR\r\nVERSION:2.0\r\n{body}END:VCALENDAR\r\n"
+
+
+class OccurrencesTest(unittest.TestCase):
+    def test_monthly_on_the_31st_skips_short_months(self):
+        ev = event("2025-01-31T09:00:00", {"FREQ": "MONTHLY"})
+        self.assertEqual(starts(ev, "2025-01-01", "2025-09-01"), [
+            "2025-01-31T09:00:00", "2025-03-31T09:00:00", "2025-05-31T09:00:00",
+            "2025-07-31T09:00:00", "2025-08-31T09:00:00",
+        ])
+        # Skipping ahead to a later window lands on the same days
+        self.assertEqual(starts(ev, "2026-02-01", "2026-06-01"),
+                         ["2026-03-31T09:00:00", "2026-05-31T09:00:00"])
+
+    def test_count_includes_excluded_dates(self):
+        # RFC 5545: EXDATE removes instances from the COUNT set, it doesn't extend it
+        ev = event("2025-03-10T08:00:00", {"FREQ": "DAILY", "COUNT": "5"},
+                   exdates=["2025-03-12T08:00:00"])
+        self.assertEqual(starts(ev, "2025-03-01", "2025-04-01"), [
+            "2025-03-10T08:00:00", "2025-03-11T08:00:00", "2025-03-13T08:00:00", "2025-03-14T08:00:00",
+        ])
+        # COUNT is counted from DTSTART even when the window starts later
+        self.assertEqual(starts(ev, "2025-03-13T12:00", "2025-04-01"), ["2025-03-14T08:00:00"])
+
+    def test_count_with_weekly_byday(self):
+        ev = event("2025-03-05T18:00:00", {"FREQ": "WEEKLY", "BYDAY": "MO,WE", "COUNT": "3"})
+        self.assertEqual(starts(ev, "2025-03-01", "2025-04-01"), [
+            "2025-03-05T18:00:00", "2025-03-10T18:00:00", "2025-03-12T18:00:00",
+        ])
+
+    def test_until_is_inclusive_for_dates(self):
+        ev = event("2025-03-10T08:00:00", {"FREQ": "DAILY", "UNTIL": "20250312"})
+        self.assertEqual(starts(ev, "2025-03-01", "2025-04-01"), [
+            "2025-03-10T08:00:00", "2025-03-11T08:00:00", "2025-03-12T08:00:00",
+        ])
+
+    def test_all_day_event_covers_its_day_only(self):
+        ev = event("2025-03-10T00:00:00", minutes=24 * 60, all_day=True)
+        self.assertEqual(starts(ev, "2025-03-10T23:00", "2025-03-11"), ["2025-03-10T00:00:00"])
+        self.assertEqual(starts(ev, "2025-03-11", "2025-03-12"), [])
+
+    def test_yearly_on_feb_29_only_in_leap_years(self):
+        ev = event("2024-02-29T00:00:00", {"FREQ": "YEARLY"}, minutes=24 * 60, all_day=True)
+        self.assertEqual(starts(ev, "2024-01-01", "2029-01-01"),
+                         ["2024-02-29T00:00:00", "2028-02-29T00:00:00"])
+
+
+class IcsTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.path = Path(self.tmp.name) / "work.ics"
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_recurrence_id_override_replaces_one_instance(self):
+        self.path.write_text(ics("""
+UID:standup
+SUMMARY:Standup
+DTSTART:20250310T090000
+DTEND:20250310T091500
+RRULE:FREQ=DAILY;COUNT=3
+""", """
+UID:standup
+RECURRENCE-ID:20250311T090000
+SUMMARY:Standup (moved)
+DTSTART:20250311T140000
+DURATION:PT30M
+"""))
+        events = {ev["uid"]: ev for ev in calendar_engine.events_from_ics(self.path)}
+        self.assertEqual(set(events), {"work.ics:standup", "work.ics:standup@2025-03-11T09:00:00"})
+        master = events["work.ics:standup"]
+        self.assertEqual(master["minutes"], 15)
+        self.assertEqual(starts(master, "2025-03-01", "2025-04-01"),
+                         ["2025-03-10T09:00:00", "2025-03-12T09:00:00"])
+        moved = events["work.ics:standup@2025-03-11T09:00:00"]
+        self.assertEqual((moved["title"], moved["minutes"], moved["rrule"]), ("Standup (moved)", 30, None))
+
+    def test_all_day_and_cancelled(self):
+        self.path.write_text(ics("""
+UID:holiday
+SUMMARY:Holiday\\, long weekend
+DTSTART;VALUE=DATE:20250418
+DTEND;VALUE=DATE:20250422
+""", """
+UID:gone
+SUMMARY:Cancelled
+DTSTART:20250418T100000
+STATUS:CANCELLED
+"""))
+        events = calendar_engine.events_from_ics(self.path)
+        self.assertEqual(len(events), 1)
+        self.assertEqual(events[0]["title"], "Holiday, long weekend")
+        self.assertTrue(events[0]["all_day"])
+        self.assertEqual(events[0]["minutes"], 4 * 24 * 60)
+
+
+class EngineTest(unittest.TestCase):
+    """Index built from real sources; dates are relative to today so they
+    fall inside the engine's window"""
+
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.dir = Path(self.tmp.name)
+        (self.dir / "calendars").mkdir()
+        self.engine = calendar_engine.CalendarEngine(self.dir)
+        self.day = datetime.combine(date.today() + timedelta(days=7), datetime.min.time())
+
+    def tearDown(self):
+        self.engine.db.close()
+        self.tmp.cleanup()
+
+    def stamp(self, days, hour=None):
+        dt = self.day + timedelta(days=days)
+        return dt.strftime("%Y%m%d") if hour is None else dt.replace(hour=hour).strftime("%Y%m%dT%H%M%S")
+
+    def titles(self, days_from, days_to):
+        lo, hi = self.day + timedelta(days=days_from), self.day + timedelta(days=days_to)
+        return [(i["date"], i["title"]) for i in self.engine.range(lo, hi)]
+
+    def test_range_applies_overrides_exdates_and_all_day(self):
+        (self.dir / "calendars" / "work.ics").write_text(ics(f"""
+UID:gym
+SUMMARY:Gym
+DTSTART:{self.stamp(0, 7)}
+RRULE:FREQ=DAILY;COUNT=4
+EXDATE:{self.stamp(2, 7)}
+""", f"""
+UID:gym
+RECURRENCE-ID:{self.stamp(1, 7)}
+SUMMARY:Gym (late)
+DTSTART:{self.stamp(1, 19)}
+""", f"""
+UID:trip
+SUMMARY:Trip
+DTSTART;VALUE=DATE:{self.stamp(1)}
+DTEND;VALUE=DATE:{self.stamp(3)}
+"""))
+        d = [(self.day + timedelta(days=n)).date().isoformat() for n in range(5)]
+        self.assertEqual(self.titles(0, 5), [
+            (d[0], "Gym"), (d[1], "Trip"), (d[1], "Gym (late)"), (d[3], "Gym"),
+        ])
+        # The two-day trip still shows on its second day
+        self.assertEqual(self.titles(2, 3), [(d[1], "Trip")])
+
+    def test_calendar_json_edits_are_picked_up(self):
+        key = self.day.date().isoformat()
+        path = self.dir / "calendar.json"
+        path.write_text(json.dumps({key: [{"title": "Rent", "repeat": "monthly"}]}))
+        self.assertEqual(self.titles(0, 1), [(key, "Rent")])
+        instance = self.engine.range(self.day, self.day + timedelta(days=1))[0]
+        self.assertTrue(instance["all_day"] and instance["recurring"])
+
+        path.write_text(json.dumps({key: [{"title": "Dentist", "time": "3:30 PM"}]}))
+        instance, = self.engine.range(self.day, self.day + timedelta(days=1))
+        self.assertEqual((instance["title"], instance["start"][11:]), ("Dentist", "15:30"))
+        self.assertEqual(self.engine.stats()["events"], 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,656 @@
+#!/usr/bin/env python3
+"""
+Flick Contacts Store - indexed contact search and caller-ID lookup
+
+contacts.json stays the source of truth (Contacts, Messages and Phone all
+write it), but scanning it linearly on every keystroke or incoming call does
+not scale to large address books. This module keeps a SQLite index next to it:
+
+- numbers:     normalised digits stored reversed, so "ends with" becomes an
+               indexed range scan (caller ID matches with or without country
+               code / trunk prefix)
+- name_tokens: lower-cased name words for prefix search ("jo" -> "John Smith")
+- trigrams:    3-character name fragments for substring search ("ohn")
+- vcf_imports: per-file size/mtime/offset so re-importing a grown .vcf only
+               parses the new cards
+
+The index is rebuilt only when contacts.json's mtime/size changes, so a
+lookup is a stat() plus one indexed query.
+
+Python daemons import it directly:
+
+    from contacts_store import lookup_contact_name
+    name = lookup_contact_name("+1 (541) 799-9824")
+
+QML reaches it over localhost HTTP (same approach as the Store's install
+server):
+
+    python3 contacts_store.py serve [--port 7657]
+    GET /search?q=jo&limit=50   matching contacts, sorted by name
+    GET /lookup?number=...      {"name": ...} for caller ID
+    POST /import {"path": ...}  incremental vCard import into contacts.json
+                                (JSON body; files under ~/Documents only)
+    GET /status                 index stats
+
+The server sends no CORS headers, so web pages (the Web app included)
+cannot read its answers; QML's XMLHttpRequest does not need them.
+
+    python3 contacts_store.py lookup NUMBER
+    python3 contacts_store.py search QUERY
+    python3 contacts_store.py import FILE.vcf
+"""
+
+import json
+import os
+import re
+import sqlite3
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from pathlib import Path
+from urllib.parse import parse_qs, urlparse
+
+DEFAULT_PORT = 7657
+SCHEMA_VERSION = 1
+
+# Numbers shorter than this are service codes, never caller-ID candidates
+MIN_MATCH_DIGITS = 6
+# Subscriber part compared when the country/trunk prefix differs
+SUFFIX_DIGITS = 9
+DEFAULT_LIMIT = 50
+PHONE_PUNCTUATION = set("+-() .")
+# Leading bytes fingerprinted to detect a .vcf that was replaced, not appended to
+VCF_HEAD_BYTES = 256
+
+# Dropped during a rebuild and recreated afterwards; bulk-loading then
+# sorting once is several times faster than maintaining them per row
+INDEXES = """
+    CREATE INDEX IF NOT EXISTS contacts_sort ON contacts(sort_key);
+    CREATE INDEX IF NOT EXISTS numbers_rev ON numbers(rev);
+    CREATE INDEX IF NOT EXISTS name_tokens_token ON name_tokens(token);
+    CREATE INDEX IF NOT EXISTS trigrams_tri ON trigrams(tri);
+"""
+
+_WORD = re.compile(r"[^\W_]+")
+# SQLite's default bound-parameter limit is 999
+MAX_PARAMS = 500
+
+
+def log(msg):
+    print(f"[Contacts] {msg}", file=sys.stderr, flush=True)
+
+
+def get_home():
+    """Home of the Flick user (daemons may run as root via sudo)."""
+    home = os.environ.get("FLICK_HOME")
+    if not home:
+        home = str(Path.home())
+        for candidate in ("/home/furios", "/home/droidian"):
+            if os.geteuid() == 0 and os.path.isdir(candidate):
+                home = candidate
+                break
+    return Path(home)
+
+
+def get_state_dir():
+    return get_home() / ".local/state/flick"
+
+
+def import_path_allowed(path, root):
+    """Resolved path of a .vcf under `root`, or None for anything else."""
+    try:
+        resolved = Path(path).resolve(strict=True)
+        root = Path(root).resolve()
+    except (OSError, RuntimeError):
+        return None
+    if resolved.suffix.lower() != ".vcf" or not resolved.is_file() or not resolved.is_relative_to(root):
+        return None
+    return resolved
+
+
+def normalize_number(number):
+    """Digits only; drop international/trunk prefixes.
+
+    Matches the messaging daemon's rule for NANP numbers and also strips
+    a leading 00 (international) or single 0 (trunk) so local and
+    international forms of the same number compare equal by suffix.
+    """
+    if not number:
+        return ""
+    digits = "".join(c for c in str(number) if c.isdigit())
+    if digits.startswith("00"):
+        digits = digits[2:]
+    elif digits.startswith("0"):
+        digits = digits[1:]
+    if len(digits) == 11 and digits.startswith("1"):
+        digits = digits[1:]
+    return digits
+
+
+def name_tokens(name):
+    return _WORD.findall(name.lower())
+
+
+def trigrams(name):
+    text = " ".join(name_tokens(name))
+    return {text[i:i + 3] for i in range(len(text) - 2)} - {""}
+
+
+def initials_for(name):
+    parts = name.strip().split(" ")
+    if len(parts) >= 2 and parts[0] and parts[-1]:
+        return (parts[0][0] + parts[-1][0]).upper()
+    return name[:2].upper()
+
+
+def _prefix_range(prefix):
+    """[lo, hi) bounds so `col >= lo AND col < hi` is an indexed prefix match."""
+    return prefix, prefix + "￿"
+
+
+def parse_vcards(text):
+    """Yield {name, phone, email} from vCard text (handles folded lines)."""
+    card = None
+    # RFC 6350 line folding: continuation lines start with a space or tab
+    lines = []
+    for raw in text.splitlines():
+        if raw[:1] in (" ", "\t") and lines:
+            lines[-1] += raw[1:]
+        else:
+            lines.append(raw)
+
+    for line in lines:
+        line = line.strip()
+        upper = line.upper()
+        if upper == "BEGIN:VCARD":
+            card = {"name": "", "phone": "", "email": "", "n": ""}
+        elif upper == "END:VCARD":
+            if card is not None:
+                name = card["name"] or card["n"]
+                if name:
+                    yield {"name": name, "phone": card["phone"], "email": card["email"]}
+            card = None
+        elif card is not None and ":" in line:
+            key, value = line.split(":", 1)
+            prop = key.split(";", 1)[0].upper()
+            if prop == "FN":
+                card["name"] = value.strip()
+            elif prop == "N" and not card["n"]:
+                parts = [p.strip() for p in value.split(";")]
+                card["n"] = " ".join(p for p in (parts[1:2] + parts[:1]) if p)
+            elif prop == "TEL" and not card["phone"]:
+                card["phone"] = value.strip()
+            elif prop == "EMAIL" and not card["email"]:
+                card["email"] = value.strip()
+
+
+def _locked(method):
+    def wrapper(self, *args, **kwargs):
+        with self.lock:
+            return method(self, *args, **kwargs)
+    wrapper.__name__ = method.__name__
+    wrapper.__doc__ = method.__doc__
+    return wrapper
+
+
+class ContactsStore:
+    """SQLite index over contacts.json.
+
+    One instance is shared by all threads of a process (see shared_store());
+    its public methods serialise on the connection's lock.
+    """
+
+    def __init__(self, state_dir=None):
+        self.state_dir = Path(state_dir) if state_dir else get_state_dir()
+        self.json_path = self.state_dir / "contacts.json"
+        self.db_path = self.state_dir / "contacts.db"
+        self.state_dir.mkdir(parents=True, exist_ok=True)
+
+        self.lock = threading.RLock()
+        self.db = sqlite3.connect(str(self.db_path), timeout=5, isolation_level=None,
+                                  check_same_thread=False)
+        self.db.row_factory = sqlite3.Row
+        self.db.execute("PRAGMA journal_mode=WAL")
+        self.db.execute("PRAGMA synchronous=NORMAL")
+        self._create_schema()
+        self._fix_ownership()
+        self._json_stamp = None
+
+    @_locked
+    def close(self):
+        self.db.close()
+
+    def _create_schema(self):
+        version = self.db.execute("PRAGMA user_version").fetchone()[0]
+        if version == SCHEMA_VERSION:
+            return
+        self.db.executescript("""
+            DROP TABLE IF EXISTS contacts;
+            DROP TABLE IF EXISTS numbers;
+            DROP TABLE IF EXISTS name_tokens;
+            DROP TABLE IF EXISTS trigrams;
+            DROP TABLE IF EXISTS meta;
+            DROP TABLE IF EXISTS vcf_imports;
+            CREATE TABLE contacts (
+                id INTEGER PRIMARY KEY,
+                name TEXT NOT NULL,
+                phone TEXT NOT NULL,
+                email TEXT NOT NULL,
+                initials TEXT NOT NULL,
+                sort_key TEXT NOT NULL
+            );
+            CREATE TABLE numbers (rev TEXT NOT NULL, contact_id INTEGER NOT NULL);
+            CREATE TABLE name_tokens (token TEXT NOT NULL, contact_id INTEGER NOT NULL);
+            CREATE TABLE trigrams (tri TEXT NOT NULL, contact_id INTEGER NOT NULL);
+            CREATE TABLE meta (key TEXT PRIMARY KEY, value TEXT);
+            CREATE TABLE vcf_imports (
+                path TEXT PRIMARY KEY,
+                size INTEGER, mtime REAL, offset INTEGER, head TEXT
+            );
+        """)
+        self.db.executescript(INDEXES)
+        self.db.execute(f"PRAGMA user_version={SCHEMA_VERSION}")
+
+    def _fix_ownership(self):
+        # phone_helper runs as root; keep the index writable for the user
+        if os.geteuid() != 0:
+            return
+        try:
+            st = self.state_dir.stat()
+            for suffix in ("", "-wal", "-shm"):
+                path = Path(str(self.db_path) + suffix)
+                if path.exists():
+                    os.chown(path, st.st_uid, st.st_gid)
+        except OSError:
+            pass
+
+    # ---- Index maintenance -------------------------------------------------
+
+    def _stat_json(self):
+        try:
+            st = self.json_path.stat()
+            return f"{st.st_mtime_ns}:{st.st_size}"
+        except FileNotFoundError:
+            return "missing"
+
+    @_locked
+    def refresh(self):
+        """Rebuild the index if contacts.json changed since it was built."""
+        stamp = self._stat_json()
+        if stamp == self._json_stamp:
+            return
+        row = self.db.execute("SELECT value FROM meta WHERE key='json_stamp'").fetchone()
+        if row and row[0] == stamp:
+            self._json_stamp = stamp
+            return
+
+        self.db.execute("BEGIN IMMEDIATE")
+        try:
+            # Another process may have rebuilt while we waited for the lock
+            row = self.db.execute("SELECT value FROM meta WHERE key='json_stamp'").fetchone()
+            if not (row and row[0] == stamp):
+                self._rebuild(self._read_json())
+                self.db.execute("INSERT OR REPLACE INTO meta VALUES ('json_stamp', ?)", (stamp,))
+            self.db.execute("COMMIT")
+        except Exception:
+            self.db.execute("ROLLBACK")
+            raise
+        self._json_stamp = stamp
+
+    def _read_json(self):
+        try:
+            with open(self.json_path) as f:
+                return json.load(f).get("contacts", [])
+        except FileNotFoundError:
+            return []
+        except (ValueError, AttributeError) as e:
+            log(f"contacts.json unreadable, keeping empty index: {e}")
+            return []
+
+    def _rebuild(self, contacts):
+        start = time.monotonic()
+        for index in ("contacts_sort", "numbers_rev", "name_tokens_token", "trigrams_tri"):
+            self.db.execute(f"DROP INDEX IF EXISTS {index}")
+        for table in ("contacts", "numbers", "name_tokens", "trigrams"):
+            self.db.execute(f"DELETE FROM {table}")
+
+        rows, numbers, tokens, grams = [], [], [], []
+        for cid, c in enumerate(contacts, 1):
+            name = (c.get("name") or "").strip()
+            if not name:
+                continue
+            phone = c.get("phone") or ""
+            rows.append((cid, name, phone, c.get("email") or "",
+                         c.get("initials") or initials_for(name), name.lower()))
+            digits = normalize_number(phone)
+            if digits:
+                numbers.append((digits[::-1], cid))
+            tokens.extend((t, cid) for t in set(name_tokens(name)))
+            grams.extend((t, cid) for t in trigrams(name))
+
+        self.db.executemany("INSERT INTO contacts VALUES (?, ?, ?, ?, ?, ?)", rows)
+        self.db.executemany("INSERT INTO numbers VALUES (?, ?)", numbers)
+        self.db.executemany("INSERT INTO name_tokens VALUES (?, ?)", tokens)
+        self.db.executemany("INSERT INTO trigrams VALUES (?, ?)", grams)
+        for statement in INDEXES.split(";"):
+            if statement.strip():
+                self.db.execute(statement)
+        log(f"Indexed {len(rows)} contacts in {(time.monotonic() - start) * 1000:.0f}ms")
+
+    # ---- Queries -----------------------------------------------------------
+
+    @_locked
+    def lookup(self, number):
+        """Contact row for a phone number, or None.
+
+        Exact normalised match wins; otherwise the longest shared suffix of
+        at least SUFFIX_DIGITS (or the whole shorter number), so
+        "+44 7700 900123" finds "07700 900123".
+        """
+        self.refresh()
+        digits = normalize_number(number)
+        if not digits:
+            return None
+        if len(digits) < MIN_MATCH_DIGITS:
+            # Short codes only ever match exactly
+            row = self.db.execute(
+                "SELECT c.* FROM numbers n JOIN contacts c ON c.id = n.contact_id WHERE n.rev = ? LIMIT 1",
+                (digits[::-1],)).fetchone()
+            return dict(row) if row else None
+
+        rev = digits[::-1]
+        key = rev[:SUFFIX_DIGITS]
+        lo, hi = _prefix_range(key)
+        best, best_len = None, 0
+        for row in self.db.execute(
+                "SELECT n.rev, c.* FROM numbers n JOIN contacts c ON c.id = n.contact_id "
+                "WHERE n.rev >= ? AND n.rev < ?", (lo, hi)):
+            shared = len(os.path.commonprefix([rev, row["rev"]]))
+            if shared > best_len:
+                best, best_len = row, shared
+        if best is None or best_len < min(len(rev), len(best["rev"]), SUFFIX_DIGITS):
+            return None
+        result = dict(best)
+        result.pop("rev", None)
+        return result
+
+    def lookup_name(self, number):
+        """Display name for a number, or "" if unknown."""
+        try:
+            row = self.lookup(number)
+        except sqlite3.Error as e:
+            log(f"lookup failed: {e}")
+            return ""
+        return row["name"] if row else ""
+
+    @_locked
+    def search(self, query, limit=DEFAULT_LIMIT):
+        """Contacts matching a search box query, sorted by name.
+
+        Digits match phone numbers by suffix/contained digits; words match
+        name-word prefixes (all words must match); 3+ characters also match
+        anywhere in the name via the trigram index.
+        """
+        self.refresh()
+        query = (query or "").strip()
+        if not query:
+            rows = self.db.execute("SELECT * FROM contacts ORDER BY sort_key LIMIT ?", (limit,))
+            return [dict(r) for r in rows]
+
+        ids = self._name_matches(query)
+        if all(c.isdigit() or c in PHONE_PUNCTUATION for c in query):
+            digits = "".join(c for c in query if c.isdigit())
+            if digits:
+                ids |= self._number_matches(digits)
+        if not ids:
+            return []
+
+        results = [dict(r) for r in self._rows_by_id("*", ids)]
+        results.sort(key=lambda r: r["sort_key"])
+        return results[:limit]
+
+    def _rows_by_id(self, columns, ids):
+        # Chunk to stay below SQLite's bound-parameter limit
+        id_list = list(ids)
+        for i in range(0, len(id_list), MAX_PARAMS):
+            chunk = id_list[i:i + MAX_PARAMS]
+            marks = ",".join("?" * len(chunk))
+            yield from self.db.execute(f"SELECT {columns} FROM contacts WHERE id IN ({marks})", chunk)
+
+    def _name_matches(self, query):
+        tokens = name_tokens(query)
+        if not tokens:
+            return set()
+
+        ids = None
+        for token in tokens:
+            lo, hi = _prefix_range(token)
+            found = {r[0] for r in self.db.execute(
+                "SELECT contact_id FROM name_tokens WHERE token >= ? AND token < ?", (lo, hi))}
+            ids = found if ids is None else ids & found
+            if not ids:
+                break
+
+        # Substring match ("ohn" -> "John") via trigram intersection, verified
+        text = " ".join(tokens)
+        grams = trigrams(text)
+        if grams:
+            sub = None
+            for gram in grams:
+                found = {r[0] for r in self.db.execute(
+                    "SELECT contact_id FROM trigrams WHERE tri = ?", (gram,))}
+                sub = found if sub is None else sub & found
+                if not sub:
+                    break
+            if sub:
+                for r in self._rows_by_id("id, name", sub - ids):
+                    if text in " ".join(name_tokens(r["name"])):
+                        ids.add(r["id"])
+        return ids
+
+    def _number_matches(self, digits):
+        # Typed digits are usually the start or end of a number; the reversed
+        # index answers "ends with", and short inputs are rare enough to scan
+        rev = digits[::-1]
+        lo, hi = _prefix_range(rev)
+        ids = {r[0] for r in self.db.execute(
+            "SELECT contact_id FROM numbers WHERE rev >= ? AND rev < ?", (lo, hi))}
+        ids |= {r[0] for r in self.db.execute(
+            "SELECT contact_id FROM numbers WHERE instr(rev, ?) > 0", (rev,))}
+        return ids
+
+    @_locked
+    def count(self):
+        self.refresh()
+        return self.db.execute("SELECT COUNT(*) FROM contacts").fetchone()[0]
+
+    # ---- vCard import ------------------------------------------------------
+
+    @_locked
+    def import_vcf(self, path):
+        """Merge cards from a .vcf into contacts.json; returns number added.
+
+        Files previously imported are resumed from the last complete card if
+        they only grew (same leading bytes), so syncing an exported address
+        book again is proportional to what changed.
+        """
+        path = os.path.abspath(path)
+        st = os.stat(path)
+        prev = self.db.execute("SELECT * FROM vcf_imports WHERE path = ?", (path,)).fetchone()
+        with open(path, "rb") as f:
+            # Compare as many leading bytes as were recorded, so a file that
+            # was shorter than the fingerprint still counts as "only grew"
+            prev_head_len = len(prev["head"]) // 2 if prev else VCF_HEAD_BYTES
+            same_head = prev is not None and f.read(prev_head_len).hex() == prev["head"]
+            f.seek(0)
+            head = f.read(VCF_HEAD_BYTES).hex()
+
+        offset = 0
+        if same_head and st.st_size >= prev["size"]:
+            if st.st_size == prev["size"] and st.st_mtime == prev["mtime"]:
+                return 0
+            offset = prev["offset"]
+
+        with open(path, "rb") as f:
+            f.seek(offset)
+            data = f.read()
+        # Only consume up to the last complete card; a partial one is retried
+        end = data.upper().rfind(b"END:VCARD")
+        if end < 0:
+            return 0
+        end = data.find(b"\n", end)
+        end = len(data) if end < 0 else end + 1
+        text = data[:end].decode("utf-8", errors="replace")
+
+        contacts = self._read_json()
+        seen = {(c.get("name", "").strip().lower(), normalize_number(c.get("phone", ""))) for c in contacts}
+        seen_names = {key[0] for key in seen}
+        added = 0
+        for card in parse_vcards(text):
+            key = (card["name"].lower(), normalize_number(card["phone"]))
+            # Same name with no number, or same name+number, is a duplicate
+            if key in seen or (not key[1] and key[0] in seen_names):
+                continue
+            seen.add(key)
+            seen_names.add(key[0])
+            card["initials"] = initials_for(card["name"])
+            contacts.append(card)
+            added += 1
+
+        if added:
+            contacts.sort(key=lambda c: c.get("name", "").lower())
+            self._write_json(contacts)
+        self.db.execute("INSERT OR REPLACE INTO vcf_imports VALUES (?, ?, ?, ?, ?)",
+                        (path, st.st_size, st.st_mtime, offset + end, head))
+        log(f"Imported {added} new contacts from {path} (from byte {offset})")
+        self.refresh()
+        return added
+
+    def _write_json(self, contacts):
+        tmp = self.json_path.with_suffix(".json.tmp")
+        with open(tmp, "w") as f:
+            json.dump({"contacts": contacts}, f, indent=2)
+        os.replace(tmp, self.json_path)
+
+
+# ---- Localhost HTTP interface for QML --------------------------------------
+
+_shared_store = None
+_shared_lock = threading.Lock()
+
+
+def shared_store(state_dir=None):
+    """The process-wide store, opened on first use"""
+    global _shared_store
+    with _shared_lock:
+        if _shared_store is None:
+            _shared_store = ContactsStore(state_dir)
+        return _shared_store
+
+
+def lookup_contact_name(number, state_dir=None):
+    """Name for a phone number, or "" if unknown or the index is unavailable"""
+    if not number:
+        return ""
+    try:
+        return shared_store(state_dir).lookup_name(number)
+    except (OSError, sqlite3.Error) as e:
+        log(f"lookup failed: {e}")
+        return ""
+
+
+class Handler(BaseHTTPRequestHandler):
+    # vCards are only imported from here (where the picker browses and
+    # exports go); None means ~/Documents of the Flick user
+    import_root = None
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        params = {k: v[0] for k, v in parse_qs(url.query).items()}
+        try:
+            store = shared_store()
+            if url.path == "/search":
+                limit = int(params.get("limit", DEFAULT_LIMIT))
+                self._json(200, {"contacts": store.search(params.get("q", ""), limit)})
+            elif url.path == "/lookup":
+                row = store.lookup(params.get("number", ""))
+                self._json(200, {"name": row["name"] if row else "", "contact": row})
+            elif url.path == "/import":
+                self._json(405, {"error": "use POST"})
+            elif url.path == "/status":
+                self._json(200, {"contacts": store.count(), "db": str(store.db_path)})
+            else:
+                self._json(404, {"error": "not found"})
+        except (OSError, ValueError, sqlite3.Error) as e:
+            self._json(500, {"error": str(e)})
+
+    def do_POST(self):
+        if urlparse(self.path).path != "/import":
+            self._json(404, {"error": "not found"})
+            return
+        # A page cannot send a JSON body cross-origin without a preflight,
+        # which this server never answers
+        if self.headers.get("Content-Type", "").split(";")[0].strip() != "application/json":
+            self._json(415, {"error": "expected application/json"})
+            return
+        try:
+            length = int(self.headers.get("Content-Length", 0))
+            body = json.loads(self.rfile.read(length) or b"{}")
+            root = self.import_root or get_home() / "Documents"
+            path = import_path_allowed(str(body.get("path", "")), root)
+            if path is None:
+                self._json(403, {"error": f"only .vcf files under {root} can be imported"})
+                return
+            self._json(200, {"added": shared_store().import_vcf(str(path))})
+        except (OSError, ValueError, AttributeError, sqlite3.Error) as e:
+            self._json(500, {"error": str(e)})
+
+    def _json(self, status, payload):
+        body = json.dumps(payload).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, fmt, *args):
+        pass
+
+
+def serve(port):
+    # Build the index before accepting requests so the first search is fast
+    shared_store().refresh()
+    server = ThreadingHTTPServer(("127.0.0.1", port), Handler)
+    server.daemon_threads = True
+    log(f"Listening on 127.0.0.1:{port}")
+    server.serve_forever()
+
+
+def main():
+    args = sys.argv[1:]
+    if not args:
+        print(__doc__)
+        return 1
+
+    cmd = args[0]
+    if cmd == "serve":
+        port = int(args[2]) if len(args) > 2 and args[1] == "--port" else DEFAULT_PORT
+        serve(port)
+    elif cmd == "lookup" and len(args) > 1:
+        store = ContactsStore()
+        start = time.perf_counter()
+        name = store.lookup_name(args[1])
+        print(json.dumps({"name": name, "ms": round((time.perf_counter() - start) * 1000, 3)}))
+    elif cmd == "search" and len(args) > 1:
+        print(json.dumps(ContactsStore().search(" ".join(args[1:])), indent=2))
+    elif cmd == "import" and len(args) > 1:
+        print(json.dumps({"added": ContactsStore().import_vcf(args[1])}))
+    else:
+        print(__doc__)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main() or 0)
@@ -24,12 +24,71 @@ Window {
     property bool waitingForPicker: false
     property string statusMessage: ""
 
+    // Indexed search via contacts_store.py; falls back to substring filtering when it's not running
+    readonly property string storeUrl: "http://127.0.0.1:7657"
+    property bool storeAvailable: false
+    property var searchMatches: ({})
+    property int searchGeneration: 0
+
     ListModel { id: contactsModel }
 
     Component.onCompleted: {
         loadConfig()
         loadContacts()
         checkAddContactHint()
+        probeStore()
+    }
+
+    onSearchTextChanged: runSearch()
+
+    function probeStore() {
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState === XMLHttpRequest.DONE) {
+                storeAvailable = xhr.status === 200
+                if (storeAvailable && searchText !== "") runSearch()
+            }
+        }
+        xhr.open("GET", storeUrl + "/status")
+        xhr.send()
+    }
+
+    function contactKey(name, phone) {
+        return name + "\n" + phone
+    }
+
+    function runSearch() {
+        var generation = ++searchGeneration
+        if (searchText === "" || !storeAvailable) {
+            searchMatches = {}
+            return
+        }
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            // Drop replies to older keystrokes
+            if (generation !== searchGeneration) return
+            if (xhr.status !== 200) {
+                storeAvailable = false
+                return
+            }
+            var matches = {}
+            var results = JSON.parse(xhr.responseText).contacts
+            for (var i = 0; i < results.length; i++) {
+                matches[contactKey(results[i].name, results[i].phone)] = true
+            }
+            searchMatches = matches
+        }
+        xhr.open("GET", storeUrl + "/search?q=" + encodeURIComponent(searchText) +
+                 "&limit=" + Math.max(contactsModel.count, 1))
+        xhr.send()
+    }
+
+    function matchesSearch(name, phone) {
+        if (searchText === "") return true
+        if (storeAvailable) return searchMatches[contactKey(name, phone)] === true
+        return name.toLowerCase().indexOf(searchText.toLowerCase()) >= 0 ||
+               phone.indexOf(searchText) >= 0
     }
 
     function checkAddContactHint() {
@@ -110,12 +169,13 @@ Window {
                 waitingForPicker = false
                 pickerPollTimer.stop()
                 // Now import from the selected file
-                var count = importContacts()
-                if (count > 0) {
-                    statusMessage = "Imported " + count + " contacts"
-                } else {
-                    statusMessage = "No new contacts found in file"
-                }
+                importContacts(function(count) {
+                    if (count > 0) {
+                        statusMessage = "Imported " + count + " contacts"
+                    } else {
+                        statusMessage = "No new contacts found in file"
+                    }
+                })
             }
         } catch (e) {
             // File doesn't exist yet, keep polling
@@ -160,6 +220,7 @@ Window {
         } catch (e) {
             console.log("Error saving contacts: " + e)
         }
+        if (searchText !== "") runSearch()
     }
 
     function sortContacts() {
@@ -290,68 +351,101 @@ Window {
         }
     }
 
-    function importContacts() {
+    // Imports importPath asynchronously and calls done(count) with the
+    // number of contacts added
+    function importContacts(done) {
         if (!importPath || importPath === "") {
             console.log("No import path set")
-            return 0
+            done(0)
+            return
+        }
+        if (!storeAvailable) {
+            importContactsLocally(done)
+            return
         }
+        // The store merges into contacts.json and only parses cards added since the last import
+        var storeXhr = new XMLHttpRequest()
+        storeXhr.onreadystatechange = function() {
+            if (storeXhr.readyState !== XMLHttpRequest.DONE) return
+            if (storeXhr.status === 200) {
+                try {
+                    var added = JSON.parse(storeXhr.responseText).added
+                    if (added > 0) loadContacts()
+                    console.log("Imported " + added + " contacts from " + importPath)
+                    done(added)
+                    return
+                } catch (e) {}
+            }
+            console.log("Contacts store import failed, parsing locally")
+            importContactsLocally(done)
+        }
+        storeXhr.open("POST", storeUrl + "/import")
+        storeXhr.setRequestHeader("Content-Type", "application/json")
+        storeXhr.send(JSON.stringify({ path: importPath }))
+    }
+
+    function importContactsLocally(done) {
         var xhr = new XMLHttpRequest()
-        xhr.open("GET", "file://" + importPath, false)
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            done(xhr.status === 200 || xhr.status === 0 ? parseVcf(xhr.responseText) : 0)
+        }
+        xhr.open("GET", "file://" + importPath)
+        xhr.send()
+    }
+
+    function parseVcf(vcf) {
         try {
-            xhr.send()
-            if (xhr.status === 200 || xhr.status === 0) {
-                var vcf = xhr.responseText
-                var imported = 0
-                var cards = vcf.split("END:VCARD")
-
-                for (var i = 0; i < cards.length; i++) {
-                    var card = cards[i]
-                    if (card.indexOf("BEGIN:VCARD") < 0) continue
-
-                    var name = "", phone = "", email = ""
-                    var lines = card.split("\n")
-
-                    for (var j = 0; j < lines.length; j++) {
-                        var line = lines[j].trim()
-                        if (line.indexOf("FN:") === 0) {
-                            name = line.substring(3)
-                        } else if (line.indexOf("TEL") === 0) {
-                            var colonIdx = line.indexOf(":")
-                            if (colonIdx > 0) phone = line.substring(colonIdx + 1)
-                        } else if (line.indexOf("EMAIL") === 0) {
-                            var emailIdx = line.indexOf(":")
-                            if (emailIdx > 0) email = line.substring(emailIdx + 1)
-                        }
+            var imported = 0
+            var cards = vcf.split("END:VCARD")
+
+            for (var i = 0; i < cards.length; i++) {
+                var card = cards[i]
+                if (card.indexOf("BEGIN:VCARD") < 0) continue
+
+                var name = "", phone = "", email = ""
+                var lines = card.split("\n")
+
+                for (var j = 0; j < lines.length; j++) {
+                    var line = lines[j].trim()
+                    if (line.indexOf("FN:") === 0) {
+                        name = line.substring(3)
+                    } else if (line.indexOf("TEL") === 0) {
+                        var colonIdx = line.indexOf(":")
+                        if (colonIdx > 0) phone = line.substring(colonIdx + 1)
+                    } else if (line.indexOf("EMAIL") === 0) {
+                        var emailIdx = line.indexOf(":")
+                        if (emailIdx > 0) email = line.substring(emailIdx + 1)
                     }
+                }
 
-                    if (name) {
-                        // Check for duplicates by name
-                        var exists = false
-                        for (var k = 0; k < contactsModel.count; k++) {
-                            if (contactsModel.get(k).name === name) {
-                                exists = true
-                                break
-                            }
-                        }
-                        if (!exists) {
-                            contactsModel.append({
-                                name: name,
-                                phone: phone,
-                                email: email,
-                                initials: getInitials(name)
-                            })
-                            imported++
+                if (name) {
+                    // Check for duplicates by name
+                    var exists = false
+                    for (var k = 0; k < contactsModel.count; k++) {
+                        if (contactsModel.get(k).name === name) {
+                            exists = true
+                            break
                         }
                     }
+                    if (!exists) {
+                        contactsModel.append({
+                            name: name,
+                            phone: phone,
+                            email: email,
+                            initials: getInitials(name)
+                        })
+                        imported++
+                    }
                 }
+            }
 
-                if (imported > 0) {
-                    sortContacts()
-                    saveContacts()
-                }
-                console.log("Imported " + imported + " contacts from " + importPath)
-                return imported
+            if (imported > 0) {
+                sortContacts()
+                saveContacts()
             }
+            console.log("Imported " + imported + " contacts from " + importPath)
+            return imported
         } catch (e) {
             console.log("Import error: " + e)
         }
@@ -531,9 +625,7 @@ Window {
                 height: visible ? 80 : 0
                 radius: 12
                 color: itemMouse.pressed ? "#1a1a2e" : "#15151f"
-                visible: searchText === "" ||
-                         model.name.toLowerCase().indexOf(searchText.toLowerCase()) >= 0 ||
-                         model.phone.indexOf(searchText) >= 0
+                visible: matchesSearch(model.name, model.phone)
 
                 Row {
                     anchors.fill: parent
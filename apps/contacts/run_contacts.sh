@@ -11,6 +11,13 @@ mkdir -p ~/.local/state/flick
 
 echo "Starting Contacts app" >> "$LOG_FILE"
 
+# Contacts index normally runs from start.sh; start it if it isn't up.
+# Left running on exit - Messages and Phone use it for caller ID.
+if ! pgrep -f "contacts_store.py serve" > /dev/null; then
+    echo "Starting contacts store" >> "$LOG_FILE"
+    python3 "$SCRIPT_DIR/contacts_store.py" serve 2>> "$LOG_FILE" &
+fi
+
 # Run /usr/lib/qt5/bin/qmlscene and capture output for picker commands
 stdbuf -oL -eL /usr/lib/qt5/bin/qmlscene "$SCRIPT_DIR/main.qml" 2>&1 | tee -a "$LOG_FILE" | while IFS= read -r line; do
     # Check for picker clear command
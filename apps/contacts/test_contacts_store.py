@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""Tests for contacts_store.py: python3 -m unittest test_contacts_store (from apps/contacts)"""
+
+import http.client
+import http.server
+import json
+import tempfile
+import threading
+import unittest
+from pathlib import Path
+
+import contacts_store
+
+CONTACTS = [
+    {"name": "John Smith", "phone": "+1 (541) 799-9824", "email": "john@example.com"},
+    {"name": "Johanna Berg", "phone": "+44 7700 900123", "email": ""},
+    {"name": "Bob Dylan", "phone": "112", "email": ""},
+    {"name": "Anna Schmidt", "phone": "", "email": "anna@example.com"},
+]
+
+VCF = """BEGIN:VCARD
+VERSION:3.0
+FN:Carol Jones
+TEL;TYPE=CELL:+49 30 1234567
+END:VCARD
+BEGIN:VCARD
+VERSION:3.0
+N:Lee;Dana;;;
+EMAIL:dana@exa
+ mple.com
+END:VCARD
+BEGIN:VCARD
+VERSION:3.0
+FN:John Smith
+TEL:+1 (541) 799-9824
+END:VCARD
+"""
+
+MORE_VCF = """BEGIN:VCARD
+VERSION:3.0
+FN:Eve Adams
+TEL:0612345678
+END:VCARD
+"""
+
+
+class StoreTestCase(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.dir = Path(self.tmp.name)
+        (self.dir / "contacts.json").write_text(json.dumps({"contacts": CONTACTS}))
+        self.store = contacts_store.ContactsStore(self.dir)
+
+    def tearDown(self):
+        self.store.close()
+        self.tmp.cleanup()
+
+    def names(self, rows):
+        return sorted(r["name"] for r in rows)
+
+
+class LookupTest(StoreTestCase):
+    def test_lookup_matches_by_number_suffix(self):
+        self.assertEqual(self.store.lookup_name("5417999824"), "John Smith")
+        self.assertEqual(self.store.lookup_name("001 541 799 9824"), "John Smith")
+        # Local (trunk prefix) and international forms of the same number
+        self.assertEqual(self.store.lookup_name("07700 900123"), "Johanna Berg")
+        self.assertEqual(self.store.lookup_name("+447700900123"), "Johanna Berg")
+
+    def test_lookup_rejects_partial_numbers(self):
+        self.assertEqual(self.store.lookup_name("9824"), "")
+        self.assertEqual(self.store.lookup_name("+1 541 799 0000"), "")
+
+    def test_short_codes_match_exactly(self):
+        self.assertEqual(self.store.lookup_name("112"), "Bob Dylan")
+        self.assertEqual(self.store.lookup_name("12"), "")
+
+    def test_index_follows_contacts_json(self):
+        contacts = CONTACTS + [{"name": "Zed New", "phone": "+1 202 555 0147"}]
+        (self.dir / "contacts.json").write_text(json.dumps({"contacts": contacts}))
+        self.assertEqual(self.store.lookup_name("2025550147"), "Zed New")
+
+
+class SearchTest(StoreTestCase):
+    def test_word_prefix_search(self):
+        self.assertEqual(self.names(self.store.search("jo")), ["Johanna Berg", "John Smith"])
+        self.assertEqual(self.names(self.store.search("jo sm")), ["John Smith"])
+
+    def test_trigram_substring_search(self):
+        self.assertEqual(self.names(self.store.search("ohn")), ["John Smith"])
+        self.assertEqual(self.names(self.store.search("mid")), ["Anna Schmidt"])
+        # Every trigram matches some name, but no name contains the text
+        self.assertEqual(self.store.search("ohna smi"), [])
+
+    def test_digits_search_numbers(self):
+        self.assertEqual(self.names(self.store.search("9824")), ["John Smith"])
+        self.assertEqual(self.names(self.store.search("799")), ["John Smith"])
+
+    def test_empty_query_lists_sorted_with_limit(self):
+        self.assertEqual([r["name"] for r in self.store.search("", limit=2)], ["Anna Schmidt", "Bob Dylan"])
+
+
+class ImportTest(StoreTestCase):
+    def contacts(self):
+        return json.loads((self.dir / "contacts.json").read_text())["contacts"]
+
+    def test_import_adds_new_cards_once(self):
+        vcf = self.dir / "book.vcf"
+        vcf.write_text(VCF)
+        # John Smith is already there; Dana's folded EMAIL line is unfolded
+        self.assertEqual(self.store.import_vcf(str(vcf)), 2)
+        added = {c["name"]: c for c in self.contacts()}
+        self.assertEqual(added["Carol Jones"]["phone"], "+49 30 1234567")
+        self.assertEqual(added["Dana Lee"]["email"], "dana@example.com")
+        self.assertEqual(self.store.lookup_name("030 1234567"), "Carol Jones")
+
+        self.assertEqual(self.store.import_vcf(str(vcf)), 0)
+
+    def test_grown_file_is_resumed(self):
+        vcf = self.dir / "book.vcf"
+        vcf.write_text(VCF)
+        self.store.import_vcf(str(vcf))
+        with open(vcf, "a") as f:
+            f.write(MORE_VCF)
+        self.assertEqual(self.store.import_vcf(str(vcf)), 1)
+        self.assertEqual(self.names(self.store.search("eve")), ["Eve Adams"])
+
+
+class ServerTest(StoreTestCase):
+    def setUp(self):
+        super().setUp()
+        self.documents = self.dir / "Documents"
+        self.documents.mkdir()
+        contacts_store._shared_store = self.store
+        contacts_store.Handler.import_root = self.documents
+        self.server = http.server.ThreadingHTTPServer(("127.0.0.1", 0), contacts_store.Handler)
+        threading.Thread(target=self.server.serve_forever, daemon=True).start()
+
+    def tearDown(self):
+        self.server.shutdown()
+        self.server.server_close()
+        contacts_store._shared_store = None
+        contacts_store.Handler.import_root = None
+        super().tearDown()
+
+    def request(self, method, path, body=None, content_type="application/json"):
+        conn = http.client.HTTPConnection("127.0.0.1", self.server.server_port, timeout=5)
+        headers = {"Content-Type": content_type} if body is not None else {}
+        conn.request(method, path, body=body, headers=headers)
+        response = conn.getresponse()
+        data = response.read()
+        conn.close()
+        if response.getheader("Content-Type") != "application/json":
+            return response, None
+        return response, json.loads(data)
+
+    def test_no_cors_headers(self):
+        response, payload = self.request("GET", "/search?q=jo")
+        self.assertEqual(response.status, 200)
+        self.assertEqual(len(payload["contacts"]), 2)
+        self.assertIsNone(response.getheader("Access-Control-Allow-Origin"))
+        response, _ = self.request("OPTIONS", "/search")
+        self.assertIsNone(response.getheader("Access-Control-Allow-Origin"))
+
+    def test_import_is_post_only(self):
+        (self.documents / "book.vcf").write_text(VCF)
+        response, _ = self.request("GET", "/import?path=" + str(self.documents / "book.vcf"))
+        self.assertEqual(response.status, 405)
+
+        body = json.dumps({"path": str(self.documents / "book.vcf")})
+        response, _ = self.request("POST", "/import", body, content_type="text/plain")
+        self.assertEqual(response.status, 415)
+
+        response, payload = self.request("POST", "/import", body)
+        self.assertEqual(response.status, 200)
+        self.assertEqual(payload["added"], 2)
+
+    def test_import_outside_documents_refused(self):
+        outside = self.dir / "book.vcf"
+        outside.write_text(VCF)
+        (self.documents / "link.vcf").symlink_to(outside)
+        (self.documents / "notes.txt").write_text(VCF)
+        for path in (outside, self.documents / "link.vcf", self.documents / "notes.txt",
+                     self.documents / ".." / "book.vcf", "/etc/passwd"):
+            response, _ = self.request("POST", "/import", json.dumps({"path": str(path)}))
+            self.assertEqual(response.status, 403, path)
+        self.assertEqual(self.store.count(), len(CONTACTS))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -51,7 +51,7 @@ Window {
 
     // ==================== SOUND GENERATION ====================
 
-    // Audio player pool for polyphonic sound playback
+    // Fallback QtMultimedia pool, only built if flick-audio-engine isn't running
     property var audioPool: []
     property int audioPoolSize: 10
     property int currentAudioIndex: 0
@@ -60,8 +60,14 @@ Window {
     property var frequencies: [200, 250, 300, 350, 400, 450, 500, 550, 600, 650, 700, 750, 800]
     property var waveformNames: ["sine", "square", "triangle", "sawtooth"]
 
-    // Initialize audio pool
-    Component.onCompleted: {
+    // The engine closes its stream when idle; reopen it as the app comes
+    // forward so the first tap doesn't wait for the sink to resume
+    Component.onCompleted: AudioEngine.warm()
+    onActiveChanged: if (active) AudioEngine.warm()
+
+    // Create the fallback audio pool on first use
+    function ensureAudioPool() {
+        if (audioPool.length > 0) return
         for (var i = 0; i < audioPoolSize; i++) {
             var audio = Qt.createQmlObject('
                 import QtQuick 2.15
@@ -109,8 +115,15 @@ Window {
         })
     }
 
-    // Play a beep from pre-generated sound files
+    // Play a beep - synthesized by the audio engine when available,
+    // otherwise from the pre-generated sound files
     function playBeep(freq, waveType, volume) {
+        if (AudioEngine.available) {
+            AudioEngine.tone(freq, waveType, volume)
+            return
+        }
+        ensureAudioPool()
+
         // Get next available audio player from pool
         var audio = audioPool[currentAudioIndex]
         currentAudioIndex = (currentAudioIndex + 1) % audioPoolSize
@@ -57,26 +57,52 @@ Window {
 
     function loadConfig() {
         var xhr = new XMLHttpRequest()
-        xhr.open("GET", "file://" + Theme.stateDir + "/display_config.json", false)
-        try {
-            xhr.send()
-            if (xhr.status === 200 || xhr.status === 0) {
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            if (xhr.status !== 200 && xhr.status !== 0) return
+            try {
                 var c = JSON.parse(xhr.responseText)
                 textScale = c.text_scale || 1.0
                 fontSize = 22 * textScale
-            }
-        } catch (e) {}
+            } catch (e) {}
+        }
+        xhr.open("GET", "file://" + Theme.stateDir + "/display_config.json")
+        xhr.send()
     }
 
     function loadPositions() {
         var xhr = new XMLHttpRequest()
-        xhr.open("GET", "file://" + positionsFile, false)
-        try {
-            xhr.send()
-            if (xhr.status === 200 || xhr.status === 0) {
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            if (xhr.status !== 200 && xhr.status !== 0) return
+            try {
                 positions = JSON.parse(xhr.responseText)
-            }
-        } catch (e) { positions = {} }
+            } catch (e) { positions = {} }
+        }
+        xhr.open("GET", "file://" + positionsFile)
+        xhr.send()
+    }
+
+    // One asynchronous write in flight at a time; a save requested meanwhile
+    // is written when it completes, so an older write never lands last
+    property bool positionsSaving: false
+    property bool positionsDirty: false
+
+    function writePositions() {
+        if (positionsSaving) {
+            positionsDirty = true
+            return
+        }
+        positionsSaving = true
+        positionsDirty = false
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            positionsSaving = false
+            if (positionsDirty) writePositions()
+        }
+        xhr.open("PUT", "file://" + positionsFile)
+        xhr.send(JSON.stringify(positions))
     }
 
     function savePosition() {
@@ -88,9 +114,7 @@ Window {
             serifFont: serifFont,
             totalPages: bookPages.length
         }
-        var xhr = new XMLHttpRequest()
-        xhr.open("PUT", "file://" + positionsFile, false)
-        try { xhr.send(JSON.stringify(positions)) } catch (e) {}
+        writePositions()
     }
 
     function scanBooks() {
@@ -106,14 +130,11 @@ Window {
             import Qt.labs.folderlistmodel 2.15
             FolderListModel { showDirs: false; nameFilters: ["*.txt"] }
         ', root)
-        model.folder = "file://" + path
-
-        var timer = Qt.createQmlObject('import QtQuick 2.15; Timer { interval: 100; repeat: true }', root)
-        var count = 0
-        timer.triggered.connect(function() {
-            count++
-            if (model.status === 2 || count > 10) {
-                timer.stop()
+        // Listed in the model's worker thread; rows are read once it is Ready
+        var listed = false
+        model.statusChanged.connect(function() {
+            if (model.status === FolderListModel.Ready && !listed) {
+                listed = true
                 for (var i = 0; i < model.count; i++) {
                     var name = model.get(i, "fileName")
                     var fpath = model.get(i, "filePath")
@@ -126,11 +147,12 @@ Window {
                     }
                 }
                 model.destroy()
-                timer.destroy()
                 booksModel.sync()
             }
         })
-        timer.start()
+        model.folder = "file://" + path
+        // A missing folder leaves the model Null and never becomes Ready
+        if (model.status === FolderListModel.Null) model.destroy()
     }
 
     function getCoverColor(title) {
@@ -180,9 +202,10 @@ Window {
         }
 
         var xhr = new XMLHttpRequest()
-        xhr.open("GET", "file://" + book.path, false)
-        try {
-            xhr.send()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            // Another book was opened while this one was loading
+            if (!currentBook || currentBook.path !== book.path) return
             if (xhr.status === 200 || xhr.status === 0) {
                 bookContent = xhr.responseText
                 wordCount = bookContent.split(/\s+/).length
@@ -190,7 +213,9 @@ Window {
                 currentView = "reader"
                 immersiveMode = false
             }
-        } catch (e) {}
+        }
+        xhr.open("GET", "file://" + book.path)
+        xhr.send()
     }
 
     function paginate() {
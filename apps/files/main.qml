@@ -62,25 +62,18 @@ Window {
         }
     }
 
-    function matchesFilter(fileName) {
-        if (!pickerMode || pickerFilter === "") return true
-        var lower = fileName.toLowerCase()
-        if (pickerFilter === "images") {
-            return lower.endsWith(".png") || lower.endsWith(".jpg") ||
-                   lower.endsWith(".jpeg") || lower.endsWith(".webp") ||
-                   lower.endsWith(".bmp") || lower.endsWith(".gif")
-        } else if (pickerFilter === "audio") {
-            return lower.endsWith(".mp3") || lower.endsWith(".wav") ||
-                   lower.endsWith(".ogg") || lower.endsWith(".flac") ||
-                   lower.endsWith(".m4a") || lower.endsWith(".aac")
-        } else if (pickerFilter === "video") {
-            return lower.endsWith(".mp4") || lower.endsWith(".mkv") ||
-                   lower.endsWith(".webm") || lower.endsWith(".avi") ||
-                   lower.endsWith(".mov")
-        } else if (pickerFilter === "vcf") {
-            return lower.endsWith(".vcf") || lower.endsWith(".vcard")
-        }
-        return true
+    // Extensions per picker filter. Applied as folderModel.nameFilters so
+    // filtering happens in the model's worker thread, not per delegate.
+    readonly property var filterExtensions: ({
+        "images": ["png", "jpg", "jpeg", "webp", "bmp", "gif"],
+        "audio": ["mp3", "wav", "ogg", "flac", "m4a", "aac"],
+        "video": ["mp4", "mkv", "webm", "avi", "mov"],
+        "vcf": ["vcf", "vcard"]
+    })
+
+    function filterPatterns() {
+        if (!pickerMode || !filterExtensions[pickerFilter]) return []
+        return filterExtensions[pickerFilter].map(function(ext) { return "*." + ext })
     }
 
     function pickFile(filePath) {
@@ -113,6 +106,10 @@ Window {
         showDotAndDotDot: false
         showHidden: false
         sortField: FolderListModel.Name
+        sortCaseSensitive: false
+        // Picker filter; directories are always listed
+        nameFilters: filterPatterns()
+        caseSensitive: false
     }
 
     function navigateTo(path) {
@@ -251,8 +248,7 @@ Window {
         model: folderModel
         delegate: Rectangle {
             width: listView.width
-            height: (model.fileIsDir || matchesFilter(model.fileName)) ? 70 * textScale : 0
-            visible: model.fileIsDir || matchesFilter(model.fileName)
+            height: 70 * textScale
             color: mouseArea.pressed ? "#1a1a2e" : "transparent"
 
             Rectangle {
@@ -281,11 +277,14 @@ Window {
                     // Image thumbnail for image files
                     Image {
                         anchors.fill: parent
-                        source: (!model.fileIsDir && pickerFilter === "images" && matchesFilter(model.fileName))
+                        source: (!model.fileIsDir && pickerFilter === "images")
                                 ? "file://" + model.filePath : ""
                         fillMode: Image.PreserveAspectCrop
-                        visible: !model.fileIsDir && pickerFilter === "images" && matchesFilter(model.fileName)
+                        visible: !model.fileIsDir && pickerFilter === "images"
                         asynchronous: true
+                        // Decode at thumbnail size, not full camera resolution
+                        sourceSize.width: width
+                        sourceSize.height: height
                     }
 
                     Text {
@@ -306,7 +305,7 @@ Window {
                     Text {
                         width: parent.width
                         text: model.fileName
-                        color: matchesFilter(model.fileName) || model.fileIsDir ? "#ffffff" : "#666677"
+                        color: "#ffffff"
                         font.pixelSize: 14 * textScale
                         font.weight: Font.Medium
                         elide: Text.ElideRight
@@ -336,7 +335,7 @@ Window {
                     anchors.verticalCenter: parent.verticalCenter
                     radius: 18 * textScale
                     color: accentColor
-                    visible: pickerMode && !model.fileIsDir && matchesFilter(model.fileName)
+                    visible: pickerMode && !model.fileIsDir
 
                     Text {
                         anchors.centerIn: parent
@@ -357,9 +356,8 @@ Window {
                         navigateTo(model.filePath)
                     } else if (pickerMode) {
                         // In picker mode, select the file and return
-                        if (matchesFilter(model.fileName)) {
-                            pickFile(model.filePath)
-                        }
+                        // (folderModel only lists files matching the filter)
+                        pickFile(model.filePath)
                     } else {
                         openFile(model.filePath)
                     }
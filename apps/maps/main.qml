@@ -37,9 +37,111 @@ Window {
     property bool hasGpsFix: false
     property bool gpsWaiting: true
 
+    // Offline tile store (tile_server.py, started by run_maps.sh)
+    readonly property string tileServerUrl: "http://127.0.0.1:7656"
+    property bool tileServerAvailable: false
+    // Region download needs a bulk-capable tile source (FLICK_MAPS_BULK_UPSTREAM)
+    property bool tileBulkDownload: false
+    property var tileDownload: null
+
     Component.onCompleted: {
         loadConfig()
         loadFavorites()
+        checkTileServer()
+    }
+
+    // Switch to the custom map type, which is served by the offline tile store
+    function useOfflineTiles() {
+        if (!tileServerAvailable) return
+        var types = map.supportedMapTypes
+        for (var i = 0; i < types.length; i++) {
+            if (types[i].style === MapType.CustomMap) {
+                map.activeMapType = types[i]
+                return
+            }
+        }
+    }
+
+    function checkTileServer() {
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            if (xhr.status === 200) {
+                try {
+                    tileBulkDownload = JSON.parse(xhr.responseText).bulk_download === true
+                } catch (e) {}
+                tileServerAvailable = true
+                console.log("Tile server available, region download:", tileBulkDownload)
+                useOfflineTiles()
+            } else if (tileServerRetry.attempts < 10) {
+                // The server may still be starting - retry briefly before giving up
+                tileServerRetry.attempts++
+                tileServerRetry.start()
+            } else {
+                console.log("Tile server not available")
+            }
+        }
+        xhr.open("GET", tileServerUrl + "/status")
+        xhr.send()
+    }
+
+    Timer {
+        id: tileServerRetry
+        property int attempts: 0
+        interval: 300
+        onTriggered: checkTileServer()
+    }
+
+    // Save the visible area (current zoom + 3 levels of detail) for offline use
+    function downloadVisibleArea() {
+        var rect = map.visibleRegion.boundingGeoRectangle()
+        var minZoom = Math.max(0, Math.floor(map.zoomLevel) - 2)
+        var maxZoom = Math.min(17, Math.floor(map.zoomLevel) + 3)
+        var url = tileServerUrl + "/download?south=" + rect.bottomLeft.latitude +
+                  "&west=" + rect.bottomLeft.longitude +
+                  "&north=" + rect.topRight.latitude +
+                  "&east=" + rect.topRight.longitude +
+                  "&minzoom=" + minZoom + "&maxzoom=" + maxZoom
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState === XMLHttpRequest.DONE) {
+                try {
+                    var result = JSON.parse(xhr.responseText)
+                    tileDownload = { active: result.success, done: 0, total: 0, message: result.message }
+                } catch (e) {
+                    tileDownload = { active: false, done: 0, total: 0, message: "Tile server not running" }
+                }
+                downloadStatusHide.restart()
+            }
+        }
+        xhr.open("GET", url)
+        xhr.send()
+    }
+
+    // Poll download progress while a region download runs
+    Timer {
+        interval: 1000
+        repeat: true
+        running: tileDownload !== null && tileDownload.active
+        onTriggered: {
+            var xhr = new XMLHttpRequest()
+            xhr.onreadystatechange = function() {
+                if (xhr.readyState === XMLHttpRequest.DONE && xhr.status === 200) {
+                    var d = JSON.parse(xhr.responseText).download
+                    tileDownload = { active: d.active, done: d.done, total: d.total,
+                                     message: d.active ? "" : "Saved " + d.done + " tiles for offline use" }
+                    downloadStatusHide.restart()
+                }
+            }
+            xhr.open("GET", tileServerUrl + "/status")
+            xhr.send()
+        }
+    }
+
+    Timer {
+        id: downloadStatusHide
+        interval: 4000
+        onTriggered: if (tileDownload && !tileDownload.active) tileDownload = null
     }
 
     function loadConfig() {
@@ -416,6 +518,12 @@ Window {
         name: "osm"
         PluginParameter { name: "osm.mapping.highdpi_tiles"; value: "true" }
         PluginParameter { name: "osm.useragent"; value: "FlickMaps/1.0 (Linux; Droidian)" }
+        // Custom map type is backed by the local tile store (tile_server.py)
+        PluginParameter { name: "osm.mapping.custom.host"; value: tileServerUrl + "/" }
+        // Keep decoded tiles and GPU textures resident so panning back doesn't re-decode
+        PluginParameter { name: "osm.mapping.cache.memory.size"; value: "33554432" }
+        PluginParameter { name: "osm.mapping.cache.texture.size"; value: "67108864" }
+        PluginParameter { name: "osm.mapping.prefetching_style"; value: "TwoNeighbourLayers" }
     }
 
     // Main map
@@ -427,6 +535,9 @@ Window {
         zoomLevel: 14
         copyrightsVisible: false
 
+        // Plugin map types can arrive after creation
+        onSupportedMapTypesChanged: useOfflineTiles()
+
         // GPS marker
         MapQuickItem {
             id: gpsMarker
@@ -1212,6 +1323,56 @@ Window {
                 onClicked: { Haptic.tap(); map.bearing = 0 }
             }
         }
+
+        // Save visible area for offline use
+        Rectangle {
+            width: 56
+            height: 56
+            radius: 28
+            visible: tileServerAvailable && tileBulkDownload
+            color: (tileDownload && tileDownload.active) ? "#4285f4" : (offlineMouse.pressed ? "#333344" : "#1a1a2e")
+            border.color: "#333344"
+            border.width: 1
+
+            Text {
+                anchors.centerIn: parent
+                text: "⬇"
+                font.pixelSize: 22
+                color: "#ffffff"
+            }
+
+            MouseArea {
+                id: offlineMouse
+                anchors.fill: parent
+                enabled: !(tileDownload && tileDownload.active)
+                onClicked: { Haptic.tap(); downloadVisibleArea() }
+            }
+        }
+    }
+
+    // Offline download progress
+    Rectangle {
+        anchors.horizontalCenter: parent.horizontalCenter
+        anchors.bottom: controlsColumn.top
+        anchors.bottomMargin: 16
+        width: downloadText.width + 32
+        height: 44
+        radius: 22
+        color: "#1a1a2e"
+        border.color: "#333344"
+        border.width: 1
+        visible: tileDownload !== null
+        z: 99
+
+        Text {
+            id: downloadText
+            anchors.centerIn: parent
+            text: !tileDownload ? "" :
+                  tileDownload.active ? "Saving map… " + tileDownload.done + " / " + tileDownload.total :
+                  tileDownload.message
+            font.pixelSize: 14
+            color: "#ffffff"
+        }
     }
 
     // Map type toggle (bottom left)
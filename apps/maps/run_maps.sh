@@ -13,12 +13,16 @@ mkdir -p ~/.local/state/flick
 # Speech queue file for voice navigation
 SPEAK_QUEUE="$HOME/.local/state/flick/speak_queue"
 SPEECH_PID=""
+TILE_SERVER_PID=""
 
 # Clean up on exit
 cleanup() {
     if [ -n "$SPEECH_PID" ] && kill -0 "$SPEECH_PID" 2>/dev/null; then
         kill "$SPEECH_PID" 2>/dev/null
     fi
+    if [ -n "$TILE_SERVER_PID" ] && kill -0 "$TILE_SERVER_PID" 2>/dev/null; then
+        kill "$TILE_SERVER_PID" 2>/dev/null
+    fi
     rm -f "$SPEAK_QUEUE"
 }
 trap cleanup EXIT
@@ -50,5 +54,9 @@ speech_daemon() {
 speech_daemon &
 SPEECH_PID=$!
 
+# Start offline tile store (serves cached/offline tiles to the map on localhost:7656)
+python3 "$SCRIPT_DIR/tile_server.py" 2>> ~/.local/state/flick/maps_tiles.log &
+TILE_SERVER_PID=$!
+
 # Run the maps app
 /usr/lib/qt5/bin/qmlscene "$SCRIPT_DIR/main.qml"
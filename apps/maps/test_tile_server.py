@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Tests for tile_server.py: python3 -m unittest test_tile_server (from apps/maps)"""
+
+import http.server
+import sqlite3
+import tempfile
+import threading
+import time
+import unittest
+from pathlib import Path
+
+import tile_server
+
+
+class StubUpstream(http.server.BaseHTTPRequestHandler):
+    """Serves b"tile z/x/y" for every path and counts requests"""
+    requests = []
+
+    def log_message(self, format, *args):
+        pass
+
+    def do_GET(self):
+        StubUpstream.requests.append(self.path)
+        body = f"tile {self.path.strip('/').rsplit('.', 1)[0]}".encode()
+        self.send_response(200)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+
+def make_region(path, tiles):
+    """Write a minimal MBTiles file holding {(z, x, y): data}"""
+    db = sqlite3.connect(str(path))
+    db.execute("CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)")
+    for (z, x, y), data in tiles.items():
+        db.execute("INSERT INTO tiles VALUES (?, ?, ?, ?)", (z, x, tile_server.tms_row(z, y), data))
+    db.commit()
+    db.close()
+
+
+class TileStoreTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.server = http.server.ThreadingHTTPServer(("127.0.0.1", 0), StubUpstream)
+        threading.Thread(target=cls.server.serve_forever, daemon=True).start()
+        cls.upstream = f"http://127.0.0.1:{cls.server.server_port}/{{z}}/{{x}}/{{y}}.png"
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.server.shutdown()
+
+    def setUp(self):
+        StubUpstream.requests = []
+        self.tmp = tempfile.TemporaryDirectory()
+        self.dir = Path(self.tmp.name)
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def store(self, limit=1 << 20, bulk=""):
+        return tile_server.TileStore(self.dir, self.dir / "cache.mbtiles", self.upstream, limit, bulk)
+
+    def wait_download(self, store):
+        deadline = time.time() + 10
+        while store.download["active"] and time.time() < deadline:
+            time.sleep(0.01)
+        self.assertFalse(store.download["active"])
+
+    def test_fetched_tile_is_cached(self):
+        store = self.store()
+        self.assertEqual(store.get(3, 1, 2), b"tile 3/1/2")
+        self.assertEqual(store.get(3, 1, 2), b"tile 3/1/2")
+        self.assertEqual(len(StubUpstream.requests), 1)
+
+    def test_region_file_served_first(self):
+        make_region(self.dir / "city.mbtiles", {(3, 1, 2): b"offline"})
+        store = self.store()
+        self.assertEqual(store.get(3, 1, 2), b"offline")
+        self.assertEqual(StubUpstream.requests, [])
+
+    def test_eviction_keeps_pinned_tiles(self):
+        store = self.store(limit=40)
+        store.store(5, 0, 0, b"p" * 30, pinned=True)
+        for x in range(1, 6):
+            store.store(5, x, 0, b"u" * 10)
+        self.assertLessEqual(store.cache_bytes, 40)
+        self.assertEqual(store.lookup(5, 0, 0), b"p" * 30)
+        self.assertIsNone(store.lookup(5, 1, 0))
+
+    def test_download_needs_bulk_source(self):
+        ok, _ = self.store().start_download(0.0, 0.0, 1.0, 1.0, 1, 2)
+        self.assertFalse(ok)
+        self.assertEqual(StubUpstream.requests, [])
+
+    def test_download_skips_region_tiles_and_pins_cached(self):
+        make_region(self.dir / "city.mbtiles", {(1, 1, 0): b"offline"})
+        store = self.store(bulk=self.upstream.replace("/{z}", "/bulk/{z}"))
+        store.get(1, 0, 0)  # cached, unpinned
+        ok, _ = store.start_download(1.0, -10.0, 10.0, 10.0, 1, 1)
+        self.assertTrue(ok)
+        self.wait_download(store)
+
+        # (1, 0, 0) pinned in place, (1, 1, 0) left in its region file
+        self.assertEqual(StubUpstream.requests, ["/1/0/0.png"])
+        self.assertEqual(store.cache_bytes, 0)
+        pinned = store.cache.execute("SELECT zoom_level, tile_column FROM tiles WHERE pinned = 1").fetchall()
+        self.assertEqual(pinned, [(1, 0)])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,405 @@
+#!/usr/bin/env python3
+"""
+Flick Maps Tile Server - offline tile store for the Maps app
+
+Serves XYZ tiles to the QtLocation OSM plugin (as its custom map host) on
+localhost:7656. Tiles are looked up in order:
+
+1. Offline region files: any *.mbtiles in the maps data directory
+   (~/.local/share/flick/maps). These are read-only.
+2. The tile cache (cache.mbtiles). This holds tiles fetched from the network
+   and tiles saved by region downloads. Fetched tiles are evicted
+   least-recently-used once the cache grows past its size limit. Region
+   tiles are pinned and are never evicted.
+3. The upstream tile server. A fetched tile is stored in the cache.
+
+Region downloads fetch many tiles at once, which the public OpenStreetMap
+tile servers do not allow. They only run against a bulk tile source (a
+provider or self-hosted server whose terms permit bulk download), set as
+"bulk_upstream" in ~/.local/state/flick/maps_tiles.json or in
+FLICK_MAPS_BULK_UPSTREAM; without one /download is refused.
+
+The database files are plain MBTiles. SQLite memory-maps them
+(PRAGMA mmap_size), so hot tiles are served from the page cache without
+read() copies.
+
+Endpoints:
+    GET /{z}/{x}/{y}.png          tile
+    GET /download?south=..&west=..&north=..&east=..&minzoom=..&maxzoom=..
+                                  pre-download a region (background)
+    GET /status                   JSON: cache size, download progress,
+                                  whether region download is available
+"""
+
+import http.server
+import json
+import math
+import os
+import sqlite3
+import sys
+import threading
+import time
+import urllib.parse
+import urllib.request
+from pathlib import Path
+
+PORT = 7656
+DATA_DIR = Path(os.environ.get("FLICK_MAPS_DIR", Path.home() / ".local" / "share" / "flick" / "maps"))
+CACHE_FILE = DATA_DIR / "cache.mbtiles"
+UPSTREAM = os.environ.get("FLICK_MAPS_UPSTREAM", "https://tile.openstreetmap.org/{z}/{x}/{y}.png")
+# Holds "bulk_upstream": tile source for region downloads, which must permit
+# bulk download (unset = region download disabled)
+CONFIG_FILE = Path.home() / ".local" / "state" / "flick" / "maps_tiles.json"
+USER_AGENT = "FlickMaps/1.0 (Linux; Droidian)"
+
+# Bounded LRU for fetched (unpinned) tiles
+CACHE_LIMIT_BYTES = int(os.environ.get("FLICK_MAPS_CACHE_MB", "256")) * 1024 * 1024
+# Map the database files instead of copying pages through read()
+MMAP_SIZE = 256 * 1024 * 1024
+# Fail fast with poor signal so the map shows cached neighbours instead of hanging
+FETCH_TIMEOUT = 5
+# Region downloads are refused past this many tiles (~ a city at zoom 17)
+MAX_REGION_TILES = 50000
+# Flush batched access times after this many hits
+TOUCH_BATCH = 64
+
+
+def log(msg):
+    """Log to stderr for debugging"""
+    print(f"[TileServer] {msg}", file=sys.stderr)
+    sys.stderr.flush()
+
+
+def tms_row(z, y):
+    """MBTiles stores rows bottom-up (TMS); XYZ counts from the top"""
+    return (1 << z) - 1 - y
+
+
+def lon_to_x(lon, z):
+    return int((lon + 180.0) / 360.0 * (1 << z))
+
+
+def lat_to_y(lat, z):
+    lat = max(min(lat, 85.0511), -85.0511)
+    rad = math.radians(lat)
+    return int((1.0 - math.asinh(math.tan(rad)) / math.pi) / 2.0 * (1 << z))
+
+
+def region_tiles(south, west, north, east, minzoom, maxzoom):
+    """Yield (z, x, y) for every tile covering the bounding box"""
+    for z in range(minzoom, maxzoom + 1):
+        last = (1 << z) - 1
+        x0, x1 = max(0, lon_to_x(west, z)), min(last, lon_to_x(east, z))
+        y0, y1 = max(0, lat_to_y(north, z)), min(last, lat_to_y(south, z))
+        for x in range(x0, x1 + 1):
+            for y in range(y0, y1 + 1):
+                yield z, x, y
+
+
+def count_region_tiles(south, west, north, east, minzoom, maxzoom):
+    total = 0
+    for z in range(minzoom, maxzoom + 1):
+        last = (1 << z) - 1
+        xs = min(last, lon_to_x(east, z)) - max(0, lon_to_x(west, z)) + 1
+        ys = min(last, lat_to_y(south, z)) - max(0, lat_to_y(north, z)) + 1
+        total += max(0, xs) * max(0, ys)
+    return total
+
+
+def load_bulk_upstream():
+    """Region download tile source from the environment or config file"""
+    if os.environ.get("FLICK_MAPS_BULK_UPSTREAM"):
+        return os.environ["FLICK_MAPS_BULK_UPSTREAM"]
+    try:
+        return json.loads(CONFIG_FILE.read_text()).get("bulk_upstream", "")
+    except (OSError, ValueError, AttributeError):
+        return ""
+
+
+def open_db(path, readonly=False):
+    if readonly:
+        conn = sqlite3.connect(f"file:{path}?mode=ro", uri=True, check_same_thread=False)
+    else:
+        conn = sqlite3.connect(str(path), check_same_thread=False)
+    conn.execute(f"PRAGMA mmap_size={MMAP_SIZE}")
+    return conn
+
+
+class TileStore:
+    """Offline regions + LRU tile cache, shared by all request threads
+
+    sqlite connections are not safe to use from several threads at once, so
+    the region files and the cache each have a lock.
+    """
+
+    def __init__(self, data_dir, cache_file, upstream, cache_limit, bulk_upstream=""):
+        self.upstream = upstream
+        self.bulk_upstream = bulk_upstream
+        self.cache_limit = cache_limit
+        self.lock = threading.Lock()
+        self.regions_lock = threading.Lock()
+        self.touched = {}
+        self.download = {"active": False, "done": 0, "total": 0, "failed": 0}
+
+        data_dir.mkdir(parents=True, exist_ok=True)
+        self.regions = []
+        for path in sorted(data_dir.glob("*.mbtiles")):
+            if path == cache_file:
+                continue
+            try:
+                self.regions.append(open_db(path, readonly=True))
+                log(f"Offline region: {path.name}")
+            except sqlite3.Error as e:
+                log(f"Skipping {path.name}: {e}")
+
+        self.cache = open_db(cache_file)
+        self.cache.executescript("""
+            PRAGMA journal_mode=WAL;
+            PRAGMA synchronous=NORMAL;
+            CREATE TABLE IF NOT EXISTS metadata (name TEXT PRIMARY KEY, value TEXT);
+            CREATE TABLE IF NOT EXISTS tiles (
+                zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER,
+                tile_data BLOB,
+                last_access INTEGER DEFAULT 0,
+                pinned INTEGER DEFAULT 0,
+                PRIMARY KEY (zoom_level, tile_column, tile_row)
+            );
+            CREATE INDEX IF NOT EXISTS tiles_lru ON tiles (pinned, last_access);
+        """)
+        self.cache.execute("INSERT OR IGNORE INTO metadata VALUES ('name', 'Flick tile cache')")
+        self.cache.execute("INSERT OR IGNORE INTO metadata VALUES ('format', 'png')")
+        self.cache.commit()
+        self.cache_bytes = self.cache.execute(
+            "SELECT COALESCE(SUM(LENGTH(tile_data)), 0) FROM tiles WHERE pinned = 0").fetchone()[0]
+
+    def lookup_region(self, z, x, y):
+        """Tile bytes from the offline region files, or None"""
+        row = tms_row(z, y)
+        with self.regions_lock:
+            for db in self.regions:
+                hit = db.execute(
+                    "SELECT tile_data FROM tiles WHERE zoom_level=? AND tile_column=? AND tile_row=?",
+                    (z, x, row)).fetchone()
+                if hit:
+                    return hit[0]
+        return None
+
+    def lookup(self, z, x, y):
+        """Tile bytes from regions or cache, or None"""
+        data = self.lookup_region(z, x, y)
+        if data is not None:
+            return data
+
+        row = tms_row(z, y)
+        with self.lock:
+            hit = self.cache.execute(
+                "SELECT tile_data FROM tiles WHERE zoom_level=? AND tile_column=? AND tile_row=?",
+                (z, x, row)).fetchone()
+            if hit:
+                # Access times are only an LRU hint; batch the writes
+                self.touched[(z, x, row)] = int(time.time())
+                if len(self.touched) >= TOUCH_BATCH:
+                    self._flush_touched()
+                return hit[0]
+        return None
+
+    def fetch(self, z, x, y, upstream=None):
+        """Download a tile from upstream, or None on failure"""
+        url = (upstream or self.upstream).format(z=z, x=x, y=y)
+        req = urllib.request.Request(url, headers={"User-Agent": USER_AGENT})
+        try:
+            with urllib.request.urlopen(req, timeout=FETCH_TIMEOUT) as resp:
+                if resp.status == 200:
+                    return resp.read()
+        except Exception as e:
+            log(f"Fetch failed {z}/{x}/{y}: {e}")
+        return None
+
+    def store(self, z, x, y, data, pinned=False):
+        size = len(data)
+        with self.lock:
+            # Keep the byte count right when a tile is replaced or pinned
+            old = self.cache.execute(
+                "SELECT LENGTH(tile_data), pinned FROM tiles WHERE zoom_level=? AND tile_column=? AND tile_row=?",
+                (z, x, tms_row(z, y))).fetchone()
+            if old and not old[1]:
+                self.cache_bytes -= old[0]
+            if old and old[1]:
+                pinned = True
+            self.cache.execute(
+                "INSERT OR REPLACE INTO tiles VALUES (?, ?, ?, ?, ?, ?)",
+                (z, x, tms_row(z, y), sqlite3.Binary(data), int(time.time()), 1 if pinned else 0))
+            if not pinned:
+                self.cache_bytes += size
+                if self.cache_bytes > self.cache_limit:
+                    self._evict()
+            self.cache.commit()
+
+    def pin(self, z, x, y):
+        """Pin a cached tile; False if it is not in the cache"""
+        with self.lock:
+            row = self.cache.execute(
+                "SELECT LENGTH(tile_data), pinned FROM tiles WHERE zoom_level=? AND tile_column=? AND tile_row=?",
+                (z, x, tms_row(z, y))).fetchone()
+            if row is None:
+                return False
+            if not row[1]:
+                self.cache.execute(
+                    "UPDATE tiles SET pinned = 1 WHERE zoom_level=? AND tile_column=? AND tile_row=?",
+                    (z, x, tms_row(z, y)))
+                self.cache.commit()
+                self.cache_bytes -= row[0]
+            return True
+
+    def get(self, z, x, y):
+        data = self.lookup(z, x, y)
+        if data is None:
+            data = self.fetch(z, x, y)
+            if data is not None:
+                self.store(z, x, y, data)
+        return data
+
+    def _flush_touched(self):
+        self.cache.executemany(
+            "UPDATE tiles SET last_access=? WHERE zoom_level=? AND tile_column=? AND tile_row=?",
+            [(t, z, x, r) for (z, x, r), t in self.touched.items()])
+        self.cache.commit()
+        self.touched.clear()
+
+    def _evict(self):
+        """Drop least-recently-used unpinned tiles down to 90% of the limit"""
+        self._flush_touched()
+        target = int(self.cache_limit * 0.9)
+        rows = self.cache.execute(
+            "SELECT zoom_level, tile_column, tile_row, LENGTH(tile_data) FROM tiles "
+            "WHERE pinned = 0 ORDER BY last_access ASC").fetchall()
+        victims = []
+        for z, x, r, size in rows:
+            if self.cache_bytes <= target:
+                break
+            victims.append((z, x, r))
+            self.cache_bytes -= size
+        self.cache.executemany(
+            "DELETE FROM tiles WHERE zoom_level=? AND tile_column=? AND tile_row=?", victims)
+        log(f"Evicted {len(victims)} tiles, cache now {self.cache_bytes // 1024} KiB")
+
+    def start_download(self, south, west, north, east, minzoom, maxzoom):
+        """Pre-download a region into the cache as pinned tiles
+
+        Tiles already in an offline region file are skipped and cached ones
+        are pinned in place; only missing tiles come from the bulk source.
+        """
+        if not self.bulk_upstream:
+            return False, "no bulk tile source configured"
+        total = count_region_tiles(south, west, north, east, minzoom, maxzoom)
+        if total > MAX_REGION_TILES:
+            return False, f"region too large ({total} tiles, max {MAX_REGION_TILES})"
+        if self.download["active"]:
+            return False, "download already running"
+
+        self.download = {"active": True, "done": 0, "total": total, "failed": 0}
+
+        def run():
+            for z, x, y in region_tiles(south, west, north, east, minzoom, maxzoom):
+                if self.lookup_region(z, x, y) is None and not self.pin(z, x, y):
+                    data = self.fetch(z, x, y, self.bulk_upstream)
+                    if data is not None:
+                        self.store(z, x, y, data, pinned=True)
+                    else:
+                        self.download["failed"] += 1
+                self.download["done"] += 1
+            self.download["active"] = False
+            log(f"Region download finished: {self.download}")
+
+        threading.Thread(target=run, daemon=True).start()
+        log(f"Region download started: {total} tiles, zoom {minzoom}-{maxzoom}")
+        return True, f"{total} tiles"
+
+    def status(self):
+        with self.lock:
+            pinned = self.cache.execute("SELECT COUNT(*) FROM tiles WHERE pinned = 1").fetchone()[0]
+        return {
+            "status": "ok",
+            "regions": len(self.regions),
+            "cache_bytes": self.cache_bytes,
+            "cache_limit": self.cache_limit,
+            "pinned_tiles": pinned,
+            "bulk_download": bool(self.bulk_upstream),
+            "download": dict(self.download),
+        }
+
+
+STORE = None
+
+
+class TileHandler(http.server.BaseHTTPRequestHandler):
+    # Keep-alive so QtLocation reuses connections while panning
+    protocol_version = "HTTP/1.1"
+
+    def log_message(self, format, *args):
+        pass
+
+    def send_body(self, code, body, content_type):
+        self.send_response(code)
+        self.send_header("Content-Type", content_type)
+        self.send_header("Content-Length", str(len(body)))
+        self.send_header("Access-Control-Allow-Origin", "*")
+        self.end_headers()
+        self.wfile.write(body)
+
+    def send_json(self, code, obj):
+        self.send_body(code, json.dumps(obj).encode(), "application/json")
+
+    def do_GET(self):
+        parsed = urllib.parse.urlparse(self.path)
+        parts = parsed.path.strip("/").split("/")
+
+        if parsed.path == "/status":
+            self.send_json(200, STORE.status())
+
+        elif parsed.path == "/download":
+            q = urllib.parse.parse_qs(parsed.query)
+            try:
+                args = [float(q[k][0]) for k in ("south", "west", "north", "east")]
+                minzoom = int(q.get("minzoom", ["0"])[0])
+                maxzoom = min(int(q.get("maxzoom", ["16"])[0]), 19)
+            except (KeyError, ValueError):
+                self.send_json(400, {"error": "need south, west, north, east"})
+                return
+            ok, message = STORE.start_download(*args, minzoom, maxzoom)
+            self.send_json(200 if ok else 409, {"success": ok, "message": message})
+
+        elif len(parts) == 3 and parts[2].endswith(".png"):
+            try:
+                z, x, y = int(parts[0]), int(parts[1]), int(parts[2][:-4])
+            except ValueError:
+                self.send_body(400, b"", "text/plain")
+                return
+            data = STORE.get(z, x, y)
+            if data is None:
+                self.send_body(404, b"", "text/plain")
+            else:
+                self.send_body(200, data, "image/png")
+
+        else:
+            self.send_body(404, b"", "text/plain")
+
+
+def main():
+    global STORE
+    port = int(sys.argv[1]) if len(sys.argv) > 1 else PORT
+    STORE = TileStore(DATA_DIR, CACHE_FILE, UPSTREAM, CACHE_LIMIT_BYTES, load_bulk_upstream())
+    log(f"Cache {STORE.cache_bytes // 1024} KiB / {CACHE_LIMIT_BYTES // (1024 * 1024)} MiB, "
+        f"{len(STORE.regions)} offline regions")
+
+    server = http.server.ThreadingHTTPServer(("127.0.0.1", port), TileHandler)
+    server.daemon_threads = True
+    log(f"Serving tiles on 127.0.0.1:{port}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -21,6 +21,7 @@ Window {
     property string lastMessageText: ""  // Track last message for smart scrolling
     property bool userScrolledUp: false  // Track if user scrolled away from bottom
     property string newMessagePhone: ""  // Phone number for new message
+    property var contactNameByNumber: ({})  // normalizePhone(number) -> name, rebuilt by loadContacts()
     property string newMessageSearch: "" // Search filter for contacts
     property string saveContactPhone: "" // Phone number when saving new contact
     property string saveContactName: ""  // Name input for new contact
@@ -96,9 +97,13 @@ Window {
             if (xhr.status === 200 || xhr.status === 0) {
                 var data = JSON.parse(xhr.responseText)
                 contactsModel.clear()
+                var byNumber = {}
                 for (var i = 0; i < data.contacts.length; i++) {
                     contactsModel.append(data.contacts[i])
+                    var key = normalizePhone(data.contacts[i].phone || "")
+                    if (key !== "" && !(key in byNumber)) byNumber[key] = data.contacts[i].name
                 }
+                contactNameByNumber = byNumber
             }
         } catch (e) {
             console.log("No contacts found")
@@ -115,15 +120,9 @@ Window {
     }
 
     function getContactName(phoneNumber) {
-        var normalizedInput = normalizePhone(phoneNumber)
-        for (var i = 0; i < contactsModel.count; i++) {
-            var contact = contactsModel.get(i)
-            var normalizedContact = normalizePhone(contact.phone)
-            if (normalizedInput === normalizedContact) {
-                return contact.name
-            }
-        }
-        return ""
+        // Called from every conversation delegate - keep it a hash lookup
+        var name = contactNameByNumber[normalizePhone(phoneNumber)]
+        return name === undefined ? "" : name
     }
 
     function saveNewContact(name, phone) {
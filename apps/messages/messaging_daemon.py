@@ -68,6 +68,19 @@ CMD_FILE = "/tmp/flick_messages_cmd"
 os.makedirs(STATE_DIR, exist_ok=True)
 
 
+# Indexed contacts lookup shared with the Contacts app
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "contacts"))
+try:
+    from contacts_store import lookup_contact_name as _lookup_contact_name
+except ImportError:
+    _lookup_contact_name = None
+
+
+def lookup_contact_name(number):
+    """Name for a phone number from the contacts index, or "" if unknown"""
+    return _lookup_contact_name(number, STATE_DIR) if _lookup_contact_name else ""
+
+
 def normalize_phone_number(number):
     """Normalize phone number for consistent matching.
 
@@ -269,7 +282,7 @@ class ModemManagerSMS:
             print(f"SMS from {number}: {text}")
 
             # Create notification for lock screen / quick settings
-            create_notification(number, text)
+            create_notification(number, text, lookup_contact_name(number) or None)
 
             # Add to messages
             self.add_message(number, text, "incoming", timestamp)
@@ -353,13 +366,16 @@ class ModemManagerSMS:
             # Store the normalized version for consistency
             conversation = {
                 "phone_number": normalized_input,
-                "contact_name": normalized_input,  # TODO: lookup from contacts
+                "contact_name": lookup_contact_name(phone_number) or normalized_input,
                 "messages": [],
                 "last_message": "",
                 "last_message_time": "",
                 "unread_count": 0
             }
             data["conversations"].append(conversation)
+        elif conversation.get("contact_name") == conversation["phone_number"]:
+            # Number was saved as a contact after the conversation started
+            conversation["contact_name"] = lookup_contact_name(phone_number) or conversation["contact_name"]
 
         # Check for duplicate message (same text and similar timestamp, ignore direction)
         for existing in conversation["messages"]:
@@ -23,44 +23,51 @@ Window {
 
     Component.onCompleted: {
         console.log("NOTES_INIT:" + notesDir)
-        loadNotes()
     }
 
     // Notes model for search/filtering
     ListModel { id: notesModel }
 
     function loadNotes() {
+        // Listing comes from folderModel (enumerated off the GUI thread);
+        // rows appear immediately and fill in as their contents are read
+        noteReader.clear()
         notesModel.clear()
-        // Request shell to scan notes
-        var xhr = new XMLHttpRequest()
-        xhr.open("GET", "file://" + notesDir, false)
-        xhr.send()
+        var index = {}
+        for (var i = 0; i < folderModel.count; i++) {
+            var fileUrl = folderModel.get(i, "fileURL")
+            var fileName = folderModel.get(i, "fileName")
+            index[fileName] = i
+            notesModel.append({
+                fileName: fileName,
+                fileURL: fileUrl,
+                content: "",
+                title: folderModel.get(i, "fileBaseName"),
+                preview: ""
+            })
+            noteReader.read(fileUrl, fileName)
+        }
+        noteRows = index
+    }
 
-        // Load each note from folder model after it updates
-        loadNotesTimer.start()
+    // fileName -> row in notesModel, for filling in async reads
+    property var noteRows: ({})
+
+    AsyncFileReader {
+        id: noteReader
+        onLoaded: function(key, text) {
+            var row = noteRows[key]
+            if (row === undefined || row >= notesModel.count) return
+            notesModel.setProperty(row, "content", text)
+            notesModel.setProperty(row, "title", getNoteTitle(text))
+            notesModel.setProperty(row, "preview", getNotePreview(text))
+        }
     }
 
     Timer {
         id: loadNotesTimer
         interval: 100
-        onTriggered: {
-            notesModel.clear()
-            for (var i = 0; i < folderModel.count; i++) {
-                var fileUrl = folderModel.get(i, "fileURL")
-                var fileName = folderModel.get(i, "fileName")
-                var xhr = new XMLHttpRequest()
-                xhr.open("GET", fileUrl, false)
-                xhr.send()
-                var content = xhr.responseText
-                notesModel.append({
-                    fileName: fileName,
-                    fileURL: fileUrl,
-                    content: content,
-                    title: getNoteTitle(content),
-                    preview: getNotePreview(content)
-                })
-            }
-        }
+        onTriggered: loadNotes()
     }
 
     function matchesSearch(content, title) {
@@ -118,6 +125,10 @@ Window {
         showDirs: false
         sortField: FolderListModel.Time
         sortReversed: true
+
+        // Also fires when the directory changes on disk (file watcher)
+        onStatusChanged: if (status === FolderListModel.Ready) loadNotes()
+        onCountChanged: if (status === FolderListModel.Ready) loadNotesTimer.restart()
     }
 
     // Notes List View
@@ -19,6 +19,7 @@ Window {
     property bool inCall: false
     property string callState: "idle"  // idle, dialing, incoming, active
     property string callerNumber: ""
+    property string callerName: ""  // Caller ID from the contacts index (phone_helper.py)
     property int callDuration: 0
     property int currentTab: 0  // 0 = dialpad, 1 = history
     property bool speakerOn: false
@@ -77,6 +78,7 @@ Window {
             if (xhr.status === 200 || xhr.status === 0) {
                 var status = JSON.parse(xhr.responseText)
                 var newState = status.state || "idle"
+                callerName = status.name || ""
 
                 // Handle state transitions - sync with daemon state
                 if (newState === "incoming") {
@@ -565,6 +567,16 @@ Window {
                 font.pixelSize: 20 * textScale
             }
 
+            // Caller name (known contacts only)
+            Text {
+                anchors.horizontalCenter: parent.horizontalCenter
+                text: callerName
+                color: "white"
+                font.pixelSize: 28 * textScale
+                font.weight: Font.Bold
+                visible: callerName !== ""
+            }
+
             // Caller number
             Text {
                 anchors.horizontalCenter: parent.horizontalCenter
@@ -75,6 +75,19 @@ CMD_FILE = "/tmp/flick_phone_cmd"
 os.makedirs(STATE_DIR, exist_ok=True)
 
 
+# Indexed contacts lookup shared with the Contacts app
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "contacts"))
+try:
+    from contacts_store import lookup_contact_name as _lookup_contact_name
+except ImportError:
+    _lookup_contact_name = None
+
+
+def lookup_contact_name(number):
+    """Name for a phone number from the contacts index, or "" if unknown"""
+    return _lookup_contact_name(number, STATE_DIR) if _lookup_contact_name else ""
+
+
 def trigger_haptic():
     """Trigger haptic feedback"""
     try:
@@ -518,6 +531,8 @@ def daemon_mode():
     last_state = "idle"
     call_start = None
     call_number = ""
+    caller_name = ""
+    caller_name_for = None
 
     while True:
         try:
@@ -584,6 +599,13 @@ def daemon_mode():
                 switch_to_2g_for_call()
                 play_ringtone()
 
+            # Caller ID - resolved once per number, not every poll
+            number = status.get("number", "")
+            if number != caller_name_for:
+                caller_name = lookup_contact_name(number)
+                caller_name_for = number
+            status["name"] = caller_name
+
             # Update status file
             status["duration"] = int(time.time() - call_start) if call_start else 0
             write_status(status)
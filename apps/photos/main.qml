@@ -252,6 +252,9 @@ Window {
                             fillMode: Image.PreserveAspectCrop
                             asynchronous: true
                             cache: true
+                            // Decode at cell size, not full camera resolution
+                            sourceSize.width: width
+                            sourceSize.height: height
 
                             Rectangle {
                                 anchors.fill: parent
@@ -31,16 +31,18 @@ Window {
     function loadConfig() {
         var configPath = Theme.stateDir + "/display_config.json"
         var xhr = new XMLHttpRequest()
-        xhr.open("GET", "file://" + configPath, false)
-        try {
-            xhr.send()
-            if (xhr.status === 200 || xhr.status === 0) {
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            if (xhr.status !== 200 && xhr.status !== 0) return
+            try {
                 var config = JSON.parse(xhr.responseText)
                 if (config.text_scale !== undefined) {
                     textScale = config.text_scale
                 }
-            }
-        } catch (e) {}
+            } catch (e) {}
+        }
+        xhr.open("GET", "file://" + configPath)
+        xhr.send()
     }
 
     // Reload config periodically
@@ -92,7 +94,8 @@ Window {
 
         sendCommand("STOP")
 
-        // Refresh folder model after a delay
+        // The watcher only sees entries come and go; re-list once the
+        // processor has finished the file so its size and time are current
         refreshTimer.start()
     }
 
@@ -123,10 +126,8 @@ Window {
 
     function deleteRecording(filePath) {
         Haptic.heavy()
+        // The model's directory watcher drops the row once it is deleted
         sendCommand("DELETE:" + filePath)
-        // Refresh after delete
-        refreshTimer.interval = 500
-        refreshTimer.start()
     }
 
     function formatTime(seconds) {
@@ -154,17 +155,16 @@ Window {
         repeat: true
         onTriggered: {
             var xhr = new XMLHttpRequest()
-            xhr.open("GET", "file:///tmp/flick_recorder_status", false)
-            try {
-                xhr.send()
-                if (xhr.status === 200 || xhr.status === 0) {
-                    var status = xhr.responseText.trim()
-                    if (status === "idle" && isPlaying) {
-                        isPlaying = false
-                        playingFile = ""
-                    }
+            xhr.onreadystatechange = function() {
+                if (xhr.readyState !== XMLHttpRequest.DONE) return
+                if (xhr.status !== 200 && xhr.status !== 0) return
+                if (xhr.responseText.trim() === "idle" && isPlaying) {
+                    isPlaying = false
+                    playingFile = ""
                 }
-            } catch (e) {}
+            }
+            xhr.open("GET", "file:///tmp/flick_recorder_status")
+            xhr.send()
         }
     }
 
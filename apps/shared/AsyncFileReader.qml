@@ -0,0 +1,48 @@
+import QtQuick 2.15
+
+// Reads local files with asynchronous XMLHttpRequest, a few at a time, so
+// listing a folder never blocks the GUI thread on file contents.
+// read(url, key) queues a file; loaded(key, text) fires as each one arrives.
+QtObject {
+    id: reader
+
+    property int maxConcurrent: 4
+
+    property var queue: []
+    property int active: 0
+    // Bumped by clear() so results from a previous listing are dropped
+    property int generation: 0
+
+    signal loaded(var key, string text)
+
+    function read(url, key) {
+        queue.push({ url: url, key: key, generation: generation })
+        pump()
+    }
+
+    function clear() {
+        queue = []
+        generation++
+    }
+
+    function pump() {
+        while (active < maxConcurrent && queue.length > 0) {
+            start(queue.shift())
+        }
+    }
+
+    function start(item) {
+        active++
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            active--
+            if (item.generation === generation && (xhr.status === 200 || xhr.status === 0)) {
+                loaded(item.key, xhr.responseText)
+            }
+            pump()
+        }
+        xhr.open("GET", item.url)
+        xhr.send()
+    }
+}
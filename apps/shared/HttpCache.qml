@@ -0,0 +1,52 @@
+pragma Singleton
+import QtQuick 2.15
+
+// Client for the shared HTTP cache (services/flick-http-cache)
+// GETs go through the localhost proxy, so a cold open is answered from the
+// last response straight away while it revalidates with ETag/Last-Modified
+// in the background. Falls back to a direct request if the proxy is down.
+// The proxy only fetches https URLs on its host allowlist (ALLOWED_HOSTS in
+// http_cache.py); anything else gets a 403.
+QtObject {
+    id: httpCache
+
+    property int port: 7659
+    readonly property string baseUrl: "http://127.0.0.1:" + port
+
+    // callback(status, responseText, cacheState)
+    // cacheState: HIT, STALE (revalidating now), MISS, REVALIDATED,
+    //             STALE-ERROR (origin unreachable), DIRECT (proxy not running)
+    // options.maxAge:  seconds a response counts as fresh (default 300)
+    // options.refresh: keep the URL warm in the background every N seconds
+    // options.wait:    revalidate before answering (explicit user refresh)
+    function get(url, options, callback) {
+        var opts = options || {}
+        var path = baseUrl + "/fetch?url=" + encodeURIComponent(url) +
+                   "&max_age=" + (opts.maxAge !== undefined ? opts.maxAge : 300)
+        if (opts.refresh) path += "&refresh=" + opts.refresh
+        if (opts.wait) path += "&wait=1"
+
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            if (xhr.status === 0) {
+                direct(url, callback)
+                return
+            }
+            callback(xhr.status, xhr.responseText, xhr.getResponseHeader("X-Flick-Cache") || "")
+        }
+        xhr.open("GET", path)
+        xhr.send()
+    }
+
+    function direct(url, callback) {
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState === XMLHttpRequest.DONE) {
+                callback(xhr.status, xhr.responseText, "DIRECT")
+            }
+        }
+        xhr.open("GET", url)
+        xhr.send()
+    }
+}
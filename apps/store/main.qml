@@ -287,26 +287,22 @@ Window {
         isLoadingFeatured = true
         apiError = ""
 
-        var xhr = new XMLHttpRequest()
-        xhr.open("GET", apiBaseUrl + "/apps/featured")
-        xhr.onreadystatechange = function() {
-            if (xhr.readyState === XMLHttpRequest.DONE) {
-                isLoadingFeatured = false
-                if (xhr.status === 200) {
-                    try {
-                        var data = JSON.parse(xhr.responseText)
-                        featuredApps = data.apps || data || []
-                    } catch (e) {
-                        console.log("Error parsing featured apps:", e)
-                        apiError = "Failed to parse featured apps"
-                    }
-                } else {
-                    console.log("Error loading featured apps:", xhr.status, xhr.statusText)
-                    apiError = "Failed to load featured apps"
+        // Catalog lists go through the shared cache so the Store opens populated
+        HttpCache.get(apiBaseUrl + "/apps/featured", {maxAge: 900}, function(status, text) {
+            isLoadingFeatured = false
+            if (status === 200) {
+                try {
+                    var data = JSON.parse(text)
+                    featuredApps = data.apps || data || []
+                } catch (e) {
+                    console.log("Error parsing featured apps:", e)
+                    apiError = "Failed to parse featured apps"
                 }
+            } else {
+                console.log("Error loading featured apps:", status)
+                apiError = "Failed to load featured apps"
             }
-        }
-        xhr.send()
+        })
     }
 
     function loadNewApps() {
@@ -314,26 +310,21 @@ Window {
         isLoadingNew = true
         apiError = ""
 
-        var xhr = new XMLHttpRequest()
-        xhr.open("GET", apiBaseUrl + "/apps?sort=newest")
-        xhr.onreadystatechange = function() {
-            if (xhr.readyState === XMLHttpRequest.DONE) {
-                isLoadingNew = false
-                if (xhr.status === 200) {
-                    try {
-                        var data = JSON.parse(xhr.responseText)
-                        newApps = data.apps || data || []
-                    } catch (e) {
-                        console.log("Error parsing new apps:", e)
-                        apiError = "Failed to parse new apps"
-                    }
-                } else {
-                    console.log("Error loading new apps:", xhr.status, xhr.statusText)
-                    apiError = "Failed to load new apps"
+        HttpCache.get(apiBaseUrl + "/apps?sort=newest", {maxAge: 900}, function(status, text) {
+            isLoadingNew = false
+            if (status === 200) {
+                try {
+                    var data = JSON.parse(text)
+                    newApps = data.apps || data || []
+                } catch (e) {
+                    console.log("Error parsing new apps:", e)
+                    apiError = "Failed to parse new apps"
                 }
+            } else {
+                console.log("Error loading new apps:", status)
+                apiError = "Failed to load new apps"
             }
-        }
-        xhr.send()
+        })
     }
 
     function loadPopularApps() {
@@ -341,26 +332,21 @@ Window {
         isLoadingPopular = true
         apiError = ""
 
-        var xhr = new XMLHttpRequest()
-        xhr.open("GET", apiBaseUrl + "/apps?sort=downloads")
-        xhr.onreadystatechange = function() {
-            if (xhr.readyState === XMLHttpRequest.DONE) {
-                isLoadingPopular = false
-                if (xhr.status === 200) {
-                    try {
-                        var data = JSON.parse(xhr.responseText)
-                        popularApps = data.apps || data || []
-                    } catch (e) {
-                        console.log("Error parsing popular apps:", e)
-                        apiError = "Failed to parse popular apps"
-                    }
-                } else {
-                    console.log("Error loading popular apps:", xhr.status, xhr.statusText)
-                    apiError = "Failed to load popular apps"
+        HttpCache.get(apiBaseUrl + "/apps?sort=downloads", {maxAge: 900}, function(status, text) {
+            isLoadingPopular = false
+            if (status === 200) {
+                try {
+                    var data = JSON.parse(text)
+                    popularApps = data.apps || data || []
+                } catch (e) {
+                    console.log("Error parsing popular apps:", e)
+                    apiError = "Failed to parse popular apps"
                 }
+            } else {
+                console.log("Error loading popular apps:", status)
+                apiError = "Failed to load popular apps"
             }
-        }
-        xhr.send()
+        })
     }
 
     function searchApps(query) {
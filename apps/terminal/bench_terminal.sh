@@ -0,0 +1,35 @@
+#!/bin/bash
+# Flick Terminal - headless output benchmark
+# Streams a large amount of text through the terminal widget and reports
+# wall time and peak RSS.
+# Usage: bench_terminal.sh [MEGABYTES] [SCROLLBACK_LINES]
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+MB="${1:-100}"
+SCROLLBACK="${2:-}"
+
+if [ ! -x /usr/bin/time ]; then
+    echo "Error: /usr/bin/time not found (apt install time)"
+    exit 1
+fi
+
+# 120-column lines of printable text, like a build log
+COMMAND="head -c $((MB * 1024 * 1024)) /dev/zero | tr '\\0' 'x' | fold -w 120"
+
+ARGS=(--exec "$COMMAND")
+if [ -n "$SCROLLBACK" ]; then
+    ARGS+=(--scrollback "$SCROLLBACK")
+fi
+
+export QT_QPA_PLATFORM=offscreen
+export QML_XHR_ALLOW_FILE_READ=1
+
+echo "Streaming ${MB} MB through the terminal (scrollback: ${SCROLLBACK:-config})..."
+RESULT=$(/usr/bin/time -f "elapsed_s=%e max_rss_kb=%M" \
+    /usr/lib/qt5/bin/qmlscene "$SCRIPT_DIR/main.qml" -- "${ARGS[@]}" 2>&1 | grep -E "^elapsed_s=|Scrollback:")
+
+echo "$RESULT" | grep "Scrollback:"
+eval "$(echo "$RESULT" | grep "^elapsed_s=")"
+echo "Elapsed:    ${elapsed_s}s"
+echo "Peak RSS:   $((max_rss_kb / 1024)) MB"
+echo "Throughput: $(awk "BEGIN { printf \"%.1f\", $MB / $elapsed_s }") MB/s"
@@ -16,8 +16,55 @@ Window {
     property color accentPressed: Qt.darker(accentColor, 1.2)
     property int baseFontSize: 8
 
+    // Scrollback override from "scrollback_lines" in terminal_config.json:
+    // N keeps N lines in memory, -1 uses the widget's file-backed history.
+    // null leaves the widget's own default.
+    property var scrollbackLines: null
+
+    // Command to run instead of the login shell (--exec "cmd") and a
+    // scrollback override (--scrollback N), used by bench_terminal.sh
+    property string execCommand: ""
+
     Component.onCompleted: {
         loadConfig()
+        loadTerminalConfig()
+
+        var args = Qt.application.arguments
+        for (var i = 1; i < args.length - 1; i++) {
+            if (args[i] === "--exec") execCommand = args[i + 1]
+            if (args[i] === "--scrollback") scrollbackLines = parseInt(args[i + 1])
+        }
+        startSession()
+    }
+
+    // Started here rather than from the widget's onCompleted, which may run
+    // before the config and arguments above are read
+    function startSession() {
+        if (scrollbackLines !== null) {
+            termSession.historySize = scrollbackLines
+        }
+        console.log("Scrollback: " + (scrollbackLines === null ? "default"
+                                      : scrollbackLines < 0 ? "file-backed" : scrollbackLines + " lines"))
+        if (execCommand !== "") {
+            termSession.shellProgram = "/bin/sh"
+            termSession.shellProgramArgs = ["-c", execCommand]
+        }
+        termSession.startShellProgram()
+        terminal.forceActiveFocus()
+    }
+
+    function loadTerminalConfig() {
+        var xhr = new XMLHttpRequest()
+        xhr.open("GET", "file://" + Theme.stateDir + "/terminal_config.json", false)
+        try {
+            xhr.send()
+            if (xhr.status === 200 || xhr.status === 0) {
+                var config = JSON.parse(xhr.responseText)
+                if (config.scrollback_lines !== undefined) {
+                    scrollbackLines = config.scrollback_lines
+                }
+            }
+        } catch (e) {}
     }
 
     function loadConfig() {
@@ -177,11 +224,6 @@ Window {
             onFinished: Qt.quit()
         }
 
-        Component.onCompleted: {
-            termSession.startShellProgram()
-            forceActiveFocus()
-        }
-
         // Scrollbar
         QMLTermScrollbar {
             terminal: terminal
@@ -23,14 +23,16 @@ Window {
 
     function loadConfig() {
         var xhr = new XMLHttpRequest()
-        xhr.open("GET", "file://" + Theme.stateDir + "/display_config.json", false)
-        try {
-            xhr.send()
-            if (xhr.status === 200 || xhr.status === 0) {
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState !== XMLHttpRequest.DONE) return
+            if (xhr.status !== 200 && xhr.status !== 0) return
+            try {
                 var config = JSON.parse(xhr.responseText)
                 if (config.text_scale) textScale = config.text_scale
-            }
-        } catch (e) {}
+            } catch (e) {}
+        }
+        xhr.open("GET", "file://" + Theme.stateDir + "/display_config.json")
+        xhr.send()
     }
 
     Timer {
@@ -96,11 +98,6 @@ Window {
         })
     }
 
-    function isVideoFile(fileName) {
-        var ext = fileName.split(".").pop().toLowerCase()
-        return videoExtensions.indexOf(ext) >= 0
-    }
-
     // Component to scan a folder (one at a time)
     Component {
         id: folderScannerComponent
@@ -115,6 +112,10 @@ Window {
                 showDirsFirst: true
                 showDotAndDotDot: false
                 showOnlyReadable: true
+                // Matched in the model's worker thread; directories are
+                // listed regardless of nameFilters
+                nameFilters: videoExtensions.map(function(ext) { return "*." + ext })
+                caseSensitive: false
 
                 onStatusChanged: {
                     if (status === FolderListModel.Ready) {
@@ -134,7 +135,7 @@ Window {
                     if (isDir) {
                         // Queue subdirectory for later scanning
                         scanQueue.push(filePath)
-                    } else if (isVideoFile(fileName)) {
+                    } else {
                         // Add video to model
                         videoModel.append({
                             name: folderModel.get(i, "fileBaseName"),
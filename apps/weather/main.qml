@@ -110,7 +110,9 @@ Window {
         } catch (e) {}
     }
 
-    function fetchWeather() {
+    // userRefresh: revalidate before answering instead of showing the cached copy
+    // recheck: the one follow-up after a STALE answer; it never schedules another
+    function fetchWeather(userRefresh, recheck) {
         if (!hasLocation) {
             currentCondition = "Set your location"
             currentIcon = "📍"
@@ -126,18 +128,24 @@ Window {
                   "&wind_speed_unit=mph" +
                   "&timezone=auto"
 
-        var xhr = new XMLHttpRequest()
-        xhr.onreadystatechange = function() {
-            if (xhr.readyState === XMLHttpRequest.DONE) {
-                if (xhr.status === 200) {
-                    parseWeather(JSON.parse(xhr.responseText))
-                } else {
-                    currentCondition = "Unable to fetch weather"
-                }
+        // Through the shared cache: the last forecast shows instantly on open and
+        // the proxy keeps it warm every 30 minutes alongside other apps' refreshes
+        HttpCache.get(url, {maxAge: 600, refresh: 1800, wait: userRefresh === true},
+                      function(status, text, cacheState) {
+            if (status === 200) {
+                parseWeather(JSON.parse(text))
+                // Pick up the revalidated copy once the proxy has it
+                if (cacheState === "STALE" && recheck !== true) staleRecheck.restart()
+            } else {
+                currentCondition = "Unable to fetch weather"
             }
-        }
-        xhr.open("GET", url)
-        xhr.send()
+        })
+    }
+
+    Timer {
+        id: staleRecheck
+        interval: 3000
+        onTriggered: fetchWeather(false, true)
     }
 
     function parseWeather(data) {
@@ -322,7 +330,7 @@ Window {
                         anchors.fill: parent
                         onClicked: {
                             Haptic.tap()
-                            fetchWeather()
+                            fetchWeather(true)
                         }
                     }
                 }
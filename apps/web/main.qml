@@ -3,6 +3,7 @@ import QtQuick.Window 2.15
 import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
 import QtWebEngine 1.10
+import Qt.labs.folderlistmodel 2.15
 import "../shared"
 
 Window {
@@ -47,6 +48,27 @@ Window {
     property string historyFile: stateDir + "/browser_history.json"
     property string downloadsFile: stateDir + "/browser_downloads.json"
     property string settingsFile: stateDir + "/browser_settings.json"
+    property string tabsFile: stateDir + "/browser_tabs.json"
+
+    // Warm host: closing the window hides it and keeps the WebEngine profile,
+    // GPU process and renderers alive. run_web.sh re-attaches to a running
+    // host by dropping <launch ms>.json into web_commands/ instead of
+    // starting a new qmlscene.
+    property string commandDir: stateDir + "/web_commands"
+    property real lastCommandTs: 0
+    property bool hostHidden: false
+    property real hiddenSince: 0
+    // Set once a hidden host has discarded its tabs; nothing is left to poll
+    property bool hiddenTabsDropped: false
+
+    // Launch timing (ms since epoch from run_web.sh) for first-paint logging
+    property real launchMs: 0
+    property bool launchWarm: false
+
+    // Background tab policy
+    readonly property int freezeAfterMs: 60000        // hidden tabs stop running JS/timers
+    readonly property int discardHiddenHostAfterMs: 300000  // hidden host drops all renderers
+    readonly property int lowMemoryKb: 350 * 1024     // MemAvailable below this discards background tabs
 
     Component.onCompleted: {
         loadConfig()
@@ -57,15 +79,203 @@ Window {
 
         // Check for URL argument (for opening links from other apps)
         var args = Qt.application.arguments
-        var initialUrl = homepage
+        var initialUrl = ""
+        var prewarm = false
         for (var i = 1; i < args.length; i++) {
             var arg = args[i]
             if (arg.indexOf("http://") === 0 || arg.indexOf("https://") === 0) {
                 initialUrl = arg
-                break
+            } else if (arg === "--prewarm") {
+                prewarm = true
+            } else if (arg.indexOf("--launch-ms=") === 0) {
+                launchMs = parseFloat(arg.substring(12))
             }
         }
-        createTab(initialUrl)
+
+        restoreTabs()
+        if (initialUrl !== "") {
+            createTab(initialUrl)
+        } else if (tabs.length === 0) {
+            createTab(prewarm ? "about:blank" : homepage)
+        }
+
+        if (prewarm) {
+            // Started ahead of time: initialise Chromium, then wait hidden
+            console.log("WEB: pre-warmed host started")
+            launchMs = 0
+            Qt.callLater(hideToBackground)
+        }
+    }
+
+    onClosing: function(close) {
+        // Stay resident so the next launch attaches instead of cold-starting
+        close.accepted = false
+        hideToBackground()
+    }
+
+    // ==================== Warm Host ====================
+
+    function hideToBackground() {
+        saveTabs()
+        hostHidden = true
+        hiddenSince = Date.now()
+        root.visible = false
+    }
+
+    function showFromBackground() {
+        hostHidden = false
+        hiddenTabsDropped = false
+        loadConfig()
+        root.visible = true
+        root.visibility = Window.FullScreen
+        root.raise()
+        root.requestActivate()
+    }
+
+    function readCommand(path) {
+        var xhr = new XMLHttpRequest()
+        xhr.open("GET", "file://" + path, false)
+        try {
+            xhr.send()
+            if ((xhr.status === 200 || xhr.status === 0) && xhr.responseText) {
+                return JSON.parse(xhr.responseText)
+            }
+        } catch (e) {}
+        return null
+    }
+
+    // Attach requests from run_web.sh. The model watches the directory
+    // (inotify), so the host has no wakeups at all until a launch arrives.
+    FolderListModel {
+        id: commandWatch
+        folder: "file://" + commandDir
+        nameFilters: ["*.json"]
+        showDirs: false
+        sortField: FolderListModel.Name
+        onCountChanged: handleCommands()
+    }
+
+    function handleCommands() {
+        // Names are launch timestamps, so the newest unseen one wins
+        for (var i = commandWatch.count - 1; i >= 0; i--) {
+            var ts = parseFloat(commandWatch.get(i, "fileBaseName"))
+            if (!(ts > lastCommandTs)) return
+            var cmd = readCommand(commandWatch.get(i, "filePath"))
+            if (!cmd) continue
+            lastCommandTs = ts
+            console.log("WEB: attach request, url=" + (cmd.url || "(none)"))
+
+            launchMs = cmd.ts
+            launchWarm = true
+            if (cmd.url) {
+                createTab(cmd.url)
+            }
+            currentView = "browser"
+            showFromBackground()
+            return
+        }
+    }
+
+    // Log launch-to-first-paint once the current tab finishes loading
+    function reportFirstPaint() {
+        if (launchMs <= 0) return
+        console.log("WEB_TIMING first_paint_ms=" + Math.round(Date.now() - launchMs) +
+                    " start=" + (launchWarm ? "warm" : "cold"))
+        launchMs = 0
+    }
+
+    // ==================== Tab Persistence ====================
+
+    function saveTabs() {
+        // Private tabs are never written to disk
+        if (privateMode) return
+        var data = {
+            current: currentTabIndex,
+            tabs: tabs.map(function(t) { return { url: t.url, title: t.title } })
+        }
+        var xhr = new XMLHttpRequest()
+        xhr.open("PUT", "file://" + tabsFile)
+        xhr.send(JSON.stringify(data, null, 2))
+    }
+
+    function restoreTabs() {
+        var xhr = new XMLHttpRequest()
+        xhr.open("GET", "file://" + tabsFile, false)
+        try {
+            xhr.send()
+            if (xhr.status === 200 || xhr.status === 0) {
+                var data = JSON.parse(xhr.responseText)
+                var saved = data.tabs || []
+                for (var i = 0; i < saved.length; i++) {
+                    if (!saved[i].url || saved[i].url === "about:blank") continue
+                    tabs.push({
+                        id: tabIdCounter++,
+                        url: saved[i].url,
+                        title: saved[i].title || "Untitled",
+                        loading: false,
+                        progress: 0,
+                        canGoBack: false,
+                        canGoForward: false
+                    })
+                }
+                currentTabIndex = Math.max(0, Math.min(data.current || 0, tabs.length - 1))
+                tabsChanged()
+            }
+        } catch (e) {}
+    }
+
+    // Tab state changes constantly while loading - write at most every 2s
+    Timer {
+        id: saveTabsTimer
+        interval: 2000
+        onTriggered: saveTabs()
+    }
+    onTabsChanged: saveTabsTimer.start()
+    onCurrentTabIndexChanged: saveTabsTimer.start()
+
+    // ==================== Background Tabs ====================
+
+    function memAvailableKb() {
+        var xhr = new XMLHttpRequest()
+        xhr.open("GET", "file:///proc/meminfo", false)
+        try {
+            xhr.send()
+            var m = xhr.responseText.match(/MemAvailable:\s+(\d+)/)
+            if (m) return parseInt(m[1])
+        } catch (e) {}
+        return -1
+    }
+
+    // Freeze tabs that have been in the background for a while and discard
+    // them when memory runs low. Discarded tabs keep their URL and history
+    // and reload when shown again.
+    Timer {
+        interval: 10000
+        running: !(hostHidden && hiddenTabsDropped)
+        repeat: true
+        onTriggered: {
+            var now = Date.now()
+            var avail = memAvailableKb()
+            var lowMemory = avail >= 0 && avail < lowMemoryKb
+            var dropAll = hostHidden && now - hiddenSince > discardHiddenHostAfterMs
+
+            for (var i = 0; i < tabRepeater.count; i++) {
+                var view = tabRepeater.itemAt(i)
+                // WebEngine never freezes the view on screen (even if the host is hidden)
+                if (!view || view.visible) continue
+
+                if (lowMemory || dropAll) {
+                    if (view.lifecycleState !== WebEngineView.LifecycleState.Discarded) {
+                        console.log("WEB: discarding tab " + i + (lowMemory ? " (low memory)" : ""))
+                        view.lifecycleState = WebEngineView.LifecycleState.Discarded
+                    }
+                } else if (now - view.hiddenSince > freezeAfterMs &&
+                           view.lifecycleState === WebEngineView.LifecycleState.Active) {
+                    view.lifecycleState = WebEngineView.LifecycleState.Frozen
+                }
+            }
+            if (dropAll) hiddenTabsDropped = true
+        }
     }
 
     // ==================== Data Functions ====================
@@ -323,9 +533,10 @@ Window {
 
     // ==================== Config Timer ====================
 
+    // Not while hidden (showFromBackground reloads it)
     Timer {
         interval: 5000
-        running: true
+        running: !hostHidden
         repeat: true
         onTriggered: loadConfig()
     }
@@ -338,6 +549,7 @@ Window {
         storageName: "FlickBrowser"
         offTheRecord: false
         httpCacheType: WebEngineProfile.DiskHttpCache
+        httpCacheMaximumSize: 100 * 1024 * 1024
         persistentCookiesPolicy: WebEngineProfile.AllowPersistentCookies
         httpUserAgent: "Mozilla/5.0 (Linux; Android 11; Mobile) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Mobile Safari/537.36"
 
@@ -672,9 +884,25 @@ Window {
                     visible: index === currentTabIndex
                     profile: privateMode ? privateProfile : normalProfile
 
+                    // When this view was last moved to the background
+                    property real hiddenSince: Date.now()
+
+                    onVisibleChanged: {
+                        if (visible) {
+                            // Frozen/discarded tabs resume (or reload) on show
+                            lifecycleState = WebEngineView.LifecycleState.Active
+                        } else {
+                            hiddenSince = Date.now()
+                        }
+                    }
+
                     Component.onCompleted: {
                         if (tabs[index]) {
                             url = tabs[index].url
+                            // Restored background tabs don't load until shown
+                            if (index !== currentTabIndex) {
+                                lifecycleState = WebEngineView.LifecycleState.Discarded
+                            }
                         }
                     }
 
@@ -709,6 +937,7 @@ Window {
 
                             if (loadRequest.status === WebEngineLoadRequest.LoadSucceededStatus) {
                                 addToHistory(title, url.toString())
+                                if (index === currentTabIndex) reportFirstPaint()
                             }
                         }
                     }
@@ -1246,6 +1475,7 @@ Window {
                     anchors.fill: parent
                     onClicked: {
                         Haptic.click()
+                        saveTabs()
                         Qt.quit()
                     }
                 }
@@ -1,5 +1,7 @@
 #!/bin/bash
 # Flick Web - Mobile web browser for Flick shell
+# Usage: run_web.sh [URL]      open the browser (attaches to a warm host if one is running)
+#        run_web.sh --prewarm  start a hidden host ahead of time (e.g. at session start)
 
 SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 STATE_DIR="$HOME/.local/state/flick"
@@ -8,8 +10,36 @@ LOG_FILE="${STATE_DIR}/web.log"
 mkdir -p "$STATE_DIR"
 mkdir -p "$HOME/Downloads"
 
+PID_FILE="$STATE_DIR/web_host.pid"
+COMMAND_DIR="$STATE_DIR/web_commands"
+mkdir -p "$COMMAND_DIR"
+LAUNCH_MS=$(date +%s%3N)
+
+URL=""
+for arg in "$@"; do
+    case "$arg" in
+        http://*|https://*) URL="$arg" ;;
+    esac
+done
+
+# Attach to a running warm host instead of cold-starting Chromium
+if [ "$1" != "--prewarm" ] && [ -f "$PID_FILE" ]; then
+    HOST_PID=$(cat "$PID_FILE")
+    if grep -qs "web/main.qml" "/proc/$HOST_PID/cmdline"; then
+        ESCAPED_URL=$(printf '%s' "$URL" | sed 's/\\/\\\\/g; s/"/\\"/g')
+        # The host watches the directory; the rename makes the file appear whole
+        printf '{"action": "show", "url": "%s", "ts": %s}\n' "$ESCAPED_URL" "$LAUNCH_MS" > "$COMMAND_DIR/.$LAUNCH_MS.tmp"
+        mv "$COMMAND_DIR/.$LAUNCH_MS.tmp" "$COMMAND_DIR/$LAUNCH_MS.json"
+        echo "=== Attached to warm host $HOST_PID at $(date) ===" >> "$LOG_FILE"
+        exit 0
+    fi
+fi
+
 echo "=== Flick Web started at $(date) ===" >> "$LOG_FILE"
 
+# Commands for a previous host are stale (this also bounds the directory)
+rm -f "$COMMAND_DIR"/*.json "$COMMAND_DIR"/.*.tmp
+
 # Set Wayland environment
 export QT_QPA_PLATFORM=wayland
 export QT_WAYLAND_DISABLE_WINDOWDECORATION=1
@@ -29,5 +59,7 @@ export QML_XHR_ALLOW_FILE_READ=1
 export QTWEBENGINE_DICTIONARIES_PATH="$STATE_DIR/webengine/dictionaries"
 mkdir -p "$STATE_DIR/webengine"
 
-# Run the browser (pass any URL argument)
-exec /usr/lib/qt5/bin/qmlscene "$SCRIPT_DIR/main.qml" "$@" 2>> "$LOG_FILE"
+# Run the browser (pass any URL argument). exec keeps our PID, so the PID
+# file points at qmlscene.
+echo $$ > "$PID_FILE"
+exec /usr/lib/qt5/bin/qmlscene "$SCRIPT_DIR/main.qml" -- --launch-ms="$LAUNCH_MS" "$@" 2>> "$LOG_FILE"
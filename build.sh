@@ -116,9 +116,18 @@ fi
 
 if [ "$BUILD_ALL" = true ] || [ "$BUILD_SERVICES" = true ]; then
     build_project "Flick App Service" "$SCRIPT_DIR/services/flick-app-service"
+    build_project "Flick Audio Engine" "$SCRIPT_DIR/services/flick-audio-engine"
 fi
 
 if [ "$BUILD_ALL" = true ] || [ "$BUILD_APPS" = true ]; then
+    # Store-package apps bundle the FlickBackend audio client; keep them on
+    # the current version
+    for copy in "$SCRIPT_DIR"/apps/*/app/shared/AudioEngine.qml; do
+        if [ -f "$copy" ]; then
+            cp "$SCRIPT_DIR/lib/FlickBackend/AudioEngine.qml" "$copy"
+        fi
+    done
+
     # Build all Rust apps
     for app_dir in "$SCRIPT_DIR"/apps/*/; do
         if [ -f "$app_dir/Cargo.toml" ]; then
@@ -146,6 +155,9 @@ if [ "$BUILD_ALL" = true ] || [ "$BUILD_SERVICES" = true ]; then
     if [ -f "$SCRIPT_DIR/services/flick-app-service/target/release/flick-app-service" ]; then
         echo "  App Service: $SCRIPT_DIR/services/flick-app-service/target/release/flick-app-service"
     fi
+    if [ -f "$SCRIPT_DIR/services/flick-audio-engine/target/release/flick-audio-engine" ]; then
+        echo "  Audio Engine: $SCRIPT_DIR/services/flick-audio-engine/target/release/flick-audio-engine"
+    fi
 fi
 
 if [ "$BUILD_ALL" = true ] || [ "$BUILD_APPS" = true ]; then
@@ -1,6 +1,8 @@
 #!/bin/bash
 # Flick gesture configuration for lisgd
 # This script starts lisgd with edge gesture bindings for back/forward navigation
+# Only used by the legacy phoc sessions - the Flick compositor handles these
+# bindings itself (see edge_gestures.conf)
 
 log_msg() {
     echo "$(date '+%Y-%m-%d %H:%M:%S') [lisgd.sh] $*"
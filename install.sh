@@ -418,7 +418,7 @@ ExecStartPre=/bin/chown -R $INSTALL_USER:$INSTALL_USER $INSTALL_HOME/.local/stat
 ExecStartPre=/bin/sh -c '[ "$ANDROID_CONTAINER" != "true" ] && exit 0; ANDROID_SERVICE="$HWCOMPOSER_SERVICE" /usr/lib/halium-wrappers/android-service.sh hwcomposer start || true'
 ExecStartPre=/bin/sleep 2
 
-ExecStart=$SCRIPT_DIR/shell/target/release/flick
+ExecStart=$SCRIPT_DIR/shell/target/release/flick --supervise
 
 StandardOutput=journal
 StandardError=journal
@@ -428,6 +428,10 @@ Restart=on-failure
 RestartSec=3
 LimitNOFILE=65536
 
+# Compositor scheduling boost (apps get per-group tiers from the shell)
+CPUWeight=400
+IOWeight=400
+
 [Install]
 WantedBy=multi-user.target
 EOF
@@ -489,45 +493,33 @@ StandardOutput=journal
 StandardError=journal
 SyslogIdentifier=flick-messaging
 
-Restart=on-failure
-RestartSec=5
-
-[Install]
-WantedBy=flick.service
-EOF
-
-    # Create flick-audio-keepalive.service (only if needed)
-    if [ "$AUDIO_KEEPALIVE" = "true" ]; then
-        cat > /etc/systemd/system/flick-audio-keepalive.service << EOF
-[Unit]
-Description=Flick Audio Keepalive
-After=pulseaudio.service user@$INSTALL_UID.service
-Wants=user@$INSTALL_UID.service
-BindsTo=flick.service
-After=flick.service
-
-[Service]
-Type=simple
-User=$INSTALL_USER
-Group=$INSTALL_USER
-Environment=XDG_RUNTIME_DIR=$XDG_RUNTIME_DIR
+# Background sync must not steal frames from the foreground app
+CPUWeight=20
+IOWeight=25
 
-ExecStartPre=/bin/sh -c 'for i in \$(seq 1 60); do [ -S $XDG_RUNTIME_DIR/pulse/native ] && exit 0; sleep 1; done; echo "PulseAudio not ready"; exit 1'
-ExecStart=/usr/bin/pacat --playback /dev/zero --rate=44100 --channels=2 --format=s16le --latency-msec=1000
 Restart=on-failure
 RestartSec=5
 
 [Install]
 WantedBy=flick.service
 EOF
+
+    # The old keepalive played silence around the clock to dodge the sink
+    # resume pop; the sink now suspends after a device-tuned idle timeout
+    # and the audio engine pre-rolls on touch instead. Remove old installs.
+    if [ -f /etc/systemd/system/flick-audio-keepalive.service ]; then
+        systemctl disable --now flick-audio-keepalive 2>/dev/null || true
+        rm -f /etc/systemd/system/flick-audio-keepalive.service
     fi
 
-    # Disable PulseAudio suspend-on-idle
+    # Suspend the sink when idle, late enough that bursts of UI sounds
+    # don't each pay the resume latency
     mkdir -p /etc/pulse/default.pa.d
-    cat > /etc/pulse/default.pa.d/no-suspend.pa << EOF
-# Disable suspend-on-idle for Droidian audio stability
+    rm -f /etc/pulse/default.pa.d/no-suspend.pa
+    cat > /etc/pulse/default.pa.d/suspend-timeout.pa << EOF
 .nofail
 unload-module module-suspend-on-idle
+load-module module-suspend-on-idle timeout=${AUDIO_SUSPEND_TIMEOUT:-5}
 EOF
 
     systemctl daemon-reload
@@ -536,7 +528,6 @@ EOF
         log "Enabling Flick services..."
         # Don't disable phosh - just enable flick
         systemctl enable flick flick-phone-helper flick-messaging
-        [ "$AUDIO_KEEPALIVE" = "true" ] && systemctl enable flick-audio-keepalive
     fi
 
     echo ""
@@ -548,7 +539,6 @@ EOF
     echo "  - flick.service (main compositor)"
     echo "  - flick-phone-helper.service (phone daemon)"
     echo "  - flick-messaging.service (SMS daemon)"
-    [ "$AUDIO_KEEPALIVE" = "true" ] && echo "  - flick-audio-keepalive.service (audio fix)"
     echo ""
     if [ "$NO_ENABLE" = false ]; then
         info "Flick is enabled and will start on next boot."
@@ -574,7 +564,7 @@ Conflicts=greetd.service phosh.service
 [Service]
 Type=simple
 ExecStartPre=+/usr/bin/chvt 2
-ExecStart=$SCRIPT_DIR/shell/target/release/flick
+ExecStart=$SCRIPT_DIR/shell/target/release/flick --supervise
 User=$INSTALL_USER
 StandardOutput=journal
 StandardError=journal
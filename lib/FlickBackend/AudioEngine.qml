@@ -0,0 +1,59 @@
+pragma Singleton
+import QtQuick 2.15
+
+// Client for flick-audio-engine (services/flick-audio-engine)
+// Sounds are pre-decoded and mixed on one open stream, so play() is a single
+// localhost request instead of a QtMultimedia pipeline per tap.
+// This is the copy to edit: store-package apps run under a bare qmlscene
+// without FlickBackend on the import path, so they ship this file in their
+// app/shared/ and build.sh refreshes those copies from here.
+QtObject {
+    id: audioEngine
+
+    property int port: 7655
+    readonly property string baseUrl: "http://127.0.0.1:" + port
+
+    // False while the engine is unreachable - callers can fall back to QtMultimedia
+    property bool available: false
+
+    // Play a synthesized tone
+    // wave: 0/"sine", 1/"square", 2/"triangle", 3/"sawtooth"
+    // gain: 0.0-1.0, durationMs defaults to 150
+    function tone(freq, wave, gain, durationMs) {
+        var path = "/tone?freq=" + freq + "&wave=" + wave + "&gain=" + (gain === undefined ? 1.0 : gain)
+        if (durationMs !== undefined) path += "&ms=" + durationMs
+        request(path)
+    }
+
+    // Play a sample pre-loaded by the engine (WAV file name without extension)
+    function play(name, gain) {
+        request("/play?sample=" + encodeURIComponent(name) + "&gain=" + (gain === undefined ? 1.0 : gain))
+    }
+
+    function stopAll() {
+        request("/stop")
+    }
+
+    // Reopen the engine's stream ahead of a likely sound (it closes when idle)
+    function warm() {
+        request("/warm")
+    }
+
+    // Re-check whether the engine is running
+    function probe() {
+        request("/status")
+    }
+
+    function request(path) {
+        var xhr = new XMLHttpRequest()
+        xhr.onreadystatechange = function() {
+            if (xhr.readyState === XMLHttpRequest.DONE) {
+                available = xhr.status === 200
+            }
+        }
+        xhr.open("GET", baseUrl + path)
+        xhr.send()
+    }
+
+    Component.onCompleted: probe()
+}
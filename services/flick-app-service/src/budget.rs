@@ -0,0 +1,121 @@
+//! CPU and memory budget for prelaunching
+//!
+//! Prelaunching is only worth it while the phone is otherwise idle. The
+//! budget reads PSI (`/proc/pressure/{cpu,memory}`) and MemAvailable: new
+//! apps are only requested when there is slack, the current ones are kept
+//! while things are merely busy, and everything is cancelled (the
+//! compositor kills the hidden apps) as soon as the foreground is short of
+//! CPU or memory.
+
+use std::time::{Duration, Instant};
+
+/// After a cancel, wait this long before prelaunching again
+const COOLDOWN: Duration = Duration::from_secs(60);
+
+/// Snapshot of system load
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct Load {
+    /// `some avg10` of /proc/pressure/cpu, in percent
+    pub cpu_pressure: f32,
+    /// `some avg10` of /proc/pressure/memory, in percent
+    pub memory_pressure: f32,
+    pub mem_available_kb: u64,
+}
+
+impl Load {
+    pub fn read() -> Option<Self> {
+        let cpu = std::fs::read_to_string("/proc/pressure/cpu").ok()?;
+        let memory = std::fs::read_to_string("/proc/pressure/memory").ok()?;
+        let meminfo = std::fs::read_to_string("/proc/meminfo").ok()?;
+        Some(Self {
+            cpu_pressure: parse_some_avg10(&cpu)?,
+            memory_pressure: parse_some_avg10(&memory)?,
+            mem_available_kb: parse_mem_available(&meminfo)?,
+        })
+    }
+}
+
+/// `some avg10=1.23 avg60=...` -> 1.23
+fn parse_some_avg10(psi: &str) -> Option<f32> {
+    psi.lines()
+        .find(|line| line.starts_with("some "))?
+        .split_whitespace()
+        .find_map(|field| field.strip_prefix("avg10="))?
+        .parse()
+        .ok()
+}
+
+fn parse_mem_available(meminfo: &str) -> Option<u64> {
+    meminfo
+        .lines()
+        .find_map(|line| line.strip_prefix("MemAvailable:"))?
+        .split_whitespace()
+        .next()?
+        .parse()
+        .ok()
+}
+
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Verdict {
+    /// Room to start predicted apps
+    Allow,
+    /// Keep what is prelaunched, start nothing new
+    Hold,
+    /// Drop every prelaunched app
+    Cancel,
+}
+
+pub struct Budget {
+    /// Free memory needed to start an app
+    pub min_available_kb: u64,
+    cancelled_at: Option<Instant>,
+}
+
+impl Budget {
+    pub fn new(min_available_mb: u64) -> Self {
+        Self { min_available_kb: min_available_mb * 1024, cancelled_at: None }
+    }
+
+    pub fn verdict(&mut self, load: Option<Load>, now: Instant) -> Verdict {
+        // Without PSI there is no way to tell whether we'd be in the way
+        let Some(load) = load else { return Verdict::Hold };
+        if load.cpu_pressure > 40.0 || load.memory_pressure > 5.0 || load.mem_available_kb < self.min_available_kb / 2 {
+            self.cancelled_at = Some(now);
+            return Verdict::Cancel;
+        }
+        if self.cancelled_at.is_some_and(|at| now.duration_since(at) < COOLDOWN) {
+            return Verdict::Hold;
+        }
+        if load.cpu_pressure < 10.0 && load.memory_pressure < 0.5 && load.mem_available_kb >= self.min_available_kb {
+            Verdict::Allow
+        } else {
+            Verdict::Hold
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_proc() {
+        let psi = "some avg10=2.50 avg60=1.00 avg300=0.20 total=123\nfull avg10=9.00 avg60=0.00 avg300=0.00 total=4\n";
+        assert_eq!(parse_some_avg10(psi), Some(2.5));
+        assert_eq!(parse_mem_available("MemTotal: 3900000 kB\nMemAvailable:  1200000 kB\n"), Some(1200000));
+    }
+
+    #[test]
+    fn test_cancel_then_cooldown() {
+        let mut budget = Budget::new(512);
+        let idle = Load { cpu_pressure: 1.0, memory_pressure: 0.0, mem_available_kb: 1024 * 1024 };
+        let busy = Load { cpu_pressure: 60.0, ..idle };
+        let now = Instant::now();
+        assert_eq!(budget.verdict(Some(idle), now), Verdict::Allow);
+        assert_eq!(budget.verdict(Some(Load { cpu_pressure: 20.0, ..idle }), now), Verdict::Hold);
+        assert_eq!(budget.verdict(Some(busy), now), Verdict::Cancel);
+        assert_eq!(budget.verdict(Some(idle), now + Duration::from_secs(10)), Verdict::Hold);
+        assert_eq!(budget.verdict(Some(idle), now + COOLDOWN), Verdict::Allow);
+        assert_eq!(budget.verdict(None, now + COOLDOWN), Verdict::Hold);
+    }
+}
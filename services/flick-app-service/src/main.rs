@@ -1,3 +1,273 @@
+//! Flick app service - predictive app prelaunch
+//!
+//! Cold-starting a QML app costs seconds on a phone; bringing an already
+//! running one to the front costs a frame. This daemon learns when and after
+//! what each app is usually opened (see model.rs) from the launch log the
+//! compositor keeps, and while the phone is idle asks the compositor to start
+//! the next likely apps hidden. The compositor lets each one draw its first
+//! frame at background priority, freezes it, and shows it instantly if the
+//! user does open it; apps that were not opened are killed when the request
+//! changes. The budget (budget.rs) cancels everything as soon as the
+//! foreground needs the CPU or memory.
+//!
+//! The loop sleeps until the launch log changes (watch.rs). In between it
+//! only wakes to watch the budget while apps are prelaunched, or to
+//! re-predict as the hour moves on. Once a locked phone's prediction is
+//! made it does not wake again until the compositor logs the unlock.
+//!
+//! Files in the state dir (`~/.local/state/flick`):
+//!   app_launches  written by the compositor, one event per line
+//!   prelaunch     written here, one app id per line
+//!
+//! Usage: flick-app-service [--state-dir DIR] [--max-apps N] [--min-free-mb MB]
+//!                          [--interval-ms MS] [--predict]
+
+mod budget;
+mod model;
+mod watch;
+
+use std::fs::File;
+use std::io::{Read, Seek, SeekFrom};
+use std::path::{Path, PathBuf};
+use std::sync::mpsc::RecvTimeoutError;
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+
+use budget::{Budget, Load, Verdict};
+use model::{Event, Model};
+
+const LAUNCH_LOG: &str = "app_launches";
+const REQUEST_FILE: &str = "prelaunch";
+const DEFAULT_MAX_APPS: usize = 2;
+/// MemAvailable needed before another app is started
+const DEFAULT_MIN_FREE_MB: u64 = 600;
+/// Budget check interval while apps are prelaunched
+const DEFAULT_INTERVAL_MS: u64 = 2000;
+/// Re-prediction interval with nothing prelaunched
+const IDLE_INTERVAL: Duration = Duration::from_secs(60);
+
+struct Options {
+    state_dir: PathBuf,
+    max_apps: usize,
+    min_free_mb: u64,
+    interval_ms: u64,
+    predict_only: bool,
+}
+
+fn default_state_dir() -> PathBuf {
+    if let Ok(dir) = std::env::var("FLICK_STATE_DIR") {
+        return PathBuf::from(dir);
+    }
+    let home = std::env::var("HOME").unwrap_or_else(|_| "/tmp".to_string());
+    PathBuf::from(home).join(".local/state/flick")
+}
+
+fn parse_args() -> Result<Options, String> {
+    let mut opts = Options {
+        state_dir: default_state_dir(),
+        max_apps: DEFAULT_MAX_APPS,
+        min_free_mb: DEFAULT_MIN_FREE_MB,
+        interval_ms: DEFAULT_INTERVAL_MS,
+        predict_only: false,
+    };
+
+    let mut args = std::env::args().skip(1);
+    while let Some(arg) = args.next() {
+        let mut value = |name: &str| args.next().ok_or(format!("{} needs a value", name));
+        match arg.as_str() {
+            "--state-dir" => opts.state_dir = PathBuf::from(value("--state-dir")?),
+            "--max-apps" => opts.max_apps = value("--max-apps")?.parse().map_err(|_| "bad --max-apps")?,
+            "--min-free-mb" => opts.min_free_mb = value("--min-free-mb")?.parse().map_err(|_| "bad --min-free-mb")?,
+            "--interval-ms" => opts.interval_ms = value("--interval-ms")?.parse().map_err(|_| "bad --interval-ms")?,
+            "--predict" => opts.predict_only = true,
+            other => return Err(format!("unknown argument '{}'", other)),
+        }
+    }
+    Ok(opts)
+}
+
+fn now_secs() -> u64 {
+    SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0)
+}
+
+/// Follows the launch log, handing out complete new lines
+///
+/// The compositor trims the log by rewriting it; a file that got shorter
+/// than what was already read is read again from the start.
+struct LogReader {
+    path: PathBuf,
+    offset: u64,
+    partial: String,
+}
+
+impl LogReader {
+    fn new(path: PathBuf) -> Self {
+        Self { path, offset: 0, partial: String::new() }
+    }
+
+    /// New complete lines, and whether the log was rewritten since last time
+    fn read_new(&mut self) -> (Vec<String>, bool) {
+        let Ok(mut file) = File::open(&self.path) else { return (Vec::new(), false) };
+        let len = file.metadata().map(|m| m.len()).unwrap_or(0);
+        let rewritten = len < self.offset;
+        if rewritten {
+            self.offset = 0;
+            self.partial.clear();
+        }
+        if len == self.offset {
+            return (Vec::new(), rewritten);
+        }
+        let mut chunk = String::new();
+        if file.seek(SeekFrom::Start(self.offset)).is_err() || file.read_to_string(&mut chunk).is_err() {
+            return (Vec::new(), rewritten);
+        }
+        self.offset += chunk.len() as u64;
+        self.partial.push_str(&chunk);
+        let complete = match self.partial.rfind('\n') {
+            Some(end) => self.partial.drain(..=end).collect::<String>(),
+            None => String::new(),
+        };
+        (complete.lines().map(str::to_string).collect(), rewritten)
+    }
+}
+
+/// Replace the request file atomically so the compositor never sees half of it
+fn write_requests(path: &Path, apps: &[String]) -> std::io::Result<()> {
+    let tmp = path.with_extension("tmp");
+    let mut contents = apps.join("\n");
+    contents.push('\n');
+    std::fs::write(&tmp, contents)?;
+    std::fs::rename(&tmp, path)
+}
+
 fn main() {
-    println!("Hello, world!");
+    let opts = match parse_args() {
+        Ok(o) => o,
+        Err(e) => {
+            eprintln!("flick-app-service: {}", e);
+            std::process::exit(2);
+        }
+    };
+    let _ = std::fs::create_dir_all(&opts.state_dir);
+
+    let mut log = LogReader::new(opts.state_dir.join(LAUNCH_LOG));
+    let request_path = opts.state_dir.join(REQUEST_FILE);
+    let mut model = Model::new();
+    let mut budget = Budget::new(opts.min_free_mb);
+    let mut requested: Vec<String> = Vec::new();
+    let (mut hits, mut misses) = (0u32, 0u32);
+
+    if opts.predict_only {
+        for line in log.read_new().0 {
+            if let Some(record) = model::parse_line(&line) {
+                model.observe(&record);
+            }
+        }
+        let context = model.context(now_secs());
+        println!("{} launches on record, context {:?}", model.len(), context);
+        for (app, p) in model.predict(&context, opts.max_apps) {
+            println!("  {} {:.2}", app, p);
+        }
+        return;
+    }
+
+    // Nothing from a previous run is running any more
+    if let Err(e) = write_requests(&request_path, &[]) {
+        eprintln!("App service: cannot write {:?}: {}", request_path, e);
+    }
+    println!("App service: watching {:?}", log.path);
+    let mut changes = watch::watch_file(&opts.state_dir, LAUNCH_LOG);
+
+    loop {
+        let (lines, rewritten) = log.read_new();
+        if rewritten {
+            model = Model::new();
+        }
+        for line in lines {
+            let Some(record) = model::parse_line(&line) else { continue };
+            if let Event::Launch(app) = &record.event {
+                if requested.contains(app) {
+                    hits += 1;
+                } else {
+                    misses += 1;
+                }
+                if (hits + misses) % 20 == 0 {
+                    println!("App service: {} of {} launches were prelaunched", hits, hits + misses);
+                }
+            }
+            model.observe(&record);
+        }
+
+        let now = now_secs();
+        let verdict = budget.verdict(Load::read(), Instant::now());
+        let wanted = match verdict {
+            Verdict::Cancel => Vec::new(),
+            Verdict::Allow if model.settled(now) => model
+                .predict(&model.context(now), opts.max_apps)
+                .into_iter()
+                .map(|(app, _)| app)
+                .collect(),
+            Verdict::Allow | Verdict::Hold => requested.clone(),
+        };
+        if wanted != requested {
+            println!("App service: prelaunch {:?}", wanted);
+            match write_requests(&request_path, &wanted) {
+                Ok(()) => requested = wanted,
+                Err(e) => eprintln!("App service: cannot write {:?}: {}", request_path, e),
+            }
+        }
+
+        let wait = next_wait(&model, now, &requested, verdict, Duration::from_millis(opts.interval_ms));
+        let woken = match (&changes, wait) {
+            (Some(rx), Some(wait)) => rx.recv_timeout(wait).map_err(|e| e == RecvTimeoutError::Disconnected),
+            (Some(rx), None) => rx.recv().map_err(|_| true),
+            // Without inotify, check the log at the budget interval
+            (None, wait) => {
+                std::thread::sleep(wait.unwrap_or(Duration::from_millis(opts.interval_ms)));
+                Ok(())
+            }
+        };
+        if woken == Err(true) {
+            eprintln!("App service: log watch ended, polling instead");
+            changes = None;
+        }
+        // One pass covers every write that arrived meanwhile
+        if let Some(rx) = &changes {
+            while rx.try_recv().is_ok() {}
+        }
+    }
+}
+
+/// How long to sleep before looking again; None to wait for the launch log
+fn next_wait(model: &Model, now: u64, requested: &[String], verdict: Verdict, interval: Duration) -> Option<Duration> {
+    if !model.settled(now) {
+        return Some(Duration::from_secs(model.settles_in(now)));
+    }
+    if model.locked() {
+        // Nothing changes until the unlock is logged; the compositor's own
+        // memory pressure handling covers the frozen apps meanwhile
+        return if verdict == Verdict::Allow { None } else { Some(IDLE_INTERVAL) };
+    }
+    if requested.is_empty() { Some(IDLE_INTERVAL) } else { Some(interval) }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Write;
+
+    #[test]
+    fn test_log_reader_follows_and_restarts() {
+        let path = std::env::temp_dir().join(format!("flick-app-service-test-{}", std::process::id()));
+        std::fs::write(&path, "1 0 launch a\n2 0 lau").unwrap();
+        let mut reader = LogReader::new(path.clone());
+        assert_eq!(reader.read_new(), (vec!["1 0 launch a".to_string()], false));
+
+        std::fs::OpenOptions::new().append(true).open(&path).unwrap().write_all(b"nch b\n").unwrap();
+        assert_eq!(reader.read_new(), (vec!["2 0 launch b".to_string()], false));
+        assert_eq!(reader.read_new(), (Vec::new(), false));
+
+        std::fs::write(&path, "3 0 lock\n").unwrap();
+        assert_eq!(reader.read_new(), (vec!["3 0 lock".to_string()], true));
+        let _ = std::fs::remove_file(&path);
+    }
 }
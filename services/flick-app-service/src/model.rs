@@ -0,0 +1,291 @@
+//! Launch history and next-app prediction
+//!
+//! The compositor appends one line per event to `app_launches`:
+//!
+//! ```text
+//! <unix secs> <utc offset secs> launch <app_id>
+//! <unix secs> <utc offset secs> unlock
+//! <unix secs> <utc offset secs> lock
+//! ```
+//!
+//! Each launch is remembered with its context (local hour, weekend, the
+//! previous app, whether it came right after an unlock). A prediction
+//! weighs every past launch by how similar its context is to the current
+//! one and by its age, so habits fade out over a few weeks instead of
+//! sticking forever.
+
+use std::collections::{HashMap, VecDeque};
+
+/// Launches kept in memory (a few months of normal use)
+const MAX_HISTORY: usize = 2000;
+/// Age at which a launch counts half
+const HALF_LIFE_SECS: f64 = 14.0 * 86400.0;
+/// A launch this soon after an unlock counts as "after unlock"
+const UNLOCK_WINDOW_SECS: u64 = 120;
+/// The previous app only counts if it was launched this recently
+const PREV_WINDOW_SECS: u64 = 30 * 60;
+/// No predictions this soon after any event, while the user is still busy
+const SETTLE_SECS: u64 = 15;
+/// An app needs this many launches on record before it is predicted
+const MIN_LAUNCHES: usize = 3;
+/// ... and at least this share of the weighted launches in this context
+const MIN_PROBABILITY: f64 = 0.2;
+
+#[derive(Debug, Clone, PartialEq)]
+pub enum Event {
+    Launch(String),
+    Unlock,
+    Lock,
+}
+
+/// One line of the launch log
+#[derive(Debug, Clone, PartialEq)]
+pub struct Record {
+    pub secs: u64,
+    /// Local time offset from UTC when the event happened
+    pub offset: i64,
+    pub event: Event,
+}
+
+/// Parse one log line, None for malformed ones
+pub fn parse_line(line: &str) -> Option<Record> {
+    let mut fields = line.split_whitespace();
+    let secs = fields.next()?.parse().ok()?;
+    let offset = fields.next()?.parse().ok()?;
+    let event = match (fields.next()?, fields.next()) {
+        ("launch", Some(app)) => Event::Launch(app.to_string()),
+        ("unlock", None) => Event::Unlock,
+        ("lock", None) => Event::Lock,
+        _ => return None,
+    };
+    Some(Record { secs, offset, event })
+}
+
+/// Local hour of day (0-23) and whether it is Saturday or Sunday
+fn local_time(secs: u64, offset: i64) -> (u8, bool) {
+    let local = secs as i64 + offset;
+    let hour = local.rem_euclid(86400) / 3600;
+    // 1970-01-01 was a Thursday (weekday 4, Sunday = 0)
+    let weekday = (local.div_euclid(86400) + 4).rem_euclid(7);
+    (hour as u8, weekday == 0 || weekday == 6)
+}
+
+fn hour_distance(a: u8, b: u8) -> u8 {
+    let d = a.abs_diff(b);
+    d.min(24 - d)
+}
+
+#[derive(Debug, Clone)]
+struct Launch {
+    secs: u64,
+    hour: u8,
+    weekend: bool,
+    prev: Option<String>,
+    after_unlock: bool,
+    app: String,
+}
+
+/// What a prediction is made for
+#[derive(Debug, Clone, PartialEq)]
+pub struct Context {
+    pub secs: u64,
+    pub hour: u8,
+    pub weekend: bool,
+    /// App in front right now (excluded from predictions)
+    pub prev: Option<String>,
+    /// The next launch will be the first after an unlock
+    pub after_unlock: bool,
+}
+
+#[derive(Debug, Default)]
+pub struct Model {
+    launches: VecDeque<Launch>,
+    last_app: Option<(String, u64)>,
+    last_unlock: Option<u64>,
+    locked: bool,
+    offset: i64,
+    last_event: u64,
+}
+
+impl Model {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn len(&self) -> usize {
+        self.launches.len()
+    }
+
+    pub fn observe(&mut self, record: &Record) {
+        self.offset = record.offset;
+        self.last_event = self.last_event.max(record.secs);
+        match &record.event {
+            Event::Lock => self.locked = true,
+            Event::Unlock => {
+                self.locked = false;
+                self.last_unlock = Some(record.secs);
+            }
+            Event::Launch(app) => {
+                let (hour, weekend) = local_time(record.secs, record.offset);
+                let prev = self.last_app.as_ref()
+                    .filter(|(_, at)| record.secs.saturating_sub(*at) <= PREV_WINDOW_SECS)
+                    .map(|(prev, _)| prev.clone())
+                    .filter(|prev| prev != app);
+                let after_unlock = self.last_unlock
+                    .is_some_and(|at| record.secs.saturating_sub(at) <= UNLOCK_WINDOW_SECS);
+                if self.launches.len() == MAX_HISTORY {
+                    self.launches.pop_front();
+                }
+                self.launches.push_back(Launch {
+                    secs: record.secs,
+                    hour,
+                    weekend,
+                    prev,
+                    after_unlock,
+                    app: app.clone(),
+                });
+                self.last_app = Some((app.clone(), record.secs));
+                // Only the first launch after an unlock counts as one
+                self.last_unlock = None;
+            }
+        }
+    }
+
+    /// True once nothing has happened for a while
+    pub fn settled(&self, now: u64) -> bool {
+        now >= self.last_event + SETTLE_SECS
+    }
+
+    /// Seconds until `settled` turns true (0 once it is)
+    pub fn settles_in(&self, now: u64) -> u64 {
+        (self.last_event + SETTLE_SECS).saturating_sub(now)
+    }
+
+    pub fn locked(&self) -> bool {
+        self.locked
+    }
+
+    /// Context of the next launch at `now`
+    ///
+    /// While locked the next launch is the first after unlocking, so that
+    /// is what gets prelaunched.
+    pub fn context(&self, now: u64) -> Context {
+        let (hour, weekend) = local_time(now, self.offset);
+        if self.locked {
+            return Context { secs: now, hour, weekend, prev: None, after_unlock: true };
+        }
+        let prev = self.last_app.as_ref()
+            .filter(|(_, at)| now.saturating_sub(*at) <= PREV_WINDOW_SECS)
+            .map(|(app, _)| app.clone());
+        let after_unlock = self.last_unlock
+            .is_some_and(|at| now.saturating_sub(at) <= UNLOCK_WINDOW_SECS);
+        Context { secs: now, hour, weekend, prev, after_unlock }
+    }
+
+    /// Most likely next apps with their probability, best first
+    pub fn predict(&self, context: &Context, max: usize) -> Vec<(String, f64)> {
+        let mut scores: HashMap<&str, (f64, usize)> = HashMap::new();
+        let mut total = 0.0;
+        for launch in &self.launches {
+            let age = context.secs.saturating_sub(launch.secs) as f64;
+            let mut weight = 1.0;
+            if hour_distance(context.hour, launch.hour) <= 1 {
+                weight += 2.0;
+            }
+            if context.weekend == launch.weekend {
+                weight += 0.5;
+            }
+            if context.prev.is_some() && context.prev == launch.prev {
+                weight += 3.0;
+            }
+            if context.after_unlock && launch.after_unlock {
+                weight += 3.0;
+            }
+            weight *= (-age / HALF_LIFE_SECS * std::f64::consts::LN_2).exp();
+            total += weight;
+            let entry = scores.entry(launch.app.as_str()).or_default();
+            entry.0 += weight;
+            entry.1 += 1;
+        }
+        if total <= 0.0 {
+            return Vec::new();
+        }
+
+        let mut ranked: Vec<(String, f64)> = scores
+            .into_iter()
+            .filter(|(app, (_, count))| *count >= MIN_LAUNCHES && context.prev.as_deref() != Some(*app))
+            .map(|(app, (score, _))| (app.to_string(), score / total))
+            .filter(|(_, p)| *p >= MIN_PROBABILITY)
+            .collect();
+        ranked.sort_by(|a, b| b.1.total_cmp(&a.1).then_with(|| a.0.cmp(&b.0)));
+        ranked.truncate(max);
+        ranked
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const DAY: u64 = 86400;
+    // Monday 2024-01-01 00:00 UTC
+    const MONDAY: u64 = 1704067200;
+
+    fn feed(model: &mut Model, secs: u64, line: &str) {
+        model.observe(&parse_line(&format!("{} 0 {}", secs, line)).unwrap());
+    }
+
+    #[test]
+    fn test_parse_line() {
+        assert_eq!(
+            parse_line("1704067200 3600 launch weather"),
+            Some(Record { secs: 1704067200, offset: 3600, event: Event::Launch("weather".into()) })
+        );
+        assert_eq!(parse_line("1 -18000 unlock").map(|r| r.event), Some(Event::Unlock));
+        assert_eq!(parse_line("1 0 launch"), None);
+        assert_eq!(parse_line("garbage"), None);
+        assert_eq!(local_time(MONDAY + 7 * 3600, 3600), (8, false));
+        assert_eq!(local_time(MONDAY - 3600, 0), (23, true));
+    }
+
+    #[test]
+    fn test_predicts_morning_routine_after_unlock() {
+        let mut model = Model::new();
+        for day in 0..7 {
+            let morning = MONDAY + day * DAY + 7 * 3600;
+            feed(&mut model, morning, "unlock");
+            feed(&mut model, morning + 5, "launch weather");
+            feed(&mut model, morning + 60, "launch messages");
+            feed(&mut model, morning + 600, "lock");
+            let evening = MONDAY + day * DAY + 20 * 3600;
+            feed(&mut model, evening, "unlock");
+            feed(&mut model, evening + 5, "launch video");
+            feed(&mut model, evening + 1800, "lock");
+        }
+
+        // Locked on the next morning: ready the first app after unlock
+        let now = MONDAY + 7 * DAY + 6 * 3600 + 1800;
+        let context = model.context(now);
+        assert!(context.after_unlock);
+        let predicted = model.predict(&context, 2);
+        assert_eq!(predicted[0].0, "weather");
+        assert!(predicted.iter().all(|(app, _)| app != "messages"));
+
+        // Weather is open: messages follows it
+        feed(&mut model, now, "unlock");
+        feed(&mut model, now + 5, "launch weather");
+        let context = model.context(now + 30);
+        assert_eq!(context.prev.as_deref(), Some("weather"));
+        assert_eq!(model.predict(&context, 1)[0].0, "messages");
+    }
+
+    #[test]
+    fn test_needs_evidence() {
+        let mut model = Model::new();
+        feed(&mut model, MONDAY, "launch weather");
+        feed(&mut model, MONDAY + 60, "launch weather");
+        assert!(model.predict(&model.context(MONDAY + 3600), 2).is_empty());
+        assert!(!model.settled(MONDAY + 65));
+        assert!(model.settled(MONDAY + 3600));
+    }
+}
@@ -0,0 +1,116 @@
+//! Wake-ups for new launch log entries
+//!
+//! A worker thread blocks on inotify for the state dir and reports writes
+//! to one file name, so the main loop can sleep until the compositor logs
+//! something instead of rereading the log on a timer. The crate has no
+//! dependencies; the two inotify calls are declared here.
+
+use std::ffi::{CString, c_char};
+use std::fs::File;
+use std::io::Read;
+use std::os::fd::FromRawFd;
+use std::os::unix::ffi::OsStrExt;
+use std::path::Path;
+use std::sync::mpsc::{self, Receiver};
+
+const IN_CLOEXEC: i32 = 0o2000000;
+const IN_MODIFY: u32 = 0x002;
+const IN_CLOSE_WRITE: u32 = 0x008;
+const IN_MOVED_TO: u32 = 0x080;
+const IN_CREATE: u32 = 0x100;
+/// wd, mask, cookie, len
+const EVENT_HEADER: usize = 16;
+
+unsafe extern "C" {
+    fn inotify_init1(flags: i32) -> i32;
+    fn inotify_add_watch(fd: i32, path: *const c_char, mask: u32) -> i32;
+}
+
+/// Receiver that gets a message whenever `name` in `dir` is written,
+/// created or replaced; None if inotify is unavailable
+pub fn watch_file(dir: &Path, name: &str) -> Option<Receiver<()>> {
+    let path = CString::new(dir.as_os_str().as_bytes()).ok()?;
+    let fd = unsafe { inotify_init1(IN_CLOEXEC) };
+    if fd < 0 {
+        eprintln!("App service: inotify unavailable: {}", std::io::Error::last_os_error());
+        return None;
+    }
+    // Owns the fd from here, so every early return closes it
+    let mut inotify = unsafe { File::from_raw_fd(fd) };
+    let mask = IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+    if unsafe { inotify_add_watch(fd, path.as_ptr(), mask) } < 0 {
+        eprintln!("App service: cannot watch {:?}: {}", dir, std::io::Error::last_os_error());
+        return None;
+    }
+
+    let name = name.as_bytes().to_vec();
+    let (tx, rx) = mpsc::channel();
+    std::thread::Builder::new()
+        .name("app-service-watch".into())
+        .spawn(move || {
+            let mut buf = [0u8; 4096];
+            loop {
+                let n = match inotify.read(&mut buf) {
+                    Ok(n) => n,
+                    Err(e) if e.kind() == std::io::ErrorKind::Interrupted => continue,
+                    Err(e) => {
+                        eprintln!("App service: inotify read failed: {}", e);
+                        return;
+                    }
+                };
+                if names(&buf[..n]).any(|event| event == name.as_slice()) && tx.send(()).is_err() {
+                    return;
+                }
+            }
+        })
+        .ok()?;
+    Some(rx)
+}
+
+/// File names of the events in one inotify read
+fn names(mut buf: &[u8]) -> impl Iterator<Item = &[u8]> {
+    std::iter::from_fn(move || {
+        if buf.len() < EVENT_HEADER {
+            return None;
+        }
+        let len = u32::from_ne_bytes(buf[12..16].try_into().ok()?) as usize;
+        let end = (EVENT_HEADER + len).min(buf.len());
+        // The name is NUL-padded to the record length
+        let name = buf[EVENT_HEADER..end].split(|b| *b == 0).next().unwrap_or(&[]);
+        buf = &buf[end..];
+        Some(name)
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::time::Duration;
+
+    fn event(name: &[u8], padded: usize) -> Vec<u8> {
+        let mut record = vec![0u8; EVENT_HEADER];
+        record[12..16].copy_from_slice(&(padded as u32).to_ne_bytes());
+        record.extend_from_slice(name);
+        record.resize(EVENT_HEADER + padded, 0);
+        record
+    }
+
+    #[test]
+    fn test_event_names() {
+        let mut buf = event(b"prelaunch.tmp", 16);
+        buf.extend(event(b"app_launches", 16));
+        assert_eq!(names(&buf).collect::<Vec<_>>(), vec![&b"prelaunch.tmp"[..], &b"app_launches"[..]]);
+    }
+
+    #[test]
+    fn test_watch_wakes_on_named_file_only() {
+        let dir = std::env::temp_dir().join(format!("flick-app-service-watch-{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let Some(rx) = watch_file(&dir, "app_launches") else { return };
+        std::fs::write(dir.join("other"), "x").unwrap();
+        assert!(rx.recv_timeout(Duration::from_millis(200)).is_err());
+        std::fs::write(dir.join("app_launches"), "1 0 lock\n").unwrap();
+        assert!(rx.recv_timeout(Duration::from_secs(2)).is_ok());
+        let _ = std::fs::remove_dir_all(&dir);
+    }
+}
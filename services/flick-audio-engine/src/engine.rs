@@ -0,0 +1,227 @@
+//! Audio thread: drains commands, renders a block, writes it to the sink
+//!
+//! Blocks are paced against the wall clock and kept at most `LEAD_BLOCKS`
+//! ahead of real time. Together with the shrunken pipe this bounds
+//! tap-to-sound latency to a few blocks plus the stream's own buffer, instead
+//! of whatever the pipe happens to hold.
+//!
+//! After `idle` without voices or commands the stream is closed and the
+//! thread sleeps in `recv()`, so an idle engine causes no wakeups and lets
+//! the sound server suspend the sink. The next command reopens the stream
+//! and pre-rolls a little silence so the sink resumes before the sound.
+//! `Command::Warm` does just that ahead of a likely sound. A sink that starts
+//! closed is opened the same way, and a stream that fails is closed until
+//! the next command.
+
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::sync::mpsc::{self, Receiver, Sender, TryRecvError};
+use std::sync::Arc;
+use std::thread;
+use std::time::{Duration, Instant};
+
+use crate::mixer::{Command, Mixer};
+use crate::output::Sink;
+
+/// Frames per block (~5.3ms at 48kHz)
+pub const BLOCK_FRAMES: usize = 256;
+/// How far ahead of real time we may render
+const LEAD_BLOCKS: u64 = 2;
+/// Silent blocks written after reopening the stream (~10ms at 48kHz)
+const PREROLL_BLOCKS: u32 = 2;
+
+/// State shared with the control side
+#[derive(Default)]
+pub struct EngineStats {
+    pub active_voices: AtomicUsize,
+    pub blocks: AtomicUsize,
+    pub running: AtomicBool,
+    /// Stream open (false while suspended for idle)
+    pub streaming: AtomicBool,
+}
+
+pub struct Engine {
+    commands: Option<Sender<Command>>,
+    pub stats: Arc<EngineStats>,
+    pub rate: u32,
+    pub sink_name: &'static str,
+    thread: Option<thread::JoinHandle<()>>,
+}
+
+impl Engine {
+    /// Start the audio thread. `idle` is how long to keep the stream open
+    /// without sound; None keeps it open for good.
+    pub fn start(sink: Sink, rate: u32, max_voices: usize, master_gain: f32, idle: Option<Duration>) -> Self {
+        let (tx, rx) = mpsc::channel();
+        let stats = Arc::new(EngineStats::default());
+        stats.running.store(true, Ordering::SeqCst);
+        stats.streaming.store(sink.is_open(), Ordering::SeqCst);
+        let sink_name = sink.name();
+
+        let thread_stats = stats.clone();
+        let thread = thread::Builder::new()
+            .name("audio".into())
+            .spawn(move || {
+                let mixer = Mixer::new(max_voices, master_gain);
+                audio_loop(sink, mixer, rx, rate, idle, &thread_stats);
+                thread_stats.running.store(false, Ordering::SeqCst);
+            })
+            .expect("spawn audio thread");
+
+        Self { commands: Some(tx), stats, rate, sink_name, thread: Some(thread) }
+    }
+
+    pub fn send(&self, command: Command) -> bool {
+        self.commands.as_ref().is_some_and(|tx| tx.send(command).is_ok())
+    }
+
+    pub fn is_running(&self) -> bool {
+        self.stats.running.load(Ordering::SeqCst)
+    }
+}
+
+impl Drop for Engine {
+    fn drop(&mut self) {
+        // Closing the channel ends the loop once it next drains commands
+        self.commands.take();
+        if let Some(t) = self.thread.take() {
+            let _ = t.join();
+        }
+    }
+}
+
+fn audio_loop(mut sink: Sink, mut mixer: Mixer, rx: Receiver<Command>, rate: u32,
+              idle: Option<Duration>, stats: &EngineStats) {
+    let mut block = [0i16; BLOCK_FRAMES];
+    let block_time = Duration::from_secs_f64(BLOCK_FRAMES as f64 / rate as f64);
+    let mut clock = Instant::now();
+    let mut rendered: u64 = 0;
+    let mut last_activity = Instant::now();
+    let mut preroll = 0;
+    let mut open = sink.is_open();
+
+    loop {
+        let mut woken = false;
+        loop {
+            match rx.try_recv() {
+                Ok(cmd) => {
+                    mixer.handle(cmd);
+                    last_activity = Instant::now();
+                    woken = true;
+                }
+                Err(TryRecvError::Empty) => break,
+                Err(TryRecvError::Disconnected) => return,
+            }
+        }
+
+        if open && idle.is_some_and(|idle| mixer.active_voices() == 0 && last_activity.elapsed() >= idle) {
+            sink.suspend();
+            open = false;
+            stats.streaming.store(false, Ordering::Relaxed);
+        }
+        if !open {
+            // Nothing to do until the next command
+            if !woken {
+                match rx.recv() {
+                    Ok(cmd) => mixer.handle(cmd),
+                    Err(_) => return,
+                }
+            }
+            if let Err(e) = sink.resume() {
+                eprintln!("Audio engine: cannot open output stream: {}", e);
+                mixer.handle(Command::StopAll);
+                continue;
+            }
+            open = true;
+            stats.streaming.store(true, Ordering::Relaxed);
+            last_activity = Instant::now();
+            clock = Instant::now();
+            rendered = 0;
+            preroll = PREROLL_BLOCKS;
+        }
+
+        // Stay at most LEAD_BLOCKS ahead of the wall clock
+        let due = block_time.mul_f64(rendered.saturating_sub(LEAD_BLOCKS) as f64);
+        let elapsed = clock.elapsed();
+        if due > elapsed {
+            thread::sleep(due - elapsed);
+        } else if elapsed > due + block_time * 8 {
+            // Fell far behind (suspend, stalled server) - restart the clock
+            // rather than rendering a burst to catch up
+            clock = Instant::now();
+            rendered = 0;
+        }
+
+        if preroll > 0 {
+            block.fill(0);
+            preroll -= 1;
+        } else {
+            mixer.render(&mut block);
+            if mixer.active_voices() > 0 {
+                last_activity = Instant::now();
+            }
+        }
+        rendered += 1;
+        stats.active_voices.store(mixer.active_voices(), Ordering::Relaxed);
+        stats.blocks.fetch_add(1, Ordering::Relaxed);
+
+        if let Err(e) = sink.write(&block) {
+            eprintln!("Audio engine: output stream failed: {}", e);
+            sink.suspend();
+            open = false;
+            stats.streaming.store(false, Ordering::Relaxed);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::synth::{tone, Sample, Waveform};
+
+    #[test]
+    fn test_null_sink_plays_and_drains_voices() {
+        let engine = Engine::start(Sink::Null, 48000, 8, 0.8, None);
+        let sample = Sample::new(tone(440.0, Waveform::Sine, 20, 48000));
+        for _ in 0..3 {
+            assert!(engine.send(Command::Play { sample: sample.clone(), gain: 0.5 }));
+        }
+
+        // 20ms of audio is gone well within 200ms of paced rendering
+        thread::sleep(Duration::from_millis(200));
+        assert!(engine.is_running());
+        assert!(engine.stats.blocks.load(Ordering::Relaxed) > 10);
+        assert_eq!(engine.stats.active_voices.load(Ordering::Relaxed), 0);
+    }
+
+    #[test]
+    fn test_idle_suspends_and_warm_resumes() {
+        let engine = Engine::start(Sink::Null, 48000, 8, 0.8, Some(Duration::from_millis(50)));
+        thread::sleep(Duration::from_millis(150));
+        assert!(!engine.stats.streaming.load(Ordering::Relaxed));
+
+        // No blocks are rendered while suspended
+        let blocks = engine.stats.blocks.load(Ordering::Relaxed);
+        thread::sleep(Duration::from_millis(50));
+        assert_eq!(engine.stats.blocks.load(Ordering::Relaxed), blocks);
+
+        assert!(engine.send(Command::Warm));
+        thread::sleep(Duration::from_millis(20));
+        assert!(engine.stats.streaming.load(Ordering::Relaxed));
+        assert!(engine.stats.blocks.load(Ordering::Relaxed) > blocks);
+    }
+
+    #[test]
+    fn test_closed_stream_opens_on_first_command() {
+        let sink = Sink::stream(|| vec![std::process::Command::new("/nonexistent/player"), std::process::Command::new("cat")]);
+        let engine = Engine::start(sink, 48000, 8, 0.8, Some(Duration::from_millis(500)));
+        thread::sleep(Duration::from_millis(20));
+        assert!(!engine.stats.streaming.load(Ordering::Relaxed));
+        assert_eq!(engine.stats.blocks.load(Ordering::Relaxed), 0);
+
+        // The first player fails to start, the second takes the stream
+        assert!(engine.send(Command::Warm));
+        thread::sleep(Duration::from_millis(50));
+        assert!(engine.stats.streaming.load(Ordering::Relaxed));
+        assert!(engine.stats.blocks.load(Ordering::Relaxed) > 0);
+    }
+}
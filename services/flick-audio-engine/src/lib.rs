@@ -0,0 +1,10 @@
+//! Flick audio engine: sample decoding, the voice mixer and the paced
+//! playback thread
+//!
+//! The flick-audio-engine service (main.rs) serves these to QML apps over
+//! HTTP; the shell links them for its own system sounds.
+
+pub mod engine;
+pub mod mixer;
+pub mod output;
+pub mod synth;
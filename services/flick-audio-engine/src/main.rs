@@ -0,0 +1,141 @@
+//! Flick audio engine - low-latency sound playback for QML apps
+//!
+//! QtMultimedia's Audio element opens, decodes and sets up a pipeline on every
+//! play(), which costs 100ms+ of jittery latency per tap. This service keeps one
+//! playback stream open, holds all sounds pre-decoded in memory, and mixes
+//! voices in a real-time audio thread. Apps trigger sounds over localhost HTTP
+//! (see server.rs and lib/FlickBackend/AudioEngine.qml).
+//!
+//! Usage: flick-audio-engine [--port N] [--samples DIR] [--sink stream|null]
+//!                           [--device NAME] [--rate HZ] [--latency-ms MS]
+//!                           [--voices N] [--idle-ms MS]
+
+mod server;
+
+use flick_audio_engine::{engine, mixer, output, synth};
+
+use std::collections::HashMap;
+use std::path::Path;
+use std::sync::Arc;
+use std::time::Duration;
+
+use engine::Engine;
+use output::Sink;
+use server::Server;
+use synth::Sample;
+
+const DEFAULT_PORT: u16 = 7655;
+const DEFAULT_RATE: u32 = 48000;
+const DEFAULT_LATENCY_MS: u32 = 10;
+const DEFAULT_VOICES: usize = 16;
+/// Close the stream after this long without sound so the sink can suspend
+/// (0 keeps it open)
+const DEFAULT_IDLE_MS: u64 = 3000;
+/// Headroom so a handful of simultaneous full-scale voices don't hard-clip
+const MASTER_GAIN: f32 = 0.5;
+
+struct Options {
+    port: u16,
+    samples_dir: Option<String>,
+    null_sink: bool,
+    device: Option<String>,
+    rate: u32,
+    latency_ms: u32,
+    voices: usize,
+    idle_ms: u64,
+}
+
+fn parse_args() -> Result<Options, String> {
+    let mut opts = Options {
+        port: DEFAULT_PORT,
+        samples_dir: None,
+        null_sink: false,
+        device: None,
+        rate: DEFAULT_RATE,
+        latency_ms: DEFAULT_LATENCY_MS,
+        voices: DEFAULT_VOICES,
+        idle_ms: DEFAULT_IDLE_MS,
+    };
+
+    let mut args = std::env::args().skip(1);
+    while let Some(arg) = args.next() {
+        let mut value = |name: &str| args.next().ok_or(format!("{} needs a value", name));
+        match arg.as_str() {
+            "--port" => opts.port = value("--port")?.parse().map_err(|_| "bad --port")?,
+            "--samples" => opts.samples_dir = Some(value("--samples")?),
+            "--sink" => match value("--sink")?.as_str() {
+                "null" => opts.null_sink = true,
+                "stream" => opts.null_sink = false,
+                other => return Err(format!("unknown sink '{}'", other)),
+            },
+            "--device" => opts.device = Some(value("--device")?),
+            "--rate" => opts.rate = value("--rate")?.parse().map_err(|_| "bad --rate")?,
+            "--latency-ms" => opts.latency_ms = value("--latency-ms")?.parse().map_err(|_| "bad --latency-ms")?,
+            "--voices" => opts.voices = value("--voices")?.parse().map_err(|_| "bad --voices")?,
+            "--idle-ms" => opts.idle_ms = value("--idle-ms")?.parse().map_err(|_| "bad --idle-ms")?,
+            other => return Err(format!("unknown argument '{}'", other)),
+        }
+    }
+    Ok(opts)
+}
+
+/// Pre-decode every .wav in `dir`, keyed by file stem
+fn load_samples(dir: &Path, rate: u32) -> HashMap<String, Arc<Sample>> {
+    let mut samples = HashMap::new();
+    let entries = match std::fs::read_dir(dir) {
+        Ok(e) => e,
+        Err(e) => {
+            eprintln!("Audio engine: cannot read samples dir {:?}: {}", dir, e);
+            return samples;
+        }
+    };
+
+    for entry in entries.flatten() {
+        let path = entry.path();
+        if path.extension().and_then(|e| e.to_str()) != Some("wav") {
+            continue;
+        }
+        let Some(name) = path.file_stem().and_then(|s| s.to_str()) else { continue };
+        match std::fs::read(&path).map_err(|e| e.to_string()).and_then(|b| synth::decode_wav(&b, rate)) {
+            Ok(frames) => {
+                samples.insert(name.to_string(), Sample::new(frames));
+            }
+            Err(e) => eprintln!("Audio engine: skipping {:?}: {}", path, e),
+        }
+    }
+    println!("Audio engine: loaded {} samples from {:?}", samples.len(), dir);
+    samples
+}
+
+fn main() {
+    let opts = match parse_args() {
+        Ok(o) => o,
+        Err(e) => {
+            eprintln!("flick-audio-engine: {}", e);
+            std::process::exit(2);
+        }
+    };
+
+    let samples = opts.samples_dir.as_deref()
+        .map(|d| load_samples(Path::new(d), opts.rate))
+        .unwrap_or_default();
+
+    let sink = if opts.null_sink {
+        Sink::Null
+    } else {
+        match Sink::open(opts.rate, opts.latency_ms, opts.device.as_deref()) {
+            Ok(s) => s,
+            Err(e) => {
+                eprintln!("Audio engine: no playback stream ({}), exiting", e);
+                std::process::exit(1);
+            }
+        }
+    };
+
+    let idle = (opts.idle_ms > 0).then(|| Duration::from_millis(opts.idle_ms));
+    let engine = Engine::start(sink, opts.rate, opts.voices, MASTER_GAIN, idle);
+    if let Err(e) = Server::new(engine, samples).run(opts.port) {
+        eprintln!("Audio engine: {}", e);
+        std::process::exit(1);
+    }
+}
@@ -0,0 +1,187 @@
+//! Real-time voice mixer
+//!
+//! `Mixer::render` is the audio callback: it runs on the audio thread for
+//! every block, so it never allocates, locks or does I/O. New voices arrive
+//! as `Command`s that the audio thread drains between blocks.
+
+use std::sync::Arc;
+
+use crate::synth::Sample;
+
+/// Requests from the control side to the audio thread
+pub enum Command {
+    Play { sample: Arc<Sample>, gain: f32 },
+    /// Play until `StopLooping` (a ringtone)
+    Loop { sample: Arc<Sample>, gain: f32 },
+    StopAll,
+    /// End looping voices, letting the others finish
+    StopLooping,
+    /// Open the stream ahead of a likely sound (no voice)
+    Warm,
+}
+
+struct Voice {
+    sample: Arc<Sample>,
+    pos: usize,
+    gain: f32,
+    looping: bool,
+}
+
+pub struct Mixer {
+    voices: Vec<Voice>,
+    max_voices: usize,
+    master_gain: f32,
+}
+
+impl Mixer {
+    pub fn new(max_voices: usize, master_gain: f32) -> Self {
+        Self {
+            // Reserve up front so starting a voice never reallocates on the audio thread
+            voices: Vec::with_capacity(max_voices),
+            max_voices: max_voices.max(1),
+            master_gain,
+        }
+    }
+
+    pub fn active_voices(&self) -> usize {
+        self.voices.len()
+    }
+
+    pub fn handle(&mut self, command: Command) {
+        match command {
+            Command::Play { sample, gain } => self.start(sample, gain, false),
+            Command::Loop { sample, gain } => self.start(sample, gain, true),
+            Command::StopAll => self.voices.clear(),
+            Command::StopLooping => self.voices.retain(|v| !v.looping),
+            Command::Warm => {}
+        }
+    }
+
+    /// Start a voice, stealing the one-shot closest to finishing if all are
+    /// busy (looping voices are never stolen)
+    fn start(&mut self, sample: Arc<Sample>, gain: f32, looping: bool) {
+        if sample.frames.is_empty() {
+            return;
+        }
+        let voice = Voice { sample, pos: 0, gain: gain.clamp(0.0, 1.0), looping };
+        if self.voices.len() < self.max_voices {
+            self.voices.push(voice);
+            return;
+        }
+        let steal = self
+            .voices
+            .iter()
+            .enumerate()
+            .filter(|(_, v)| !v.looping)
+            .min_by_key(|(_, v)| v.sample.frames.len() - v.pos)
+            .map(|(i, _)| i);
+        if let Some(steal) = steal {
+            self.voices[steal] = voice;
+        }
+    }
+
+    /// Mix all active voices into `out` (mono, s16), wrapping looping ones
+    pub fn render(&mut self, out: &mut [i16]) {
+        let master = self.master_gain * 32767.0;
+
+        for (i, sample_out) in out.iter_mut().enumerate() {
+            let mut acc = 0.0f32;
+            for v in &self.voices {
+                let frames = &v.sample.frames;
+                if let Some(s) = frames.get(v.pos + i) {
+                    acc += s * v.gain;
+                } else if v.looping {
+                    acc += frames[(v.pos + i) % frames.len()] * v.gain;
+                }
+            }
+            *sample_out = (acc * master).clamp(-32768.0, 32767.0) as i16;
+        }
+
+        let len = out.len();
+        for v in &mut self.voices {
+            v.pos += len;
+            if v.looping {
+                v.pos %= v.sample.frames.len();
+            }
+        }
+        self.voices.retain(|v| v.pos < v.sample.frames.len());
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn constant(value: f32, len: usize) -> Arc<Sample> {
+        Sample::new(vec![value; len])
+    }
+
+    #[test]
+    fn test_voices_mix_and_finish() {
+        let mut mixer = Mixer::new(4, 1.0);
+        mixer.handle(Command::Play { sample: constant(0.25, 6), gain: 1.0 });
+        mixer.handle(Command::Play { sample: constant(0.25, 3), gain: 0.5 });
+
+        let mut block = [0i16; 4];
+        mixer.render(&mut block);
+        // 0.25 + 0.125 for the first three frames, then only the longer voice
+        assert_eq!(block[0], (0.375f32 * 32767.0) as i16);
+        assert_eq!(block[3], (0.25f32 * 32767.0) as i16);
+        assert_eq!(mixer.active_voices(), 1);
+
+        mixer.render(&mut block);
+        assert_eq!(block[2], 0);
+        assert_eq!(mixer.active_voices(), 0);
+    }
+
+    #[test]
+    fn test_voice_stealing_keeps_polyphony_bounded() {
+        let mut mixer = Mixer::new(2, 1.0);
+        mixer.handle(Command::Play { sample: constant(0.1, 100), gain: 1.0 });
+        mixer.handle(Command::Play { sample: constant(0.1, 10), gain: 1.0 });
+        mixer.handle(Command::Play { sample: constant(0.1, 50), gain: 1.0 });
+        assert_eq!(mixer.active_voices(), 2);
+
+        // The 10-frame voice was stolen, so both survivors outlast 10 frames
+        let mut block = [0i16; 20];
+        mixer.render(&mut block);
+        assert_eq!(mixer.active_voices(), 2);
+
+        mixer.handle(Command::StopAll);
+        assert_eq!(mixer.active_voices(), 0);
+    }
+
+    #[test]
+    fn test_looping_voice_wraps_until_stopped() {
+        let mut mixer = Mixer::new(2, 1.0);
+        mixer.handle(Command::Loop { sample: constant(0.5, 3), gain: 1.0 });
+        mixer.handle(Command::Play { sample: constant(0.25, 3), gain: 1.0 });
+
+        let mut block = [0i16; 4];
+        mixer.render(&mut block);
+        assert_eq!(block[0], (0.75f32 * 32767.0) as i16);
+        // The one-shot ended, the loop wrapped around
+        assert_eq!(block[3], (0.5f32 * 32767.0) as i16);
+        assert_eq!(mixer.active_voices(), 1);
+
+        // A full mixer steals one-shots only
+        mixer.handle(Command::Loop { sample: constant(0.1, 3), gain: 1.0 });
+        mixer.handle(Command::Play { sample: constant(0.1, 3), gain: 1.0 });
+        assert_eq!(mixer.active_voices(), 2);
+
+        mixer.render(&mut block);
+        mixer.handle(Command::StopLooping);
+        assert_eq!(mixer.active_voices(), 0);
+    }
+
+    #[test]
+    fn test_output_clips_instead_of_wrapping() {
+        let mut mixer = Mixer::new(8, 1.0);
+        for _ in 0..4 {
+            mixer.handle(Command::Play { sample: constant(-0.9, 4), gain: 1.0 });
+        }
+        let mut block = [0i16; 4];
+        mixer.render(&mut block);
+        assert!(block.iter().all(|&s| s == -32768));
+    }
+}
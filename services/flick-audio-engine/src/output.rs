@@ -0,0 +1,158 @@
+//! Audio output: one long-lived playback stream
+//!
+//! Rather than linking libpulse we keep a single `pacat` (PulseAudio, or
+//! pipewire-pulse) or `pw-cat` child open and feed it raw s16le. The stream is
+//! created at startup, so playing a sound is just mixing into the next block.
+//! While nothing plays the engine suspends the stream (closes the child) so
+//! the sound server can suspend the sink; see engine.rs. Other users (the
+//! shell's system sounds) pass their own playback commands to
+//! `Sink::stream`. The null sink discards blocks and exists for testing.
+
+use std::io::{self, Write};
+use std::os::fd::AsRawFd;
+use std::process::{Child, ChildStdin, Command, Stdio};
+
+/// Where mixed blocks go
+pub enum Sink {
+    Stream { commands: PlaybackCommands, pipe: Option<Pipe>, bytes: Vec<u8> },
+    Null,
+}
+
+/// Builds the playback children to try, in order, each time the stream opens.
+/// Each reads raw mono s16le at the engine rate on stdin.
+pub type PlaybackCommands = Box<dyn Fn() -> Vec<Command> + Send>;
+
+/// Parameters of the engine's own pacat/pw-cat stream
+struct StreamConfig {
+    rate: u32,
+    latency_ms: u32,
+    device: Option<String>,
+}
+
+/// Running playback child and the pipe feeding it
+pub struct Pipe {
+    child: Child,
+    stdin: ChildStdin,
+}
+
+unsafe extern "C" {
+    fn fcntl(fd: i32, cmd: i32, ...) -> i32;
+}
+/// Linux F_SETPIPE_SZ
+const F_SETPIPE_SZ: i32 = 1031;
+/// Smallest pipe the kernel allows (one page). The default 64 KiB would let
+/// ~0.7s of audio queue up ahead of the server.
+const PIPE_SIZE: i32 = 4096;
+
+impl Sink {
+    /// Open the playback stream, trying pacat then pw-cat
+    pub fn open(rate: u32, latency_ms: u32, device: Option<&str>) -> io::Result<Self> {
+        let config = StreamConfig { rate, latency_ms, device: device.map(str::to_string) };
+        let (pipe, program) = spawn(config.commands())?;
+        println!("Audio engine: streaming via {} ({} Hz, {} ms)", program, rate, latency_ms);
+        Ok(Sink::Stream { commands: Box::new(move || config.commands()), pipe: Some(pipe), bytes: Vec::new() })
+    }
+
+    /// A stream fed to the first of `commands()` that starts, opened by the
+    /// engine when the first sound plays
+    pub fn stream(commands: impl Fn() -> Vec<Command> + Send + 'static) -> Self {
+        Sink::Stream { commands: Box::new(commands), pipe: None, bytes: Vec::new() }
+    }
+
+    /// Whether blocks can be written without `resume` first
+    pub fn is_open(&self) -> bool {
+        !matches!(self, Sink::Stream { pipe: None, .. })
+    }
+
+    pub fn name(&self) -> &'static str {
+        match self {
+            Sink::Stream { .. } => "stream",
+            Sink::Null => "null",
+        }
+    }
+
+    /// Close the stream so the server can suspend the sink when idle
+    pub fn suspend(&mut self) {
+        if let Sink::Stream { pipe, .. } = self {
+            pipe.take();
+        }
+    }
+
+    /// Reopen a suspended stream
+    pub fn resume(&mut self) -> io::Result<()> {
+        if let Sink::Stream { commands, pipe: pipe @ None, .. } = self {
+            *pipe = Some(spawn(commands())?.0);
+        }
+        Ok(())
+    }
+
+    /// Write one block. Blocks when the stream's buffer is full.
+    pub fn write(&mut self, block: &[i16]) -> io::Result<()> {
+        match self {
+            Sink::Stream { pipe: Some(pipe), bytes, .. } => {
+                // Capacity is kept between blocks, so this only allocates once
+                bytes.clear();
+                bytes.extend(block.iter().flat_map(|s| s.to_le_bytes()));
+                pipe.stdin.write_all(bytes)
+            }
+            Sink::Stream { pipe: None, .. } => Err(io::ErrorKind::NotConnected.into()),
+            Sink::Null => Ok(()),
+        }
+    }
+}
+
+impl StreamConfig {
+    /// pacat, then pw-cat
+    fn commands(&self) -> Vec<Command> {
+        let rate_arg = self.rate.to_string();
+        let latency_arg = self.latency_ms.to_string();
+
+        let mut pacat = Command::new("pacat");
+        pacat.args(["--playback", "--raw", "--format=s16le", "--channels=1"])
+            .arg(format!("--rate={}", rate_arg))
+            .arg(format!("--latency-msec={}", latency_arg))
+            .args(["--client-name=flick-audio-engine", "--stream-name=Flick sounds"]);
+        if let Some(dev) = &self.device {
+            pacat.arg(format!("--device={}", dev));
+        }
+
+        let mut pwcat = Command::new("pw-cat");
+        pwcat.args(["--playback", "--format", "s16", "--channels", "1"])
+            .args(["--rate", &rate_arg])
+            .args(["--latency", &format!("{}ms", latency_arg)]);
+        if let Some(dev) = &self.device {
+            pwcat.args(["--target", dev]);
+        }
+        pwcat.arg("-");
+        vec![pacat, pwcat]
+    }
+}
+
+/// Start the first playback child that runs, returning it with its name
+fn spawn(commands: Vec<Command>) -> io::Result<(Pipe, String)> {
+    let mut last_err = io::Error::new(io::ErrorKind::NotFound, "no playback tool");
+    for mut cmd in commands {
+        let program = cmd.get_program().to_string_lossy().into_owned();
+        match cmd.stdin(Stdio::piped()).stdout(Stdio::null()).spawn() {
+            Ok(mut child) => {
+                let stdin = child.stdin.take().expect("piped stdin");
+                unsafe {
+                    fcntl(stdin.as_raw_fd(), F_SETPIPE_SZ, PIPE_SIZE);
+                }
+                return Ok((Pipe { child, stdin }, program));
+            }
+            Err(e) => {
+                eprintln!("Audio engine: {} unavailable: {}", program, e);
+                last_err = e;
+            }
+        }
+    }
+    Err(last_err)
+}
+
+impl Drop for Pipe {
+    fn drop(&mut self) {
+        let _ = self.child.kill();
+        let _ = self.child.wait();
+    }
+}
@@ -0,0 +1,235 @@
+//! Localhost HTTP control interface
+//!
+//! QML apps can't open sockets without a plugin, but XMLHttpRequest to
+//! localhost works everywhere (same approach as the Store's install server).
+//! Requests are tiny GETs, so this is a minimal blocking HTTP/1.1 handler.
+//!
+//!   GET /tone?freq=400&wave=sine&gain=0.5&ms=150   synthesized tone
+//!   GET /play?sample=beep_400_0&gain=0.5           pre-decoded sample
+//!   GET /stop                                      silence all voices
+//!   GET /warm                                      reopen the stream ahead of a sound
+//!   GET /status                                    JSON engine state
+
+use std::collections::HashMap;
+use std::io::{BufRead, BufReader, Write};
+use std::net::{TcpListener, TcpStream};
+use std::sync::atomic::Ordering;
+use std::sync::Arc;
+use std::time::Duration;
+
+use crate::engine::Engine;
+use crate::mixer::Command;
+use crate::synth::{self, Sample, Waveform};
+
+/// Default tone length, matching the old generated beeps
+const DEFAULT_TONE_MS: u32 = 150;
+/// Bound the tone cache; a UI only ever uses a handful of distinct tones
+const MAX_CACHED_TONES: usize = 256;
+
+pub struct Server {
+    engine: Engine,
+    samples: HashMap<String, Arc<Sample>>,
+    /// Synthesized tones keyed by (freq in Hz, waveform, duration)
+    tones: HashMap<(u32, Waveform, u32), Arc<Sample>>,
+}
+
+impl Server {
+    pub fn new(engine: Engine, samples: HashMap<String, Arc<Sample>>) -> Self {
+        Self { engine, samples, tones: HashMap::new() }
+    }
+
+    pub fn run(mut self, port: u16) -> std::io::Result<()> {
+        let listener = TcpListener::bind(("127.0.0.1", port))?;
+        println!("Audio engine: listening on 127.0.0.1:{}", port);
+
+        for stream in listener.incoming() {
+            match stream {
+                Ok(s) => {
+                    let _ = s.set_nodelay(true);
+                    // One connection at a time, so never let a stuck client hold the loop
+                    let _ = s.set_read_timeout(Some(Duration::from_millis(500)));
+                    self.handle_connection(s);
+                }
+                Err(e) => eprintln!("Audio engine: accept failed: {}", e),
+            }
+            if !self.engine.is_running() {
+                return Err(std::io::Error::other("audio thread stopped"));
+            }
+        }
+        Ok(())
+    }
+
+    fn handle_connection(&mut self, stream: TcpStream) {
+        let mut reader = BufReader::new(&stream);
+        let mut request_line = String::new();
+        if reader.read_line(&mut request_line).is_err() {
+            return;
+        }
+        // Drain headers; we never need them
+        let mut line = String::new();
+        while reader.read_line(&mut line).map(|n| n > 2).unwrap_or(false) {
+            line.clear();
+        }
+
+        let mut parts = request_line.split_whitespace();
+        let method = parts.next().unwrap_or("");
+        let target = parts.next().unwrap_or("/");
+
+        let (status, body) = if method == "OPTIONS" {
+            (204, String::new())
+        } else {
+            let (path, query) = target.split_once('?').unwrap_or((target, ""));
+            self.dispatch(path, &parse_query(query))
+        };
+        respond(&stream, status, &body);
+    }
+
+    fn dispatch(&mut self, path: &str, params: &HashMap<String, String>) -> (u16, String) {
+        let gain = params.get("gain").and_then(|g| g.parse::<f32>().ok()).unwrap_or(1.0);
+
+        match path {
+            "/tone" => {
+                let freq = match params.get("freq").and_then(|f| f.parse::<f32>().ok()) {
+                    Some(f) if f > 0.0 && f < 20000.0 => f,
+                    _ => return (400, "bad freq".into()),
+                };
+                let wave = match Waveform::parse(params.get("wave").map(String::as_str).unwrap_or("0")) {
+                    Some(w) => w,
+                    None => return (400, "bad wave".into()),
+                };
+                let ms = params.get("ms").and_then(|m| m.parse::<u32>().ok())
+                    .unwrap_or(DEFAULT_TONE_MS)
+                    .clamp(1, 5000);
+                let sample = self.tone(freq, wave, ms);
+                self.play(sample, gain)
+            }
+            "/play" => match params.get("sample").and_then(|name| self.samples.get(name)) {
+                Some(sample) => {
+                    let sample = sample.clone();
+                    self.play(sample, gain)
+                }
+                None => (404, "unknown sample".into()),
+            },
+            "/stop" => {
+                self.engine.send(Command::StopAll);
+                (200, "ok".into())
+            }
+            "/warm" => {
+                self.engine.send(Command::Warm);
+                (200, "ok".into())
+            }
+            "/status" => (200, self.status_json()),
+            _ => (404, "not found".into()),
+        }
+    }
+
+    fn play(&self, sample: Arc<Sample>, gain: f32) -> (u16, String) {
+        if self.engine.send(Command::Play { sample, gain }) {
+            (200, "ok".into())
+        } else {
+            (503, "audio thread stopped".into())
+        }
+    }
+
+    /// Synthesize on first use, then reuse; keeps synthesis off the audio thread
+    fn tone(&mut self, freq: f32, wave: Waveform, ms: u32) -> Arc<Sample> {
+        let key = (freq.round() as u32, wave, ms);
+        if let Some(s) = self.tones.get(&key) {
+            return s.clone();
+        }
+        if self.tones.len() >= MAX_CACHED_TONES {
+            self.tones.clear();
+        }
+        let sample = Sample::new(synth::tone(key.0 as f32, wave, ms, self.engine.rate));
+        self.tones.insert(key, sample.clone());
+        sample
+    }
+
+    fn status_json(&self) -> String {
+        let mut names: Vec<&String> = self.samples.keys().collect();
+        names.sort();
+        let names: Vec<String> = names.iter().map(|n| format!("\"{}\"", n.replace('"', ""))).collect();
+        format!(
+            "{{\"sink\":\"{}\",\"rate\":{},\"streaming\":{},\"active_voices\":{},\"blocks\":{},\"samples\":[{}]}}",
+            self.engine.sink_name,
+            self.engine.rate,
+            self.engine.stats.streaming.load(Ordering::Relaxed),
+            self.engine.stats.active_voices.load(Ordering::Relaxed),
+            self.engine.stats.blocks.load(Ordering::Relaxed),
+            names.join(",")
+        )
+    }
+}
+
+fn respond(mut stream: &TcpStream, status: u16, body: &str) {
+    let reason = match status {
+        200 => "OK",
+        204 => "No Content",
+        400 => "Bad Request",
+        404 => "Not Found",
+        _ => "Service Unavailable",
+    };
+    // CORS headers so QML (file:// origin) XMLHttpRequest accepts the reply
+    let response = format!(
+        "HTTP/1.1 {} {}\r\n\
+         Access-Control-Allow-Origin: *\r\n\
+         Access-Control-Allow-Methods: GET, OPTIONS\r\n\
+         Content-Type: text/plain\r\n\
+         Content-Length: {}\r\n\
+         Connection: close\r\n\r\n{}",
+        status, reason, body.len(), body
+    );
+    let _ = stream.write_all(response.as_bytes());
+}
+
+/// Parse `a=1&b=two` (with %XX and + decoding)
+fn parse_query(query: &str) -> HashMap<String, String> {
+    query
+        .split('&')
+        .filter(|kv| !kv.is_empty())
+        .map(|kv| {
+            let (k, v) = kv.split_once('=').unwrap_or((kv, ""));
+            (percent_decode(k), percent_decode(v))
+        })
+        .collect()
+}
+
+fn percent_decode(s: &str) -> String {
+    let bytes = s.as_bytes();
+    let mut out = Vec::with_capacity(bytes.len());
+    let mut i = 0;
+    while i < bytes.len() {
+        match bytes[i] {
+            b'+' => out.push(b' '),
+            b'%' if i + 2 < bytes.len() => {
+                let hex = std::str::from_utf8(&bytes[i + 1..i + 3]).ok()
+                    .and_then(|h| u8::from_str_radix(h, 16).ok());
+                match hex {
+                    Some(b) => {
+                        out.push(b);
+                        i += 2;
+                    }
+                    None => out.push(b'%'),
+                }
+            }
+            b => out.push(b),
+        }
+        i += 1;
+    }
+    String::from_utf8_lossy(&out).into_owned()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_query() {
+        let q = parse_query("freq=400&wave=sine&name=a%20b+c&flag");
+        assert_eq!(q["freq"], "400");
+        assert_eq!(q["wave"], "sine");
+        assert_eq!(q["name"], "a b c");
+        assert_eq!(q["flag"], "");
+        assert_eq!(percent_decode("100%"), "100%");
+    }
+}
@@ -0,0 +1,221 @@
+//! Sample sources: tone synthesis and WAV decoding
+//!
+//! Everything is converted once, up front, into mono f32 at the engine rate
+//! so the mixer callback only ever adds floats.
+
+use std::sync::Arc;
+
+/// A decoded, ready-to-mix sound (mono f32 at the engine sample rate)
+#[derive(Debug)]
+pub struct Sample {
+    pub frames: Vec<f32>,
+}
+
+impl Sample {
+    pub fn new(frames: Vec<f32>) -> Arc<Self> {
+        Arc::new(Self { frames })
+    }
+}
+
+/// Waveforms, numbered to match the old beep_<freq>_<wave>.wav files
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum Waveform {
+    Sine,
+    Square,
+    Triangle,
+    Sawtooth,
+}
+
+impl Waveform {
+    /// Accepts either the numeric index (0-3) or the name
+    pub fn parse(s: &str) -> Option<Self> {
+        match s {
+            "0" | "sine" => Some(Self::Sine),
+            "1" | "square" => Some(Self::Square),
+            "2" | "triangle" => Some(Self::Triangle),
+            "3" | "sawtooth" | "saw" => Some(Self::Sawtooth),
+            _ => None,
+        }
+    }
+
+    /// Value at `phase` (0..1), range -1..1
+    fn at(self, phase: f32) -> f32 {
+        match self {
+            Self::Sine => (phase * std::f32::consts::TAU).sin(),
+            Self::Square => if phase < 0.5 { 1.0 } else { -1.0 },
+            Self::Triangle => 1.0 - 4.0 * (phase - 0.5).abs(),
+            Self::Sawtooth => 2.0 * phase - 1.0,
+        }
+    }
+
+    /// Harsher waveforms are attenuated so all four sound about equally loud
+    fn level(self) -> f32 {
+        match self {
+            Self::Sine | Self::Triangle => 1.0,
+            Self::Square => 0.5,
+            Self::Sawtooth => 0.6,
+        }
+    }
+}
+
+/// Fade length at each end of a synthesized tone (avoids clicks)
+const FADE_MS: u32 = 10;
+
+/// Synthesize a tone with short linear fades at both ends
+pub fn tone(freq: f32, wave: Waveform, duration_ms: u32, rate: u32) -> Vec<f32> {
+    let len = (rate as u64 * duration_ms as u64 / 1000) as usize;
+    let fade = ((rate * FADE_MS / 1000) as usize).min(len / 2).max(1);
+    let step = freq / rate as f32;
+    let level = wave.level();
+    let mut phase = 0.0f32;
+
+    (0..len)
+        .map(|i| {
+            let envelope = if i < fade {
+                i as f32 / fade as f32
+            } else if i >= len - fade {
+                (len - i) as f32 / fade as f32
+            } else {
+                1.0
+            };
+            let v = wave.at(phase) * level * envelope;
+            phase = (phase + step).fract();
+            v
+        })
+        .collect()
+}
+
+/// Decode a PCM WAV (8/16-bit, any channel count) to mono f32 at `rate`
+pub fn decode_wav(bytes: &[u8], rate: u32) -> Result<Vec<f32>, String> {
+    if bytes.len() < 12 || &bytes[0..4] != b"RIFF" || &bytes[8..12] != b"WAVE" {
+        return Err("not a RIFF/WAVE file".into());
+    }
+
+    let u16_at = |off: usize| u16::from_le_bytes([bytes[off], bytes[off + 1]]);
+    let u32_at = |off: usize| u32::from_le_bytes(bytes[off..off + 4].try_into().unwrap());
+
+    let mut format: Option<(u16, u16, u32, u16)> = None; // (tag, channels, rate, bits)
+    let mut data: Option<&[u8]> = None;
+    let mut off = 12;
+    while off + 8 <= bytes.len() {
+        let id = &bytes[off..off + 4];
+        let size = u32_at(off + 4) as usize;
+        let body = off + 8;
+        let end = body.saturating_add(size).min(bytes.len());
+        match id {
+            b"fmt " if end - body >= 16 => {
+                format = Some((u16_at(body), u16_at(body + 2), u32_at(body + 4), u16_at(body + 14)));
+            }
+            b"data" => data = Some(&bytes[body..end]),
+            _ => {}
+        }
+        // Chunks are padded to even sizes
+        off = body + size + (size & 1);
+    }
+
+    let (tag, channels, src_rate, bits) = format.ok_or("missing fmt chunk")?;
+    let data = data.ok_or("missing data chunk")?;
+    if tag != 1 {
+        return Err(format!("unsupported WAV format tag {}", tag));
+    }
+    if channels == 0 || src_rate == 0 {
+        return Err("invalid WAV header".into());
+    }
+
+    let channels = channels as usize;
+    let mono: Vec<f32> = match bits {
+        16 => data
+            .chunks_exact(2 * channels)
+            .map(|frame| {
+                let sum: f32 = frame
+                    .chunks_exact(2)
+                    .map(|s| i16::from_le_bytes([s[0], s[1]]) as f32 / 32768.0)
+                    .sum();
+                sum / channels as f32
+            })
+            .collect(),
+        8 => data
+            .chunks_exact(channels)
+            .map(|frame| {
+                let sum: f32 = frame.iter().map(|&s| (s as f32 - 128.0) / 128.0).sum();
+                sum / channels as f32
+            })
+            .collect(),
+        other => return Err(format!("unsupported bit depth {}", other)),
+    };
+
+    Ok(resample(&mono, src_rate, rate))
+}
+
+/// Linear-interpolation resampler (good enough for short UI sounds)
+fn resample(input: &[f32], from: u32, to: u32) -> Vec<f32> {
+    if from == to || input.is_empty() {
+        return input.to_vec();
+    }
+    let out_len = (input.len() as u64 * to as u64 / from as u64) as usize;
+    let ratio = from as f64 / to as f64;
+    (0..out_len)
+        .map(|i| {
+            let pos = i as f64 * ratio;
+            let idx = pos as usize;
+            let frac = (pos - idx as f64) as f32;
+            let a = input[idx.min(input.len() - 1)];
+            let b = input[(idx + 1).min(input.len() - 1)];
+            a + (b - a) * frac
+        })
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn wav_16bit(rate: u32, channels: u16, samples: &[i16]) -> Vec<u8> {
+        let data_len = (samples.len() * 2) as u32;
+        let mut out = Vec::new();
+        out.extend_from_slice(b"RIFF");
+        out.extend_from_slice(&(36 + data_len).to_le_bytes());
+        out.extend_from_slice(b"WAVEfmt ");
+        out.extend_from_slice(&16u32.to_le_bytes());
+        out.extend_from_slice(&1u16.to_le_bytes());
+        out.extend_from_slice(&channels.to_le_bytes());
+        out.extend_from_slice(&rate.to_le_bytes());
+        out.extend_from_slice(&(rate * channels as u32 * 2).to_le_bytes());
+        out.extend_from_slice(&(channels * 2).to_le_bytes());
+        out.extend_from_slice(&16u16.to_le_bytes());
+        out.extend_from_slice(b"data");
+        out.extend_from_slice(&data_len.to_le_bytes());
+        for s in samples {
+            out.extend_from_slice(&s.to_le_bytes());
+        }
+        out
+    }
+
+    #[test]
+    fn test_tone_length_and_fades() {
+        let t = tone(400.0, Waveform::Square, 150, 48000);
+        assert_eq!(t.len(), 7200);
+        assert_eq!(t[0], 0.0);
+        assert!(t.last().unwrap().abs() < 0.01);
+        assert!(t.iter().all(|v| v.abs() <= 1.0));
+    }
+
+    #[test]
+    fn test_waveform_parse() {
+        assert_eq!(Waveform::parse("2"), Some(Waveform::Triangle));
+        assert_eq!(Waveform::parse("saw"), Some(Waveform::Sawtooth));
+        assert_eq!(Waveform::parse("7"), None);
+    }
+
+    #[test]
+    fn test_decode_wav_downmixes_and_resamples() {
+        // Stereo frames: (L, R) averages to 0.5 full scale
+        let bytes = wav_16bit(24000, 2, &[16384, 16384, 0, 32767, 16384, 16384]);
+        let mono = decode_wav(&bytes, 48000).unwrap();
+        assert_eq!(mono.len(), 6);
+        assert!((mono[0] - 0.5).abs() < 0.001);
+        assert!((mono[2] - 0.5).abs() < 0.001);
+
+        assert!(decode_wav(b"not a wav", 48000).is_err());
+    }
+}
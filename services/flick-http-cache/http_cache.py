@@ -0,0 +1,512 @@
+#!/usr/bin/env python3
+"""
+Flick HTTP cache - shared conditional-request cache for polling apps
+
+Weather, the Store and similar apps used to send a fresh XMLHttpRequest to a
+remote API on every open, so a cold open showed an empty UI until the
+network answered. They now go through this localhost proxy, which provides:
+
+- stale-while-revalidate: a cached response is returned at once even when
+  it's past max_age, and revalidation happens in the background
+- validators: revalidation sends If-None-Match/If-Modified-Since, so an
+  unchanged resource costs a 304 and no body
+- coalescing: concurrent requests for the same URL, from any app, share one
+  upstream fetch
+- background refresh: URLs registered with refresh=SECONDS are kept warm.
+  Refreshes that fall due close together run as one batch, and they also
+  piggyback on any foreground fetch, so the modem wakes once rather than
+  once per app
+
+    GET /fetch?url=<encoded>&max_age=600&refresh=1800[&wait=1]
+        Body and content type come from the upstream response. The
+        X-Flick-Cache header says HIT, STALE, MISS, REVALIDATED or
+        STALE-ERROR. wait=1 revalidates before answering (pull-to-refresh).
+    GET /status
+
+Only GET is cached; apps keep sending POSTs directly. /fetch only proxies
+https URLs on the hosts the apps use (ALLOWED_HOSTS, plus any listed in
+FLICK_HTTP_CACHE_HOSTS, comma separated), and no CORS headers are sent, so
+neither web pages nor other local processes can use it as an open proxy.
+At most MAX_REFRESH_URLS URLs are kept warm in the background.
+
+    python3 http_cache.py [--port 7659] [--db PATH]
+    python3 http_cache.py selftest      # exercises the cache against a local stub server
+"""
+
+import json
+import os
+import sqlite3
+import sys
+import threading
+import time
+import urllib.error
+import urllib.request
+from email.utils import formatdate
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from pathlib import Path
+from urllib.parse import parse_qs, urlparse
+
+DEFAULT_PORT = 7659
+DEFAULT_MAX_AGE = 300
+FETCH_TIMEOUT = 15
+MAX_BODY_BYTES = 8 * 1024 * 1024
+CACHE_LIMIT_BYTES = 64 * 1024 * 1024
+# Refreshes due within this long of each other are run in one batch
+BATCH_WINDOW = 300
+# Stop background-refreshing URLs no app has asked for in this long
+REFRESH_IDLE_LIMIT = 3 * 24 * 3600
+MIN_REFRESH_INTERVAL = 60
+# Wait before retrying a background refresh that failed (e.g. offline)
+RETRY_BACKOFF = 300
+USER_AGENT = "Flick/1.0 (http-cache)"
+# Origins /fetch will proxy: Weather's forecast API and the Store's catalogue
+ALLOWED_HOSTS = ("api.open-meteo.com", "255.one")
+# Background refresh registrations beyond this are served but not kept warm
+MAX_REFRESH_URLS = 32
+
+
+def log(msg):
+    print(f"[HttpCache] {msg}", file=sys.stderr, flush=True)
+
+
+def allowed_hosts():
+    extra = os.environ.get("FLICK_HTTP_CACHE_HOSTS", "")
+    return set(ALLOWED_HOSTS) | {h.strip().lower() for h in extra.split(",") if h.strip()}
+
+
+def url_allowed(url, hosts):
+    """https on the default port of an allowed host, without credentials"""
+    try:
+        parsed = urlparse(url)
+        port = parsed.port
+    except ValueError:
+        return False
+    return (parsed.scheme == "https" and port is None and not parsed.username
+            and (parsed.hostname or "") in hosts)
+
+
+def default_db_path():
+    base = os.environ.get("XDG_CACHE_HOME") or str(Path.home() / ".cache")
+    return Path(base) / "flick" / "http_cache.db"
+
+
+class Entry:
+    __slots__ = ("url", "status", "content_type", "body", "etag", "last_modified",
+                 "fetched_at", "max_age", "refresh", "last_used")
+
+    def __init__(self, row):
+        for key in self.__slots__:
+            setattr(self, key, row[key])
+
+    def age(self, now):
+        return now - self.fetched_at
+
+
+class HttpCache:
+    def __init__(self, db_path, upstream_timeout=FETCH_TIMEOUT, limit_bytes=CACHE_LIMIT_BYTES,
+                 max_refresh_urls=MAX_REFRESH_URLS):
+        self.db_path = Path(db_path)
+        self.db_path.parent.mkdir(parents=True, exist_ok=True)
+        self.timeout = upstream_timeout
+        self.limit_bytes = limit_bytes
+        self.max_refresh_urls = max_refresh_urls
+        # One connection shared by all handler threads, guarded by a lock;
+        # queries are tiny compared to the network round trips
+        self.db = sqlite3.connect(str(self.db_path), check_same_thread=False, isolation_level=None)
+        self.db.row_factory = sqlite3.Row
+        self.db.execute("PRAGMA journal_mode=WAL")
+        self.db.execute("""
+            CREATE TABLE IF NOT EXISTS entries (
+                url TEXT PRIMARY KEY,
+                status INTEGER NOT NULL,
+                content_type TEXT,
+                body BLOB NOT NULL,
+                etag TEXT,
+                last_modified TEXT,
+                fetched_at REAL NOT NULL,
+                max_age INTEGER NOT NULL,
+                refresh INTEGER NOT NULL DEFAULT 0,
+                last_used REAL NOT NULL
+            )""")
+        self.lock = threading.Lock()
+        # url -> Event for fetches in flight (coalescing)
+        self.inflight = {}
+        self.wake = threading.Event()
+        # url -> time before which a failed background refresh isn't retried
+        self.retry_after = {}
+        self.stats = {"hit": 0, "stale": 0, "miss": 0, "revalidated": 0,
+                      "not_modified": 0, "coalesced": 0, "batched": 0, "errors": 0}
+
+    # ---- Storage -----------------------------------------------------------
+
+    def get_entry(self, url):
+        with self.lock:
+            row = self.db.execute("SELECT * FROM entries WHERE url = ?", (url,)).fetchone()
+        return Entry(row) if row else None
+
+    def _refresh_allowed(self, url, entry, refresh, now):
+        """`refresh`, or 0 once MAX_REFRESH_URLS other URLs are being kept warm"""
+        if not refresh or (entry is not None and entry.refresh > 0):
+            return refresh
+        with self.lock:
+            active = self.db.execute(
+                "SELECT COUNT(*) FROM entries WHERE refresh > 0 AND last_used > ? AND url != ?",
+                (now - REFRESH_IDLE_LIMIT, url)).fetchone()[0]
+        if active >= self.max_refresh_urls:
+            log(f"not keeping {url} warm: {active} URLs already refreshing")
+            return 0
+        return refresh
+
+    def _touch(self, url, max_age, refresh):
+        with self.lock:
+            self.db.execute(
+                "UPDATE entries SET last_used = ?, max_age = ?, refresh = MAX(refresh, ?) WHERE url = ?",
+                (time.time(), max_age, refresh, url))
+
+    def _store(self, url, status, content_type, body, etag, last_modified, max_age, refresh):
+        now = time.time()
+        with self.lock:
+            self.db.execute(
+                "INSERT INTO entries VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+                "ON CONFLICT(url) DO UPDATE SET status=excluded.status, "
+                "content_type=excluded.content_type, body=excluded.body, etag=excluded.etag, "
+                "last_modified=excluded.last_modified, fetched_at=excluded.fetched_at, "
+                "max_age=excluded.max_age, refresh=MAX(entries.refresh, excluded.refresh)",
+                (url, status, content_type, body, etag, last_modified, now, max_age, refresh, now))
+        self._evict()
+
+    def _mark_fresh(self, url):
+        with self.lock:
+            self.db.execute("UPDATE entries SET fetched_at = ? WHERE url = ?", (time.time(), url))
+
+    def _evict(self):
+        with self.lock:
+            total = self.db.execute("SELECT COALESCE(SUM(LENGTH(body)), 0) FROM entries").fetchone()[0]
+            if total <= self.limit_bytes:
+                return
+            for row in self.db.execute("SELECT url, LENGTH(body) AS size FROM entries ORDER BY last_used").fetchall():
+                self.db.execute("DELETE FROM entries WHERE url = ?", (row["url"],))
+                total -= row["size"]
+                if total <= self.limit_bytes:
+                    break
+
+    # ---- Upstream ----------------------------------------------------------
+
+    def _fetch_upstream(self, url, entry, max_age, refresh):
+        """One (conditional) request to the origin; updates the store."""
+        headers = {"User-Agent": USER_AGENT, "Accept-Encoding": "identity"}
+        if entry is not None:
+            if entry.etag:
+                headers["If-None-Match"] = entry.etag
+            if entry.last_modified:
+                headers["If-Modified-Since"] = entry.last_modified
+        req = urllib.request.Request(url, headers=headers)
+        try:
+            with urllib.request.urlopen(req, timeout=self.timeout) as resp:
+                body = resp.read(MAX_BODY_BYTES + 1)
+                if len(body) > MAX_BODY_BYTES:
+                    raise ValueError("response too large to cache")
+                self._store(url, resp.status, resp.headers.get("Content-Type"), body,
+                            resp.headers.get("ETag"), resp.headers.get("Last-Modified"),
+                            max_age, refresh)
+                return "MISS" if entry is None else "REVALIDATED"
+        except urllib.error.HTTPError as e:
+            if e.code == 304 and entry is not None:
+                self._mark_fresh(url)
+                self.stats["not_modified"] += 1
+                return "REVALIDATED"
+            # Error statuses are passed through but never replace a good copy
+            if entry is None:
+                body = e.read(MAX_BODY_BYTES)
+                self._store(url, e.code, e.headers.get("Content-Type"), body, None, None, 0, 0)
+                return "MISS"
+            raise
+
+    def fetch(self, url, max_age, refresh):
+        """Fetch `url` upstream, sharing the request with concurrent callers."""
+        with self.lock:
+            event = self.inflight.get(url)
+            leader = event is None
+            if leader:
+                event = self.inflight[url] = threading.Event()
+        if not leader:
+            self.stats["coalesced"] += 1
+            event.wait(self.timeout + 5)
+            return "MISS"
+
+        try:
+            result = self._fetch_upstream(url, self.get_entry(url), max_age, refresh)
+            self.retry_after.pop(url, None)
+        except Exception as e:
+            self.stats["errors"] += 1
+            log(f"fetch failed for {url}: {e}")
+            result = "ERROR"
+            self.retry_after[url] = time.time() + RETRY_BACKOFF
+        finally:
+            with self.lock:
+                del self.inflight[url]
+            event.set()
+        # The radio is awake now - let anything due soon ride along
+        self.wake.set()
+        return result
+
+    def fetch_async(self, url, max_age, refresh):
+        threading.Thread(target=self.fetch, args=(url, max_age, refresh), daemon=True).start()
+
+    # ---- Request handling --------------------------------------------------
+
+    def get(self, url, max_age=DEFAULT_MAX_AGE, refresh=0, wait=False):
+        """Returns (Entry or None, cache state)."""
+        now = time.time()
+        entry = self.get_entry(url)
+        refresh = self._refresh_allowed(url, entry, refresh, now)
+        if entry is not None:
+            self._touch(url, max_age, refresh)
+            if entry.age(now) < max_age and not wait:
+                self.stats["hit"] += 1
+                return entry, "HIT"
+            if not wait:
+                # Serve what we have now; the app gets fresh data next time
+                self.stats["stale"] += 1
+                self.fetch_async(url, max_age, refresh)
+                return entry, "STALE"
+
+        state = self.fetch(url, max_age, refresh)
+        fresh = self.get_entry(url)
+        if state == "ERROR":
+            return (fresh, "STALE-ERROR") if fresh else (None, "ERROR")
+        if state == "REVALIDATED":
+            self.stats["revalidated"] += 1
+        else:
+            self.stats["miss"] += 1
+        return fresh, state
+
+    # ---- Background refresh ------------------------------------------------
+
+    def due_refreshes(self, now, horizon):
+        """URLs whose refresh falls due before now + horizon."""
+        with self.lock:
+            rows = self.db.execute(
+                "SELECT url, max_age, refresh FROM entries "
+                "WHERE refresh > 0 AND last_used > ? AND fetched_at + refresh < ?",
+                (now - REFRESH_IDLE_LIMIT, now + horizon)).fetchall()
+        return [(r["url"], r["max_age"], r["refresh"]) for r in rows
+                if self.retry_after.get(r["url"], 0) <= now]
+
+    def next_refresh_at(self):
+        """When the next refresh falls due, counting a URL that failed
+        recently as due only once its backoff ends (None if nothing is)."""
+        now = time.time()
+        # Expired backoffs are dropped so they stop holding entries
+        for url, until in list(self.retry_after.items()):
+            if until <= now:
+                self.retry_after.pop(url, None)
+        with self.lock:
+            rows = self.db.execute(
+                "SELECT url, fetched_at + refresh FROM entries WHERE refresh > 0 AND last_used > ?",
+                (now - REFRESH_IDLE_LIMIT,)).fetchall()
+        return min((max(due, self.retry_after.get(url, 0)) for url, due in rows), default=None)
+
+    def refresh_loop(self):
+        while True:
+            due_at = self.next_refresh_at()
+            timeout = None if due_at is None else max(due_at - time.time(), 0)
+            woken = self.wake.wait(timeout)
+            self.wake.clear()
+            now = time.time()
+            # Woken by a foreground fetch or by the timer, take everything
+            # due within the batch window so it shares this radio wake-up
+            batch = self.due_refreshes(now, BATCH_WINDOW)
+            if not batch:
+                continue
+            if not woken:
+                log(f"background refresh of {len(batch)} URL(s)")
+            self.stats["batched"] += len(batch)
+            threads = [threading.Thread(target=self.fetch, args=item, daemon=True) for item in batch]
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join()
+
+    def status(self):
+        with self.lock:
+            count, size = self.db.execute(
+                "SELECT COUNT(*), COALESCE(SUM(LENGTH(body)), 0) FROM entries").fetchone()
+            refreshing = self.db.execute("SELECT COUNT(*) FROM entries WHERE refresh > 0").fetchone()[0]
+        return {"entries": count, "bytes": size, "background_refresh": refreshing,
+                "inflight": len(self.inflight), **self.stats}
+
+
+def make_handler(cache, hosts):
+    class Handler(BaseHTTPRequestHandler):
+        def log_message(self, fmt, *args):
+            pass
+
+        def do_GET(self):
+            parsed = urlparse(self.path)
+            params = {k: v[0] for k, v in parse_qs(parsed.query).items()}
+            if parsed.path == "/status":
+                return self._send(200, "application/json", json.dumps(cache.status()).encode(), {})
+            if parsed.path != "/fetch":
+                return self._send(404, "text/plain", b"not found", {})
+
+            url = params.get("url", "")
+            if not url_allowed(url, hosts):
+                return self._send(403, "text/plain", b"host not allowed", {})
+            try:
+                max_age = int(params.get("max_age", DEFAULT_MAX_AGE))
+                refresh = int(params.get("refresh", 0))
+            except ValueError:
+                return self._send(400, "text/plain", b"bad max_age/refresh", {})
+            if refresh:
+                refresh = max(refresh, MIN_REFRESH_INTERVAL)
+
+            entry, state = cache.get(url, max_age, refresh, params.get("wait") == "1")
+            if entry is None:
+                return self._send(502, "text/plain", b"upstream unreachable", {"X-Flick-Cache": state})
+            self._send(entry.status, entry.content_type or "application/octet-stream", entry.body, {
+                "X-Flick-Cache": state,
+                "X-Flick-Cache-Age": str(int(time.time() - entry.fetched_at)),
+            })
+
+        def _send(self, code, content_type, body, headers):
+            self.send_response(code)
+            self.send_header("Content-Type", content_type)
+            self.send_header("Content-Length", str(len(body)))
+            for k, v in headers.items():
+                self.send_header(k, v)
+            self.end_headers()
+            self.wfile.write(body)
+
+    return Handler
+
+
+def serve(port, db_path):
+    cache = HttpCache(db_path)
+    threading.Thread(target=cache.refresh_loop, daemon=True).start()
+    server = ThreadingHTTPServer(("127.0.0.1", port), make_handler(cache, allowed_hosts()))
+    server.daemon_threads = True
+    log(f"Listening on 127.0.0.1:{port}, cache {db_path}")
+    server.serve_forever()
+    return cache, server
+
+
+# ---- Self-test against a local stub origin ----------------------------------
+
+def selftest():
+    import tempfile
+
+    hits = {"count": 0, "conditional": 0}
+    version = {"etag": '"v1"', "body": b'{"temp": 20}'}
+
+    class Origin(BaseHTTPRequestHandler):
+        def log_message(self, fmt, *args):
+            pass
+
+        def do_GET(self):
+            hits["count"] += 1
+            time.sleep(0.2)  # long enough for concurrent requests to overlap
+            if self.headers.get("If-None-Match") == version["etag"]:
+                hits["conditional"] += 1
+                self.send_response(304)
+                self.end_headers()
+                return
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("ETag", version["etag"])
+            self.send_header("Last-Modified", formatdate(usegmt=True))
+            self.send_header("Content-Length", str(len(version["body"])))
+            self.end_headers()
+            self.wfile.write(version["body"])
+
+    origin = ThreadingHTTPServer(("127.0.0.1", 0), Origin)
+    threading.Thread(target=origin.serve_forever, daemon=True).start()
+    url = f"http://127.0.0.1:{origin.server_port}/forecast"
+
+    with tempfile.TemporaryDirectory() as tmp:
+        cache = HttpCache(Path(tmp) / "cache.db")
+
+        # Coalescing: five concurrent cold requests, one upstream fetch
+        results = []
+        threads = [threading.Thread(target=lambda: results.append(cache.get(url, 60)))
+                   for _ in range(5)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        assert hits["count"] == 1, hits
+        assert all(e is not None and e.body == version["body"] for e, _ in results)
+
+        # Fresh hit never touches the origin
+        entry, state = cache.get(url, 60)
+        assert state == "HIT" and hits["count"] == 1
+
+        # Stale: served immediately, revalidated in the background with a 304
+        entry, state = cache.get(url, 0)
+        assert state == "STALE" and entry.body == version["body"]
+        time.sleep(0.5)
+        assert hits["conditional"] == 1, hits
+
+        # Changed upstream: wait=1 revalidates and returns the new body
+        version.update(etag='"v2"', body=b'{"temp": 25}')
+        entry, state = cache.get(url, 60, wait=True)
+        assert state == "REVALIDATED" and entry.body == b'{"temp": 25}', (state, entry.body)
+
+        # Origin down: the last good copy is still served
+        origin.shutdown()
+        origin.server_close()
+        cache.timeout = 1
+        entry, state = cache.get(url, 0, wait=True)
+        assert state == "STALE-ERROR" and entry.body == b'{"temp": 25}', state
+
+        # The failure above backs the URL off; once that expires, background
+        # refresh batching picks up everything due within the window
+        cache.get(url, 60, refresh=60)
+        assert cache.due_refreshes(time.time() + 60, BATCH_WINDOW) == []
+        assert cache.next_refresh_at() >= cache.retry_after[url]
+        cache.retry_after[url] = time.time() - 1
+        assert cache.next_refresh_at() < time.time() + 60 and url not in cache.retry_after
+        due = cache.due_refreshes(time.time() + 60, BATCH_WINDOW)
+        assert [d[0] for d in due] == [url], due
+
+        # Registrations past the cap are served but not kept warm
+        cache.max_refresh_urls = 1
+        now = time.time()
+        assert cache._refresh_allowed(url + "?other", None, 60, now) == 0
+        assert cache._refresh_allowed(url, cache.get_entry(url), 120, now) == 120
+
+    # Only https on allowed hosts is proxied
+    hosts = {"api.open-meteo.com"}
+    assert url_allowed("https://api.open-meteo.com/v1/forecast?latitude=1", hosts)
+    for bad in ("http://api.open-meteo.com/v1", "https://api.open-meteo.com:8443/v1",
+                "https://user@api.open-meteo.com/v1", "https://api.open-meteo.com.evil.net/",
+                "https://127.0.0.1/", "file:///etc/passwd", "https://api.open-meteo.com:x/"):
+        assert not url_allowed(bad, hosts), bad
+
+    print("selftest passed:", json.dumps(hits))
+    return 0
+
+
+def main():
+    args = sys.argv[1:]
+    if args[:1] == ["selftest"]:
+        return selftest()
+
+    port, db_path = DEFAULT_PORT, default_db_path()
+    i = 0
+    while i < len(args):
+        if args[i] == "--port" and i + 1 < len(args):
+            port = int(args[i + 1])
+            i += 2
+        elif args[i] == "--db" and i + 1 < len(args):
+            db_path = Path(args[i + 1])
+            i += 2
+        else:
+            print(__doc__)
+            return 1
+    serve(port, db_path)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
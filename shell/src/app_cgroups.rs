@@ -0,0 +1,896 @@
+//! Per-app cgroup v2 groups and the background app freezer
+//!
+//! Every app launched through `spawn_user` is moved into its own cgroup under
+//! `/sys/fs/cgroup/flick-apps/<app_id>` before it drops privileges, so the
+//! whole process tree (run script, qmlscene, helpers) shares one group.
+//!
+//! Once an app leaves the foreground it is frozen via `cgroup.freeze` after a
+//! short grace period, which stops its timers, polls and animations. Apps that
+//! are playing audio (an uncorked PulseAudio sink input) or hold a wake reason
+//! (a file at `~/.local/state/flick/wake/<app_id>`) are left running. Groups
+//! are thawed synchronously when the app is focused again or the switcher
+//! needs live thumbnails, before the next frame callbacks go out.
+//!
+//! Under memory pressure (see `memory_pressure`) background groups are asked
+//! to give memory back: each app gets a trim request (the unix time written
+//! to `~/.local/state/flick/trim/<app_id>`, to drop caches when it next
+//! runs) and the kernel reclaims from its group via `memory.reclaim`. As a
+//! last resort the least recently used one is killed through `cgroup.kill`. Killed apps are kept as
+//! placeholder cards in the switcher so they can be relaunched cold.
+//!
+//! Each group is also given a scheduling tier (`cpu.weight`, `cpu.uclamp.*`,
+//! `io.weight`): the foreground app is boosted, apps used in the last minute
+//! run at normal priority and everything else is clamped. The foreground
+//! tier is applied in `focus_changed`, in the same frame as the focus change.
+//!
+//! Apps prelaunched on a prediction (see `prelaunch`) run in the lowest tier
+//! under a `memory.high` cap until their first frame is drawn, then stay
+//! frozen until they are shown or cancelled. They have no mapped window, so
+//! the freezer policy and the memory-pressure killer never see them.
+//!
+//! Daemons that an app's run script starts on demand are moved out of the app
+//! into the `.services` group so they are never frozen or killed with it.
+//! Batch daemons (mail/SMS sync, indexers) share that group at background
+//! priority; latency-sensitive ones (phone, audio) go to `.services-system`.
+//!
+//! When cgroup v2 is not mounted or the root is not writable the freezer is
+//! disabled and apps are spawned exactly as before.
+
+use std::collections::{HashMap, HashSet};
+use std::ffi::CString;
+use std::os::unix::ffi::OsStrExt;
+use std::os::unix::fs::MetadataExt;
+use std::os::unix::process::CommandExt;
+use std::path::{Path, PathBuf};
+use std::process::Command;
+use std::sync::mpsc::{self, Receiver, TryRecvError};
+use std::sync::Mutex;
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+
+/// Default location of the app groups (override with FLICK_CGROUP_ROOT)
+const DEFAULT_ROOT: &str = "/sys/fs/cgroup/flick-apps";
+/// Mount point of the unified hierarchy
+const CGROUP_MOUNT: &str = "/sys/fs/cgroup";
+/// How long a backgrounded app keeps running before it is frozen
+const FREEZE_GRACE: Duration = Duration::from_secs(5);
+/// Re-check interval for apps kept awake by audio or a wake reason
+const AWAKE_RECHECK: Duration = Duration::from_secs(30);
+/// How often empty groups of exited apps are removed
+const SWEEP_INTERVAL: Duration = Duration::from_secs(10);
+/// Group for batch daemons, clamped (app ids never start with '.')
+pub const SERVICES_GROUP: &str = ".services";
+/// Group for latency-sensitive daemons, normal priority
+pub const SYSTEM_SERVICES_GROUP: &str = ".services-system";
+/// Controllers delegated to the app groups
+const CONTROLLERS: &str = "+memory +cpu +io";
+/// Apps focused this recently stay at normal priority
+const RECENT_WINDOW: Duration = Duration::from_secs(60);
+/// util_min (out of 1024) for the compositor's own threads
+const SHELL_UCLAMP_MIN: u32 = 512;
+/// How much memory.reclaim asks each background group for per trim
+const RECLAIM_PER_GROUP: &str = "32M";
+/// memory.high of a prelaunched app until it is shown
+const PRELAUNCH_MEMORY_HIGH: &str = "256M";
+
+lazy_static::lazy_static! {
+    /// Group name -> (app id, exec line) of the last launch, for cold relaunch
+    static ref LAUNCHES: Mutex<HashMap<String, (String, String)>> = Mutex::new(HashMap::new());
+    /// Root of the app groups, None without cgroup v2 (checked once)
+    static ref GROUPS_ROOT: Option<PathBuf> = cgroup_root();
+    /// The root's path inside the hierarchy as /proc/<pid>/cgroup shows it
+    static ref GROUPS_REL_ROOT: String = rel_root(GROUPS_ROOT.as_deref());
+}
+
+/// Turn an app id into a cgroup directory name
+pub fn group_name(app_id: &str) -> String {
+    let name: String = app_id
+        .chars()
+        .map(|c| if c.is_ascii_alphanumeric() || c == '-' || c == '_' || c == '.' { c } else { '_' })
+        .collect();
+    match name.trim_start_matches('.') {
+        "" => "app".to_string(),
+        trimmed => trimmed.to_string(),
+    }
+}
+
+/// Derive a group name from an exec line for launches without an app id
+/// e.g. `sh -c "$HOME/Flick/apps/settings/run_settings.sh"` -> "settings",
+/// `env FOO=1 /usr/bin/foot` -> "foot"
+pub fn group_name_for_exec(exec: &str) -> String {
+    let program = exec
+        .split(|c: char| c.is_whitespace() || c == '"' || c == '\'')
+        .filter(|part| !part.is_empty())
+        .find(|part| !part.starts_with('-') && !part.starts_with('%') && !part.contains('=')
+            && !matches!(*part, "sh" | "bash" | "env" | "exec"))
+        .unwrap_or("app");
+    let base = program.rsplit('/').next().unwrap_or(program);
+    let base = base.strip_suffix(".sh").unwrap_or(base);
+    group_name(base.strip_prefix("run_").unwrap_or(base))
+}
+
+/// Root directory for app groups, or None when cgroup v2 is unavailable
+fn cgroup_root() -> Option<PathBuf> {
+    let root = match std::env::var("FLICK_CGROUP_ROOT") {
+        Ok(path) if !path.is_empty() => PathBuf::from(path),
+        _ => {
+            // Only the unified hierarchy has cgroup.freeze
+            if !Path::new(CGROUP_MOUNT).join("cgroup.controllers").exists() {
+                return None;
+            }
+            PathBuf::from(DEFAULT_ROOT)
+        }
+    };
+    if let Err(e) = std::fs::create_dir_all(&root) {
+        tracing::warn!("App cgroups disabled, cannot create {:?}: {}", root, e);
+        return None;
+    }
+    // Best effort: without these the freezer still works, only the
+    // memory.* knobs are missing from the app groups
+    if let Some(parent) = root.parent() {
+        let _ = std::fs::write(parent.join("cgroup.subtree_control"), CONTROLLERS);
+    }
+    let _ = std::fs::write(root.join("cgroup.subtree_control"), CONTROLLERS);
+    Some(root)
+}
+
+/// Whether apps are placed in their own groups (cgroup v2 available)
+pub fn groups_enabled() -> bool {
+    GROUPS_ROOT.is_some()
+}
+
+/// Path of the app groups' root inside the hierarchy (e.g. "/flick-apps"),
+/// empty when disabled or outside /sys/fs/cgroup
+pub fn groups_rel_root() -> &'static str {
+    &GROUPS_REL_ROOT
+}
+
+fn rel_root(root: Option<&Path>) -> String {
+    root.and_then(|r| r.strip_prefix(CGROUP_MOUNT).ok())
+        .map(|r| format!("/{}", r.display()))
+        .unwrap_or_default()
+}
+
+/// Create (or reuse) the group for an app and thaw it
+///
+/// Returns the path of its `cgroup.procs`, or None when cgroups are disabled.
+fn prepare_group(app_id: &str) -> Option<PathBuf> {
+    let dir = cgroup_root()?.join(group_name(app_id));
+    if let Err(e) = std::fs::create_dir_all(&dir) {
+        tracing::warn!("Could not create app cgroup {:?}: {}", dir, e);
+        return None;
+    }
+    // A relaunch of a frozen app must not start inside a frozen group
+    let _ = std::fs::write(dir.join("cgroup.freeze"), "0");
+    Some(dir.join("cgroup.procs"))
+}
+
+/// Move the spawned child into the app's group before it execs
+///
+/// Must be called before the privilege-dropping `pre_exec` is registered:
+/// migrating a process needs write access to the group, which only root has.
+pub fn attach_command(command: &mut Command, app_id: &str, exec: &str) {
+    if let Ok(mut launches) = LAUNCHES.lock() {
+        launches.insert(group_name(app_id), (app_id.to_string(), exec.to_string()));
+    }
+    let procs = match prepare_group(app_id).and_then(|p| CString::new(p.as_os_str().as_bytes()).ok()) {
+        Some(procs) => procs,
+        None => return,
+    };
+    tracing::info!("Placing app '{}' in cgroup {:?}", app_id, procs);
+
+    // Only async-signal-safe calls between fork and exec: open/write/close.
+    // Writing "0" moves the writing process itself.
+    unsafe {
+        command.pre_exec(move || {
+            let fd = libc::open(procs.as_ptr(), libc::O_WRONLY | libc::O_CLOEXEC);
+            if fd >= 0 {
+                libc::write(fd, b"0".as_ptr() as *const libc::c_void, 1);
+                libc::close(fd);
+            }
+            // Not fatal: the app just runs unmanaged
+            Ok(())
+        });
+    }
+}
+
+/// (app id, exec line) of the last launch into a group
+pub fn launch_of_group(name: &str) -> Option<(String, String)> {
+    LAUNCHES.lock().ok().and_then(|launches| launches.get(name).cloned())
+}
+
+/// Parse the unified hierarchy entry of /proc/<pid>/cgroup into a group name
+/// under `rel_root` (the root's path inside the hierarchy, e.g. "/flick-apps")
+pub fn parse_proc_cgroup(content: &str, rel_root: &str) -> Option<String> {
+    let path = content.lines().find_map(|line| line.strip_prefix("0::"))?;
+    let rest = path.strip_prefix(rel_root)?.strip_prefix('/')?;
+    let name = rest.split('/').next()?;
+    if name.is_empty() { None } else { Some(name.to_string()) }
+}
+
+/// Parse `pactl list sink-inputs` into the pids of streams that are playing
+fn parse_playing_pids(output: &str) -> HashSet<u32> {
+    let mut pids = HashSet::new();
+    let mut corked = false;
+    let mut pid = None;
+    let mut flush = |corked: bool, pid: Option<u32>| {
+        if let (false, Some(pid)) = (corked, pid) {
+            pids.insert(pid);
+        }
+    };
+    for line in output.lines() {
+        let line = line.trim();
+        if line.starts_with("Sink Input #") {
+            flush(corked, pid.take());
+            corked = false;
+        } else if let Some(value) = line.strip_prefix("Corked:") {
+            corked = value.trim() == "yes";
+        } else if let Some(value) = line.strip_prefix("application.process.id = ") {
+            pid = value.trim_matches('"').parse().ok();
+        }
+    }
+    flush(corked, pid);
+    pids
+}
+
+/// Freezer bookkeeping for one app group
+#[derive(Debug, Default)]
+struct AppGroup {
+    frozen: bool,
+    /// When the app should be frozen (None while foreground or frozen)
+    freeze_at: Option<Instant>,
+    /// Last time the app was in the foreground (or first seen)
+    last_used: Option<Instant>,
+    /// Scheduling tier last written to the group
+    tier: Option<Tier>,
+}
+
+/// An app killed under memory pressure, shown in the switcher until relaunched
+#[derive(Debug, Clone)]
+pub struct KilledApp {
+    pub group: String,
+    pub app_id: String,
+    pub exec: String,
+    pub title: String,
+}
+
+/// Scheduling tier of an app group
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Tier {
+    /// Focused app
+    Foreground,
+    /// Recently used app or latency-sensitive daemon
+    Recent,
+    /// Everything else, including batch daemons
+    Background,
+    /// Hidden prelaunched app: only runs on otherwise idle CPUs
+    Prelaunch,
+}
+
+impl Tier {
+    /// (cpu.weight, cpu.uclamp.min, cpu.uclamp.max, io.weight)
+    fn knobs(self) -> [(&'static str, &'static str); 4] {
+        match self {
+            Tier::Foreground => [("cpu.weight", "400"), ("cpu.uclamp.min", "25"), ("cpu.uclamp.max", "max"), ("io.weight", "default 400")],
+            Tier::Recent => [("cpu.weight", "100"), ("cpu.uclamp.min", "0"), ("cpu.uclamp.max", "max"), ("io.weight", "default 100")],
+            Tier::Background => [("cpu.weight", "20"), ("cpu.uclamp.min", "0"), ("cpu.uclamp.max", "40"), ("io.weight", "default 25")],
+            Tier::Prelaunch => [("cpu.weight", "1"), ("cpu.uclamp.min", "0"), ("cpu.uclamp.max", "20"), ("io.weight", "default 1")],
+        }
+    }
+}
+
+/// Raise util_min of the compositor's threads so frequency scaling reacts to
+/// frame work immediately (threads spawned later inherit it)
+fn boost_shell() {
+    // struct sched_attr from include/uapi/linux/sched/types.h
+    #[repr(C)]
+    #[derive(Default)]
+    struct SchedAttr {
+        size: u32,
+        sched_policy: u32,
+        sched_flags: u64,
+        sched_nice: i32,
+        sched_priority: u32,
+        sched_runtime: u64,
+        sched_deadline: u64,
+        sched_period: u64,
+        sched_util_min: u32,
+        sched_util_max: u32,
+    }
+    const SCHED_FLAG_KEEP_ALL: u64 = 0x08 | 0x10;
+    const SCHED_FLAG_UTIL_CLAMP_MIN: u64 = 0x20;
+
+    let attr = SchedAttr {
+        size: std::mem::size_of::<SchedAttr>() as u32,
+        sched_flags: SCHED_FLAG_KEEP_ALL | SCHED_FLAG_UTIL_CLAMP_MIN,
+        sched_util_min: SHELL_UCLAMP_MIN,
+        ..Default::default()
+    };
+    let ret = unsafe { libc::syscall(libc::SYS_sched_setattr, 0, &attr as *const SchedAttr, 0) };
+    if ret == 0 {
+        tracing::info!("Shell uclamp.min set to {}/1024", SHELL_UCLAMP_MIN);
+    } else {
+        // Kernels without CONFIG_UCLAMP_TASK
+        tracing::debug!("sched_setattr(uclamp) failed: {}", std::io::Error::last_os_error());
+    }
+}
+
+/// Write a trim request for each group: `dir/<group>` holding the unix time.
+/// Files are owned like the state directory, so apps can clear them.
+fn request_trim(dir: &Path, groups: &[String]) {
+    let owner = dir.parent().and_then(|state| std::fs::metadata(state).ok()).map(|m| (m.uid(), m.gid()));
+    let give_to_user = |path: &Path| {
+        if let Some((uid, gid)) = owner {
+            let _ = std::os::unix::fs::chown(path, Some(uid), Some(gid));
+        }
+    };
+    if !dir.exists() {
+        if let Err(e) = std::fs::create_dir_all(dir) {
+            tracing::debug!("Cannot create {:?}: {}", dir, e);
+            return;
+        }
+        give_to_user(dir);
+    }
+    let now = SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0);
+    for name in groups {
+        let path = dir.join(name);
+        if std::fs::write(&path, now.to_string()).is_ok() {
+            give_to_user(&path);
+        }
+    }
+}
+
+/// Tracks app groups and applies the freeze/thaw policy each frame
+pub struct AppCgroups {
+    root: Option<PathBuf>,
+    /// Path of `root` inside the cgroup hierarchy, as seen in /proc/<pid>/cgroup
+    rel_root: String,
+    wake_dir: Option<PathBuf>,
+    groups: HashMap<String, AppGroup>,
+    /// Client pid -> group (None for clients outside any app group)
+    pid_groups: HashMap<u32, Option<String>>,
+    /// Pending audio probe: names of groups with a playing stream
+    audio_probe: Option<Receiver<HashSet<String>>>,
+    /// Groups that had a playing stream at the last probe
+    audible: HashSet<String>,
+    /// Foreground group and groups with mapped windows (switcher order) as of the last update
+    foreground: Option<String>,
+    visible: Vec<String>,
+    killed: Vec<KilledApp>,
+    last_sweep: Instant,
+}
+
+impl AppCgroups {
+    pub fn new() -> Self {
+        let root = cgroup_root();
+        let wake_dir = crate::spawn_user::get_target_user()
+            .and_then(|user| crate::spawn_user::get_user_info(&user))
+            .map(|(_, _, home)| PathBuf::from(home))
+            .or_else(|| std::env::var("HOME").ok().map(PathBuf::from))
+            .map(|home| home.join(".local/state/flick/wake"));
+        let mut cgroups = Self::with_root(root, wake_dir);
+        boost_shell();
+        if cgroups.root.is_some() {
+            tracing::info!("App freezer enabled at {:?}", cgroups.root);
+            // Groups left over from a previous compositor run must not stay frozen
+            cgroups.thaw_all_on_disk();
+        } else {
+            tracing::info!("App freezer disabled (no writable cgroup v2 hierarchy)");
+        }
+        cgroups
+    }
+
+    fn with_root(root: Option<PathBuf>, wake_dir: Option<PathBuf>) -> Self {
+        let rel_root = rel_root(root.as_deref());
+        Self {
+            root,
+            rel_root,
+            wake_dir,
+            groups: HashMap::new(),
+            pid_groups: HashMap::new(),
+            audio_probe: None,
+            audible: HashSet::new(),
+            foreground: None,
+            visible: Vec::new(),
+            killed: Vec::new(),
+            last_sweep: Instant::now(),
+        }
+    }
+
+    pub fn enabled(&self) -> bool {
+        self.root.is_some()
+    }
+
+    /// Group an app client belongs to (cached per pid)
+    pub fn group_of_pid(&mut self, pid: u32) -> Option<String> {
+        if self.rel_root.is_empty() {
+            return self.pid_groups.get(&pid).cloned().flatten();
+        }
+        let rel_root = &self.rel_root;
+        self.pid_groups
+            .entry(pid)
+            .or_insert_with(|| {
+                std::fs::read_to_string(format!("/proc/{}/cgroup", pid))
+                    .ok()
+                    .and_then(|content| parse_proc_cgroup(&content, rel_root))
+            })
+            .clone()
+    }
+
+    /// Bring a client's group to the foreground immediately (called on
+    /// focus change, before the next frame callbacks): thaw it, boost it and
+    /// drop the previous foreground app to normal priority
+    pub fn focus_pid(&mut self, pid: u32) {
+        if !self.enabled() {
+            return;
+        }
+        let Some(name) = self.group_of_pid(pid) else { return };
+        if let Some(previous) = self.foreground.take().filter(|p| *p != name) {
+            self.set_tier(&previous, Tier::Recent);
+        }
+        self.thaw(&name);
+        self.set_tier(&name, Tier::Foreground);
+        self.groups.entry(name.clone()).or_default().last_used = Some(Instant::now());
+        self.foreground = Some(name);
+    }
+
+    /// Write the scheduling knobs of a tier to a group (only on change)
+    fn set_tier(&mut self, name: &str, tier: Tier) {
+        let Some(root) = self.root.as_ref() else { return };
+        let group = self.groups.entry(name.to_string()).or_default();
+        if group.tier == Some(tier) {
+            return;
+        }
+        group.tier = Some(tier);
+        let dir = root.join(name);
+        for (knob, value) in tier.knobs() {
+            // cpu.uclamp.* needs CONFIG_UCLAMP_TASK_GROUP; missing knobs are skipped
+            if let Err(e) = std::fs::write(dir.join(knob), value) {
+                tracing::debug!("Could not set {} on '{}': {}", knob, name, e);
+            }
+        }
+        tracing::debug!("App group '{}' now {:?}", name, tier);
+    }
+
+    fn write_freeze(&self, name: &str, frozen: bool) -> bool {
+        let Some(root) = self.root.as_ref() else { return false };
+        let path = root.join(name).join("cgroup.freeze");
+        match std::fs::write(&path, if frozen { "1" } else { "0" }) {
+            Ok(()) => true,
+            Err(e) => {
+                tracing::warn!("Failed to write {:?}: {}", path, e);
+                false
+            }
+        }
+    }
+
+    fn thaw(&mut self, name: &str) {
+        let group = self.groups.entry(name.to_string()).or_default();
+        group.freeze_at = None;
+        if group.frozen {
+            group.frozen = false;
+            if self.write_freeze(name, false) {
+                tracing::info!("Thawed app group '{}'", name);
+            }
+        }
+    }
+
+    fn freeze(&mut self, name: &str) {
+        if self.write_freeze(name, true) {
+            tracing::info!("Froze background app group '{}'", name);
+            if let Some(group) = self.groups.get_mut(name) {
+                group.frozen = true;
+                group.freeze_at = None;
+            }
+        }
+    }
+
+    fn has_wake_reason(&self, name: &str) -> bool {
+        self.wake_dir.as_ref().map(|dir| dir.join(name).exists()).unwrap_or(false)
+    }
+
+    /// Apply the freezer policy for this frame
+    ///
+    /// `foreground` is the pid of the focused app client, `window_pids` the
+    /// pids of every mapped window, `show_all` is set while the switcher is
+    /// visible and every app must keep drawing its thumbnail.
+    pub fn update(&mut self, foreground: Option<u32>, window_pids: &[u32], show_all: bool) {
+        if !self.enabled() {
+            return;
+        }
+        self.pid_groups.retain(|pid, _| window_pids.contains(pid) || Some(*pid) == foreground);
+
+        let foreground = foreground.and_then(|pid| self.group_of_pid(pid));
+        // Keep switcher (stacking) order, one entry per group
+        let mut visible: Vec<String> = Vec::new();
+        for pid in window_pids {
+            if let Some(name) = self.group_of_pid(*pid) {
+                if !visible.contains(&name) {
+                    visible.push(name);
+                }
+            }
+        }
+        // A killed app that has a window again was relaunched
+        self.killed.retain(|k| !visible.contains(&k.group));
+
+        let now = Instant::now();
+        let mut due = false;
+        for name in &visible {
+            let is_foreground = foreground.as_deref() == Some(name.as_str());
+            let last_used = *self.groups.entry(name.clone()).or_default().last_used.get_or_insert(now);
+            let tier = if is_foreground {
+                Tier::Foreground
+            } else if now.duration_since(last_used) < RECENT_WINDOW {
+                Tier::Recent
+            } else {
+                Tier::Background
+            };
+            self.set_tier(name, tier);
+
+            if show_all || is_foreground {
+                self.thaw(name);
+                if is_foreground {
+                    self.groups.entry(name.clone()).or_default().last_used = Some(now);
+                }
+                continue;
+            }
+            let group = self.groups.entry(name.clone()).or_default();
+            if group.frozen {
+                continue;
+            }
+            match group.freeze_at {
+                None => group.freeze_at = Some(now + FREEZE_GRACE),
+                Some(at) if at <= now => due = true,
+                Some(_) => {}
+            }
+        }
+
+        if due && self.audio_probe.is_none() {
+            self.start_audio_probe();
+        }
+        self.finish_audio_probe(&visible, foreground.as_deref(), show_all);
+
+        if now.duration_since(self.last_sweep) >= SWEEP_INTERVAL {
+            self.last_sweep = now;
+            self.sweep_empty_groups();
+        }
+        self.foreground = foreground;
+        self.visible = visible;
+    }
+
+    /// Ask PulseAudio for playing streams off the main loop (pactl may take
+    /// tens of milliseconds, too long for a frame)
+    fn start_audio_probe(&mut self) {
+        let (tx, rx) = mpsc::channel();
+        let rel_root = self.rel_root.clone();
+        std::thread::spawn(move || {
+            let playing = crate::system::VolumeManager::run_pactl(&["list", "sink-inputs"])
+                .map(|out| parse_playing_pids(&String::from_utf8_lossy(&out.stdout)))
+                .unwrap_or_default();
+            let groups = playing
+                .into_iter()
+                .filter_map(|pid| {
+                    std::fs::read_to_string(format!("/proc/{}/cgroup", pid))
+                        .ok()
+                        .and_then(|content| parse_proc_cgroup(&content, &rel_root))
+                })
+                .collect();
+            let _ = tx.send(groups);
+        });
+        self.audio_probe = Some(rx);
+    }
+
+    /// Freeze due groups once the audio probe has answered
+    fn finish_audio_probe(&mut self, visible: &[String], foreground: Option<&str>, show_all: bool) {
+        let playing = match self.audio_probe.as_ref().map(|rx| rx.try_recv()) {
+            Some(Ok(playing)) => playing,
+            Some(Err(TryRecvError::Empty)) | None => return,
+            Some(Err(TryRecvError::Disconnected)) => HashSet::new(),
+        };
+        self.audio_probe = None;
+        self.audible = playing.clone();
+        if show_all {
+            return;
+        }
+
+        let now = Instant::now();
+        for name in visible {
+            if foreground == Some(name.as_str()) {
+                continue;
+            }
+            let is_due = self.groups.get(name)
+                .map(|g| !g.frozen && g.freeze_at.map(|at| at <= now).unwrap_or(false))
+                .unwrap_or(false);
+            if !is_due {
+                continue;
+            }
+            if playing.contains(name) || self.has_wake_reason(name) {
+                tracing::debug!("App group '{}' kept awake (audio or wake reason)", name);
+                if let Some(group) = self.groups.get_mut(name) {
+                    group.freeze_at = Some(now + AWAKE_RECHECK);
+                }
+            } else {
+                self.freeze(name);
+            }
+        }
+    }
+
+    /// Background groups, least recently used first
+    fn background_lru(&self) -> Vec<String> {
+        let mut background: Vec<(Option<Instant>, usize, String)> = self.visible
+            .iter()
+            .enumerate()
+            .filter(|(_, name)| self.foreground.as_deref() != Some(name.as_str()))
+            .map(|(pos, name)| (self.groups.get(name).and_then(|g| g.last_used), pos, name.clone()))
+            .collect();
+        // Never-focused groups sort first (None < Some); ties fall back to switcher order
+        background.sort();
+        background.into_iter().map(|(_, _, name)| name).collect()
+    }
+
+    /// Ask background apps to trim, and the kernel to reclaim memory from
+    /// them (LRU first)
+    ///
+    /// memory.reclaim blocks until the pages are written back, so it runs on
+    /// a worker thread.
+    pub fn reclaim_background(&self) {
+        let Some(root) = self.root.clone() else { return };
+        let groups = self.background_lru();
+        if groups.is_empty() {
+            return;
+        }
+        tracing::info!("Memory pressure: reclaiming from {} background app(s)", groups.len());
+        let trim_dir = self.wake_dir.as_ref().and_then(|dir| dir.parent()).map(|state| state.join("trim"));
+        std::thread::spawn(move || {
+            if let Some(dir) = trim_dir {
+                request_trim(&dir, &groups);
+            }
+            for name in groups {
+                // EAGAIN just means less than asked for could be reclaimed
+                let _ = std::fs::write(root.join(&name).join("memory.reclaim"), RECLAIM_PER_GROUP);
+            }
+        });
+    }
+
+    /// Least recently used background group that may be killed: not in the
+    /// foreground, not playing audio and not holding a wake reason
+    pub fn kill_candidate(&self) -> Option<String> {
+        self.background_lru()
+            .into_iter()
+            .find(|name| !self.audible.contains(name) && !self.has_wake_reason(name))
+    }
+
+    /// Kill every process of a group (false when cgroups are disabled)
+    fn kill_processes(&self, name: &str) -> bool {
+        let Some(root) = self.root.as_ref() else { return false };
+        let dir = root.join(name);
+        // cgroup.kill (5.14+) also takes out frozen tasks; SIGKILL per pid otherwise
+        if std::fs::write(dir.join("cgroup.kill"), "1").is_err() {
+            if let Ok(procs) = std::fs::read_to_string(dir.join("cgroup.procs")) {
+                for pid in procs.lines().filter_map(|l| l.trim().parse::<i32>().ok()) {
+                    unsafe { libc::kill(pid, libc::SIGKILL); }
+                }
+            }
+            let _ = std::fs::write(dir.join("cgroup.freeze"), "0");
+        }
+        true
+    }
+
+    /// Kill every process of a group and remember it for cold relaunch
+    pub fn kill_group(&mut self, name: &str, title: String) {
+        if !self.kill_processes(name) {
+            return;
+        }
+        tracing::warn!("Memory pressure: killed background app group '{}'", name);
+
+        self.groups.remove(name);
+        self.visible.retain(|v| v != name);
+        if let Some((app_id, exec)) = launch_of_group(name) {
+            self.killed.retain(|k| k.group != name);
+            self.killed.push(KilledApp { group: name.to_string(), app_id, exec, title });
+        }
+    }
+
+    /// Apps killed under memory pressure, oldest first
+    pub fn killed_apps(&self) -> &[KilledApp] {
+        &self.killed
+    }
+
+    /// Remove a killed app (it is being relaunched)
+    pub fn take_killed(&mut self, index: usize) -> Option<KilledApp> {
+        if index < self.killed.len() { Some(self.killed.remove(index)) } else { None }
+    }
+
+    /// Prepare the group of an app about to be prelaunched: lowest tier and
+    /// capped memory, so it only uses what the foreground leaves over
+    pub fn start_prelaunch(&mut self, app_id: &str) {
+        let name = group_name(app_id);
+        let Some(root) = self.root.as_ref() else { return };
+        if prepare_group(app_id).is_none() {
+            return;
+        }
+        let _ = std::fs::write(root.join(&name).join("memory.high"), PRELAUNCH_MEMORY_HIGH);
+        self.set_tier(&name, Tier::Prelaunch);
+    }
+
+    /// Park a prelaunched app once it has drawn its first frame
+    pub fn suspend_prelaunch(&mut self, name: &str) {
+        self.freeze(name);
+    }
+
+    /// A prelaunched app is being shown: lift its limits and thaw it
+    pub fn end_prelaunch(&mut self, name: &str) {
+        let Some(root) = self.root.as_ref() else { return };
+        let _ = std::fs::write(root.join(name).join("memory.high"), "max");
+        self.thaw(name);
+        self.set_tier(name, Tier::Recent);
+    }
+
+    /// Kill a prelaunched app that is no longer wanted (no switcher card)
+    pub fn cancel_prelaunch(&mut self, name: &str) {
+        if self.kill_processes(name) {
+            tracing::info!("Cancelled prelaunched app group '{}'", name);
+            self.groups.remove(name);
+        }
+    }
+
+    /// Put a Flick daemon into a services group
+    ///
+    /// Daemons started by an app's run script are always moved out of the
+    /// app. Batch daemons (`clamp`) are also collected from wherever
+    /// start.sh left them, except systemd units, which set CPUWeight/IOWeight
+    /// in their unit file instead.
+    pub fn adopt_service(&mut self, pid: u32, clamp: bool) {
+        let Some(root) = self.root.as_ref() else { return };
+        if self.rel_root.is_empty() {
+            return;
+        }
+        let Ok(content) = std::fs::read_to_string(format!("/proc/{}/cgroup", pid)) else { return };
+        let target = if clamp { SERVICES_GROUP } else { SYSTEM_SERVICES_GROUP };
+        let move_it = match parse_proc_cgroup(&content, &self.rel_root) {
+            Some(group) => group != SERVICES_GROUP && group != SYSTEM_SERVICES_GROUP,
+            None => clamp && content.lines()
+                .find_map(|line| line.strip_prefix("0::"))
+                .map(|path| !path.ends_with(".service"))
+                .unwrap_or(false),
+        };
+        if !move_it {
+            return;
+        }
+        let dir = root.join(target);
+        let _ = std::fs::create_dir_all(&dir);
+        match std::fs::write(dir.join("cgroup.procs"), pid.to_string()) {
+            Ok(()) => {
+                tracing::info!("Moved service pid {} to the {} group", pid, target);
+                self.pid_groups.remove(&pid);
+            }
+            Err(e) => tracing::debug!("Could not move service pid {}: {}", pid, e),
+        }
+        self.set_tier(target, if clamp { Tier::Background } else { Tier::Recent });
+    }
+
+    /// Remove groups whose processes have all exited
+    fn sweep_empty_groups(&mut self) {
+        let Some(root) = self.root.clone() else { return };
+        let Ok(entries) = std::fs::read_dir(&root) else { return };
+        for entry in entries.flatten() {
+            let path = entry.path();
+            if !path.is_dir() {
+                continue;
+            }
+            let populated = std::fs::read_to_string(path.join("cgroup.events"))
+                .map(|events| events.lines().any(|l| l == "populated 1"))
+                .unwrap_or(true);
+            if !populated && std::fs::remove_dir(&path).is_ok() {
+                let name = entry.file_name().to_string_lossy().into_owned();
+                tracing::debug!("Removed empty app group '{}'", name);
+                self.groups.remove(&name);
+            }
+        }
+    }
+
+    fn thaw_all_on_disk(&mut self) {
+        let Some(root) = self.root.clone() else { return };
+        if let Ok(entries) = std::fs::read_dir(&root) {
+            for entry in entries.flatten() {
+                if entry.path().is_dir() {
+                    let _ = std::fs::write(entry.path().join("cgroup.freeze"), "0");
+                }
+            }
+        }
+        self.sweep_empty_groups();
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_group_names() {
+        assert_eq!(group_name("weather"), "weather");
+        assert_eq!(group_name("org.gnome/Foo bar"), "org.gnome_Foo_bar");
+        assert_eq!(group_name(".."), "app");
+        assert_eq!(group_name_for_exec(r#"sh -c "$HOME/Flick/apps/settings/run_settings.sh""#), "settings");
+        assert_eq!(group_name_for_exec("env GDK_SCALE=2 /usr/bin/foot %u"), "foot");
+    }
+
+    #[test]
+    fn test_parse_proc_cgroup() {
+        let content = "1:name=systemd:/\n0::/flick-apps/weather\n";
+        assert_eq!(parse_proc_cgroup(content, "/flick-apps"), Some("weather".to_string()));
+        assert_eq!(parse_proc_cgroup("0::/user.slice/foo\n", "/flick-apps"), None);
+        assert_eq!(parse_proc_cgroup("0::/flick-apps-old/x\n", "/flick-apps"), None);
+    }
+
+    #[test]
+    fn test_parse_playing_pids() {
+        let output = "Sink Input #1\n\tCorked: no\n\tProperties:\n\t\tapplication.process.id = \"100\"\n\
+                      Sink Input #2\n\tCorked: yes\n\tProperties:\n\t\tapplication.process.id = \"200\"\n";
+        let pids = parse_playing_pids(output);
+        assert!(pids.contains(&100));
+        assert!(!pids.contains(&200));
+    }
+
+    #[test]
+    fn test_freeze_after_grace_and_thaw_on_focus() {
+        let root = std::env::temp_dir().join(format!("flick-cgroups-{}", std::process::id()));
+        std::fs::create_dir_all(root.join("music")).unwrap();
+        let freeze_file = root.join("music/cgroup.freeze");
+        std::fs::write(&freeze_file, "0").unwrap();
+
+        let mut cgroups = AppCgroups::with_root(Some(root.clone()), None);
+        cgroups.pid_groups.insert(42, Some("music".to_string()));
+        // No sink inputs: the probe answers immediately with nothing playing
+        let (tx, rx) = mpsc::channel();
+        tx.send(HashSet::new()).unwrap();
+
+        cgroups.update(Some(42), &[42], false);
+        assert!(cgroups.groups["music"].freeze_at.is_none());
+        assert_eq!(cgroups.groups["music"].tier, Some(Tier::Foreground));
+
+        // Backgrounded: normal priority, freeze is scheduled, not immediate
+        cgroups.update(None, &[42], false);
+        assert_eq!(std::fs::read_to_string(&freeze_file).unwrap(), "0");
+        assert_eq!(std::fs::read_to_string(root.join("music/cpu.weight")).unwrap(), "100");
+        cgroups.groups.get_mut("music").unwrap().freeze_at = Some(Instant::now());
+        cgroups.audio_probe = Some(rx);
+        cgroups.update(None, &[42], false);
+        assert_eq!(std::fs::read_to_string(&freeze_file).unwrap(), "1");
+
+        // Refocus thaws and boosts synchronously
+        cgroups.focus_pid(42);
+        assert_eq!(std::fs::read_to_string(&freeze_file).unwrap(), "0");
+        assert_eq!(std::fs::read_to_string(root.join("music/cpu.weight")).unwrap(), "400");
+        assert_eq!(std::fs::read_to_string(root.join("music/cpu.uclamp.max")).unwrap(), "max");
+        let _ = std::fs::remove_dir_all(root);
+    }
+
+    #[test]
+    fn test_kill_candidate_is_lru_background() {
+        let mut cgroups = AppCgroups::with_root(Some(PathBuf::from("/nonexistent")), None);
+        let now = Instant::now();
+        for (name, age) in [("maps", 30), ("music", 60), ("notes", 10), ("weather", 5)] {
+            cgroups.groups.insert(name.to_string(), AppGroup {
+                last_used: Some(now - Duration::from_secs(age)),
+                ..Default::default()
+            });
+        }
+        cgroups.visible = ["maps", "music", "notes", "weather"].iter().map(|s| s.to_string()).collect();
+        cgroups.foreground = Some("weather".to_string());
+        assert_eq!(cgroups.background_lru(), vec!["music", "maps", "notes"]);
+        // Playing audio protects the oldest app
+        cgroups.audible.insert("music".to_string());
+        assert_eq!(cgroups.kill_candidate().as_deref(), Some("maps"));
+    }
+
+    #[test]
+    fn test_request_trim() {
+        let state = std::env::temp_dir().join(format!("flick-trim-{}", std::process::id()));
+        std::fs::create_dir_all(&state).unwrap();
+        request_trim(&state.join("trim"), &["maps".to_string(), "music".to_string()]);
+        let written: u64 = std::fs::read_to_string(state.join("trim/maps")).unwrap().parse().unwrap();
+        assert!(written > 0);
+        assert!(state.join("trim/music").exists());
+        let _ = std::fs::remove_dir_all(state);
+    }
+}
@@ -0,0 +1,137 @@
+//! Pre-rendered gesture destinations for the hwcomposer renderer
+//!
+//! In App view only the app window is drawn, so the first frames of a swipe
+//! to home or to the switcher used to be the first time the destination was
+//! rendered at all: a full software Slint frame plus a readback of every
+//! visible switcher preview, on the frame the finger started moving.
+//!
+//! While an app is shown and nothing is touched, the renderer keeps a
+//! texture of each destination, drawn by an offscreen Slint shell (the live
+//! one keeps its view) and re-rendered only when the content it was drawn
+//! from changes, at most once per REFRESH_INTERVAL. The clock is not part of
+//! that content. Gestures composite those textures; the live view takes over
+//! when the gesture commits.
+//!
+//! Content keys are `slint_ui::row_key` hashes. App previews change with
+//! every commit of the app in front, so they do not count as a change until
+//! they have held still for PREVIEW_SETTLE: a playing video leaves the
+//! switcher snapshot alone instead of having it rendered and read back at
+//! every refresh.
+
+use std::time::{Duration, Instant};
+
+/// Refreshes are spaced at least this far apart
+const REFRESH_INTERVAL: Duration = Duration::from_secs(2);
+/// Changed previews are re-rendered once they stop changing for this long
+const PREVIEW_SETTLE: Duration = Duration::from_secs(1);
+
+/// A destination view rendered ahead of time into a texture
+#[derive(Debug, Default)]
+pub struct Snapshot {
+    pub texture_id: u32,
+    /// Frame size it was rendered for
+    size: (u32, u32),
+    /// Content key it was rendered from
+    key: Option<u64>,
+    /// Preview key it was rendered with
+    previews: Option<u64>,
+    /// Differing preview key first seen, and when
+    settling: Option<(u64, Instant)>,
+}
+
+impl Snapshot {
+    /// Whether the snapshot can stand in for the view in a frame of this size
+    pub fn ready(&self, size: (u32, u32)) -> bool {
+        self.texture_id != 0 && self.size == size
+    }
+
+    /// Whether the snapshot was rendered from content with this key
+    pub fn is_current(&self, key: u64) -> bool {
+        self.key == Some(key)
+    }
+
+    /// Whether previews that differ from the rendered ones have been
+    /// unchanged for PREVIEW_SETTLE
+    pub fn previews_settled(&mut self, previews: u64, now: Instant) -> bool {
+        if self.previews == Some(previews) {
+            self.settling = None;
+            return false;
+        }
+        match self.settling {
+            Some((key, since)) if key == previews => now.duration_since(since) >= PREVIEW_SETTLE,
+            _ => {
+                self.settling = Some((previews, now));
+                false
+            }
+        }
+    }
+
+    pub fn stored(&mut self, texture_id: u32, size: (u32, u32), key: u64, previews: u64) {
+        self.texture_id = texture_id;
+        self.size = size;
+        self.key = Some(key);
+        self.previews = Some(previews);
+        self.settling = None;
+    }
+}
+
+#[derive(Debug, Default)]
+pub struct GestureSnapshots {
+    /// Slint home screen (the QML home window keeps its own texture)
+    pub home: Snapshot,
+    pub switcher: Snapshot,
+    last_refresh: Option<Instant>,
+}
+
+impl GestureSnapshots {
+    /// Whether a refresh may run now
+    pub fn may_refresh(&self, now: Instant) -> bool {
+        self.last_refresh.map_or(true, |last| now.duration_since(last) >= REFRESH_INTERVAL)
+    }
+
+    pub fn refreshed(&mut self, now: Instant) {
+        self.last_refresh = Some(now);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_refresh_spacing() {
+        let mut snapshots = GestureSnapshots::default();
+        let now = Instant::now();
+        assert!(snapshots.may_refresh(now));
+        snapshots.refreshed(now);
+        assert!(!snapshots.may_refresh(now + Duration::from_millis(500)));
+        assert!(snapshots.may_refresh(now + REFRESH_INTERVAL));
+    }
+
+    #[test]
+    fn test_snapshot_ready_for_its_size_only() {
+        let mut snapshot = Snapshot::default();
+        assert!(!snapshot.ready((720, 1440)));
+        snapshot.stored(7, (720, 1440), 3, 0);
+        assert!(snapshot.ready((720, 1440)));
+        assert!(!snapshot.ready((1440, 720)));
+        assert!(snapshot.is_current(3));
+        assert!(!snapshot.is_current(4));
+    }
+
+    #[test]
+    fn test_previews_count_once_settled() {
+        let mut snapshot = Snapshot::default();
+        snapshot.stored(7, (720, 1440), 3, 10);
+        let now = Instant::now();
+        assert!(!snapshot.previews_settled(10, now));
+
+        // A preview changing at every check never settles
+        for (i, previews) in (11..15).enumerate() {
+            assert!(!snapshot.previews_settled(previews, now + PREVIEW_SETTLE * i as u32));
+        }
+        assert!(snapshot.previews_settled(14, now + PREVIEW_SETTLE * 4));
+        snapshot.stored(7, (720, 1440), 3, 14);
+        assert!(!snapshot.previews_settled(14, now + PREVIEW_SETTLE * 10));
+    }
+}
@@ -28,17 +28,15 @@ use smithay::{
             dmabuf::Dmabuf,
             Buffer, Format, Fourcc, Modifier,
         },
-        input::InputEvent,
-        libinput::{LibinputInputBackend, LibinputSessionInterface},
         session::{
             libseat::LibSeatSession,
             Event as SessionEvent, Session,
         },
     },
+    desktop::Window,
     output::{Mode, Output, PhysicalProperties, Subpixel},
     reexports::{
         calloop::{EventLoop, timer::{Timer, TimeoutAction}},
-        input::Libinput,
         wayland_server::{Display, Resource},
     },
     utils::Transform,
@@ -48,6 +46,9 @@ use smithay::{
     xwayland::{XWayland, XWaylandEvent, xwm::X11Wm},
 };
 
+use super::input_thread::{self, InputEvent};
+use super::render_list::{self, RenderList, Role};
+use super::gesture_snapshots::GestureSnapshots;
 use crate::state::Flick;
 use crate::shell::ShellView;
 use smithay::input::keyboard::FilterResult;
@@ -218,6 +219,12 @@ struct HwcDisplay {
     egl_destroy_image: Option<EglDestroyImageKHR>,
     /// GL extension: bind EGL image to texture
     gl_egl_image_target_texture_2d: Option<GlEGLImageTargetTexture2DOES>,
+    /// Windows to draw, rebuilt only when the scene changes
+    render_list: RenderList,
+    /// Home and switcher pre-rendered for gestures out of an app
+    snapshots: GestureSnapshots,
+    /// Offscreen Slint shell the snapshots are drawn with, created on first use
+    snapshot_ui: Option<crate::shell::slint_ui::SlintShell>,
 }
 
 impl Drop for HwcDisplay {
@@ -459,26 +466,24 @@ fn init_hwc_display(_output: &Output) -> Result<HwcDisplay> {
         egl_create_image,
         egl_destroy_image,
         gl_egl_image_target_texture_2d,
+        render_list: RenderList::default(),
+        snapshots: GestureSnapshots::default(),
+        snapshot_ui: None,
     })
 }
 
-/// Handle input events from libinput
+/// Handle input events from the input thread
 fn handle_input_event(
     state: &mut Flick,
-    event: InputEvent<LibinputInputBackend>,
-    _session: &Rc<RefCell<LibSeatSession>>,
+    event: InputEvent,
     modifiers: &Rc<RefCell<ModifierState>>,
 ) {
-    use smithay::backend::input::{
-        Event, KeyboardKeyEvent, PointerMotionEvent, PointerButtonEvent,
-    };
     use smithay::input::keyboard::FilterResult;
 
     // Log all input events (brief)
     info!("INPUT EVENT: {:?}", std::mem::discriminant(&event));
     match &event {
         InputEvent::DeviceAdded { device } => {
-            use smithay::backend::input::Device;
             info!("INPUT: DeviceAdded: {:?}", device.name());
         }
         InputEvent::DeviceRemoved { device } => {
@@ -488,7 +493,6 @@ fn handle_input_event(
         InputEvent::TouchUp { .. } => info!("INPUT: TouchUp"),
         InputEvent::TouchMotion { .. } => {} // too spammy
         InputEvent::Keyboard { ref event } => {
-            use smithay::backend::input::KeyboardKeyEvent;
             info!("INPUT: Keyboard key={} state={:?}", event.key_code().raw(), event.state());
         }
         _ => {}
@@ -579,7 +583,7 @@ fn handle_input_event(
                     } else {
                         // Lock the screen and blank display
                         info!("Power button pressed, locking screen");
-                        state.shell.lock();
+                        state.lock_session();
                         state.shell.lock_screen_dimmed = true;
                         state.shell.display_blanked = true;
                         // Launch lock screen app
@@ -611,8 +615,6 @@ fn handle_input_event(
         }
 
         InputEvent::PointerMotion { event } => {
-            use smithay::backend::input::PointerMotionEvent;
-
             let delta = event.delta();
             debug!("Pointer motion: delta=({}, {})", delta.x, delta.y);
 
@@ -661,7 +663,6 @@ fn handle_input_event(
         }
 
         InputEvent::TouchDown { event } => {
-            use smithay::backend::input::{TouchEvent, AbsolutePositionEvent};
             use smithay::utils::Point;
 
             let slot_id: i32 = event.slot().into();
@@ -672,6 +673,11 @@ fn handle_input_event(
             // Update last activity time for auto-lock
             state.last_activity = std::time::Instant::now();
 
+            // A tap is usually followed by a UI sound: resume audio now
+            if !state.shell.display_blanked {
+                state.system.warm_audio();
+            }
+
             // If lock screen is active, handle touch
             if state.shell.lock_screen_active {
                 if state.shell.display_blanked || state.shell.lock_screen_dimmed {
@@ -716,8 +722,10 @@ fn handle_input_event(
                 state.shell.start_context_menu_tracking(touch_pos, slot_id);
             }
 
-            // Forward to gesture recognizer
-            if let Some(gesture_event) = state.gesture_recognizer.touch_down(slot_id, touch_pos) {
+            // Forward to gesture recognizer (edge bindings only apply to app windows)
+            state.gesture_recognizer.edge_bindings_enabled =
+                state.shell.view == crate::shell::ShellView::App && !state.shell.lock_screen_active;
+            if let Some(gesture_event) = state.gesture_recognizer.touch_down(slot_id, touch_pos, event.time_usec()) {
                 debug!("Gesture touch_down: {:?}", gesture_event);
 
                 // Handle edge swipe start for quick settings, app switcher, and home/close gestures
@@ -1038,7 +1046,6 @@ fn handle_input_event(
         }
 
         InputEvent::TouchMotion { event } => {
-            use smithay::backend::input::{TouchEvent, AbsolutePositionEvent};
             use smithay::utils::Point;
 
             let slot_id: i32 = event.slot().into();
@@ -1058,7 +1065,7 @@ fn handle_input_event(
             }
 
             // Forward to gesture recognizer
-            if let Some(gesture_event) = state.gesture_recognizer.touch_motion(slot_id, touch_pos) {
+            if let Some(gesture_event) = state.gesture_recognizer.touch_motion(slot_id, touch_pos, event.time_usec()) {
                 debug!("Gesture touch_motion: {:?}", gesture_event);
 
                 // Handle edge swipe start (when PotentialEdgeSwipe activates after min drag distance)
@@ -1316,8 +1323,8 @@ fn handle_input_event(
                             let delta_x = last_x - touch_pos.x;
                             state.shell.switcher_scroll += delta_x;
 
-                            // Clamp scroll to valid range
-                            let num_windows = state.space.elements().count();
+                            // Clamp scroll to valid range (killed-app cards included)
+                            let num_windows = state.switcher_card_count();
                             let screen_w = state.screen_size.w as f64;
                             let card_width = screen_w * 0.80;
                             let card_spacing = card_width * 0.35;
@@ -1369,8 +1376,6 @@ fn handle_input_event(
         }
 
         InputEvent::TouchUp { event } => {
-            use smithay::backend::input::TouchEvent;
-
             let slot_id: i32 = event.slot().into();
 
             // Get last touch position
@@ -1512,7 +1517,7 @@ fn handle_input_event(
             let mut switcher_opened_by_gesture = false;
 
             // Forward to gesture recognizer
-            if let Some(gesture_event) = state.gesture_recognizer.touch_up(slot_id) {
+            if let Some(gesture_event) = state.gesture_recognizer.touch_up(slot_id, event.time_usec()) {
                 debug!("Gesture touch_up: {:?}", gesture_event);
 
                 // Handle edge swipe completion
@@ -1582,6 +1587,9 @@ fn handle_input_event(
                 }
             }
 
+            // Deliver a completed bound edge swipe to the focused client
+            state.dispatch_edge_binding();
+
             // Check if QML lockscreen is connected
             let has_wayland_window = state.space.elements().count() > 0;
             let shell_view = state.shell.view;
@@ -1729,6 +1737,7 @@ fn handle_input_event(
                                 // Process keyboard actions
                                 for action in actions {
                                     state.system.haptic_tap();
+                                    state.system.play_key_click();
                                     info!("Home KB ACTION: {:?}", action);
                                     match action {
                                         KeyboardAction::Character(ch) => {
@@ -1938,12 +1947,8 @@ fn handle_input_event(
                                 info!("Launching app from home touch: {} ({})", app_id, exec);
                                 // Haptic feedback on app launch
                                 state.system.haptic_tap();
-                                // Get socket name for WAYLAND_DISPLAY
-                                let socket_name = state.socket_name.to_str().unwrap_or("wayland-1");
-                                // Get text scale for app scaling
-                                let text_scale = state.shell.text_scale as f64;
                                 // Launch app with logging to ~/.local/share/flick/logs/<app_id>/
-                                if let Err(e) = crate::spawn_user::spawn_app_with_logging(&exec, &app_id, socket_name, text_scale) {
+                                if let Err(e) = state.launch_app(&app_id, &exec) {
                                     error!("Failed to launch app: {}", e);
                                 }
 
@@ -2049,7 +2054,7 @@ fn handle_input_event(
                                         }
                                         QuickSettingsAction::Lock => {
                                             info!("Lock button pressed - locking screen");
-                                            state.shell.lock();
+                                            state.lock_session();
                                             if let Some(socket) = state.socket_name.to_str() {
                                                 state.shell.launch_lock_screen_app(socket);
                                             }
@@ -2058,10 +2063,8 @@ fn handle_input_event(
                                             info!("Settings button pressed - launching settings app");
                                             if let Some(exec) = state.shell.app_manager.get_exec("settings") {
                                                 state.shell.set_view(crate::shell::ShellView::App);
-                                                let socket_name = state.socket_name.to_str().unwrap_or("wayland-1");
-                                                let text_scale = state.shell.text_scale as f64;
                                                 // Launch with logging
-                                                if let Err(e) = crate::spawn_user::spawn_app_with_logging(&exec, "settings", socket_name, text_scale) {
+                                                if let Err(e) = state.launch_app("settings", &exec) {
                                                     error!("Failed to launch settings app: {}", e);
                                                 }
                                             }
@@ -2099,7 +2102,7 @@ fn handle_input_event(
                                 let card_height = screen_h * 0.55;
                                 let card_spacing = card_width * 0.35;
                                 let scroll = state.shell.switcher_scroll;
-                                let num_windows = state.space.elements().count();
+                                let num_windows = state.switcher_card_count();
 
                                 // Card area starts at y=60px, ends at screen_h - 40px
                                 let card_area_top = 60.0;
@@ -2143,7 +2146,13 @@ fn handle_input_event(
                                         if tapped_window.is_some() { break; }
                                     }
 
-                                    if let Some(window_id) = tapped_window {
+                                    // Cards past the live windows are apps killed under memory pressure
+                                    let tapped_killed = tapped_window
+                                        .and_then(|idx| idx.checked_sub(state.space.elements().count()));
+                                    if let Some(killed_index) = tapped_killed {
+                                        info!("Switcher tap: relaunching killed app card {}", killed_index);
+                                        state.relaunch_killed_app(killed_index);
+                                    } else if let Some(window_id) = tapped_window {
                                         info!("Switcher tap: tapped window index {} at ({}, {})", window_id, pos.x, pos.y);
 
                                         // Cancel any pending touch sequences before switching apps
@@ -2169,6 +2178,7 @@ fn handle_input_event(
                                             // Raise window to top of stacking order
                                             info!("Raising window {} to top", window_id);
                                             state.space.raise_element(window, true);
+                                            state.scene_changed();
 
                                             // Set as active window for touch input
                                             state.active_window = Some(window.clone());
@@ -2248,8 +2258,9 @@ fn handle_input_event(
 
                                 // Process keyboard actions (after dropping slint_ui borrow)
                                 for action in actions {
-                                    // Trigger haptic feedback for key presses
+                                    // Trigger haptic and sound feedback for key presses
                                     state.system.haptic_tap();
+                                    state.system.play_key_click();
                                     info!("KB ACTION: {:?}", action);
                                     match action {
                                         KeyboardAction::Character(ch) => {
@@ -2511,19 +2522,9 @@ pub fn run() -> Result<()> {
     let session = Rc::new(RefCell::new(session));
     info!("Session created, seat: {}", session.borrow().seat());
 
-    // Initialize libinput
-    let libinput_session = LibinputSessionInterface::from(session.borrow().clone());
-    let mut libinput_context = Libinput::new_with_udev(libinput_session);
-    info!("Libinput context created with udev");
-    libinput_context.udev_assign_seat(&session.borrow().seat()).unwrap();
-    info!("Libinput seat assigned: {}", session.borrow().seat());
-
-    // Initial dispatch to pick up devices
-    libinput_context.dispatch().unwrap();
-    info!("Libinput dispatched initially");
-
-    let libinput_backend = LibinputInputBackend::new(libinput_context.clone());
-    info!("Libinput backend created");
+    // Start libinput on its own thread (see input_thread.rs)
+    let input_channel = input_thread::spawn(session.borrow().seat())?;
+    info!("Input thread started");
 
     // Create Wayland display
     let display: Display<Flick> = Display::new()?;
@@ -2709,6 +2710,10 @@ pub fn run() -> Result<()> {
         slint_ui.set_size(state.screen_size);
     }
 
+    // After a supervised restart: unlocked sessions skip the lock screen,
+    // open apps are relaunched
+    state.restore_session();
+
     // Launch QML lock screen app if configured
     if state.shell.lock_screen_active {
         info!("Lock screen active - launching QML lock screen app");
@@ -2741,13 +2746,20 @@ pub fn run() -> Result<()> {
         })
         .map_err(|e| anyhow::anyhow!("Failed to insert session source: {:?}", e))?;
 
-    // Add libinput to event loop
-    let session_for_input = session.clone();
-    let modifiers_for_input = modifiers.clone();
+    // Queue input batches from the input thread; they are coalesced and
+    // handled once per loop iteration right after calloop dispatch
+    let pending_input: Rc<RefCell<Vec<InputEvent>>> = Rc::new(RefCell::new(Vec::new()));
+    let pending_input_for_channel = pending_input.clone();
+    let mut input_latency = input_thread::InputLatency::default();
 
     loop_handle
-        .insert_source(libinput_backend, move |event, _, state| {
-            handle_input_event(state, event, &session_for_input, &modifiers_for_input);
+        .insert_source(input_channel, move |event, _, _state| match event {
+            smithay::reexports::calloop::channel::Event::Msg(batch) => {
+                pending_input_for_channel.borrow_mut().extend(batch);
+            }
+            smithay::reexports::calloop::channel::Event::Closed => {
+                error!("Input thread stopped - no further input");
+            }
         })
         .map_err(|e| anyhow::anyhow!("Failed to insert input source: {:?}", e))?;
 
@@ -2773,6 +2785,7 @@ pub fn run() -> Result<()> {
     // Main event loop
     let mut loop_count: u64 = 0;
     let mut was_blanked = false; // Track previous blanked state for unblank transitions
+    let mut deferred_programs_warmed = false; // Effect shaders built after first frame
     loop {
         loop_count += 1;
         let log_loop = loop_count % 1000 == 0;
@@ -2789,6 +2802,21 @@ pub fn run() -> Result<()> {
         // Reload settings from config file (for Settings app changes)
         state.reload_settings_if_needed();
 
+        // Freeze backgrounded apps, thaw focused / switcher-visible ones
+        state.update_app_cgroups();
+
+        // Trim or kill background apps under PSI memory pressure
+        state.handle_memory_pressure();
+
+        // Claim/release the accelerometer and commit settled rotations
+        state.update_auto_rotation();
+
+        // Start, park or cancel apps predicted by flick-app-service
+        state.update_prelaunch();
+
+        // Keep the supervisor's copy of the session current
+        state.update_session_snapshot();
+
         // Check for unlock signal from external lock screen app (QML lockscreen)
         if state.shell.check_unlock_signal() {
             info!("=== UNLOCK SIGNAL DETECTED (hwcomposer) ===");
@@ -2816,21 +2844,13 @@ pub fn run() -> Result<()> {
             } else if let Some(app_cmd) = state.shell.unlock_open_app.take() {
                 // Check if we need to launch an app after unlock (from notification tap)
                 // Try to extract app_id from command, fallback to "notification_app"
-                let app_id = if app_cmd.contains("/apps/") {
-                    app_cmd.split("/apps/").nth(1)
-                        .and_then(|s| s.split('/').next())
-                        .unwrap_or("notification_app")
-                } else {
-                    "notification_app"
-                };
+                let app_id = crate::prelaunch::app_id_from_exec(&app_cmd).unwrap_or("notification_app");
                 info!("Launching app after unlock: {} ({})", app_id, app_cmd);
-                state.shell.unlock_app_launched = true; // Allow new window to switch to App view
-                if let Some(socket) = state.socket_name.to_str() {
-                    let text_scale = state.shell.text_scale as f64;
-                    if let Err(e) = crate::spawn_user::spawn_app_with_logging(&app_cmd, app_id, socket, text_scale) {
-                        error!("Failed to launch app after unlock: {}", e);
-                        state.shell.unlock_app_launched = false; // Reset on failure
-                    }
+                match state.launch_app(app_id, &app_cmd) {
+                    Ok(true) => state.shell.set_view(crate::shell::ShellView::App),
+                    // Allow the new window to switch to App view
+                    Ok(false) => state.shell.unlock_app_launched = true,
+                    Err(e) => error!("Failed to launch app after unlock: {}", e),
                 }
             }
         }
@@ -2841,7 +2861,7 @@ pub fn run() -> Result<()> {
             let timeout = Duration::from_secs(state.shell.screen_timeout_secs);
             if idle_duration >= timeout {
                 info!("Auto-lock triggered after {:?} idle (timeout={}s)", idle_duration, state.shell.screen_timeout_secs);
-                state.shell.lock();
+                state.lock_session();
                 if let Some(socket) = state.socket_name.to_str() {
                     state.shell.launch_lock_screen_app(socket);
                 }
@@ -2862,21 +2882,11 @@ pub fn run() -> Result<()> {
             state.system.haptic_click();
 
             // Extract app_id from command for logging purposes
-            let app_id = if exec_cmd.contains("/apps/") {
-                exec_cmd.split("/apps/").nth(1)
-                    .and_then(|s| s.split('/').next())
-                    .unwrap_or("qml_home_app")
-            } else {
-                "qml_home_app"
-            };
-            if let Some(socket) = state.socket_name.to_str() {
-                let text_scale = state.shell.text_scale as f64;
-                if let Err(e) = crate::spawn_user::spawn_app_with_logging(&exec_cmd, app_id, socket, text_scale) {
-                    error!("Failed to launch app from QML home: {}", e);
-                } else {
-                    // Switch to App view after launching
-                    state.shell.set_view(crate::shell::ShellView::App);
-                }
+            let app_id = crate::prelaunch::app_id_from_exec(&exec_cmd).unwrap_or("qml_home_app");
+            match state.launch_app(app_id, &exec_cmd) {
+                // Switch to App view after launching
+                Ok(_) => state.shell.set_view(crate::shell::ShellView::App),
+                Err(e) => error!("Failed to launch app from QML home: {}", e),
             }
         }
 
@@ -2890,6 +2900,20 @@ pub fn run() -> Result<()> {
 
         debug!("Loop {}: after calloop dispatch", loop_count);
 
+        // Handle input from the input thread, keeping only the latest motion per finger
+        let input_batch = std::mem::take(&mut *pending_input.borrow_mut());
+        let rotation = *state.auto_rotation.current();
+        for mut event in input_thread::coalesce(input_batch) {
+            input_latency.record(&event);
+            // Touch is reported on the panel; clients and gestures are laid out rotated
+            if rotation.is_rotated() {
+                if let InputEvent::TouchDown { event: ref mut touch } | InputEvent::TouchMotion { event: ref mut touch } = event {
+                    touch.map_position(|x, y| rotation.to_logical(x, y));
+                }
+            }
+            handle_input_event(&mut state, event, &modifiers);
+        }
+
         // Check for long press to show context menu (copy/paste) - runs every frame
         // This takes priority over wiggle mode
         let edge_gesture_active = state.switcher_gesture_active || state.qs_gesture_active ||
@@ -3116,12 +3140,10 @@ pub fn run() -> Result<()> {
             if !state.shell.lock_screen_active {
                 tracing::info!("Incoming call while unlocked - launching phone app");
                 state.shell.set_view(crate::shell::ShellView::App);
-                let text_scale = state.shell.text_scale;
-                if let Some(socket) = state.socket_name.to_str() {
-                    let phone_exec = r#"sh -c "$HOME/Flick/apps/phone/run_phone.sh""#;
-                    if let Err(e) = crate::spawn_user::spawn_app_with_logging(phone_exec, "phone", socket, text_scale as f64) {
-                        error!("Failed to launch phone app: {}", e);
-                    }
+                let phone_exec = r#"sh -c "$HOME/Flick/apps/phone/run_phone.sh""#;
+                // Not a user launch, so not logged for prediction
+                if let Err(e) = state.show_or_spawn_app("phone", phone_exec) {
+                    error!("Failed to launch phone app: {}", e);
                 }
             }
             // Play ringtone and vibrate for incoming call
@@ -3255,6 +3277,12 @@ pub fn run() -> Result<()> {
         }
         debug!("Loop {}: after render_frame", loop_count);
 
+        // First frame is on screen - build the deferred effect shaders as
+        // soon as their program cache reads are in (cheap when they hit)
+        if !deferred_programs_warmed {
+            deferred_programs_warmed = unsafe { gl::warm_deferred_programs() };
+        }
+
         // Send frame callbacks to Wayland clients
         state.space.elements().for_each(|window| {
             window.send_frame(
@@ -3440,6 +3468,7 @@ fn render_subsurfaces(
     parent: &smithay::reexports::wayland_server::protocol::wl_surface::WlSurface,
     parent_pos: smithay::utils::Point<i32, smithay::utils::Logical>,
     display: &mut HwcDisplay,
+    frame_size: (u32, u32),
     log_frame: bool,
     frame_num: u64,
 ) {
@@ -3496,7 +3525,7 @@ fn render_subsurfaces(
                 info!("  Subsurface[{}] RENDERING EGL texture {} ({}x{})", idx, texture_id, width, height);
             }
             unsafe {
-                gl::render_egl_texture_at(texture_id, width, height, display.width, display.height,
+                gl::render_egl_texture_at(texture_id, width, height, frame_size.0, frame_size.1,
                                           child_pos.x, child_pos.y);
             }
         } else if needs_egl {
@@ -3521,6 +3550,7 @@ fn render_subsurfaces(
                             height: imported.2,
                             egl_image: imported.3,
                         });
+                        bd.content_serial += 1;
                         bd.needs_egl_import = false;
                     }
                 });
@@ -3532,7 +3562,7 @@ fn render_subsurfaces(
 
                 unsafe {
                     gl::render_egl_texture_at(imported.0, imported.1, imported.2,
-                                              display.width, display.height, child_pos.x, child_pos.y);
+                                              frame_size.0, frame_size.1, child_pos.x, child_pos.y);
                 }
             } else if log_frame {
                 info!("  Subsurface[{}] EGL import FAILED", idx);
@@ -3554,14 +3584,349 @@ fn render_subsurfaces(
                     info!("  Subsurface[{}] RENDERING SHM {}x{}", idx, width, height);
                 }
                 unsafe {
-                    gl::render_texture_at(width, height, &pixels, display.width, display.height,
+                    gl::render_texture_at(width, height, &pixels, frame_size.0, frame_size.1,
                                           child_pos.x, child_pos.y);
                 }
             }
         }
 
         // Recursively render this child's subsurfaces
-        render_subsurfaces(child, child_pos, display, log_frame, frame_num);
+        render_subsurfaces(child, child_pos, display, frame_size, log_frame, frame_num);
+    }
+}
+
+/// Import the surface's newly committed EGL buffer if one is waiting, and
+/// return the texture it shows (None for SHM surfaces or a failed import)
+fn current_egl_texture(
+    wl_surface: &smithay::reexports::wayland_server::protocol::wl_surface::WlSurface,
+    display: &HwcDisplay,
+) -> Option<(u32, u32, u32)> {
+    use crate::state::{SurfaceBufferData, EglTextureBuffer};
+
+    // Check if we need to import EGL buffer, and get old texture for cleanup
+    let (needs_import, egl_texture_info, old_egl_texture) = compositor::with_states(wl_surface, |data| {
+        if let Some(buffer_data) = data.data_map.get::<RefCell<SurfaceBufferData>>() {
+            let bd = buffer_data.borrow();
+            let egl_info = bd.egl_texture.as_ref().map(|t| (t.texture_id, t.width, t.height));
+            let old_tex = if bd.needs_egl_import {
+                bd.egl_texture.as_ref().map(|t| (t.texture_id, t.egl_image))
+            } else {
+                None
+            };
+            (bd.needs_egl_import, egl_info, old_tex)
+        } else {
+            (false, None, None)
+        }
+    });
+    if !needs_import {
+        return egl_texture_info;
+    }
+
+    if let Some((old_tex_id, old_egl_image)) = old_egl_texture {
+        destroy_egl_texture(old_tex_id, old_egl_image, display);
+    }
+    let imported = try_import_egl_buffer(wl_surface, display)?;
+    compositor::with_states(wl_surface, |data| {
+        data.data_map.insert_if_missing(|| RefCell::new(SurfaceBufferData::default()));
+        if let Some(buffer_data) = data.data_map.get::<RefCell<SurfaceBufferData>>() {
+            let mut bd = buffer_data.borrow_mut();
+            bd.egl_texture = Some(EglTextureBuffer {
+                texture_id: imported.0,
+                width: imported.1,
+                height: imported.2,
+                egl_image: imported.3,
+            });
+            bd.content_serial += 1;
+            bd.needs_egl_import = false;
+            bd.wl_buffer_ptr = None;
+            if let Some(buffer) = bd.pending_buffer.take() {
+                buffer.release();
+            }
+        }
+    });
+    Some((imported.0, imported.1, imported.2))
+}
+
+/// Content serial of a window's surface (see `SurfaceBufferData::content_serial`),
+/// None if it has no buffer to preview
+fn preview_serial(window: &Window) -> Option<u64> {
+    use crate::state::SurfaceBufferData;
+    let toplevel = window.toplevel()?;
+    compositor::with_states(toplevel.wl_surface(), |states| {
+        let bd = states.data_map.get::<RefCell<SurfaceBufferData>>()?.borrow();
+        (bd.buffer.is_some() || bd.egl_texture.is_some()).then_some(bd.content_serial)
+    })
+}
+
+/// Capture a switcher preview from the window's SHM buffer or EGL texture
+fn capture_preview(window: &Window) -> Option<slint::Image> {
+    use crate::state::SurfaceBufferData;
+    let toplevel = window.toplevel()?;
+    compositor::with_states(toplevel.wl_surface(), |states| {
+        let bd = states.data_map.get::<RefCell<SurfaceBufferData>>()?.borrow();
+        // First try SHM buffer (software rendered apps)
+        if let Some(ref buffer) = bd.buffer {
+            let pixel_buffer = slint::SharedPixelBuffer::<slint::Rgba8Pixel>::clone_from_slice(
+                &buffer.pixels,
+                buffer.width,
+                buffer.height,
+            );
+            Some(slint::Image::from_rgba8(pixel_buffer))
+        } else if let Some(ref egl_tex) = bd.egl_texture {
+            // Try reading from EGL texture (hardware rendered apps)
+            let pixels = unsafe { gl::read_texture_pixels(egl_tex.texture_id, egl_tex.width, egl_tex.height) }?;
+            let pixel_buffer = slint::SharedPixelBuffer::<slint::Rgba8Pixel>::clone_from_slice(
+                &pixels,
+                egl_tex.width,
+                egl_tex.height,
+            );
+            Some(slint::Image::from_rgba8(pixel_buffer))
+        } else {
+            None
+        }
+    })
+}
+
+/// A switcher card: (id, title, app_class, original_index, preview_serial)
+type SwitcherRow = (i32, String, String, i32, Option<u64>);
+
+/// Switcher cards for the app windows plus killed-app placeholders, sorted
+/// by render order around `scroll` (furthest from center first, center last)
+fn switcher_rows<'a>(state: &Flick, cards: impl Iterator<Item = &'a Window>, scroll: f64) -> Vec<SwitcherRow> {
+    // Calculate visibility bounds for preview culling (performance optimization)
+    let screen_w = state.screen_size.w as f64;
+    let card_spacing = screen_w * 0.80 * 0.35;
+    let visible_margin = screen_w * 1.5;
+
+    let mut rows: Vec<SwitcherRow> = cards
+        .enumerate()
+        .map(|(i, window)| {
+            // Check if this window is visible in the fanout
+            let window_pos = (i as f64) * card_spacing - scroll;
+            let is_visible = window_pos > -visible_margin && window_pos < screen_w + visible_margin;
+
+            // Try X11 surface first, then Wayland toplevel, fall back to generic name
+            let title = if let Some(x11) = window.x11_surface() {
+                let t = x11.title();
+                if !t.is_empty() { t } else { x11.class() }
+            } else if let Some(toplevel) = window.toplevel() {
+                compositor::with_states(toplevel.wl_surface(), |states| {
+                    states
+                        .data_map
+                        .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
+                        .and_then(|data| {
+                            let data = data.lock().unwrap();
+                            let title = data.title.clone();
+                            if title.as_ref().map(|t| !t.is_empty()).unwrap_or(false) {
+                                title
+                            } else {
+                                data.app_id.clone()
+                            }
+                        })
+                }).unwrap_or_else(|| format!("Window {}", i + 1))
+            } else {
+                format!("Window {}", i + 1)
+            };
+
+            let app_class = if let Some(x11) = window.x11_surface() {
+                x11.class()
+            } else if let Some(toplevel) = window.toplevel() {
+                compositor::with_states(toplevel.wl_surface(), |states| {
+                    states
+                        .data_map
+                        .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
+                        .and_then(|data| data.lock().unwrap().app_id.clone())
+                }).unwrap_or_else(|| "app".to_string())
+            } else {
+                "app".to_string()
+            };
+
+            // Only preview visible windows (performance optimization); the serial
+            // changes with the window's content, so unchanged previews are not read back
+            let preview = if is_visible { preview_serial(window) } else { None };
+
+            (i as i32, title, app_class, i as i32, preview)
+        })
+        .collect();
+
+    // Sort by render order: furthest from center first, center last
+    // This ensures center card renders on top
+    rows.extend(state.killed_app_cards(rows.len()));
+    rows.sort_by(|a, b| {
+        let dist_a = ((a.3 as f64) * card_spacing - scroll).abs();
+        let dist_b = ((b.3 as f64) * card_spacing - scroll).abs();
+        // Reverse order: larger distance first (renders behind)
+        dist_b.partial_cmp(&dist_a).unwrap_or(std::cmp::Ordering::Equal)
+    });
+    rows
+}
+
+/// Hand the rows to the Slint switcher, reading back previews only for
+/// cards whose content changed (rows are sorted, so the window a row shows
+/// is found through its original index)
+fn set_switcher_cards<'a>(
+    slint_ui: &crate::shell::slint_ui::SlintShell,
+    cards: impl Iterator<Item = &'a Window> + Clone,
+    rows: Vec<SwitcherRow>,
+) {
+    let sources: Vec<Option<usize>> = rows.iter()
+        .map(|row| row.4.map(|_| row.3 as usize))
+        .collect();
+    slint_ui.set_switcher_windows(rows, |i| {
+        sources[i].and_then(|index| cards.clone().nth(index)).and_then(capture_preview)
+    });
+}
+
+/// Point the shared Slint window at the home screen
+fn sync_slint_home(slint_ui: &crate::shell::slint_ui::SlintShell, state: &Flick) {
+    let in_return_gesture = state.qs_return_active || state.switcher_return_active;
+    slint_ui.set_return_gesture_active(in_return_gesture);
+    slint_ui.set_view("home");
+    state.shell.sync_slint_categories();
+    slint_ui.set_show_popup(state.shell.popup_showing);
+    slint_ui.set_wiggle_mode(state.shell.wiggle_mode);
+    slint_ui.set_home_scroll(state.shell.home_scroll as f32);
+    slint_ui.set_home_push_offset(state.shell.home_push_offset as f32);
+
+    if state.shell.wiggle_mode {
+        if let Some(start) = state.shell.wiggle_start_time {
+            let elapsed = start.elapsed().as_secs_f32();
+            slint_ui.set_wiggle_time(elapsed);
+        }
+        let drag_idx = state.shell.dragging_index.map(|i| i as i32).unwrap_or(-1);
+        slint_ui.set_dragging_index(drag_idx);
+        if let Some(pos) = state.shell.drag_position {
+            slint_ui.set_drag_position(pos.x as f32, pos.y as f32);
+        }
+    }
+
+    let now = chrono::Local::now();
+    slint_ui.set_time(&now.format("%H:%M").to_string());
+    slint_ui.set_battery_percent(state.shell.quick_settings.battery_percent as i32);
+    slint_ui.set_text_scale(state.shell.text_scale);
+}
+
+/// Draw the on-screen keyboard from its cached layer texture, uploading only
+/// what Slint repainted and placing it at the current slide offset
+fn render_keyboard_layer(slint_ui: &crate::shell::slint_ui::SlintShell, frame_w: u32, frame_h: u32) {
+    let (width, height) = slint_ui.keyboard_layer_size();
+    let full = unsafe { !gl::keyboard_layer_ready(width, height) };
+    let layer = slint_ui.render_keyboard_layer(full);
+    if let Some(ref damage) = layer.damage {
+        unsafe { gl::update_keyboard_layer(layer.width, layer.height, damage) };
+    }
+    // Slint's frame is stretched over the display, so the layer is too
+    let scale = frame_h as f32 / (layer.top + layer.height) as f32;
+    let y = ((layer.top as f32 + layer.offset) * scale).round() as i32;
+    unsafe { gl::render_keyboard_layer(frame_w, frame_h, y, (layer.height as f32 * scale).round() as u32) };
+}
+
+/// Re-render a gesture destination whose content changed, one per call and
+/// at most once per refresh interval, while an app is shown and nothing is
+/// touched. The snapshots are drawn by an offscreen Slint shell, so the live
+/// one keeps its view, and this runs after the frame is presented so it
+/// never holds one back.
+fn refresh_gesture_snapshots(display: &mut HwcDisplay, state: &Flick, frame_w: u32, frame_h: u32) {
+    let Some(ref slint_ui) = state.shell.slint_ui else { return };
+    let now = std::time::Instant::now();
+    let idle = state.shell.view == ShellView::App
+        && !state.shell.lock_screen_active
+        && !state.gesture_recognizer.has_active_touches()
+        && !slint_ui.is_keyboard_visible()
+        && !state.system.should_show_volume_overlay()
+        && !state.shell.context_menu_active
+        && !state.shell.system_menu_active;
+    if !idle || !display.snapshots.may_refresh(now) {
+        return;
+    }
+    let size = (frame_w, frame_h);
+
+    // Switcher, as it would open now
+    let cards = display.render_list.windows(Role::App);
+    let scroll = state.shell.switcher_scroll;
+    let rows = switcher_rows(state, cards.clone(), scroll);
+    let layout: Vec<_> = rows.iter().map(|(id, title, class, index, _)| (id, title, class, index)).collect();
+    let key = crate::shell::slint_ui::row_key((
+        layout, scroll.to_bits(), state.shell.text_scale.to_bits(), slint_ui.wallpaper_key(), size,
+    ));
+    let previews = crate::shell::slint_ui::row_key(rows.iter().map(|row| row.4).collect::<Vec<_>>());
+    let switcher = &mut display.snapshots.switcher;
+    if !switcher.ready(size) || !switcher.is_current(key) || switcher.previews_settled(previews, now) {
+        let offscreen = snapshot_ui(&mut display.snapshot_ui, slint_ui, state);
+        offscreen.set_view("switcher");
+        offscreen.set_switcher_scroll(scroll as f32);
+        offscreen.set_switcher_enter_progress(1.0);
+        offscreen.set_switcher_push_offset(0.0);
+        // The cards are shared with the live shell, so the previews read
+        // back here are in place when the switcher opens for real
+        set_switcher_cards(offscreen, cards, rows);
+        if let Some((width, height, pixels)) = offscreen.render() {
+            let texture = unsafe { gl::store_texture(display.snapshots.switcher.texture_id, width, height, &pixels) };
+            display.snapshots.switcher.stored(texture, size, key, previews);
+        }
+        display.snapshots.refreshed(now);
+        return;
+    }
+
+    if state.shell.qml_home_launched {
+        // The QML home window is a texture already; import what it committed
+        // while hidden so a swipe home doesn't have to
+        let Some(surface) = display.render_list.find(Role::Home)
+            .and_then(|item| render_list::window_surface(&item.window)) else { return };
+        let pending = compositor::with_states(&surface, |data| {
+            data.data_map.get::<RefCell<crate::state::SurfaceBufferData>>()
+                .map(|bd| bd.borrow().needs_egl_import)
+                .unwrap_or(false)
+        });
+        if pending {
+            current_egl_texture(&surface, display);
+            display.snapshots.refreshed(now);
+        }
+        return;
+    }
+
+    // Slint home fallback (the placeholder shown until the QML home is up):
+    // it shows no clock or status, only text sized by the text scale
+    let key = crate::shell::slint_ui::row_key((state.shell.text_scale.to_bits(), size));
+    if !display.snapshots.home.is_current(key) || !display.snapshots.home.ready(size) {
+        let offscreen = snapshot_ui(&mut display.snapshot_ui, slint_ui, state);
+        offscreen.set_return_gesture_active(false);
+        offscreen.set_view("home");
+        if let Some((width, height, pixels)) = offscreen.render() {
+            let texture = unsafe { gl::store_texture(display.snapshots.home.texture_id, width, height, &pixels) };
+            display.snapshots.home.stored(texture, size, key, 0);
+        }
+        display.snapshots.refreshed(now);
+    }
+}
+
+/// The offscreen shell snapshots are drawn with, matched to the live one
+fn snapshot_ui<'a>(
+    snapshot_ui: &'a mut Option<crate::shell::slint_ui::SlintShell>,
+    slint_ui: &crate::shell::slint_ui::SlintShell,
+    state: &Flick,
+) -> &'a crate::shell::slint_ui::SlintShell {
+    let offscreen = snapshot_ui.get_or_insert_with(|| slint_ui.offscreen());
+    slint_ui.sync_offscreen(offscreen);
+    offscreen.set_text_scale(state.shell.text_scale);
+    slint::platform::update_timers_and_animations();
+    offscreen
+}
+
+/// Draw the home screen as of the last refresh, shifted by `x` pixels
+fn render_home_snapshot(display: &HwcDisplay, state: &Flick, frame_w: u32, frame_h: u32, x: i32) {
+    if state.shell.qml_home_launched {
+        let Some(surface) = display.render_list.find(Role::Home)
+            .and_then(|item| render_list::window_surface(&item.window)) else { return };
+        let texture = compositor::with_states(&surface, |data| {
+            let bd = data.data_map.get::<RefCell<crate::state::SurfaceBufferData>>()?.borrow();
+            bd.egl_texture.as_ref().map(|t| (t.texture_id, t.width, t.height))
+        });
+        if let Some((texture_id, width, height)) = texture {
+            unsafe { gl::render_egl_texture_at(texture_id, width, height, frame_w, frame_h, x, 0) };
+        }
+    } else if display.snapshots.home.ready((frame_w, frame_h)) {
+        unsafe { gl::render_texture_id_at(display.snapshots.home.texture_id, frame_w, frame_h, x, 0) };
     }
 }
 
@@ -3585,6 +3950,12 @@ fn render_frame(
         Some(display.egl_context),
     ).map_err(|e| anyhow::anyhow!("Failed to make context current: {:?}", e))?;
 
+    // Bring the render list up to date (nothing to do unless windows changed)
+    display.render_list.sync(state);
+    for texture in display.render_list.take_released() {
+        unsafe { gl::delete_texture(texture) };
+    }
+
     // Calculate effect time for animated effects (living pixels, CRT flicker)
     let effect_time = unsafe {
         if gl::EFFECT_START_TIME.is_none() {
@@ -3593,22 +3964,33 @@ fn render_frame(
         gl::EFFECT_START_TIME.unwrap().elapsed().as_secs_f32()
     };
 
+    // When auto-rotated the frame is laid out at the logical (rotated) size
+    // in the scene FBO and turned onto the panel by the final blit
+    let rotation = *state.auto_rotation.current();
+    let (frame_w, frame_h) = if rotation.is_rotated() {
+        (display.height, display.width)
+    } else {
+        (display.width, display.height)
+    };
+
     // Check if distortion effects will be active (for scene FBO rendering)
     // We need to know this early to decide whether to render to FBO or default framebuffer
     let shader_data_preview = state.touch_effects.get_shader_data(
-        display.width as f64,
-        display.height as f64,
+        frame_w as f64,
+        frame_h as f64,
         effect_time,
     );
-    // Living pixels needs rendering even with no touches, CRT mode always renders
-    let distortion_active = shader_data_preview.count > 0
-        || shader_data_preview.effect_style == 2
-        || shader_data_preview.living_pixels == 1;
+    // Living pixels needs rendering even with no touches, CRT mode always renders.
+    // Effects are skipped while rotated (their coordinates are portrait).
+    let distortion_active = !rotation.is_rotated()
+        && (shader_data_preview.count > 0
+            || shader_data_preview.effect_style == 2
+            || shader_data_preview.living_pixels == 1);
 
     // If distortion is active, render to scene FBO instead of default framebuffer
     // This avoids the tiled GPU issue of reading from the framebuffer we're writing to
-    let using_scene_fbo = if distortion_active {
-        let result = unsafe { gl::begin_scene_render(display.width as u32, display.height as u32) };
+    let using_scene_fbo = if distortion_active || rotation.is_rotated() {
+        let result = unsafe { gl::begin_scene_render(frame_w as u32, frame_h as u32) };
         if log_frame {
             let fbo_support = unsafe { gl::has_fbo_support() };
             info!("Scene FBO: active={}, fbo_support={}, result={}", distortion_active, fbo_support, result);
@@ -3621,9 +4003,7 @@ fn render_frame(
     // Set viewport to full screen (already set by begin_scene_render if using FBO)
     if !using_scene_fbo {
         unsafe {
-            if let Some(f) = gl::FN_VIEWPORT {
-                f(0, 0, display.width as i32, display.height as i32);
-            }
+            gl::set_viewport(frame_w, frame_h);
         }
     }
 
@@ -3645,7 +4025,7 @@ fn render_frame(
         }
 
         if log_frame || frame_num == 1 || frame_num == 40 || frame_num == 80 || frame_num == 120 {
-            let (sw, sh) = (display.width, display.height);
+            let (sw, sh) = (frame_w, frame_h);
             info!("Test mode frame {}: color=({:.1},{:.1},{:.1}) screen={}x{}",
                 frame_num, color[0], color[1], color[2], sw, sh);
         }
@@ -3715,36 +4095,11 @@ fn render_frame(
                     slint::platform::update_timers_and_animations();
 
                     if let Some(ref slint_ui) = state.shell.slint_ui {
-                        let in_return_gesture = state.qs_return_active || state.switcher_return_active;
-                        slint_ui.set_return_gesture_active(in_return_gesture);
-                        slint_ui.set_view("home");
-                        let slint_categories = state.shell.get_categories_with_icons();
-                        slint_ui.set_categories(slint_categories);
-                        slint_ui.set_show_popup(state.shell.popup_showing);
-                        slint_ui.set_wiggle_mode(state.shell.wiggle_mode);
-                        slint_ui.set_home_scroll(state.shell.home_scroll as f32);
-                        slint_ui.set_home_push_offset(state.shell.home_push_offset as f32);
-
-                        if state.shell.wiggle_mode {
-                            if let Some(start) = state.shell.wiggle_start_time {
-                                let elapsed = start.elapsed().as_secs_f32();
-                                slint_ui.set_wiggle_time(elapsed);
-                            }
-                            let drag_idx = state.shell.dragging_index.map(|i| i as i32).unwrap_or(-1);
-                            slint_ui.set_dragging_index(drag_idx);
-                            if let Some(pos) = state.shell.drag_position {
-                                slint_ui.set_drag_position(pos.x as f32, pos.y as f32);
-                            }
-                        }
-
-                        let now = chrono::Local::now();
-                        slint_ui.set_time(&now.format("%H:%M").to_string());
-                        slint_ui.set_battery_percent(state.shell.quick_settings.battery_percent as i32);
-                        slint_ui.set_text_scale(state.shell.text_scale);
+                        sync_slint_home(slint_ui, state);
 
                         if let Some((width, height, pixels)) = slint_ui.render() {
                             unsafe {
-                                gl::render_texture(width, height, &pixels, display.width, display.height);
+                                gl::render_texture(width, height, &pixels, frame_w, frame_h);
                             }
                         }
                     }
@@ -3780,132 +4135,14 @@ fn render_frame(
                                 let enter_progress = state.shell.get_switcher_enter_progress();
                                 slint_ui.set_switcher_enter_progress(enter_progress);
 
-                                // Calculate visibility bounds for preview culling (performance optimization)
-                                let screen_w = state.screen_size.w as f64;
-                                let scroll = state.shell.switcher_scroll;
-                                let card_spacing = screen_w * 0.80 * 0.35;
-                                let visible_margin = screen_w * 1.5;
-
-                                // Update window list for Slint Switcher
-                                // Filter out home and lock screen windows
-                                let windows: Vec<_> = state.space.elements()
-                                    .filter(|window| {
-                                        if let Some(toplevel) = window.toplevel() {
-                                            let title = compositor::with_states(toplevel.wl_surface(), |states| {
-                                                states.data_map
-                                                    .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
-                                                    .and_then(|data| data.lock().unwrap().title.clone())
-                                            });
-                                            let title = title.as_deref();
-                                            title != Some("Flick Home") && title != Some("Flick Lock Screen")
-                                        } else {
-                                            true // Include non-toplevel windows
-                                        }
-                                    })
-                                    .enumerate()
-                                    .map(|(i, window)| {
-                                        // Check if this window is visible in the fanout
-                                        let window_pos = (i as f64) * card_spacing - scroll;
-                                        let is_visible = window_pos > -visible_margin && window_pos < screen_w + visible_margin;
-
-                                        // Try X11 surface first, then Wayland toplevel, fall back to generic name
-                                        let title = if let Some(x11) = window.x11_surface() {
-                                            let t = x11.title();
-                                            if !t.is_empty() { t } else { x11.class() }
-                                        } else if let Some(toplevel) = window.toplevel() {
-                                            compositor::with_states(toplevel.wl_surface(), |states| {
-                                                states
-                                                    .data_map
-                                                    .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
-                                                    .and_then(|data| {
-                                                        let data = data.lock().unwrap();
-                                                        let title = data.title.clone();
-                                                        if title.as_ref().map(|t| !t.is_empty()).unwrap_or(false) {
-                                                            title
-                                                        } else {
-                                                            data.app_id.clone()
-                                                        }
-                                                    })
-                                            }).unwrap_or_else(|| format!("Window {}", i + 1))
-                                        } else {
-                                            format!("Window {}", i + 1)
-                                        };
-
-                                        let app_class = if let Some(x11) = window.x11_surface() {
-                                            x11.class()
-                                        } else if let Some(toplevel) = window.toplevel() {
-                                            compositor::with_states(toplevel.wl_surface(), |states| {
-                                                states
-                                                    .data_map
-                                                    .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
-                                                    .and_then(|data| data.lock().unwrap().app_id.clone())
-                                            }).unwrap_or_else(|| "app".to_string())
-                                        } else {
-                                            "app".to_string()
-                                        };
-
-                                        // Capture window preview from SHM buffer or EGL texture
-                                        // Only capture preview if window is visible (performance optimization)
-                                        let preview: Option<slint::Image> = if !is_visible {
-                                            // Skip expensive texture read for off-screen windows
-                                            None
-                                        } else if let Some(toplevel) = window.toplevel() {
-                                            compositor::with_states(toplevel.wl_surface(), |states| {
-                                                use std::cell::RefCell;
-                                                use crate::state::SurfaceBufferData;
-                                                if let Some(buffer_data) = states.data_map.get::<RefCell<SurfaceBufferData>>() {
-                                                    let bd = buffer_data.borrow();
-                                                    // First try SHM buffer (software rendered apps)
-                                                    if let Some(ref buffer) = bd.buffer {
-                                                        let pixel_buffer = slint::SharedPixelBuffer::<slint::Rgba8Pixel>::clone_from_slice(
-                                                            &buffer.pixels,
-                                                            buffer.width,
-                                                            buffer.height,
-                                                        );
-                                                        Some(slint::Image::from_rgba8(pixel_buffer))
-                                                    } else if let Some(ref egl_tex) = bd.egl_texture {
-                                                        // Try reading from EGL texture (hardware rendered apps)
-                                                        unsafe {
-                                                            if let Some(pixels) = gl::read_texture_pixels(egl_tex.texture_id, egl_tex.width, egl_tex.height) {
-                                                                let pixel_buffer = slint::SharedPixelBuffer::<slint::Rgba8Pixel>::clone_from_slice(
-                                                                    &pixels,
-                                                                    egl_tex.width,
-                                                                    egl_tex.height,
-                                                                );
-                                                                Some(slint::Image::from_rgba8(pixel_buffer))
-                                                            } else {
-                                                                None
-                                                            }
-                                                        }
-                                                    } else {
-                                                        None
-                                                    }
-                                                } else {
-                                                    None
-                                                }
-                                            })
-                                        } else {
-                                            None
-                                        };
-
-                                        (i as i32, title, app_class, i as i32, preview)
-                                    })
-                                    .collect();
-
-                                // Sort by render order: furthest from center first, center last
-                                // This ensures center card renders on top
-                                let mut windows = windows;
-                                windows.sort_by(|a, b| {
-                                    let dist_a = ((a.3 as f64) * card_spacing - scroll).abs();
-                                    let dist_b = ((b.3 as f64) * card_spacing - scroll).abs();
-                                    // Reverse order: larger distance first (renders behind)
-                                    dist_b.partial_cmp(&dist_a).unwrap_or(std::cmp::Ordering::Equal)
-                                });
-
+                                // Update window list for Slint Switcher (home and lock screen windows
+                                // are not cards)
+                                let cards = display.render_list.windows(Role::App);
+                                let rows = switcher_rows(state, cards.clone(), state.shell.switcher_scroll);
                                 if log_frame {
-                                    info!("Switcher: {} windows in space", windows.len());
+                                    info!("Switcher: {} windows in space", rows.len());
                                 }
-                                slint_ui.set_switcher_windows(windows);
+                                set_switcher_cards(slint_ui, cards, rows);
                                 // Sync push offsets for return gesture animation
                                 // Only push switcher cards during active return gesture
                                 slint_ui.set_home_push_offset(state.shell.home_push_offset as f32);
@@ -3964,7 +4201,7 @@ fn render_frame(
                                 info!("SLINT RENDER frame {}: {}x{}", frame_num, width, height);
                             }
                             unsafe {
-                                gl::render_texture(width, height, &pixels, display.width, display.height);
+                                gl::render_texture(width, height, &pixels, frame_w, frame_h);
                             }
                         }
                     }
@@ -4024,104 +4261,11 @@ fn render_frame(
                     };
                     slint_ui.set_switcher_scroll(scroll as f32);
 
-                    // Calculate visibility bounds for preview culling (performance optimization)
-                    let visible_margin = screen_w * 1.5;
-
-                    let windows: Vec<_> = state.space.elements()
-                        .enumerate()
-                        .map(|(i, window)| {
-                            // Check if this window is visible in the fanout
-                            let window_pos = (i as f64) * card_spacing - scroll;
-                            let is_visible = window_pos > -visible_margin && window_pos < screen_w + visible_margin;
-
-                            let title = if let Some(x11) = window.x11_surface() {
-                                let t = x11.title();
-                                if !t.is_empty() { t } else { x11.class() }
-                            } else if let Some(toplevel) = window.toplevel() {
-                                compositor::with_states(toplevel.wl_surface(), |states| {
-                                    states
-                                        .data_map
-                                        .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
-                                        .and_then(|data| {
-                                            let data = data.lock().unwrap();
-                                            data.title.clone().or(data.app_id.clone())
-                                        })
-                                }).unwrap_or_else(|| format!("Window {}", i + 1))
-                            } else {
-                                format!("Window {}", i + 1)
-                            };
-
-                            let app_class = if let Some(x11) = window.x11_surface() {
-                                x11.class()
-                            } else if let Some(toplevel) = window.toplevel() {
-                                compositor::with_states(toplevel.wl_surface(), |states| {
-                                    states
-                                        .data_map
-                                        .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
-                                        .and_then(|data| data.lock().unwrap().app_id.clone())
-                                }).unwrap_or_else(|| "app".to_string())
-                            } else {
-                                "app".to_string()
-                            };
-
-                            // Capture window preview from SHM buffer or EGL texture
-                            // Only capture preview if window is visible (performance optimization)
-                            let preview: Option<slint::Image> = if !is_visible {
-                                // Skip expensive texture read for off-screen windows
-                                None
-                            } else if let Some(toplevel) = window.toplevel() {
-                                compositor::with_states(toplevel.wl_surface(), |states| {
-                                    use std::cell::RefCell;
-                                    use crate::state::SurfaceBufferData;
-                                    if let Some(buffer_data) = states.data_map.get::<RefCell<SurfaceBufferData>>() {
-                                        let bd = buffer_data.borrow();
-                                        // First try SHM buffer (software rendered apps)
-                                        if let Some(ref buffer) = bd.buffer {
-                                            // Convert RGBA pixels to slint::Image
-                                            let pixel_buffer = slint::SharedPixelBuffer::<slint::Rgba8Pixel>::clone_from_slice(
-                                                &buffer.pixels,
-                                                buffer.width,
-                                                buffer.height,
-                                            );
-                                            Some(slint::Image::from_rgba8(pixel_buffer))
-                                        } else if let Some(ref egl_tex) = bd.egl_texture {
-                                            // Try reading from EGL texture (hardware rendered apps)
-                                            unsafe {
-                                                if let Some(pixels) = gl::read_texture_pixels(egl_tex.texture_id, egl_tex.width, egl_tex.height) {
-                                                    let pixel_buffer = slint::SharedPixelBuffer::<slint::Rgba8Pixel>::clone_from_slice(
-                                                        &pixels,
-                                                        egl_tex.width,
-                                                        egl_tex.height,
-                                                    );
-                                                    Some(slint::Image::from_rgba8(pixel_buffer))
-                                                } else {
-                                                    None
-                                                }
-                                            }
-                                        } else {
-                                            None
-                                        }
-                                    } else {
-                                        None
-                                    }
-                                })
-                            } else {
-                                None
-                            };
-
-                            (i as i32, title, app_class, i as i32, preview)
-                        })
-                        .collect();
-
-                    // Sort by render order (furthest from center first, using same scroll)
-                    let mut windows = windows;
-                    windows.sort_by(|a, b| {
-                        let dist_a = ((a.3 as f64) * card_spacing - scroll).abs();
-                        let dist_b = ((b.3 as f64) * card_spacing - scroll).abs();
-                        dist_b.partial_cmp(&dist_a).unwrap_or(std::cmp::Ordering::Equal)
-                    });
-
-                    slint_ui.set_switcher_windows(windows);
+                    // Same cards as the switcher it opens into (rows are sorted, so
+                    // previews are looked up by each row's original index)
+                    let cards = display.render_list.windows(Role::App);
+                    let rows = switcher_rows(state, cards.clone(), scroll);
+                    set_switcher_cards(slint_ui, cards, rows);
 
                     // Slide switcher cards in from right as home icons push left
                     // Only apply push when coming from Home view, not App view
@@ -4137,7 +4281,7 @@ fn render_frame(
                     // Render the switcher preview
                     if let Some((width, height, pixels)) = slint_ui.render() {
                         unsafe {
-                            gl::render_texture(width, height, &pixels, display.width, display.height);
+                            gl::render_texture(width, height, &pixels, frame_w, frame_h);
                         }
                     }
                 }
@@ -4147,24 +4291,7 @@ fn render_frame(
         // Render QML lock screen window when on lock screen with QML connected
         // Only render windows with title "Flick Lock" to avoid showing other apps
         if shell_view == ShellView::LockScreen && qml_lockscreen_connected {
-            let windows: Vec<_> = state.space.elements().cloned().collect();
-            for window in windows.iter() {
-                // Check if this is the lock screen window by title
-                let is_lock_window = if let Some(toplevel) = window.toplevel() {
-                    let title = compositor::with_states(toplevel.wl_surface(), |states| {
-                        states.data_map
-                            .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
-                            .and_then(|data| data.lock().unwrap().title.clone())
-                    });
-                    title.as_deref() == Some("Flick Lock Screen")
-                } else {
-                    false
-                };
-
-                if !is_lock_window {
-                    continue; // Skip non-lock windows
-                }
-
+            for window in display.render_list.windows(Role::Lock) {
                 let wl_surface = if let Some(toplevel) = window.toplevel() {
                     Some(toplevel.wl_surface().clone())
                 } else {
@@ -4212,6 +4339,7 @@ fn render_frame(
                                         height: imported.2,
                                         egl_image: imported.3,
                                     });
+                                    bd.content_serial += 1;
                                     bd.needs_egl_import = false;
                                     bd.wl_buffer_ptr = None;
                                     if let Some(buffer) = bd.pending_buffer.take() {
@@ -4221,35 +4349,23 @@ fn render_frame(
                             });
                             // Render the newly imported texture
                             unsafe {
-                                gl::render_egl_texture_at(imported.0, imported.1, imported.2, display.width, display.height, 0, 0);
+                                gl::render_egl_texture_at(imported.0, imported.1, imported.2, frame_w, frame_h, 0, 0);
                             }
                         }
                     } else if let Some((texture_id, width, height)) = egl_texture_info {
                         // Render existing EGL texture
                         unsafe {
-                            gl::render_egl_texture_at(texture_id, width, height, display.width, display.height, 0, 0);
+                            gl::render_egl_texture_at(texture_id, width, height, frame_w, frame_h, 0, 0);
                         }
                     } else {
-                        // Fallback to SHM buffer
-                        let buffer_info: Option<(u32, u32, Vec<u8>)> = compositor::with_states(&wl_surface, |data| {
-                            use std::cell::RefCell;
-                            use crate::state::SurfaceBufferData;
-
-                            if let Some(buffer_data) = data.data_map.get::<RefCell<SurfaceBufferData>>() {
-                                let data = buffer_data.borrow();
-                                if let Some(ref stored) = data.buffer {
-                                    Some((stored.width, stored.height, stored.pixels.clone()))
-                                } else {
-                                    None
-                                }
-                            } else {
-                                None
-                            }
+                        // Fallback to SHM buffer (uploaded again only after a commit)
+                        let shm = display.render_list.shm_texture(&wl_surface, |old, width, height, pixels| unsafe {
+                            gl::store_texture(old, width, height, pixels)
                         });
 
-                        if let Some((width, height, pixels)) = buffer_info {
+                        if let Some(texture) = shm {
                             unsafe {
-                                gl::render_texture(width, height, &pixels, display.width, display.height);
+                                gl::render_texture_id(texture.texture_id, frame_w, frame_h);
                             }
                         }
                     }
@@ -4261,24 +4377,7 @@ fn render_frame(
         // Only render windows with title "Flick Home" to avoid showing other apps
         if shell_view == ShellView::Home && qml_home_connected {
             let mut home_rendered = false;
-            let windows: Vec<_> = state.space.elements().cloned().collect();
-            for window in windows.iter() {
-                // Check if this is the home window by title
-                let is_home_window = if let Some(toplevel) = window.toplevel() {
-                    let title = compositor::with_states(toplevel.wl_surface(), |states| {
-                        states.data_map
-                            .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
-                            .and_then(|data| data.lock().unwrap().title.clone())
-                    });
-                    title.as_deref() == Some("Flick Home")
-                } else {
-                    false
-                };
-
-                if !is_home_window {
-                    continue; // Skip non-home windows
-                }
-
+            for window in display.render_list.windows(Role::Home) {
                 let wl_surface = if let Some(toplevel) = window.toplevel() {
                     Some(toplevel.wl_surface().clone())
                 } else {
@@ -4286,82 +4385,20 @@ fn render_frame(
                 };
 
                 if let Some(wl_surface) = wl_surface {
-                    // Check if we need to import EGL buffer, and get old texture for cleanup
-                    let (needs_import, egl_texture_info, old_egl_texture) = compositor::with_states(&wl_surface, |data| {
-                        use std::cell::RefCell;
-                        use crate::state::SurfaceBufferData;
-
-                        if let Some(buffer_data) = data.data_map.get::<RefCell<SurfaceBufferData>>() {
-                            let bd = buffer_data.borrow();
-                            let egl_info = bd.egl_texture.as_ref().map(|t| (t.texture_id, t.width, t.height));
-                            let old_tex = if bd.needs_egl_import {
-                                bd.egl_texture.as_ref().map(|t| (t.texture_id, t.egl_image))
-                            } else {
-                                None
-                            };
-                            (bd.needs_egl_import, egl_info, old_tex)
-                        } else {
-                            (false, None, None)
-                        }
-                    });
-
-                    // Try EGL import if needed
-                    if needs_import {
-                        if let Some((old_tex_id, old_egl_image)) = old_egl_texture {
-                            destroy_egl_texture(old_tex_id, old_egl_image, display);
+                    if let Some((texture_id, width, height)) = current_egl_texture(&wl_surface, display) {
+                        unsafe {
+                            gl::render_egl_texture_at(texture_id, width, height, frame_w, frame_h, 0, 0);
                         }
+                        home_rendered = true;
+                    } else {
+                        // Fallback to SHM buffer (uploaded again only after a commit)
+                        let shm = display.render_list.shm_texture(&wl_surface, |old, width, height, pixels| unsafe {
+                            gl::store_texture(old, width, height, pixels)
+                        });
 
-                        if let Some(imported) = try_import_egl_buffer(&wl_surface, display) {
-                            compositor::with_states(&wl_surface, |data| {
-                                use std::cell::RefCell;
-                                use crate::state::{SurfaceBufferData, EglTextureBuffer};
-                                data.data_map.insert_if_missing(|| RefCell::new(SurfaceBufferData::default()));
-                                if let Some(buffer_data) = data.data_map.get::<RefCell<SurfaceBufferData>>() {
-                                    let mut bd = buffer_data.borrow_mut();
-                                    bd.egl_texture = Some(EglTextureBuffer {
-                                        texture_id: imported.0,
-                                        width: imported.1,
-                                        height: imported.2,
-                                        egl_image: imported.3,
-                                    });
-                                    bd.needs_egl_import = false;
-                                    bd.wl_buffer_ptr = None;
-                                    if let Some(buffer) = bd.pending_buffer.take() {
-                                        buffer.release();
-                                    }
-                                }
-                            });
+                        if let Some(texture) = shm {
                             unsafe {
-                                gl::render_egl_texture_at(imported.0, imported.1, imported.2, display.width, display.height, 0, 0);
-                            }
-                            home_rendered = true;
-                        }
-                    } else if let Some((texture_id, width, height)) = egl_texture_info {
-                        unsafe {
-                            gl::render_egl_texture_at(texture_id, width, height, display.width, display.height, 0, 0);
-                        }
-                        home_rendered = true;
-                    } else {
-                        // Fallback to SHM buffer
-                        let buffer_info: Option<(u32, u32, Vec<u8>)> = compositor::with_states(&wl_surface, |data| {
-                            use std::cell::RefCell;
-                            use crate::state::SurfaceBufferData;
-
-                            if let Some(buffer_data) = data.data_map.get::<RefCell<SurfaceBufferData>>() {
-                                let data = buffer_data.borrow();
-                                if let Some(ref stored) = data.buffer {
-                                    Some((stored.width, stored.height, stored.pixels.clone()))
-                                } else {
-                                    None
-                                }
-                            } else {
-                                None
-                            }
-                        });
-
-                        if let Some((width, height, pixels)) = buffer_info {
-                            unsafe {
-                                gl::render_texture(width, height, &pixels, display.width, display.height);
+                                gl::render_texture_id(texture.texture_id, frame_w, frame_h);
                             }
                             home_rendered = true;
                         }
@@ -4383,11 +4420,7 @@ fn render_frame(
                 if slint_ui.is_keyboard_visible() {
                     slint::platform::update_timers_and_animations();
                     slint_ui.set_view("app");  // Use app view to show keyboard overlay
-                    if let Some((width, height, pixels)) = slint_ui.render() {
-                        unsafe {
-                            gl::render_texture(width, height, &pixels, display.width, display.height);
-                        }
-                    }
+                    render_keyboard_layer(slint_ui, frame_w, frame_h);
                 }
             }
         }
@@ -4399,7 +4432,7 @@ fn render_frame(
                 slint_ui.set_view("lock");
                 if let Some((width, height, pixels)) = slint_ui.render() {
                     unsafe {
-                        gl::render_texture(width, height, &pixels, display.width, display.height);
+                        gl::render_texture(width, height, &pixels, frame_w, frame_h);
                     }
                 }
             }
@@ -4408,41 +4441,14 @@ fn render_frame(
         // Render Wayland windows ONLY for App view (not during switcher gesture preview)
         if shell_view == ShellView::App && !switcher_gesture_preview && !state.shell.lock_screen_active {
             // Render ONLY the topmost non-shell Wayland client surface
-            // Skip home and lock screen windows
-            let windows: Vec<_> = state.space.elements().cloned().collect();
-            debug!("Rendering {} Wayland windows", windows.len());
-
-            // Find the topmost non-shell window (iterate in reverse)
-            let app_window = windows.iter().rev().find(|w| {
-                if let Some(toplevel) = w.toplevel() {
-                    let title = compositor::with_states(toplevel.wl_surface(), |states| {
-                        states.data_map
-                            .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
-                            .and_then(|data| data.lock().unwrap().title.clone())
-                    });
-                    let title = title.as_deref();
-                    title != Some("Flick Home") && title != Some("Flick Lock Screen")
-                } else {
-                    true // Non-toplevel windows are assumed to be app windows
-                }
-            });
+            // (home and lock screen windows have their own roles in the render list)
+            let app_window = display.render_list.top_app().map(|item| (item.window.clone(), item.location));
 
             // If no app window found but QML home is running, render the home window instead
             // This prevents black screen when app is launching but window not yet open
             if app_window.is_none() && state.shell.qml_home_launched {
                 // Find and render the home window
-                let home_window = windows.iter().find(|w| {
-                    if let Some(toplevel) = w.toplevel() {
-                        let title = compositor::with_states(toplevel.wl_surface(), |states| {
-                            states.data_map
-                                .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
-                                .and_then(|data| data.lock().unwrap().title.clone())
-                        });
-                        title.as_deref() == Some("Flick Home")
-                    } else {
-                        false
-                    }
-                });
+                let home_window = display.render_list.find(Role::Home).map(|item| item.window.clone());
 
                 if let Some(window) = home_window {
                     if let Some(toplevel) = window.toplevel() {
@@ -4462,28 +4468,29 @@ fn render_frame(
 
                         if let Some((texture_id, width, height)) = egl_texture_info {
                             unsafe {
-                                gl::render_egl_texture_at(texture_id, width, height, display.width, display.height, 0, 0);
+                                gl::render_egl_texture_at(texture_id, width, height, frame_w, frame_h, 0, 0);
                             }
                         }
                     }
                 }
             }
 
-            if let Some(window) = app_window {
+            // A bottom swipe past the keyboard opens the switcher: show it
+            // behind the sliding app from its pre-rendered texture
+            if state.home_gesture_window.is_some()
+                && state.home_gesture_past_keyboard
+                && display.snapshots.switcher.ready((frame_w, frame_h))
+            {
+                unsafe { gl::render_texture_id(display.snapshots.switcher.texture_id, frame_w, frame_h) };
+            }
+
+            if let Some((window, window_pos)) = app_window {
+                let window = &window;
                 let i = 0; // For debug logging
                 debug!("Processing app window");
 
                 // Get the wl_surface from either Wayland toplevel or X11 surface
-                let wl_surface = if let Some(toplevel) = window.toplevel() {
-                    debug!("Window {} is Wayland toplevel", i);
-                    Some(toplevel.wl_surface().clone())
-                } else if let Some(x11_surface) = window.x11_surface() {
-                    debug!("Window {} is X11 surface", i);
-                    x11_surface.wl_surface().map(|s| s.clone())
-                } else {
-                    debug!("Window {} has no surface", i);
-                    None
-                };
+                let wl_surface = render_list::window_surface(window);
 
                 if let Some(wl_surface) = wl_surface {
                     debug!("Window {} surface: {:?}", i, wl_surface.id());
@@ -4534,6 +4541,7 @@ fn render_frame(
                                         height: imported.2,
                                         egl_image: imported.3,
                                     });
+                                    bd.content_serial += 1;
                                     bd.needs_egl_import = false;
                                     bd.wl_buffer_ptr = None; // Clear after import
                                     // Release the buffer so client can reuse it
@@ -4545,12 +4553,11 @@ fn render_frame(
                             });
 
                             // Render the newly imported texture
-                            let window_pos = state.space.element_location(window).unwrap_or_default();
                             if log_frame {
                                 tracing::trace!("EGL IMPORT+RENDER[{}] frame {}: texture_id={}, {}x{}", i, frame_num, imported.0, imported.1, imported.2);
                             }
                             unsafe {
-                                gl::render_egl_texture_at(imported.0, imported.1, imported.2, display.width, display.height,
+                                gl::render_egl_texture_at(imported.0, imported.1, imported.2, frame_w, frame_h,
                                                            window_pos.x, window_pos.y);
                             }
                         } else {
@@ -4568,82 +4575,45 @@ fn render_frame(
                             });
                             // Try to use existing cached texture as fallback
                             if let Some((texture_id, width, height)) = egl_texture_info {
-                                let window_pos = state.space.element_location(window).unwrap_or_default();
                                 if log_frame {
                                     info!("EGL FALLBACK[{}] frame {}: using cached texture_id={}", i, frame_num, texture_id);
                                 }
                                 unsafe {
-                                    gl::render_egl_texture_at(texture_id, width, height, display.width, display.height,
+                                    gl::render_egl_texture_at(texture_id, width, height, frame_w, frame_h,
                                                                window_pos.x, window_pos.y);
                                 }
                             }
                         }
                     } else if let Some((texture_id, width, height)) = egl_texture_info {
                         // Use existing cached EGL texture
-                        let window_pos = state.space.element_location(window).unwrap_or_default();
                         if log_frame {
                             tracing::trace!("EGL RENDER[{}] frame {}: texture_id={}, {}x{}", i, frame_num, texture_id, width, height);
                         }
                         unsafe {
-                            gl::render_egl_texture_at(texture_id, width, height, display.width, display.height,
+                            gl::render_egl_texture_at(texture_id, width, height, frame_w, frame_h,
                                                        window_pos.x, window_pos.y);
                         }
                     }
 
-                    // Get stored SHM buffer from surface user data (fallback)
-                    let buffer_info: Option<(u32, u32, Vec<u8>)> = compositor::with_states(&wl_surface, |data| {
-                        debug!("  stored: inside with_states");
-                        use std::cell::RefCell;
-                        use crate::state::SurfaceBufferData;
-
-                        if let Some(buffer_data) = data.data_map.get::<RefCell<SurfaceBufferData>>() {
-                            let data = buffer_data.borrow();
-                            // Skip if we already rendered via EGL
-                            if data.egl_texture.is_some() {
-                                return None;
-                            }
-                            if let Some(ref stored) = data.buffer {
-                                debug!("  stored: found buffer {}x{}", stored.width, stored.height);
-                                Some((stored.width, stored.height, stored.pixels.clone()))
-                            } else {
-                                debug!("  stored: no buffer in data_map");
-                                None
-                            }
-                        } else {
-                            debug!("  stored: no SurfaceBufferData in data_map");
-                            None
-                        }
+                    // SHM buffer (fallback), kept as a texture until the next commit
+                    let shm = display.render_list.shm_texture(&wl_surface, |old, width, height, pixels| unsafe {
+                        gl::store_texture(old, width, height, pixels)
                     });
-                    debug!("Window {} after with_states", i);
-
-                    // Render SHM buffer outside of with_states to avoid holding locks
-                    if let Some((width, height, pixels)) = buffer_info {
-                        // Get window position from space (for close gesture animation)
-                        let window_pos = state.space.element_location(window)
-                            .unwrap_or_default();
-
-                        // Log periodically - check center pixel and client ID
-                        if log_frame && pixels.len() >= 4 {
-                            let center_x = width / 2;
-                            let center_y = height / 2; // Actual center
-                            let center_idx = ((center_y * width + center_x) * 4) as usize;
-                            let (cr, cg, cb, ca) = if center_idx + 3 < pixels.len() {
-                                (pixels[center_idx], pixels[center_idx+1], pixels[center_idx+2], pixels[center_idx+3])
-                            } else {
-                                (0, 0, 0, 0)
-                            };
+
+                    if let Some(texture) = shm {
+                        if log_frame {
                             let window_type = if window.toplevel().is_some() { "Wayland" } else { "X11" };
                             let client_info = wl_surface.client().map(|c| format!("{:?}", c.id())).unwrap_or_else(|| "no-client".to_string());
-                            info!("{} RENDER[{}] frame {}: {}x{} center_pixel=RGBA({},{},{},{}) client={}",
-                                window_type, i, frame_num, width, height, cr, cg, cb, ca, client_info);
+                            info!("{} RENDER[{}] frame {}: {}x{} texture_id={} client={}",
+                                window_type, i, frame_num, texture.width, texture.height, texture.texture_id, client_info);
                         }
 
                         // Use positioned rendering to support close gesture animation
                         unsafe {
-                            gl::render_texture_at(width, height, &pixels, display.width, display.height,
-                                                   window_pos.x, window_pos.y);
+                            gl::render_egl_texture_at(texture.texture_id, texture.width, texture.height,
+                                                       frame_w, frame_h, window_pos.x, window_pos.y);
                         }
-                    } else if log_frame {
+                    } else if log_frame && egl_texture_info.is_none() && !needs_import {
                         let window_type = if window.toplevel().is_some() { "Wayland" } else { "X11" };
                         info!("{} NO BUFFER frame {}: window {} has no stored buffer", window_type, frame_num, i);
                     }
@@ -4651,8 +4621,7 @@ fn render_frame(
                     // === RENDER SUBSURFACES ===
                     // Camera preview and other video surfaces are subsurfaces
                     // They may use EGL/dmabuf buffers for hardware-accelerated rendering
-                    let window_pos = state.space.element_location(window).unwrap_or_default();
-                    render_subsurfaces(&wl_surface, window_pos, display, log_frame, frame_num);
+                    render_subsurfaces(&wl_surface, window_pos, display, (frame_w, frame_h), log_frame, frame_num);
                 }
             }
             debug!("Finished rendering windows");
@@ -4672,17 +4641,34 @@ fn render_frame(
                     slint_ui.set_volume(state.system.volume as i32);
                     slint_ui.set_muted(state.system.muted);
 
-                    if let Some((width, height, pixels)) = slint_ui.render() {
+                    // The keyboard alone is drawn from its cached layer
+                    if !(volume_visible || context_menu_visible || system_menu_visible) {
+                        render_keyboard_layer(slint_ui, frame_w, frame_h);
+                    } else if let Some((width, height, pixels)) = slint_ui.render() {
                         if log_frame {
                             info!("APP OVERLAY frame {}: {}x{} (kbd={}, vol={}, ctx={}, sys={})",
                                 frame_num, width, height, keyboard_visible, volume_visible, context_menu_visible, system_menu_visible);
                         }
                         unsafe {
-                            gl::render_texture(width, height, &pixels, display.width, display.height);
+                            gl::render_texture(width, height, &pixels, frame_w, frame_h);
                         }
                     }
                 }
             }
+
+            // Left/right edge swipes go home: slide it in over the app from
+            // the swiped edge (the live home takes over once the swipe commits)
+            let home_offset = if state.qs_gesture_active {
+                Some(-(1.0 - state.qs_gesture_progress))
+            } else if state.switcher_gesture_active {
+                Some(1.0 - state.switcher_gesture_progress)
+            } else {
+                None
+            };
+            if let Some(offset) = home_offset {
+                let x = (offset * frame_w as f64).round() as i32;
+                render_home_snapshot(display, state, frame_w, frame_h, x);
+            }
         }
     }
 
@@ -4691,8 +4677,9 @@ fn render_frame(
         unsafe {
             gl::end_scene_render();
             // Reset viewport for default framebuffer
-            if let Some(f) = gl::FN_VIEWPORT {
-                f(0, 0, display.width as i32, display.height as i32);
+            gl::set_viewport(display.width, display.height);
+            if rotation.is_rotated() {
+                gl::render_rotated_scene(rotation.blit_rotation);
             }
         }
     }
@@ -4720,6 +4707,9 @@ fn render_frame(
     display.egl_instance.swap_buffers(display.egl_display, display.egl_surface)
         .map_err(|e| anyhow::anyhow!("Failed to swap buffers: {:?}", e))?;
 
+    // Keep gesture destinations fresh while the app sits idle
+    refresh_gesture_snapshots(display, state, frame_w, frame_h);
+
     Ok(())
 }
 
@@ -4754,6 +4744,7 @@ mod gl {
     type GenTexturesFn = unsafe extern "C" fn(i32, *mut u32);
     type BindTextureFn = unsafe extern "C" fn(u32, u32);
     type TexImage2DFn = unsafe extern "C" fn(u32, i32, i32, i32, i32, i32, u32, u32, *const c_void);
+    type TexSubImage2DFn = unsafe extern "C" fn(u32, i32, i32, i32, i32, i32, u32, u32, *const c_void);
     type TexParameteriFn = unsafe extern "C" fn(u32, u32, i32);
     type CreateShaderFn = unsafe extern "C" fn(u32) -> u32;
     type ShaderSourceFn = unsafe extern "C" fn(u32, i32, *const *const c_char, *const i32);
@@ -4785,14 +4776,25 @@ mod gl {
     type Uniform2fvFn = unsafe extern "C" fn(i32, i32, *const f32);
     type Uniform4fvFn = unsafe extern "C" fn(i32, i32, *const f32);
     type GetIntegervFn = unsafe extern "C" fn(u32, *mut i32);
+    type GetStringFn = unsafe extern "C" fn(u32) -> *const u8;
+    type GetProgramBinaryFn = unsafe extern "C" fn(u32, i32, *mut i32, *mut u32, *mut c_void);
+    type ProgramBinaryFn = unsafe extern "C" fn(u32, u32, *const c_void, i32);
+    type Uniform4fFn = unsafe extern "C" fn(i32, f32, f32, f32, f32);
+    type GenBuffersFn = unsafe extern "C" fn(i32, *mut u32);
+    type BindBufferFn = unsafe extern "C" fn(u32, u32);
+    type BufferDataFn = unsafe extern "C" fn(u32, isize, *const c_void, u32);
+    type BindAttribLocationFn = unsafe extern "C" fn(u32, u32, *const c_char);
+    type GenVertexArraysFn = unsafe extern "C" fn(i32, *mut u32);
+    type BindVertexArrayFn = unsafe extern "C" fn(u32);
 
     // Cached function pointers
     static mut FN_CLEAR_COLOR: Option<ClearColorFn> = None;
     static mut FN_CLEAR: Option<ClearFn> = None;
-    pub static mut FN_VIEWPORT: Option<ViewportFn> = None;
+    static mut FN_VIEWPORT: Option<ViewportFn> = None;
     static mut FN_GEN_TEXTURES: Option<GenTexturesFn> = None;
     static mut FN_BIND_TEXTURE: Option<BindTextureFn> = None;
     static mut FN_TEX_IMAGE_2D: Option<TexImage2DFn> = None;
+    static mut FN_TEX_SUB_IMAGE_2D: Option<TexSubImage2DFn> = None;
     static mut FN_TEX_PARAMETERI: Option<TexParameteriFn> = None;
     static mut FN_CREATE_SHADER: Option<CreateShaderFn> = None;
     static mut FN_SHADER_SOURCE: Option<ShaderSourceFn> = None;
@@ -4823,18 +4825,43 @@ mod gl {
     static mut FN_UNIFORM1F: Option<Uniform1fFn> = None;
     static mut FN_UNIFORM2FV: Option<Uniform2fvFn> = None;
     static mut FN_UNIFORM4FV: Option<Uniform4fvFn> = None;
+    static mut FN_GET_STRING: Option<GetStringFn> = None;
+    static mut FN_UNIFORM4F: Option<Uniform4fFn> = None;
+    static mut FN_GEN_BUFFERS: Option<GenBuffersFn> = None;
+    static mut FN_BIND_BUFFER: Option<BindBufferFn> = None;
+    static mut FN_BUFFER_DATA: Option<BufferDataFn> = None;
+    static mut FN_BIND_ATTRIB_LOCATION: Option<BindAttribLocationFn> = None;
+
+    // GL_OES_vertex_array_object (None on drivers without it)
+    static mut FN_GEN_VERTEX_ARRAYS: Option<GenVertexArraysFn> = None;
+    static mut FN_BIND_VERTEX_ARRAY: Option<BindVertexArrayFn> = None;
+
+    // GL_OES_get_program_binary (None if the driver can't hand back binaries)
+    static mut FN_GET_PROGRAM_BINARY: Option<GetProgramBinaryFn> = None;
+    static mut FN_PROGRAM_BINARY: Option<ProgramBinaryFn> = None;
+    // Driver identity used to key the on-disk program cache (None = cache disabled)
+    static mut PROGRAM_CACHE_DRIVER: Option<super::shader_cache::DriverInfo> = None;
+    // Reads/writes program binaries off the render thread (None = cache disabled)
+    static mut PROGRAM_CACHE: Option<super::shader_cache::CacheWorker> = None;
+    /// How long init may wait for the blit program's cache read; the first
+    /// frame can't draw without it and a compile is slower than the read
+    const BLIT_CACHE_WAIT: std::time::Duration = std::time::Duration::from_millis(100);
 
     static mut INITIALIZED: bool = false;
     static mut SHADER_PROGRAM: u32 = 0;
     static mut ATTR_POSITION: i32 = -1;
-    static mut ATTR_TEXCOORD: i32 = -1;
     static mut UNIFORM_TEXTURE: i32 = -1;
+    static mut UNIFORM_RECT: i32 = -1;
+    static mut UNIFORM_UV: i32 = -1;
 
     // Distortion shader program and uniforms
+    // Built lazily (first use or idle warm-up) so it never delays the first frame
     static mut DISTORT_PROGRAM: u32 = 0;
+    static mut DISTORT_PENDING: bool = false;
     static mut DISTORT_ATTR_POSITION: i32 = -1;
-    static mut DISTORT_ATTR_TEXCOORD: i32 = -1;
     static mut DISTORT_UNIFORM_TEXTURE: i32 = -1;
+    static mut DISTORT_UNIFORM_RECT: i32 = -1;
+    static mut DISTORT_UNIFORM_UV: i32 = -1;
     static mut DISTORT_UNIFORM_POSITIONS: i32 = -1;
     static mut DISTORT_UNIFORM_PARAMS: i32 = -1;
     static mut DISTORT_UNIFORM_COUNT: i32 = -1;
@@ -4848,9 +4875,46 @@ mod gl {
     static mut DISTORT_UNIFORM_TOUCH_Y: i32 = -1;
     static mut DISTORT_UNIFORM_TOUCH_TIME: i32 = -1;
 
+    // Rotated scene blit for auto-rotation, built on first rotation
+    static mut ROTATE_PROGRAM: u32 = 0;
+    static mut ROTATE_PENDING: bool = false;
+    static mut ROTATE_ATTR_POSITION: i32 = -1;
+    static mut ROTATE_UNIFORM_RECT: i32 = -1;
+    static mut ROTATE_UNIFORM_ROT: i32 = -1;
+
+    // Static unit quad shared by every draw; per-draw placement is in uniforms
+    static mut QUAD_VBO: u32 = 0;
+    static mut QUAD_VAO: u32 = 0;
+    /// Attribute index every program binds a_position to before linking
+    const QUAD_ATTR: u32 = 0;
+
+    /// Last GL state we set, so draws can skip redundant binds.
+    /// Anything that changes GL state behind our back must call invalidate_state().
+    struct GlStateCache {
+        program: u32,
+        texture: u32,
+        blend: Option<bool>,
+        viewport: (i32, i32, i32, i32),
+        /// Quad VAO (or VBO + attrib pointer) is bound for QUAD_ATTR
+        quad_bound: bool,
+    }
+
+    static mut STATE: GlStateCache = GlStateCache {
+        program: 0,
+        texture: 0,
+        blend: None,
+        viewport: (0, 0, 0, 0),
+        quad_bound: false,
+    };
+
     // Time tracking for animated effects
     pub static mut EFFECT_START_TIME: Option<std::time::Instant> = None;
 
+    // On-screen keyboard layer, updated from Slint's damage and placed per frame
+    static mut KEYBOARD_TEXTURE: u32 = 0;
+    static mut KEYBOARD_TEX_WIDTH: u32 = 0;
+    static mut KEYBOARD_TEX_HEIGHT: u32 = 0;
+
     // Persistent capture texture for distortion effects (avoids create/delete each frame)
     static mut CAPTURE_TEXTURE: u32 = 0;
     static mut CAPTURE_TEX_WIDTH: u32 = 0;
@@ -4898,14 +4962,49 @@ mod gl {
     const GL_COLOR_BUFFER_BIT_BLIT: u32 = 0x00004000;
     const GL_NEAREST: u32 = 0x2600;
 
-    // Vertex shader - simple pass-through
+    // GL_OES_get_program_binary / glGetString constants
+    const GL_PROGRAM_BINARY_LENGTH_OES: u32 = 0x8741;
+    const GL_NUM_PROGRAM_BINARY_FORMATS_OES: u32 = 0x87FE;
+    const GL_VENDOR: u32 = 0x1F00;
+    const GL_RENDERER: u32 = 0x1F01;
+    const GL_VERSION: u32 = 0x1F02;
+    const GL_EXTENSIONS: u32 = 0x1F03;
+
+    // Buffer object constants
+    const GL_ARRAY_BUFFER: u32 = 0x8892;
+    const GL_STATIC_DRAW: u32 = 0x88E4;
+    const GL_TEXTURE0: u32 = 0x84C0;
+
+    // Quad placements: (origin.x, origin.y, size.x, size.y) in NDC / texture space
+    const FULLSCREEN_RECT: [f32; 4] = [-1.0, -1.0, 2.0, 2.0];
+    /// Client buffers are top-down, so v runs 1 -> 0 from the bottom of the quad
+    const UV_FLIPPED: [f32; 4] = [0.0, 1.0, 1.0, -1.0];
+    /// FBO textures are bottom-up (Y=0 at bottom)
+    const UV_UPRIGHT: [f32; 4] = [0.0, 0.0, 1.0, 1.0];
+
+    // Vertex shader - places the static unit quad using per-draw uniforms
     const VERTEX_SHADER_SRC: &str = r#"
+        attribute vec2 a_position;  // unit quad corner, 0..1
+        uniform vec4 u_rect;        // NDC origin (xy) and size (zw)
+        uniform vec4 u_uv;          // texcoord origin (xy) and size (zw)
+        varying vec2 v_texcoord;
+        void main() {
+            gl_Position = vec4(u_rect.xy + a_position * u_rect.zw, 0.0, 1.0);
+            v_texcoord = u_uv.xy + a_position * u_uv.zw;
+        }
+    "#;
+
+    // Vertex shader for the rotated scene blit: texcoords are turned about
+    // the centre by the 2x2 matrix in u_rot (rows xy and zw)
+    const ROTATE_VERTEX_SRC: &str = r#"
         attribute vec2 a_position;
-        attribute vec2 a_texcoord;
+        uniform vec4 u_rect;
+        uniform vec4 u_rot;
         varying vec2 v_texcoord;
         void main() {
-            gl_Position = vec4(a_position, 0.0, 1.0);
-            v_texcoord = a_texcoord;
+            gl_Position = vec4(u_rect.xy + a_position * u_rect.zw, 0.0, 1.0);
+            vec2 d = a_position - 0.5;
+            v_texcoord = 0.5 + vec2(dot(u_rot.xy, d), dot(u_rot.zw, d));
         }
     "#;
 
@@ -5591,6 +5690,7 @@ mod gl {
         FN_GEN_TEXTURES = load_fn(lib, b"glGenTextures\0");
         FN_BIND_TEXTURE = load_fn(lib, b"glBindTexture\0");
         FN_TEX_IMAGE_2D = load_fn(lib, b"glTexImage2D\0");
+        FN_TEX_SUB_IMAGE_2D = load_fn(lib, b"glTexSubImage2D\0");
         FN_TEX_PARAMETERI = load_fn(lib, b"glTexParameteri\0");
         FN_CREATE_SHADER = load_fn(lib, b"glCreateShader\0");
         FN_SHADER_SOURCE = load_fn(lib, b"glShaderSource\0");
@@ -5631,39 +5731,291 @@ mod gl {
         FN_BLIT_FRAMEBUFFER = load_fn(lib, b"glBlitFramebuffer\0");
         FN_READ_PIXELS = load_fn(lib, b"glReadPixels\0");
         FN_GET_INTEGERV = load_fn(lib, b"glGetIntegerv\0");
+        FN_GET_STRING = load_fn(lib, b"glGetString\0");
+        FN_UNIFORM4F = load_fn(lib, b"glUniform4f\0");
+        FN_GEN_BUFFERS = load_fn(lib, b"glGenBuffers\0");
+        FN_BIND_BUFFER = load_fn(lib, b"glBindBuffer\0");
+        FN_BUFFER_DATA = load_fn(lib, b"glBufferData\0");
+        FN_BIND_ATTRIB_LOCATION = load_fn(lib, b"glBindAttribLocation\0");
+        FN_GEN_VERTEX_ARRAYS = load_fn(lib, b"glGenVertexArraysOES\0")
+            .or_else(|| load_fn(lib, b"glGenVertexArrays\0"));
+        FN_BIND_VERTEX_ARRAY = load_fn(lib, b"glBindVertexArrayOES\0")
+            .or_else(|| load_fn(lib, b"glBindVertexArray\0"));
+
+        // Program binaries: OES entry points on GLES2 blobs, core names on GLES3
+        FN_GET_PROGRAM_BINARY = load_fn(lib, b"glGetProgramBinaryOES\0")
+            .or_else(|| load_fn(lib, b"glGetProgramBinary\0"));
+        FN_PROGRAM_BINARY = load_fn(lib, b"glProgramBinaryOES\0")
+            .or_else(|| load_fn(lib, b"glProgramBinary\0"));
+        PROGRAM_CACHE_DRIVER = query_program_cache_driver();
+        if PROGRAM_CACHE_DRIVER.is_some() {
+            // Queue every program's lookup now; deferred ones are read by the
+            // time they're built
+            let worker = super::shader_cache::CacheWorker::spawn(super::shader_cache::ShaderCache::new());
+            for (vs_src, fs_src) in [
+                (VERTEX_SHADER_SRC, FRAGMENT_SHADER_SRC),
+                (VERTEX_SHADER_SRC, DISTORT_FRAGMENT_SRC),
+                (ROTATE_VERTEX_SRC, FRAGMENT_SHADER_SRC),
+            ] {
+                if let Some(key) = program_cache_key(vs_src, fs_src) {
+                    worker.prefetch(key);
+                }
+            }
+            PROGRAM_CACHE = Some(worker);
+        }
 
         tracing::info!("FBO support: gen={}, bind={}, attach={}, check={}, blit={}, read={}",
             FN_GEN_FRAMEBUFFERS.is_some(), FN_BIND_FRAMEBUFFER.is_some(),
             FN_FRAMEBUFFER_TEXTURE_2D.is_some(), FN_CHECK_FRAMEBUFFER_STATUS.is_some(),
             FN_BLIT_FRAMEBUFFER.is_some(), FN_READ_PIXELS.is_some());
 
-        // Create shader program
-        if let Some(program) = create_shader_program() {
+        // Create shader program (needed for the very first frame)
+        if let Some(program) = build_program("blit", VERTEX_SHADER_SRC, FRAGMENT_SHADER_SRC, BLIT_CACHE_WAIT) {
             SHADER_PROGRAM = program;
 
             let pos_name = CString::new("a_position").unwrap();
-            let tex_name = CString::new("a_texcoord").unwrap();
             let uni_name = CString::new("u_texture").unwrap();
+            let rect_name = CString::new("u_rect").unwrap();
+            let uv_name = CString::new("u_uv").unwrap();
 
             if let Some(f) = FN_GET_ATTRIB_LOCATION {
                 ATTR_POSITION = f(program, pos_name.as_ptr());
-                ATTR_TEXCOORD = f(program, tex_name.as_ptr());
             }
             if let Some(f) = FN_GET_UNIFORM_LOCATION {
                 UNIFORM_TEXTURE = f(program, uni_name.as_ptr());
+                UNIFORM_RECT = f(program, rect_name.as_ptr());
+                UNIFORM_UV = f(program, uv_name.as_ptr());
             }
 
-            tracing::info!("GL shader program created: program={}, pos={}, tex={}, uni={}",
-                SHADER_PROGRAM, ATTR_POSITION, ATTR_TEXCOORD, UNIFORM_TEXTURE);
+            // Sampler always reads unit 0 - set once, not per draw
+            use_program(program);
+            if let Some(f) = FN_UNIFORM1I { f(UNIFORM_TEXTURE, 0); }
+
+            tracing::info!("GL shader program created: program={}, pos={}, uni={}, rect={}, uv={}",
+                SHADER_PROGRAM, ATTR_POSITION, UNIFORM_TEXTURE, UNIFORM_RECT, UNIFORM_UV);
         }
 
-        // Create distortion shader program
-        if let Some(program) = create_distort_shader_program() {
+        // Only texture unit 0 is ever used
+        if let Some(f) = FN_ACTIVE_TEXTURE { f(GL_TEXTURE0); }
+
+        create_quad_buffers();
+
+        // Distortion shader is deferred to warm_deferred_programs() / first use
+        DISTORT_PENDING = true;
+        // Rotated blit is only needed once an app auto-rotates
+        ROTATE_PENDING = true;
+
+        INITIALIZED = true;
+        tracing::info!("OpenGL ES 2.0 functions loaded");
+    }
+
+    /// Read the driver identity for the program cache, if program binaries are usable
+    unsafe fn query_program_cache_driver() -> Option<super::shader_cache::DriverInfo> {
+        if FN_GET_PROGRAM_BINARY.is_none() || FN_PROGRAM_BINARY.is_none() {
+            tracing::info!("Program binary cache disabled: glGetProgramBinary not available");
+            return None;
+        }
+        let get_string = FN_GET_STRING?;
+        let read = |name: u32| -> String {
+            let ptr = get_string(name);
+            if ptr.is_null() {
+                String::new()
+            } else {
+                std::ffi::CStr::from_ptr(ptr as *const c_char).to_string_lossy().into_owned()
+            }
+        };
+
+        // Drivers may export the entry points yet report zero binary formats
+        let mut num_formats: i32 = 0;
+        if let Some(f) = FN_GET_INTEGERV {
+            f(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &mut num_formats);
+        }
+        let extensions = read(GL_EXTENSIONS);
+        if num_formats <= 0 || !extensions.contains("GL_OES_get_program_binary") {
+            tracing::info!("Program binary cache disabled: no binary formats ({}) or extension", num_formats);
+            return None;
+        }
+
+        let driver = super::shader_cache::DriverInfo {
+            vendor: read(GL_VENDOR),
+            renderer: read(GL_RENDERER),
+            version: read(GL_VERSION),
+        };
+        tracing::info!("Program binary cache enabled: {} / {} / {}",
+            driver.vendor, driver.renderer, driver.version);
+        Some(driver)
+    }
+
+    /// Program cache key for a source pair, None when the cache is disabled
+    unsafe fn program_cache_key(vs_src: &str, fs_src: &str) -> Option<u64> {
+        match PROGRAM_CACHE_DRIVER {
+            Some(ref driver) => Some(super::shader_cache::program_key(vs_src, fs_src, driver)),
+            None => None,
+        }
+    }
+
+    /// Build a program, loading the linked binary from the cache worker when
+    /// it has been read in (waiting at most `wait` for it)
+    unsafe fn build_program(label: &str, vs_src: &str, fs_src: &str, wait: std::time::Duration) -> Option<u32> {
+        use super::shader_cache::Lookup;
+        let start = std::time::Instant::now();
+
+        let (cache, key) = match (PROGRAM_CACHE.as_mut(), program_cache_key(vs_src, fs_src)) {
+            (Some(cache), Some(key)) => (cache, key),
+            _ => return compile_program(label, vs_src, fs_src),
+        };
+
+        let store = match cache.take(key, wait) {
+            Lookup::Hit(binary) => {
+                if let Some(program) = load_program_binary(&binary) {
+                    tracing::info!("Shader '{}' loaded from cache in {:?}", label, start.elapsed());
+                    return Some(program);
+                }
+                // Driver rejected it (e.g. same version string, different build)
+                tracing::warn!("Shader '{}' cache entry rejected, recompiling", label);
+                cache.invalidate(key);
+                true
+            }
+            Lookup::Miss => true,
+            Lookup::Pending => {
+                // The entry may well exist; leave it alone
+                tracing::info!("Shader '{}' cache read still pending, compiling", label);
+                false
+            }
+        };
+
+        let program = compile_program(label, vs_src, fs_src)?;
+        if store {
+            if let Some(binary) = get_program_binary(program) {
+                cache.store(key, binary);
+            }
+        }
+        tracing::info!("Shader '{}' compiled in {:?}", label, start.elapsed());
+        Some(program)
+    }
+
+    /// Create a program from a cached binary, None if the driver refuses it
+    unsafe fn load_program_binary(binary: &super::shader_cache::ProgramBinary) -> Option<u32> {
+        let program_binary = FN_PROGRAM_BINARY?;
+        let create_program = FN_CREATE_PROGRAM?;
+        let get_programiv = FN_GET_PROGRAMIV?;
+
+        while GetError() != 0 {}
+        let program = create_program();
+        program_binary(program, binary.format,
+            binary.data.as_ptr() as *const c_void, binary.data.len() as i32);
+
+        let mut status: i32 = 0;
+        get_programiv(program, LINK_STATUS, &mut status);
+        if status == 0 || GetError() != 0 {
+            if let Some(f) = FN_DELETE_PROGRAM { f(program); }
+            return None;
+        }
+        Some(program)
+    }
+
+    /// Fetch the linked binary of a program for caching
+    unsafe fn get_program_binary(program: u32) -> Option<super::shader_cache::ProgramBinary> {
+        let get_program_binary = FN_GET_PROGRAM_BINARY?;
+        let get_programiv = FN_GET_PROGRAMIV?;
+
+        let mut length: i32 = 0;
+        get_programiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &mut length);
+        if length <= 0 {
+            return None;
+        }
+
+        let mut data = vec![0u8; length as usize];
+        let mut written: i32 = 0;
+        let mut format: u32 = 0;
+        get_program_binary(program, length, &mut written, &mut format, data.as_mut_ptr() as *mut c_void);
+        if written <= 0 {
+            return None;
+        }
+        data.truncate(written as usize);
+        Some(super::shader_cache::ProgramBinary { format, data })
+    }
+
+    unsafe fn compile_shader(label: &str, kind: u32, src: &str) -> Option<u32> {
+        let create_shader = FN_CREATE_SHADER?;
+        let shader_source = FN_SHADER_SOURCE?;
+        let compile_shader = FN_COMPILE_SHADER?;
+        let get_shaderiv = FN_GET_SHADERIV?;
+
+        let shader = create_shader(kind);
+        let c_src = CString::new(src).unwrap();
+        let src_ptr = c_src.as_ptr();
+        shader_source(shader, 1, &src_ptr, std::ptr::null());
+        compile_shader(shader);
+
+        let mut status: i32 = 0;
+        get_shaderiv(shader, COMPILE_STATUS, &mut status);
+        if status == 0 {
+            let stage = if kind == VERTEX_SHADER { "vertex" } else { "fragment" };
+            tracing::error!("Shader '{}' {} compilation failed", label, stage);
+            if let Some(f) = FN_DELETE_SHADER { f(shader); }
+            return None;
+        }
+        Some(shader)
+    }
+
+    /// Compile and link a program from source
+    unsafe fn compile_program(label: &str, vs_src: &str, fs_src: &str) -> Option<u32> {
+        let create_program = FN_CREATE_PROGRAM?;
+        let attach_shader = FN_ATTACH_SHADER?;
+        let link_program = FN_LINK_PROGRAM?;
+        let get_programiv = FN_GET_PROGRAMIV?;
+
+        let vs = compile_shader(label, VERTEX_SHADER, vs_src)?;
+        let fs = match compile_shader(label, FRAGMENT_SHADER, fs_src) {
+            Some(fs) => fs,
+            None => {
+                if let Some(f) = FN_DELETE_SHADER { f(vs); }
+                return None;
+            }
+        };
+
+        let program = create_program();
+        attach_shader(program, vs);
+        attach_shader(program, fs);
+        // Pin a_position so every program can share the quad VAO
+        if let Some(f) = FN_BIND_ATTRIB_LOCATION {
+            let pos_name = CString::new("a_position").unwrap();
+            f(program, QUAD_ATTR, pos_name.as_ptr());
+        }
+        link_program(program);
+
+        // Shaders are only flagged for deletion; they live as long as the program
+        if let Some(f) = FN_DELETE_SHADER {
+            f(vs);
+            f(fs);
+        }
+
+        let mut status: i32 = 0;
+        get_programiv(program, LINK_STATUS, &mut status);
+        if status == 0 {
+            tracing::error!("Shader '{}' program linking failed", label);
+            if let Some(f) = FN_DELETE_PROGRAM { f(program); }
+            return None;
+        }
+
+        Some(program)
+    }
+
+    /// Build the distortion program on first need
+    unsafe fn ensure_distort_program() {
+        if !DISTORT_PENDING {
+            return;
+        }
+        DISTORT_PENDING = false;
+
+        if let Some(program) = build_program("distort", VERTEX_SHADER_SRC, DISTORT_FRAGMENT_SRC, std::time::Duration::ZERO) {
             DISTORT_PROGRAM = program;
 
             let pos_name = CString::new("a_position").unwrap();
-            let tex_name = CString::new("a_texcoord").unwrap();
             let tex_uni = CString::new("u_texture").unwrap();
+            let rect_uni = CString::new("u_rect").unwrap();
+            let uv_uni = CString::new("u_uv").unwrap();
             let pos_uni = CString::new("u_positions").unwrap();
             let params_uni = CString::new("u_params").unwrap();
             let count_uni = CString::new("u_count").unwrap();
@@ -5679,10 +6031,11 @@ mod gl {
 
             if let Some(f) = FN_GET_ATTRIB_LOCATION {
                 DISTORT_ATTR_POSITION = f(program, pos_name.as_ptr());
-                DISTORT_ATTR_TEXCOORD = f(program, tex_name.as_ptr());
             }
             if let Some(f) = FN_GET_UNIFORM_LOCATION {
                 DISTORT_UNIFORM_TEXTURE = f(program, tex_uni.as_ptr());
+                DISTORT_UNIFORM_RECT = f(program, rect_uni.as_ptr());
+                DISTORT_UNIFORM_UV = f(program, uv_uni.as_ptr());
                 DISTORT_UNIFORM_POSITIONS = f(program, pos_uni.as_ptr());
                 DISTORT_UNIFORM_PARAMS = f(program, params_uni.as_ptr());
                 DISTORT_UNIFORM_COUNT = f(program, count_uni.as_ptr());
@@ -5697,6 +6050,9 @@ mod gl {
                 DISTORT_UNIFORM_TOUCH_TIME = f(program, touch_time_uni.as_ptr());
             }
 
+            use_program(program);
+            if let Some(f) = FN_UNIFORM1I { f(DISTORT_UNIFORM_TEXTURE, 0); }
+
             tracing::info!("Distortion shader created: program={}, positions={}, params={}, count={}, aspect={}, style={}, density={}, living={}, time={}, lp_flags={}, touch_x={}, touch_y={}, touch_time={}",
                 DISTORT_PROGRAM, DISTORT_UNIFORM_POSITIONS, DISTORT_UNIFORM_PARAMS,
                 DISTORT_UNIFORM_COUNT, DISTORT_UNIFORM_ASPECT, DISTORT_UNIFORM_STYLE, DISTORT_UNIFORM_DENSITY,
@@ -5704,112 +6060,55 @@ mod gl {
                 DISTORT_UNIFORM_LP_FLAGS, DISTORT_UNIFORM_TOUCH_X, DISTORT_UNIFORM_TOUCH_Y, DISTORT_UNIFORM_TOUCH_TIME);
         }
 
-        INITIALIZED = true;
-        tracing::info!("OpenGL ES 2.0 functions loaded");
     }
 
-    unsafe fn create_shader_program() -> Option<u32> {
-        let create_shader = FN_CREATE_SHADER?;
-        let shader_source = FN_SHADER_SOURCE?;
-        let compile_shader = FN_COMPILE_SHADER?;
-        let get_shaderiv = FN_GET_SHADERIV?;
-        let create_program = FN_CREATE_PROGRAM?;
-        let attach_shader = FN_ATTACH_SHADER?;
-        let link_program = FN_LINK_PROGRAM?;
-        let get_programiv = FN_GET_PROGRAMIV?;
-
-        // Create vertex shader
-        let vs = create_shader(VERTEX_SHADER);
-        let vs_src = CString::new(VERTEX_SHADER_SRC).unwrap();
-        let vs_ptr = vs_src.as_ptr();
-        shader_source(vs, 1, &vs_ptr, std::ptr::null());
-        compile_shader(vs);
-
-        let mut status: i32 = 0;
-        get_shaderiv(vs, COMPILE_STATUS, &mut status);
-        if status == 0 {
-            tracing::error!("Vertex shader compilation failed");
-            return None;
-        }
-
-        // Create fragment shader
-        let fs = create_shader(FRAGMENT_SHADER);
-        let fs_src = CString::new(FRAGMENT_SHADER_SRC).unwrap();
-        let fs_ptr = fs_src.as_ptr();
-        shader_source(fs, 1, &fs_ptr, std::ptr::null());
-        compile_shader(fs);
-
-        get_shaderiv(fs, COMPILE_STATUS, &mut status);
-        if status == 0 {
-            tracing::error!("Fragment shader compilation failed");
-            return None;
+    /// Build the rotated blit program on first need
+    unsafe fn ensure_rotate_program() {
+        if !ROTATE_PENDING {
+            return;
         }
+        ROTATE_PENDING = false;
 
-        // Create program
-        let program = create_program();
-        attach_shader(program, vs);
-        attach_shader(program, fs);
-        link_program(program);
-
-        get_programiv(program, LINK_STATUS, &mut status);
-        if status == 0 {
-            tracing::error!("Shader program linking failed");
-            return None;
-        }
+        if let Some(program) = build_program("rotate", ROTATE_VERTEX_SRC, FRAGMENT_SHADER_SRC, std::time::Duration::ZERO) {
+            ROTATE_PROGRAM = program;
 
-        Some(program)
-    }
-
-    unsafe fn create_distort_shader_program() -> Option<u32> {
-        let create_shader = FN_CREATE_SHADER?;
-        let shader_source = FN_SHADER_SOURCE?;
-        let compile_shader = FN_COMPILE_SHADER?;
-        let get_shaderiv = FN_GET_SHADERIV?;
-        let create_program = FN_CREATE_PROGRAM?;
-        let attach_shader = FN_ATTACH_SHADER?;
-        let link_program = FN_LINK_PROGRAM?;
-        let get_programiv = FN_GET_PROGRAMIV?;
-
-        // Create vertex shader (same as normal)
-        let vs = create_shader(VERTEX_SHADER);
-        let vs_src = CString::new(VERTEX_SHADER_SRC).unwrap();
-        let vs_ptr = vs_src.as_ptr();
-        shader_source(vs, 1, &vs_ptr, std::ptr::null());
-        compile_shader(vs);
+            let pos_name = CString::new("a_position").unwrap();
+            let tex_uni = CString::new("u_texture").unwrap();
+            let rect_uni = CString::new("u_rect").unwrap();
+            let rot_uni = CString::new("u_rot").unwrap();
 
-        let mut status: i32 = 0;
-        get_shaderiv(vs, COMPILE_STATUS, &mut status);
-        if status == 0 {
-            tracing::error!("Distortion vertex shader compilation failed");
-            return None;
-        }
+            if let Some(f) = FN_GET_ATTRIB_LOCATION {
+                ROTATE_ATTR_POSITION = f(program, pos_name.as_ptr());
+            }
+            let mut texture_loc = -1;
+            if let Some(f) = FN_GET_UNIFORM_LOCATION {
+                texture_loc = f(program, tex_uni.as_ptr());
+                ROTATE_UNIFORM_RECT = f(program, rect_uni.as_ptr());
+                ROTATE_UNIFORM_ROT = f(program, rot_uni.as_ptr());
+            }
 
-        // Create distortion fragment shader
-        let fs = create_shader(FRAGMENT_SHADER);
-        let fs_src = CString::new(DISTORT_FRAGMENT_SRC).unwrap();
-        let fs_ptr = fs_src.as_ptr();
-        shader_source(fs, 1, &fs_ptr, std::ptr::null());
-        compile_shader(fs);
+            use_program(program);
+            if let Some(f) = FN_UNIFORM1I { f(texture_loc, 0); }
 
-        get_shaderiv(fs, COMPILE_STATUS, &mut status);
-        if status == 0 {
-            tracing::error!("Distortion fragment shader compilation failed");
-            return None;
+            tracing::info!("Rotate shader created: program={}, rect={}, rot={}",
+                ROTATE_PROGRAM, ROTATE_UNIFORM_RECT, ROTATE_UNIFORM_ROT);
         }
+    }
 
-        // Create program
-        let program = create_program();
-        attach_shader(program, vs);
-        attach_shader(program, fs);
-        link_program(program);
-
-        get_programiv(program, LINK_STATUS, &mut status);
-        if status == 0 {
-            tracing::error!("Distortion shader program linking failed");
-            return None;
+    /// Build programs that were deferred at init. Called after frames once
+    /// the first one is on screen so effects don't hitch the first time
+    /// they're used. Waits for the program's cache read rather than compiling
+    /// over it; returns true once there is nothing left to warm.
+    pub unsafe fn warm_deferred_programs() -> bool {
+        if DISTORT_PENDING {
+            if let (Some(cache), Some(key)) = (PROGRAM_CACHE.as_mut(), program_cache_key(VERTEX_SHADER_SRC, DISTORT_FRAGMENT_SRC)) {
+                if !cache.is_ready(key) {
+                    return false;
+                }
+            }
         }
-
-        Some(program)
+        ensure_distort_program();
+        true
     }
 
     #[allow(non_snake_case)]
@@ -5846,112 +6145,232 @@ mod gl {
         }
     }
 
-    // Frame counter for throttled logging
-    static mut FRAME_COUNT: u64 = 0;
+    /// Upload the static unit quad and, where supported, record it in a VAO
+    unsafe fn create_quad_buffers() {
+        let (gen_buffers, bind_buffer, buffer_data) = match (FN_GEN_BUFFERS, FN_BIND_BUFFER, FN_BUFFER_DATA) {
+            (Some(g), Some(b), Some(d)) => (g, b, d),
+            _ => {
+                tracing::error!("Vertex buffer objects not available");
+                return;
+            }
+        };
 
-    /// Render a texture (RGBA pixel buffer) to fill the screen
-    pub unsafe fn render_texture(tex_width: u32, tex_height: u32, pixels: &[u8], screen_width: u32, screen_height: u32) {
-        FRAME_COUNT += 1;
-        let log_frame = FRAME_COUNT % 60 == 0; // Log every 60 frames
+        // Triangle strip: bottom-left, bottom-right, top-left, top-right
+        let unit_quad: [f32; 8] = [0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0];
+        gen_buffers(1, &mut QUAD_VBO);
+        bind_buffer(GL_ARRAY_BUFFER, QUAD_VBO);
+        buffer_data(GL_ARRAY_BUFFER, std::mem::size_of_val(&unit_quad) as isize,
+            unit_quad.as_ptr() as *const c_void, GL_STATIC_DRAW);
 
-        if SHADER_PROGRAM == 0 || ATTR_POSITION < 0 || ATTR_TEXCOORD < 0 {
-            tracing::warn!("Shader not initialized");
+        if let (Some(gen_vaos), Some(bind_vao)) = (FN_GEN_VERTEX_ARRAYS, FN_BIND_VERTEX_ARRAY) {
+            gen_vaos(1, &mut QUAD_VAO);
+            bind_vao(QUAD_VAO);
+            setup_quad_attrib(QUAD_ATTR);
+            bind_vao(0);
+        }
+        STATE.quad_bound = false;
+
+        tracing::info!("Quad buffers created: vbo={}, vao={}", QUAD_VBO, QUAD_VAO);
+    }
+
+    /// Point an attribute at the quad VBO (records into the VAO if one is bound)
+    unsafe fn setup_quad_attrib(attr: u32) {
+        if let Some(f) = FN_BIND_BUFFER { f(GL_ARRAY_BUFFER, QUAD_VBO); }
+        if let Some(f) = FN_ENABLE_VERTEX_ATTRIB_ARRAY { f(attr); }
+        if let Some(f) = FN_VERTEX_ATTRIB_POINTER {
+            f(attr, 2, FLOAT, FALSE, 0, std::ptr::null());
+        }
+    }
+
+    /// Make the quad geometry current for `attr`
+    unsafe fn bind_quad(attr: i32) {
+        if attr as u32 != QUAD_ATTR {
+            // Program linked without our attribute binding - set up by hand,
+            // outside the shared VAO so its QUAD_ATTR setup is left alone
+            if let Some(f) = FN_BIND_VERTEX_ARRAY {
+                if QUAD_VAO != 0 {
+                    f(0);
+                }
+            }
+            setup_quad_attrib(attr as u32);
+            STATE.quad_bound = false;
+            return;
+        }
+        if STATE.quad_bound {
             return;
         }
+        match FN_BIND_VERTEX_ARRAY {
+            Some(f) if QUAD_VAO != 0 => f(QUAD_VAO),
+            _ => setup_quad_attrib(QUAD_ATTR),
+        }
+        STATE.quad_bound = true;
+    }
 
-        // Clear any pending errors
-        while GetError() != 0 {}
+    unsafe fn use_program(program: u32) {
+        if STATE.program != program {
+            if let Some(f) = FN_USE_PROGRAM { f(program); }
+            STATE.program = program;
+        }
+    }
 
-        // Set viewport
-        if let Some(f) = FN_VIEWPORT {
-            f(0, 0, screen_width as i32, screen_height as i32);
+    unsafe fn bind_texture_2d(texture: u32) {
+        if STATE.texture != texture {
+            if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, texture); }
+            STATE.texture = texture;
         }
-        check_error("viewport");
+    }
 
-        // Create and bind texture
+    /// Alpha blending on/off (blend func is always SRC_ALPHA, ONE_MINUS_SRC_ALPHA)
+    unsafe fn set_blend(enabled: bool) {
+        if STATE.blend == Some(enabled) {
+            return;
+        }
+        if enabled {
+            if let Some(f) = FN_ENABLE { f(BLEND); }
+            if STATE.blend.is_none() {
+                if let Some(f) = FN_BLEND_FUNC { f(SRC_ALPHA, ONE_MINUS_SRC_ALPHA); }
+            }
+        } else if let Some(f) = FN_DISABLE {
+            f(BLEND);
+        }
+        STATE.blend = Some(enabled);
+    }
+
+    /// Set a full-target viewport, skipping the call if it's unchanged
+    pub unsafe fn set_viewport(width: u32, height: u32) {
+        let vp = (0, 0, width as i32, height as i32);
+        if STATE.viewport != vp {
+            if let Some(f) = FN_VIEWPORT { f(vp.0, vp.1, vp.2, vp.3); }
+            STATE.viewport = vp;
+        }
+    }
+
+    /// Forget cached GL state after code outside this tracker changed it
+    pub unsafe fn invalidate_state() {
+        STATE.program = u32::MAX;
+        STATE.texture = u32::MAX;
+        STATE.blend = None;
+        STATE.viewport = (-1, -1, -1, -1);
+        STATE.quad_bound = false;
+    }
+
+    /// Draw the unit quad with the current program and texture
+    unsafe fn draw_quad(attr: i32, rect_loc: i32, uv_loc: i32, rect: [f32; 4], uv: [f32; 4]) {
+        bind_quad(attr);
+        if let Some(f) = FN_UNIFORM4F {
+            f(rect_loc, rect[0], rect[1], rect[2], rect[3]);
+            f(uv_loc, uv[0], uv[1], uv[2], uv[3]);
+        }
+        if let Some(f) = FN_DRAW_ARRAYS {
+            f(TRIANGLE_STRIP, 0, 4);
+        }
+    }
+
+    /// NDC rect for a tex_width x tex_height quad at screen pixel (x, y) from top-left
+    fn placed_rect(x: i32, y: i32, tex_width: u32, tex_height: u32,
+                   screen_width: u32, screen_height: u32) -> [f32; 4] {
+        let sw = screen_width as f32;
+        let sh = screen_height as f32;
+        let left = (x as f32 / sw) * 2.0 - 1.0;
+        let bottom = 1.0 - ((y as f32 + tex_height as f32) / sh) * 2.0;
+        [left, bottom, (tex_width as f32 / sw) * 2.0, (tex_height as f32 / sh) * 2.0]
+    }
+
+    /// Create a texture holding `pixels` (caller deletes it)
+    unsafe fn upload_texture(tex_width: u32, tex_height: u32, pixels: &[u8]) -> u32 {
         let mut texture: u32 = 0;
         if let Some(f) = FN_GEN_TEXTURES { f(1, &mut texture); }
-        check_error("genTextures");
+        bind_texture_2d(texture);
 
-        if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, texture); }
-        check_error("bindTexture");
-
-        // Set texture parameters
         if let Some(f) = FN_TEX_PARAMETERI {
             f(TEXTURE_2D, TEXTURE_MIN_FILTER, LINEAR);
             f(TEXTURE_2D, TEXTURE_MAG_FILTER, LINEAR);
         }
-        check_error("texParameteri");
 
-        // Upload texture data
-        let expected_size = (tex_width * tex_height * 4) as usize;
-        if pixels.len() != expected_size {
-            tracing::error!("Pixel buffer size mismatch: got {}, expected {}", pixels.len(), expected_size);
-            return;
+        if let Some(f) = FN_TEX_IMAGE_2D {
+            f(TEXTURE_2D, 0, RGBA as i32, tex_width as i32, tex_height as i32,
+              0, RGBA, UNSIGNED_BYTE, pixels.as_ptr() as *const c_void);
         }
+        texture
+    }
 
+    /// Upload pixels into a texture the caller keeps, reusing `texture` if it is non-zero
+    pub unsafe fn store_texture(texture: u32, tex_width: u32, tex_height: u32, pixels: &[u8]) -> u32 {
+        if pixels.len() != (tex_width * tex_height * 4) as usize {
+            return texture;
+        }
+        if texture == 0 {
+            return upload_texture(tex_width, tex_height, pixels);
+        }
+        bind_texture_2d(texture);
         if let Some(f) = FN_TEX_IMAGE_2D {
             f(TEXTURE_2D, 0, RGBA as i32, tex_width as i32, tex_height as i32,
               0, RGBA, UNSIGNED_BYTE, pixels.as_ptr() as *const c_void);
         }
-        check_error("texImage2D");
+        texture
+    }
 
-        // Use shader program
-        if let Some(f) = FN_USE_PROGRAM { f(SHADER_PROGRAM); }
-        check_error("useProgram");
+    /// Draw an existing texture stretched over the whole screen
+    pub unsafe fn render_texture_id(texture_id: u32, screen_width: u32, screen_height: u32) {
+        render_texture_id_at(texture_id, screen_width, screen_height, 0, 0);
+    }
 
-        // Set texture uniform
-        if let Some(f) = FN_ACTIVE_TEXTURE { f(0x84C0); } // GL_TEXTURE0
-        check_error("activeTexture");
+    /// Draw an existing texture at screen size, shifted by (x, y) pixels
+    pub unsafe fn render_texture_id_at(texture_id: u32, screen_width: u32, screen_height: u32, x: i32, y: i32) {
+        if SHADER_PROGRAM == 0 || ATTR_POSITION < 0 || texture_id == 0 {
+            return;
+        }
+        set_viewport(screen_width, screen_height);
+        bind_texture_2d(texture_id);
+        use_program(SHADER_PROGRAM);
+        set_blend(true);
+        let rect = placed_rect(x, y, screen_width, screen_height, screen_width, screen_height);
+        draw_quad(ATTR_POSITION, UNIFORM_RECT, UNIFORM_UV, rect, UV_FLIPPED);
 
-        if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, texture); }
-        check_error("bindTexture2");
+        // Finish to ensure GPU completes all rendering (prevents tearing on tiled GPUs)
+        Finish();
+    }
 
-        if let Some(f) = FN_UNIFORM1I { f(UNIFORM_TEXTURE, 0); }
-        check_error("uniform1i");
+    // Frame counter for throttled logging
+    static mut FRAME_COUNT: u64 = 0;
 
-        // Full-screen quad vertices (position + texcoord interleaved)
-        // Shell always renders in portrait - NO rotation applied here
-        let vertices: [f32; 16] = [
-            // Position (x, y)  // TexCoord (u, v)
-            -1.0, -1.0,         0.0, 1.0,  // Bottom-left
-             1.0, -1.0,         1.0, 1.0,  // Bottom-right
-            -1.0,  1.0,         0.0, 0.0,  // Top-left
-             1.0,  1.0,         1.0, 0.0,  // Top-right
-        ];
+    /// Render a texture (RGBA pixel buffer) to fill the screen
+    pub unsafe fn render_texture(tex_width: u32, tex_height: u32, pixels: &[u8], screen_width: u32, screen_height: u32) {
+        FRAME_COUNT += 1;
+        let log_frame = FRAME_COUNT % 60 == 0; // Log every 60 frames
 
-        // Set vertex attributes
-        if let Some(f) = FN_ENABLE_VERTEX_ATTRIB_ARRAY {
-            f(ATTR_POSITION as u32);
-            f(ATTR_TEXCOORD as u32);
+        if SHADER_PROGRAM == 0 || ATTR_POSITION < 0 {
+            tracing::warn!("Shader not initialized");
+            return;
         }
-        check_error("enableVertexAttribArray");
 
-        if let Some(f) = FN_VERTEX_ATTRIB_POINTER {
-            let stride = 4 * std::mem::size_of::<f32>() as i32;
-            f(ATTR_POSITION as u32, 2, FLOAT, FALSE, stride, vertices.as_ptr() as *const c_void);
-            f(ATTR_TEXCOORD as u32, 2, FLOAT, FALSE, stride,
-              (vertices.as_ptr() as *const f32).add(2) as *const c_void);
+        let expected_size = (tex_width * tex_height * 4) as usize;
+        if pixels.len() != expected_size {
+            tracing::error!("Pixel buffer size mismatch: got {}, expected {}", pixels.len(), expected_size);
+            return;
         }
-        check_error("vertexAttribPointer");
 
-        // Enable blending for transparency
-        if let Some(f) = FN_ENABLE { f(BLEND); }
-        if let Some(f) = FN_BLEND_FUNC { f(SRC_ALPHA, ONE_MINUS_SRC_ALPHA); }
-        check_error("blend setup");
+        // Clear any pending errors
+        while GetError() != 0 {}
 
-        // Draw
-        if let Some(f) = FN_DRAW_ARRAYS {
-            f(TRIANGLE_STRIP, 0, 4);
-        }
+        set_viewport(screen_width, screen_height);
+        check_error("viewport");
+
+        let texture = upload_texture(tex_width, tex_height, pixels);
+        check_error("texImage2D");
+
+        use_program(SHADER_PROGRAM);
+        set_blend(true);
+        check_error("state setup");
+
+        // Shell always renders in portrait - NO rotation applied here
+        draw_quad(ATTR_POSITION, UNIFORM_RECT, UNIFORM_UV, FULLSCREEN_RECT, UV_FLIPPED);
         check_error("drawArrays");
 
         // Finish to ensure GPU completes all rendering (prevents tearing on tiled GPUs)
         Finish();
 
-        // Cleanup
-        if let Some(f) = FN_DISABLE { f(BLEND); }
-        if let Some(f) = FN_DELETE_TEXTURES { f(1, &texture); }
+        delete_texture(texture);
 
         if log_frame {
             // Log first few pixels to verify content
@@ -5969,92 +6388,30 @@ mod gl {
     pub unsafe fn render_texture_at(tex_width: u32, tex_height: u32, pixels: &[u8],
                                      screen_width: u32, screen_height: u32,
                                      x: i32, y: i32) {
-        if SHADER_PROGRAM == 0 || ATTR_POSITION < 0 || ATTR_TEXCOORD < 0 {
+        if SHADER_PROGRAM == 0 || ATTR_POSITION < 0 {
             return;
         }
 
-        // Clear any pending errors
-        while GetError() != 0 {}
-
-        // Set viewport
-        if let Some(f) = FN_VIEWPORT {
-            f(0, 0, screen_width as i32, screen_height as i32);
-        }
-
-        // Create and bind texture
-        let mut texture: u32 = 0;
-        if let Some(f) = FN_GEN_TEXTURES { f(1, &mut texture); }
-        if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, texture); }
-
-        // Set texture parameters
-        if let Some(f) = FN_TEX_PARAMETERI {
-            f(TEXTURE_2D, TEXTURE_MIN_FILTER, LINEAR);
-            f(TEXTURE_2D, TEXTURE_MAG_FILTER, LINEAR);
-        }
-
-        // Upload texture data
         let expected_size = (tex_width * tex_height * 4) as usize;
         if pixels.len() != expected_size {
             return;
         }
 
-        if let Some(f) = FN_TEX_IMAGE_2D {
-            f(TEXTURE_2D, 0, RGBA as i32, tex_width as i32, tex_height as i32,
-              0, RGBA, UNSIGNED_BYTE, pixels.as_ptr() as *const c_void);
-        }
-
-        // Use shader program
-        if let Some(f) = FN_USE_PROGRAM { f(SHADER_PROGRAM); }
-
-        // Set texture uniform
-        if let Some(f) = FN_ACTIVE_TEXTURE { f(0x84C0); } // GL_TEXTURE0
-        if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, texture); }
-        if let Some(f) = FN_UNIFORM1I { f(UNIFORM_TEXTURE, 0); }
-
-        // Calculate positioned vertices
-        let sw = screen_width as f32;
-        let sh = screen_height as f32;
-        let tw = tex_width as f32;
-        let th = tex_height as f32;
-        let left = (x as f32 / sw) * 2.0 - 1.0;
-        let right = ((x as f32 + tw) / sw) * 2.0 - 1.0;
-        let top = 1.0 - (y as f32 / sh) * 2.0;
-        let bottom = 1.0 - ((y as f32 + th) / sh) * 2.0;
-        let vertices: [f32; 16] = [
-            left,  bottom,      0.0, 1.0,
-            right, bottom,      1.0, 1.0,
-            left,  top,         0.0, 0.0,
-            right, top,         1.0, 0.0,
-        ];
-
-        // Set vertex attributes
-        if let Some(f) = FN_ENABLE_VERTEX_ATTRIB_ARRAY {
-            f(ATTR_POSITION as u32);
-            f(ATTR_TEXCOORD as u32);
-        }
+        // Clear any pending errors
+        while GetError() != 0 {}
 
-        if let Some(f) = FN_VERTEX_ATTRIB_POINTER {
-            let stride = 4 * std::mem::size_of::<f32>() as i32;
-            f(ATTR_POSITION as u32, 2, FLOAT, FALSE, stride, vertices.as_ptr() as *const c_void);
-            f(ATTR_TEXCOORD as u32, 2, FLOAT, FALSE, stride,
-              (vertices.as_ptr() as *const f32).add(2) as *const c_void);
-        }
+        set_viewport(screen_width, screen_height);
+        let texture = upload_texture(tex_width, tex_height, pixels);
+        use_program(SHADER_PROGRAM);
+        set_blend(true);
 
-        // Enable blending for transparency
-        if let Some(f) = FN_ENABLE { f(BLEND); }
-        if let Some(f) = FN_BLEND_FUNC { f(SRC_ALPHA, ONE_MINUS_SRC_ALPHA); }
-
-        // Draw
-        if let Some(f) = FN_DRAW_ARRAYS {
-            f(TRIANGLE_STRIP, 0, 4);
-        }
+        let rect = placed_rect(x, y, tex_width, tex_height, screen_width, screen_height);
+        draw_quad(ATTR_POSITION, UNIFORM_RECT, UNIFORM_UV, rect, UV_FLIPPED);
 
         // Finish to ensure GPU completes all rendering (prevents tearing on tiled GPUs)
         Finish();
 
-        // Cleanup
-        if let Some(f) = FN_DISABLE { f(BLEND); }
-        if let Some(f) = FN_DELETE_TEXTURES { f(1, &texture); }
+        delete_texture(texture);
     }
 
     /// Render an existing GL texture at a specific position (for EGL-imported buffers)
@@ -6062,75 +6419,75 @@ mod gl {
     pub unsafe fn render_egl_texture_at(texture_id: u32, tex_width: u32, tex_height: u32,
                                          screen_width: u32, screen_height: u32,
                                          x: i32, y: i32) {
-        if SHADER_PROGRAM == 0 || ATTR_POSITION < 0 || ATTR_TEXCOORD < 0 {
+        if SHADER_PROGRAM == 0 || ATTR_POSITION < 0 {
             return;
         }
 
         // Clear any pending errors
         while GetError() != 0 {}
 
-        // Set viewport
-        if let Some(f) = FN_VIEWPORT {
-            f(0, 0, screen_width as i32, screen_height as i32);
-        }
+        set_viewport(screen_width, screen_height);
 
-        // Bind the existing texture
-        if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, texture_id); }
+        // Filters are set once in create_texture_from_egl_image
+        bind_texture_2d(texture_id);
+        use_program(SHADER_PROGRAM);
+        set_blend(true);
 
-        // Set texture parameters (in case they weren't set)
-        if let Some(f) = FN_TEX_PARAMETERI {
-            f(TEXTURE_2D, TEXTURE_MIN_FILTER, LINEAR);
-            f(TEXTURE_2D, TEXTURE_MAG_FILTER, LINEAR);
-        }
-
-        // Use shader program
-        if let Some(f) = FN_USE_PROGRAM { f(SHADER_PROGRAM); }
+        let rect = placed_rect(x, y, tex_width, tex_height, screen_width, screen_height);
+        draw_quad(ATTR_POSITION, UNIFORM_RECT, UNIFORM_UV, rect, UV_FLIPPED);
 
-        // Set texture uniform
-        if let Some(f) = FN_ACTIVE_TEXTURE { f(0x84C0); } // GL_TEXTURE0
-        if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, texture_id); }
-        if let Some(f) = FN_UNIFORM1I { f(UNIFORM_TEXTURE, 0); }
+        // Finish to ensure GPU completes all rendering (prevents tearing on tiled GPUs)
+        Finish();
+        // Note: Don't delete the texture - it's cached for reuse
+    }
 
-        // Calculate positioned vertices
-        let sw = screen_width as f32;
-        let sh = screen_height as f32;
-        let tw = tex_width as f32;
-        let th = tex_height as f32;
-        let left = (x as f32 / sw) * 2.0 - 1.0;
-        let right = ((x as f32 + tw) / sw) * 2.0 - 1.0;
-        let top = 1.0 - (y as f32 / sh) * 2.0;
-        let bottom = 1.0 - ((y as f32 + th) / sh) * 2.0;
-        let vertices: [f32; 16] = [
-            left,  bottom,      0.0, 1.0,
-            right, bottom,      1.0, 1.0,
-            left,  top,         0.0, 0.0,
-            right, top,         1.0, 0.0,
-        ];
+    /// Whether the keyboard layer texture exists at this size (else it needs a full upload)
+    pub unsafe fn keyboard_layer_ready(width: u32, height: u32) -> bool {
+        KEYBOARD_TEXTURE != 0 && KEYBOARD_TEX_WIDTH == width && KEYBOARD_TEX_HEIGHT == height
+    }
 
-        if let Some(f) = FN_ENABLE_VERTEX_ATTRIB_ARRAY {
-            f(ATTR_POSITION as u32);
-            f(ATTR_TEXCOORD as u32);
+    /// Copy repainted keyboard pixels into the layer texture
+    /// A damage rect covering the whole layer (re)creates the texture
+    pub unsafe fn update_keyboard_layer(width: u32, height: u32, damage: &crate::shell::slint_ui::LayerDamage) {
+        if damage.pixels.len() != (damage.width * damage.height * 4) as usize {
+            return;
+        }
+        if damage.width == width && damage.height == height {
+            if KEYBOARD_TEXTURE != 0 {
+                delete_texture(KEYBOARD_TEXTURE);
+            }
+            KEYBOARD_TEXTURE = upload_texture(width, height, &damage.pixels);
+            KEYBOARD_TEX_WIDTH = width;
+            KEYBOARD_TEX_HEIGHT = height;
+            return;
+        }
+        if !keyboard_layer_ready(width, height) {
+            return;
+        }
+        bind_texture_2d(KEYBOARD_TEXTURE);
+        if let Some(f) = FN_TEX_SUB_IMAGE_2D {
+            f(TEXTURE_2D, 0, damage.x as i32, damage.y as i32, damage.width as i32, damage.height as i32,
+              RGBA, UNSIGNED_BYTE, damage.pixels.as_ptr() as *const c_void);
         }
+    }
 
-        if let Some(f) = FN_VERTEX_ATTRIB_POINTER {
-            let stride = 4 * std::mem::size_of::<f32>() as i32;
-            f(ATTR_POSITION as u32, 2, FLOAT, FALSE, stride, vertices.as_ptr() as *const c_void);
-            f(ATTR_TEXCOORD as u32, 2, FLOAT, FALSE, stride,
-              (vertices.as_ptr() as *const f32).add(2) as *const c_void);
+    /// Draw the keyboard layer across the screen width with its top edge at y
+    /// (the slide animation is just this y), scaled to `height` screen pixels
+    pub unsafe fn render_keyboard_layer(screen_width: u32, screen_height: u32, y: i32, height: u32) {
+        if SHADER_PROGRAM == 0 || ATTR_POSITION < 0 || KEYBOARD_TEXTURE == 0 {
+            return;
         }
 
-        if let Some(f) = FN_ENABLE { f(BLEND); }
-        if let Some(f) = FN_BLEND_FUNC { f(SRC_ALPHA, ONE_MINUS_SRC_ALPHA); }
+        set_viewport(screen_width, screen_height);
+        bind_texture_2d(KEYBOARD_TEXTURE);
+        use_program(SHADER_PROGRAM);
+        set_blend(true);
 
-        if let Some(f) = FN_DRAW_ARRAYS {
-            f(TRIANGLE_STRIP, 0, 4);
-        }
+        let rect = placed_rect(0, y, screen_width, height, screen_width, screen_height);
+        draw_quad(ATTR_POSITION, UNIFORM_RECT, UNIFORM_UV, rect, UV_FLIPPED);
 
         // Finish to ensure GPU completes all rendering (prevents tearing on tiled GPUs)
         Finish();
-
-        if let Some(f) = FN_DISABLE { f(BLEND); }
-        // Note: Don't delete the texture - it's cached for reuse
     }
 
     /// Create a GL texture from an EGL image
@@ -6144,9 +6501,7 @@ mod gl {
         if let Some(gen_textures) = FN_GEN_TEXTURES {
             gen_textures(1, &mut texture_id);
         }
-        if let Some(bind_texture) = FN_BIND_TEXTURE {
-            bind_texture(TEXTURE_2D, texture_id);
-        }
+        bind_texture_2d(texture_id);
 
         // Bind EGL image to texture
         image_target_fn(TEXTURE_2D, egl_image);
@@ -6171,6 +6526,10 @@ mod gl {
         if let Some(f) = FN_DELETE_TEXTURES {
             f(1, &texture_id);
         }
+        // GL unbinds a deleted texture, and the name may be handed out again
+        if STATE.texture == texture_id {
+            STATE.texture = 0;
+        }
     }
 
     /// Apply distortion effects to the current framebuffer
@@ -6182,16 +6541,17 @@ mod gl {
         shader_data: &crate::touch_effects::TouchEffectShaderData,
         use_scene_texture: bool,
     ) {
-        if DISTORT_PROGRAM == 0 || DISTORT_ATTR_POSITION < 0 {
-            return;
-        }
-
         // For CRT mode (style 2) or living pixels, always render even with no touches
         // For other modes, only render when there are active effects
         if shader_data.count == 0 && shader_data.effect_style != 2 && shader_data.living_pixels != 1 {
             return;
         }
 
+        ensure_distort_program();
+        if DISTORT_PROGRAM == 0 || DISTORT_ATTR_POSITION < 0 {
+            return;
+        }
+
         // Clear any pending errors
         while GetError() != 0 {}
 
@@ -6212,13 +6572,13 @@ mod gl {
 
             if need_new_texture {
                 if CAPTURE_TEXTURE != 0 {
-                    if let Some(f) = FN_DELETE_TEXTURES { f(1, &CAPTURE_TEXTURE); }
+                    delete_texture(CAPTURE_TEXTURE);
                 }
                 if let Some(f) = FN_GEN_TEXTURES { f(1, &mut CAPTURE_TEXTURE); }
                 CAPTURE_TEX_WIDTH = screen_width;
                 CAPTURE_TEX_HEIGHT = screen_height;
 
-                if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, CAPTURE_TEXTURE); }
+                bind_texture_2d(CAPTURE_TEXTURE);
                 if let Some(f) = FN_TEX_PARAMETERI {
                     f(TEXTURE_2D, TEXTURE_MIN_FILTER, LINEAR);
                     f(TEXTURE_2D, TEXTURE_MAG_FILTER, LINEAR);
@@ -6226,7 +6586,7 @@ mod gl {
                     f(TEXTURE_2D, 0x2803, 0x812F);
                 }
             } else {
-                if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, CAPTURE_TEXTURE); }
+                bind_texture_2d(CAPTURE_TEXTURE);
             }
 
             if let Some(f) = FN_COPY_TEX_IMAGE_2D {
@@ -6238,18 +6598,14 @@ mod gl {
         // Select which texture to use
         let use_texture = source_texture;
 
-        // Set viewport
-        if let Some(f) = FN_VIEWPORT {
-            f(0, 0, screen_width as i32, screen_height as i32);
-        }
+        set_viewport(screen_width, screen_height);
 
-        // Use distortion shader
-        if let Some(f) = FN_USE_PROGRAM { f(DISTORT_PROGRAM); }
+        // Use distortion shader; it replaces the frame, so no blending
+        use_program(DISTORT_PROGRAM);
+        set_blend(false);
 
         // Bind the capture texture
-        if let Some(f) = FN_ACTIVE_TEXTURE { f(0x84C0); } // GL_TEXTURE0
-        if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, use_texture); }
-        if let Some(f) = FN_UNIFORM1I { f(DISTORT_UNIFORM_TEXTURE, 0); }
+        bind_texture_2d(use_texture);
 
         // Set uniforms
         if let Some(f) = FN_UNIFORM2FV {
@@ -6281,42 +6637,30 @@ mod gl {
             f(DISTORT_UNIFORM_TOUCH_TIME, shader_data.time_since_touch);
         }
 
-        // Fullscreen quad vertices
-        // Framebuffer has Y=0 at bottom, so use v=0 at bottom, v=1 at top
-        #[rustfmt::skip]
-        let vertices: [f32; 16] = [
-            // Position       // TexCoord
-            -1.0, -1.0,       0.0, 0.0,  // Bottom-left
-             1.0, -1.0,       1.0, 0.0,  // Bottom-right
-            -1.0,  1.0,       0.0, 1.0,  // Top-left
-             1.0,  1.0,       1.0, 1.0,  // Top-right
-        ];
-
-        // Set vertex attributes
-        if let Some(f) = FN_ENABLE_VERTEX_ATTRIB_ARRAY {
-            f(DISTORT_ATTR_POSITION as u32);
-            f(DISTORT_ATTR_TEXCOORD as u32);
-        }
-
-        if let Some(f) = FN_VERTEX_ATTRIB_POINTER {
-            let stride = 4 * std::mem::size_of::<f32>() as i32;
-            f(DISTORT_ATTR_POSITION as u32, 2, FLOAT, FALSE, stride, vertices.as_ptr() as *const c_void);
-            f(DISTORT_ATTR_TEXCOORD as u32, 2, FLOAT, FALSE, stride,
-              (vertices.as_ptr() as *const f32).add(2) as *const c_void);
-        }
-
-        // Draw fullscreen quad
-        if let Some(f) = FN_DRAW_ARRAYS {
-            f(TRIANGLE_STRIP, 0, 4);
-        }
+        // Fullscreen quad; framebuffer has Y=0 at bottom, so sample upright
+        draw_quad(DISTORT_ATTR_POSITION, DISTORT_UNIFORM_RECT, DISTORT_UNIFORM_UV,
+                  FULLSCREEN_RECT, UV_UPRIGHT);
 
         // Finish to ensure GPU completes all rendering (prevents tearing on tiled GPUs)
         Finish();
 
         // Note: Don't delete CAPTURE_TEXTURE - it's persistent and reused each frame
+    }
 
-        // Switch back to normal shader
-        if let Some(f) = FN_USE_PROGRAM { f(SHADER_PROGRAM); }
+    /// Draw the scene texture onto the default framebuffer turned by
+    /// `rotation` (see orientation::RotationPlan::blit_rotation)
+    pub unsafe fn render_rotated_scene(rotation: [f32; 4]) {
+        ensure_rotate_program();
+        if ROTATE_PROGRAM == 0 || ROTATE_ATTR_POSITION < 0 || SCENE_TEXTURE == 0 {
+            return;
+        }
+
+        use_program(ROTATE_PROGRAM);
+        set_blend(false);
+        bind_texture_2d(SCENE_TEXTURE);
+        // draw_quad's uv slot carries the rotation rows for this program
+        draw_quad(ROTATE_ATTR_POSITION, ROTATE_UNIFORM_RECT, ROTATE_UNIFORM_ROT,
+                  FULLSCREEN_RECT, rotation);
     }
 
     /// Check if FBO rendering is supported
@@ -6343,12 +6687,12 @@ mod gl {
                 if let Some(f) = FN_DELETE_FRAMEBUFFERS { f(1, &SCENE_FBO); }
             }
             if SCENE_TEXTURE != 0 {
-                if let Some(f) = FN_DELETE_TEXTURES { f(1, &SCENE_TEXTURE); }
+                delete_texture(SCENE_TEXTURE);
             }
 
             // Create texture for scene FBO
             if let Some(f) = FN_GEN_TEXTURES { f(1, &mut SCENE_TEXTURE); }
-            if let Some(f) = FN_BIND_TEXTURE { f(TEXTURE_2D, SCENE_TEXTURE); }
+            bind_texture_2d(SCENE_TEXTURE);
 
             // Allocate texture storage
             if let Some(f) = FN_TEX_IMAGE_2D {
@@ -6387,10 +6731,7 @@ mod gl {
             if let Some(f) = FN_BIND_FRAMEBUFFER { f(GL_FRAMEBUFFER, SCENE_FBO); }
         }
 
-        // Set viewport
-        if let Some(f) = FN_VIEWPORT {
-            f(0, 0, width as i32, height as i32);
-        }
+        set_viewport(width, height);
 
         SCENE_RENDERING_ACTIVE = true;
         true
@@ -6504,36 +6845,16 @@ mod gl {
         clear_color(0.0, 0.0, 0.0, 0.0);
         clear(0x00004000); // GL_COLOR_BUFFER_BIT
 
-        // Render the source texture to our FBO using the shader
-        // Set up shader
-        if let Some(use_prog) = FN_USE_PROGRAM { use_prog(SHADER_PROGRAM); }
-        if let Some(active_tex) = FN_ACTIVE_TEXTURE { active_tex(0x84C0); } // GL_TEXTURE0
-        bind_texture(TEXTURE_2D, texture_id);
-        if let Some(uniform) = FN_UNIFORM1I { uniform(UNIFORM_TEXTURE, 0); }
-
-        // Full-screen quad vertices (fills the FBO)
-        let vertices: [f32; 16] = [
-            -1.0, -1.0,    0.0, 1.0,  // bottom-left
-             1.0, -1.0,    1.0, 1.0,  // bottom-right
-            -1.0,  1.0,    0.0, 0.0,  // top-left
-             1.0,  1.0,    1.0, 0.0,  // top-right
-        ];
-
-        if let Some(f) = FN_ENABLE_VERTEX_ATTRIB_ARRAY {
-            f(ATTR_POSITION as u32);
-            f(ATTR_TEXCOORD as u32);
-        }
+        // Everything below bypasses the state tracker
+        invalidate_state();
 
-        if let Some(f) = FN_VERTEX_ATTRIB_POINTER {
-            let stride = 4 * std::mem::size_of::<f32>() as i32;
-            f(ATTR_POSITION as u32, 2, FLOAT, FALSE, stride, vertices.as_ptr() as *const c_void);
-            f(ATTR_TEXCOORD as u32, 2, FLOAT, FALSE, stride,
-              (vertices.as_ptr() as *const f32).add(2) as *const c_void);
-        }
+        // Render the source texture to our FBO using the shader
+        use_program(SHADER_PROGRAM);
+        set_blend(false);
+        bind_texture_2d(texture_id);
 
-        if let Some(f) = FN_DRAW_ARRAYS {
-            f(TRIANGLE_STRIP, 0, 4);
-        }
+        // Full-screen quad (fills the FBO)
+        draw_quad(ATTR_POSITION, UNIFORM_RECT, UNIFORM_UV, FULLSCREEN_RECT, UV_FLIPPED);
 
         Finish();
 
@@ -6547,6 +6868,7 @@ mod gl {
         viewport(saved_viewport[0], saved_viewport[1], saved_viewport[2], saved_viewport[3]);
         bind_texture(TEXTURE_2D, saved_texture as u32);
         if let Some(use_prog) = FN_USE_PROGRAM { use_prog(saved_program as u32); }
+        invalidate_state();
 
         // Flip vertically (OpenGL has origin at bottom-left, we need top-left)
         let row_size = (width * 4) as usize;
@@ -0,0 +1,417 @@
+//! Dedicated libinput thread for the hwcomposer backend
+//!
+//! libinput used to be a calloop source on the main loop, so a slow frame
+//! (GL render, Slint, file polling) delayed touch processing, and gesture
+//! velocity was computed from dispatch time. The libinput context now lives
+//! on its own raised-priority thread which:
+//!
+//! - keeps the kernel evdev timestamp (CLOCK_MONOTONIC, microseconds) on
+//!   every event, so gestures run on event time rather than dispatch time;
+//! - hands batches to the main loop over a calloop channel (a lock-free
+//!   mpsc queue plus an eventfd wakeup);
+//! - lets the main loop coalesce touch motion per frame, so a backlog after
+//!   a slow frame costs one motion per finger instead of one per sample.
+//!
+//! The event types mirror the accessors of smithay's libinput events
+//! (`slot()`, `position()`, `time_msec()`, ...) so the handler in
+//! hwcomposer.rs matches on them unchanged.
+//!
+//! The compositor runs as root on hwcomposer devices (see flick.service), so
+//! devices are opened directly rather than through the libseat session,
+//! whose handles cannot leave the main thread. There is no VT switching on
+//! these devices, so nothing is lost by not pausing on session events.
+//!
+//! Latency (event time to main-loop handling) is logged every
+//! `LATENCY_WINDOW` touch events; drive it with `tools/uinput_touch.py`.
+
+use std::fs::{File, OpenOptions};
+use std::os::fd::{AsRawFd, OwnedFd};
+use std::os::unix::fs::OpenOptionsExt;
+use std::path::Path;
+
+use smithay::backend::input::{ButtonState, KeyState, TouchSlot};
+use smithay::input::keyboard::Keycode;
+use smithay::reexports::calloop::channel::{self, Channel, Sender};
+use smithay::reexports::input::{
+    event::{
+        keyboard::{KeyState as LiKeyState, KeyboardEventTrait},
+        pointer::{ButtonState as LiButtonState, PointerEventTrait},
+        touch::{TouchEventPosition, TouchEventSlot, TouchEventTrait},
+        DeviceEvent, Event, EventTrait, KeyboardEvent, PointerEvent, TouchEvent,
+    },
+    Libinput, LibinputInterface,
+};
+use smithay::utils::{Logical, Point};
+
+/// SCHED_FIFO priority for the input thread (low, just above normal tasks)
+const INPUT_THREAD_PRIORITY: i32 = 10;
+
+/// Number of touch events per latency report
+const LATENCY_WINDOW: usize = 512;
+
+/// Input device, carrying just what the handler logs
+#[derive(Debug, Clone)]
+pub struct InputDevice {
+    name: String,
+}
+
+impl InputDevice {
+    pub fn name(&self) -> String {
+        self.name.clone()
+    }
+}
+
+/// Keyboard key event
+#[derive(Debug, Clone)]
+pub struct KeyEvent {
+    key: u32,
+    pressed: bool,
+    time_usec: u64,
+}
+
+impl KeyEvent {
+    /// XKB keycode (evdev code + 8), as smithay's libinput backend reports it
+    pub fn key_code(&self) -> Keycode {
+        Keycode::new(self.key + 8)
+    }
+
+    pub fn state(&self) -> KeyState {
+        if self.pressed { KeyState::Pressed } else { KeyState::Released }
+    }
+
+    pub fn time_msec(&self) -> u32 {
+        (self.time_usec / 1000) as u32
+    }
+}
+
+/// Relative pointer motion
+#[derive(Debug, Clone)]
+pub struct PointerMotion {
+    dx: f64,
+    dy: f64,
+    time_usec: u64,
+}
+
+impl PointerMotion {
+    pub fn delta(&self) -> Point<f64, Logical> {
+        Point::from((self.dx, self.dy))
+    }
+
+    pub fn time_msec(&self) -> u32 {
+        (self.time_usec / 1000) as u32
+    }
+}
+
+/// Pointer button press/release
+#[derive(Debug, Clone)]
+pub struct PointerButton {
+    button: u32,
+    pressed: bool,
+    time_usec: u64,
+}
+
+impl PointerButton {
+    pub fn button_code(&self) -> u32 {
+        self.button
+    }
+
+    pub fn state(&self) -> ButtonState {
+        if self.pressed { ButtonState::Pressed } else { ButtonState::Released }
+    }
+
+    pub fn time_msec(&self) -> u32 {
+        (self.time_usec / 1000) as u32
+    }
+}
+
+/// Touch down / motion / up sample. Position is unused for up.
+#[derive(Debug, Clone)]
+pub struct TouchSample {
+    slot: Option<u32>,
+    x: f64,
+    y: f64,
+    time_usec: u64,
+}
+
+impl TouchSample {
+    pub fn slot(&self) -> TouchSlot {
+        TouchSlot::from(self.slot)
+    }
+
+    /// Raw device position, same as smithay's `AbsolutePositionEvent::position()`
+    pub fn position(&self) -> Point<f64, Logical> {
+        Point::from((self.x, self.y))
+    }
+
+    /// Replace the position, e.g. to map panel into rotated coordinates
+    pub fn map_position(&mut self, f: impl FnOnce(f64, f64) -> (f64, f64)) {
+        (self.x, self.y) = f(self.x, self.y);
+    }
+
+    /// Kernel event time in microseconds (CLOCK_MONOTONIC)
+    pub fn time_usec(&self) -> u64 {
+        self.time_usec
+    }
+
+    pub fn time_msec(&self) -> u32 {
+        (self.time_usec / 1000) as u32
+    }
+}
+
+/// Input event as read on the input thread
+#[derive(Debug, Clone)]
+pub enum InputEvent {
+    DeviceAdded { device: InputDevice },
+    DeviceRemoved { device: InputDevice },
+    Keyboard { event: KeyEvent },
+    PointerMotion { event: PointerMotion },
+    PointerButton { event: PointerButton },
+    TouchDown { event: TouchSample },
+    TouchMotion { event: TouchSample },
+    TouchUp { event: TouchSample },
+    TouchCancel,
+}
+
+impl InputEvent {
+    fn touch_sample(&self) -> Option<&TouchSample> {
+        match self {
+            InputEvent::TouchDown { event }
+            | InputEvent::TouchMotion { event }
+            | InputEvent::TouchUp { event } => Some(event),
+            _ => None,
+        }
+    }
+}
+
+/// Drop touch motion that a later motion of the same slot supersedes.
+/// Down/up/cancel are ordering barriers and are always kept.
+pub fn coalesce(events: Vec<InputEvent>) -> Vec<InputEvent> {
+    let mut superseded: Vec<Option<u32>> = Vec::new();
+    let mut kept: Vec<InputEvent> = Vec::with_capacity(events.len());
+
+    for event in events.into_iter().rev() {
+        match &event {
+            InputEvent::TouchMotion { event: sample } => {
+                if superseded.contains(&sample.slot) {
+                    continue;
+                }
+                superseded.push(sample.slot);
+            }
+            InputEvent::TouchDown { event: sample } | InputEvent::TouchUp { event: sample } => {
+                superseded.retain(|slot| *slot != sample.slot);
+            }
+            InputEvent::TouchCancel => superseded.clear(),
+            _ => {}
+        }
+        kept.push(event);
+    }
+
+    kept.reverse();
+    kept
+}
+
+/// Opens evdev nodes directly (the compositor runs as root)
+struct DirectOpen;
+
+impl LibinputInterface for DirectOpen {
+    fn open_restricted(&mut self, path: &Path, flags: i32) -> Result<OwnedFd, i32> {
+        let access = flags & libc::O_ACCMODE;
+        OpenOptions::new()
+            .custom_flags(flags)
+            .read(access == libc::O_RDONLY || access == libc::O_RDWR)
+            .write(access == libc::O_WRONLY || access == libc::O_RDWR)
+            .open(path)
+            .map(OwnedFd::from)
+            .map_err(|e| e.raw_os_error().unwrap_or(libc::EIO))
+    }
+
+    fn close_restricted(&mut self, fd: OwnedFd) {
+        drop(File::from(fd));
+    }
+}
+
+/// Start the input thread on `seat`. Returns the channel to insert into the
+/// main event loop once libinput has been set up.
+pub fn spawn(seat: String) -> anyhow::Result<Channel<Vec<InputEvent>>> {
+    let (sender, channel) = channel::channel();
+    let (ready_tx, ready_rx) = std::sync::mpsc::sync_channel(1);
+
+    std::thread::Builder::new()
+        .name("flick-input".into())
+        .spawn(move || {
+            raise_priority();
+
+            let mut libinput = Libinput::new_with_udev(DirectOpen);
+            if libinput.udev_assign_seat(&seat).is_err() {
+                let _ = ready_tx.send(Err(anyhow::anyhow!("libinput: failed to assign seat {}", seat)));
+                return;
+            }
+            tracing::info!("Input thread: libinput assigned to seat {}", seat);
+            let _ = ready_tx.send(Ok(()));
+
+            run(&mut libinput, &sender);
+            tracing::warn!("Input thread exiting");
+        })?;
+
+    ready_rx.recv()??;
+    Ok(channel)
+}
+
+/// SCHED_FIFO so touch is read even while the render thread saturates the
+/// CPU; fall back to a negative nice value where RT is not permitted
+fn raise_priority() {
+    let param = libc::sched_param { sched_priority: INPUT_THREAD_PRIORITY };
+    if unsafe { libc::sched_setscheduler(0, libc::SCHED_FIFO, &param) } == 0 {
+        tracing::info!("Input thread: SCHED_FIFO priority {}", INPUT_THREAD_PRIORITY);
+        return;
+    }
+    let tid = unsafe { libc::syscall(libc::SYS_gettid) } as libc::id_t;
+    if unsafe { libc::setpriority(libc::PRIO_PROCESS, tid, -10) } != 0 {
+        tracing::warn!("Input thread: could not raise priority: {}", std::io::Error::last_os_error());
+    }
+}
+
+fn run(libinput: &mut Libinput, sender: &Sender<Vec<InputEvent>>) {
+    let fd = libinput.as_raw_fd();
+    loop {
+        let mut pfd = libc::pollfd { fd, events: libc::POLLIN, revents: 0 };
+        if unsafe { libc::poll(&mut pfd, 1, -1) } < 0 {
+            let err = std::io::Error::last_os_error();
+            if err.kind() == std::io::ErrorKind::Interrupted {
+                continue;
+            }
+            tracing::error!("Input thread: poll failed: {}", err);
+            return;
+        }
+
+        if let Err(e) = libinput.dispatch() {
+            tracing::error!("Input thread: libinput dispatch failed: {}", e);
+            return;
+        }
+
+        let batch: Vec<InputEvent> = libinput.by_ref().filter_map(convert).collect();
+        if !batch.is_empty() && sender.send(batch).is_err() {
+            // Main loop is gone
+            return;
+        }
+    }
+}
+
+fn convert(event: Event) -> Option<InputEvent> {
+    Some(match event {
+        Event::Device(DeviceEvent::Added(e)) => InputEvent::DeviceAdded {
+            device: InputDevice { name: e.device().name().to_string() },
+        },
+        Event::Device(DeviceEvent::Removed(e)) => InputEvent::DeviceRemoved {
+            device: InputDevice { name: e.device().name().to_string() },
+        },
+        Event::Keyboard(KeyboardEvent::Key(e)) => InputEvent::Keyboard {
+            event: KeyEvent {
+                key: e.key(),
+                pressed: e.key_state() == LiKeyState::Pressed,
+                time_usec: e.time_usec(),
+            },
+        },
+        Event::Pointer(PointerEvent::Motion(e)) => InputEvent::PointerMotion {
+            event: PointerMotion { dx: e.dx(), dy: e.dy(), time_usec: e.time_usec() },
+        },
+        Event::Pointer(PointerEvent::Button(e)) => InputEvent::PointerButton {
+            event: PointerButton {
+                button: e.button(),
+                pressed: e.button_state() == LiButtonState::Pressed,
+                time_usec: e.time_usec(),
+            },
+        },
+        Event::Touch(TouchEvent::Down(e)) => InputEvent::TouchDown {
+            event: TouchSample { slot: e.slot(), x: e.x(), y: e.y(), time_usec: e.time_usec() },
+        },
+        Event::Touch(TouchEvent::Motion(e)) => InputEvent::TouchMotion {
+            event: TouchSample { slot: e.slot(), x: e.x(), y: e.y(), time_usec: e.time_usec() },
+        },
+        Event::Touch(TouchEvent::Up(e)) => InputEvent::TouchUp {
+            event: TouchSample { slot: e.slot(), x: 0.0, y: 0.0, time_usec: e.time_usec() },
+        },
+        Event::Touch(TouchEvent::Cancel(_)) => InputEvent::TouchCancel,
+        // Frames are implicit in batching; gestures, tablets and switches are unused
+        _ => return None,
+    })
+}
+
+/// Current CLOCK_MONOTONIC time in microseconds (the evdev event clock)
+fn monotonic_usec() -> u64 {
+    let mut ts = libc::timespec { tv_sec: 0, tv_nsec: 0 };
+    unsafe { libc::clock_gettime(libc::CLOCK_MONOTONIC, &mut ts) };
+    ts.tv_sec as u64 * 1_000_000 + ts.tv_nsec as u64 / 1000
+}
+
+/// Event-time to handling-time latency of touch events, reported in windows
+#[derive(Default)]
+pub struct InputLatency {
+    samples: Vec<u64>,
+}
+
+impl InputLatency {
+    pub fn record(&mut self, event: &InputEvent) {
+        let Some(sample) = event.touch_sample() else { return };
+        self.samples.push(monotonic_usec().saturating_sub(sample.time_usec));
+        if self.samples.len() >= LATENCY_WINDOW {
+            let (p50, p99, max, jitter) = latency_stats(&mut self.samples);
+            tracing::info!(
+                "Touch latency over {} events: p50={}us p99={}us max={}us jitter={}us",
+                LATENCY_WINDOW, p50, p99, max, jitter
+            );
+            self.samples.clear();
+        }
+    }
+}
+
+/// p50, p99, max and standard deviation of latency samples (microseconds)
+fn latency_stats(samples: &mut [u64]) -> (u64, u64, u64, u64) {
+    samples.sort_unstable();
+    let n = samples.len();
+    let mean = samples.iter().sum::<u64>() as f64 / n as f64;
+    let variance = samples.iter().map(|&s| (s as f64 - mean).powi(2)).sum::<f64>() / n as f64;
+    (samples[n / 2], samples[(n * 99) / 100], samples[n - 1], variance.sqrt() as u64)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn motion(slot: u32, x: f64) -> InputEvent {
+        InputEvent::TouchMotion { event: TouchSample { slot: Some(slot), x, y: 0.0, time_usec: 0 } }
+    }
+
+    fn down(slot: u32) -> InputEvent {
+        InputEvent::TouchDown { event: TouchSample { slot: Some(slot), x: 0.0, y: 0.0, time_usec: 0 } }
+    }
+
+    #[test]
+    fn test_coalesce_keeps_last_motion_per_slot() {
+        let events = coalesce(vec![
+            down(0), motion(0, 1.0), motion(1, 5.0), motion(0, 2.0), motion(0, 3.0), down(2),
+        ]);
+        let xs: Vec<_> = events.iter()
+            .filter_map(|e| match e {
+                InputEvent::TouchMotion { event } => Some((event.slot, event.x)),
+                _ => None,
+            })
+            .collect();
+        assert_eq!(xs, vec![(Some(1), 5.0), (Some(0), 3.0)]);
+        assert_eq!(events.len(), 4);
+    }
+
+    #[test]
+    fn test_coalesce_respects_up_barrier() {
+        let up = InputEvent::TouchUp { event: TouchSample { slot: Some(0), x: 0.0, y: 0.0, time_usec: 0 } };
+        let events = coalesce(vec![motion(0, 1.0), up, down(0), motion(0, 2.0)]);
+        assert_eq!(events.len(), 4);
+    }
+
+    #[test]
+    fn test_latency_stats() {
+        let mut samples: Vec<u64> = (1..=100).collect();
+        let (p50, p99, max, _) = latency_stats(&mut samples);
+        assert_eq!((p50, p99, max), (51, 100, 100));
+    }
+}
@@ -15,6 +15,18 @@ pub mod hwc_shim_ffi;
 // HWComposer backend implementation
 pub mod hwcomposer;
 
+// libinput reader thread for the hwcomposer backend
+pub mod input_thread;
+
+// On-disk GL program binary cache used by the hwcomposer renderer
+pub mod shader_cache;
+
+// Retained list of what the hwcomposer renderer draws
+pub mod render_list;
+
+// Pre-rendered home and switcher textures composited during gestures
+pub mod gesture_snapshots;
+
 // Keep old FFI for reference (will be removed)
 #[allow(dead_code)]
 pub mod hwcomposer_ffi;
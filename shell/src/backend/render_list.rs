@@ -0,0 +1,166 @@
+//! Retained render list for the hwcomposer renderer
+//!
+//! `render_frame` only ever draws a few windows: the QML home or lock screen
+//! window, or the topmost app window. Finding them used to mean walking
+//! `state.space` and locking every toplevel's title on each frame, and an SHM
+//! window was copied out of its surface data and uploaded as a fresh texture
+//! every frame, committed or not.
+//!
+//! The list is rebuilt only when `Flick::scene_serial` moves (map, unmap,
+//! move, raise, retitle) and holds the windows bottom to top with their role
+//! and location. SHM surfaces keep one texture each, uploaded again only
+//! when the surface's `content_serial` says a commit brought new pixels.
+
+use std::cell::RefCell;
+use std::collections::{HashMap, HashSet};
+
+use smithay::desktop::Window;
+use smithay::reexports::wayland_server::backend::ObjectId;
+use smithay::reexports::wayland_server::protocol::wl_surface::WlSurface;
+use smithay::reexports::wayland_server::Resource;
+use smithay::utils::{Logical, Point};
+use smithay::wayland::compositor;
+
+use crate::state::{Flick, SurfaceBufferData};
+
+/// What a window is to the shell
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Role {
+    Home,
+    Lock,
+    App,
+}
+
+/// A mapped window as the renderer sees it
+pub struct DrawItem {
+    pub window: Window,
+    pub role: Role,
+    pub location: Point<i32, Logical>,
+}
+
+/// An SHM buffer uploaded to a GL texture
+#[derive(Debug, Clone, Copy)]
+pub struct ShmTexture {
+    pub texture_id: u32,
+    pub width: u32,
+    pub height: u32,
+    content_serial: u64,
+}
+
+#[derive(Default)]
+pub struct RenderList {
+    /// Scene serial the items were built for
+    serial: Option<u64>,
+    /// Mapped windows, bottom to top
+    items: Vec<DrawItem>,
+    /// Uploaded SHM content per surface (behind a RefCell so uploads can
+    /// happen while iterating `windows`)
+    shm_textures: RefCell<HashMap<ObjectId, ShmTexture>>,
+    /// Textures of surfaces that left the list, for the caller to delete
+    released: Vec<u32>,
+}
+
+/// Home and lock screen windows are told apart by title
+fn window_role(window: &Window) -> Role {
+    let Some(toplevel) = window.toplevel() else { return Role::App };
+    let title = compositor::with_states(toplevel.wl_surface(), |states| {
+        states.data_map
+            .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
+            .and_then(|data| data.lock().unwrap().title.clone())
+    });
+    match title.as_deref() {
+        Some("Flick Home") => Role::Home,
+        Some("Flick Lock Screen") => Role::Lock,
+        _ => Role::App,
+    }
+}
+
+/// The surface a window draws into (X11 windows may not have one yet)
+pub fn window_surface(window: &Window) -> Option<WlSurface> {
+    if let Some(toplevel) = window.toplevel() {
+        Some(toplevel.wl_surface().clone())
+    } else {
+        window.x11_surface().and_then(|x11| x11.wl_surface())
+    }
+}
+
+impl RenderList {
+    /// Rebuild from the space if the scene changed since the last frame
+    pub fn sync(&mut self, state: &Flick) {
+        if self.serial == Some(state.scene_serial) {
+            return;
+        }
+        self.serial = Some(state.scene_serial);
+        self.items = state.space.elements()
+            .map(|window| DrawItem {
+                window: window.clone(),
+                role: window_role(window),
+                location: state.space.element_location(window).unwrap_or_default(),
+            })
+            .collect();
+
+        let live: HashSet<ObjectId> = self.items.iter()
+            .filter_map(|item| window_surface(&item.window))
+            .map(|surface| surface.id())
+            .collect();
+        let released = &mut self.released;
+        self.shm_textures.get_mut().retain(|id, texture| {
+            let keep = live.contains(id);
+            if !keep {
+                released.push(texture.texture_id);
+            }
+            keep
+        });
+    }
+
+    /// Texture ids the caller should delete now
+    pub fn take_released(&mut self) -> Vec<u32> {
+        std::mem::take(&mut self.released)
+    }
+
+    /// Windows with this role, bottom to top
+    pub fn windows(&self, role: Role) -> impl Iterator<Item = &Window> + Clone + '_ {
+        self.items.iter().filter(move |item| item.role == role).map(|item| &item.window)
+    }
+
+    /// First window with this role
+    pub fn find(&self, role: Role) -> Option<&DrawItem> {
+        self.items.iter().find(|item| item.role == role)
+    }
+
+    /// Topmost app window
+    pub fn top_app(&self) -> Option<&DrawItem> {
+        self.items.iter().rev().find(|item| item.role == Role::App)
+    }
+
+    /// The surface's SHM buffer as a texture, calling `upload(old_texture,
+    /// width, height, pixels)` only when its content changed since the last
+    /// upload. None if the surface has no SHM buffer (or shows an EGL one).
+    pub fn shm_texture(
+        &self,
+        surface: &WlSurface,
+        upload: impl FnOnce(u32, u32, u32, &[u8]) -> u32,
+    ) -> Option<ShmTexture> {
+        let id = surface.id();
+        let cached = self.shm_textures.borrow().get(&id).copied();
+        let texture = compositor::with_states(surface, |data| {
+            let bd = data.data_map.get::<RefCell<SurfaceBufferData>>()?.borrow();
+            if bd.egl_texture.is_some() {
+                return None;
+            }
+            let stored = bd.buffer.as_ref()?;
+            if let Some(cached) = cached.filter(|c| c.content_serial == bd.content_serial) {
+                return Some(cached);
+            }
+            let old = cached.map(|c| c.texture_id).unwrap_or(0);
+            Some(ShmTexture {
+                texture_id: upload(old, stored.width, stored.height, &stored.pixels),
+                width: stored.width,
+                height: stored.height,
+                content_serial: bd.content_serial,
+            })
+        })?;
+        self.shm_textures.borrow_mut().insert(id, texture);
+        Some(texture)
+    }
+}
@@ -0,0 +1,334 @@
+//! On-disk cache for linked GL program binaries
+//!
+//! Compiling the compositor shaders from source on Adreno/Mali blobs takes
+//! tens to hundreds of milliseconds per program. When the driver exposes
+//! GL_OES_get_program_binary we store the linked binary under
+//! `~/.cache/flick/shaders/` and hand it back to `glProgramBinaryOES` on the
+//! next start.
+//!
+//! Entries are keyed by a hash of the shader sources plus the GL vendor,
+//! renderer and version strings, so a driver update or a shader edit simply
+//! misses the cache. A binary the driver refuses to load is deleted and the
+//! caller falls back to compiling from source.
+//!
+//! The render thread never touches the files itself: `CacheWorker` runs the
+//! reads, writes and deletes on its own thread. Lookups are queued as soon
+//! as the driver is known and the render thread only picks up results that
+//! have already arrived, compiling from source if one is still outstanding.
+
+use std::collections::HashMap;
+use std::path::PathBuf;
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::time::{Duration, Instant};
+
+/// File magic for cached program binaries
+const MAGIC: &[u8; 4] = b"FLPB";
+/// Bump when the on-disk layout changes
+const FORMAT_VERSION: u32 = 1;
+/// magic + version + key + binary format + length
+const HEADER_LEN: usize = 4 + 4 + 8 + 4 + 4;
+
+/// Identity of the GL driver a binary was produced by
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct DriverInfo {
+    pub vendor: String,
+    pub renderer: String,
+    pub version: String,
+}
+
+/// A linked program binary as returned by glGetProgramBinaryOES
+#[derive(Debug, Clone, PartialEq)]
+pub struct ProgramBinary {
+    pub format: u32,
+    pub data: Vec<u8>,
+}
+
+/// FNV-1a over a sequence of strings (NUL-separated so "ab"+"c" != "a"+"bc")
+fn fnv1a(parts: &[&str]) -> u64 {
+    let mut hash: u64 = 0xcbf2_9ce4_8422_2325;
+    for part in parts {
+        for byte in part.bytes().chain(std::iter::once(0u8)) {
+            hash ^= byte as u64;
+            hash = hash.wrapping_mul(0x0000_0100_0000_01b3);
+        }
+    }
+    hash
+}
+
+/// Cache key for a vertex/fragment pair on a given driver
+pub fn program_key(vertex_src: &str, fragment_src: &str, driver: &DriverInfo) -> u64 {
+    fnv1a(&[
+        vertex_src,
+        fragment_src,
+        &driver.vendor,
+        &driver.renderer,
+        &driver.version,
+    ])
+}
+
+/// Default cache directory (~/.cache/flick/shaders)
+fn default_cache_dir() -> PathBuf {
+    std::env::var("XDG_CACHE_HOME")
+        .map(PathBuf::from)
+        .or_else(|_| std::env::var("HOME").map(|h| PathBuf::from(h).join(".cache")))
+        .unwrap_or_else(|_| PathBuf::from("/tmp"))
+        .join("flick/shaders")
+}
+
+/// Program binary store rooted at a directory
+pub struct ShaderCache {
+    dir: PathBuf,
+}
+
+impl ShaderCache {
+    pub fn new() -> Self {
+        Self::with_dir(default_cache_dir())
+    }
+
+    pub fn with_dir(dir: PathBuf) -> Self {
+        Self { dir }
+    }
+
+    fn path_for(&self, key: u64) -> PathBuf {
+        self.dir.join(format!("{:016x}.bin", key))
+    }
+
+    /// Load a cached binary, or None if missing/corrupt/mismatched
+    pub fn load(&self, key: u64) -> Option<ProgramBinary> {
+        let bytes = std::fs::read(self.path_for(key)).ok()?;
+        decode(&bytes, key)
+    }
+
+    /// Store a binary. Written to a temp file and renamed so a crash mid-write
+    /// never leaves a truncated entry behind.
+    pub fn store(&self, key: u64, binary: &ProgramBinary) {
+        if binary.data.is_empty() {
+            return;
+        }
+        if let Err(e) = std::fs::create_dir_all(&self.dir) {
+            tracing::warn!("Shader cache: cannot create {:?}: {}", self.dir, e);
+            return;
+        }
+        let path = self.path_for(key);
+        let tmp = path.with_extension("tmp");
+        let result = std::fs::write(&tmp, encode(key, binary))
+            .and_then(|_| std::fs::rename(&tmp, &path));
+        match result {
+            Ok(()) => tracing::info!("Shader cache: stored {:016x} ({} bytes)", key, binary.data.len()),
+            Err(e) => {
+                tracing::warn!("Shader cache: failed to write {:?}: {}", path, e);
+                let _ = std::fs::remove_file(&tmp);
+            }
+        }
+    }
+
+    /// Drop an entry the driver rejected
+    pub fn invalidate(&self, key: u64) {
+        let _ = std::fs::remove_file(self.path_for(key));
+    }
+}
+
+/// File operation queued for the cache worker
+enum Job {
+    Load(u64),
+    Store(u64, ProgramBinary),
+    Invalidate(u64),
+}
+
+/// State of a queued lookup as seen from the render thread
+#[derive(Debug, PartialEq)]
+pub enum Lookup {
+    /// Never requested, or the worker hasn't answered yet
+    Pending,
+    Hit(ProgramBinary),
+    Miss,
+}
+
+/// `ShaderCache` driven from a worker thread
+pub struct CacheWorker {
+    jobs: Sender<Job>,
+    loaded: Receiver<(u64, Option<ProgramBinary>)>,
+    ready: HashMap<u64, Option<ProgramBinary>>,
+}
+
+impl CacheWorker {
+    pub fn spawn(cache: ShaderCache) -> Self {
+        let (jobs, job_rx) = mpsc::channel::<Job>();
+        let (loaded_tx, loaded) = mpsc::channel();
+        let spawned = std::thread::Builder::new()
+            .name("shader-cache".into())
+            .spawn(move || {
+                for job in job_rx {
+                    match job {
+                        Job::Load(key) => {
+                            if loaded_tx.send((key, cache.load(key))).is_err() {
+                                break;
+                            }
+                        }
+                        Job::Store(key, binary) => cache.store(key, &binary),
+                        Job::Invalidate(key) => cache.invalidate(key),
+                    }
+                }
+            });
+        if let Err(e) = spawned {
+            // Lookups stay pending, so every program compiles from source
+            tracing::warn!("Shader cache: cannot start worker: {}", e);
+        }
+        Self { jobs, loaded, ready: HashMap::new() }
+    }
+
+    /// Start reading an entry in the background
+    pub fn prefetch(&self, key: u64) {
+        let _ = self.jobs.send(Job::Load(key));
+    }
+
+    pub fn store(&self, key: u64, binary: ProgramBinary) {
+        let _ = self.jobs.send(Job::Store(key, binary));
+    }
+
+    pub fn invalidate(&self, key: u64) {
+        let _ = self.jobs.send(Job::Invalidate(key));
+    }
+
+    /// Whether the worker has answered a prefetch for `key`
+    pub fn is_ready(&mut self, key: u64) -> bool {
+        self.drain();
+        self.ready.contains_key(&key)
+    }
+
+    /// Take a prefetched entry, waiting at most `timeout` for the worker
+    /// (zero only consumes what has already arrived)
+    pub fn take(&mut self, key: u64, timeout: Duration) -> Lookup {
+        self.drain();
+        let deadline = Instant::now() + timeout;
+        while !self.ready.contains_key(&key) {
+            let left = deadline.saturating_duration_since(Instant::now());
+            if left.is_zero() {
+                return Lookup::Pending;
+            }
+            match self.loaded.recv_timeout(left) {
+                Ok((loaded, binary)) => {
+                    self.ready.insert(loaded, binary);
+                }
+                Err(_) => return Lookup::Pending,
+            }
+        }
+        match self.ready.remove(&key) {
+            Some(Some(binary)) => Lookup::Hit(binary),
+            _ => Lookup::Miss,
+        }
+    }
+
+    fn drain(&mut self) {
+        while let Ok((key, binary)) = self.loaded.try_recv() {
+            self.ready.insert(key, binary);
+        }
+    }
+}
+
+fn encode(key: u64, binary: &ProgramBinary) -> Vec<u8> {
+    let mut out = Vec::with_capacity(HEADER_LEN + binary.data.len());
+    out.extend_from_slice(MAGIC);
+    out.extend_from_slice(&FORMAT_VERSION.to_le_bytes());
+    out.extend_from_slice(&key.to_le_bytes());
+    out.extend_from_slice(&binary.format.to_le_bytes());
+    out.extend_from_slice(&(binary.data.len() as u32).to_le_bytes());
+    out.extend_from_slice(&binary.data);
+    out
+}
+
+fn decode(bytes: &[u8], key: u64) -> Option<ProgramBinary> {
+    if bytes.len() < HEADER_LEN || &bytes[0..4] != MAGIC {
+        return None;
+    }
+    let u32_at = |off: usize| u32::from_le_bytes(bytes[off..off + 4].try_into().unwrap());
+    if u32_at(4) != FORMAT_VERSION {
+        return None;
+    }
+    let stored_key = u64::from_le_bytes(bytes[8..16].try_into().unwrap());
+    if stored_key != key {
+        return None;
+    }
+    let format = u32_at(16);
+    let len = u32_at(20) as usize;
+    let data = &bytes[HEADER_LEN..];
+    if data.len() != len {
+        return None;
+    }
+    Some(ProgramBinary { format, data: data.to_vec() })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn driver() -> DriverInfo {
+        DriverInfo {
+            vendor: "Qualcomm".into(),
+            renderer: "Adreno (TM) 615".into(),
+            version: "OpenGL ES 3.2 V@415.0".into(),
+        }
+    }
+
+    #[test]
+    fn test_key_depends_on_sources_and_driver() {
+        let base = program_key("vs", "fs", &driver());
+        assert_eq!(base, program_key("vs", "fs", &driver()));
+        assert_ne!(base, program_key("vs", "fs2", &driver()));
+        assert_ne!(base, program_key("v", "sfs", &driver()));
+
+        let mut updated = driver();
+        updated.version = "OpenGL ES 3.2 V@502.0".into();
+        assert_ne!(base, program_key("vs", "fs", &updated));
+    }
+
+    #[test]
+    fn test_store_and_load_roundtrip() {
+        let dir = std::env::temp_dir().join(format!("flick-shader-cache-{}", std::process::id()));
+        let cache = ShaderCache::with_dir(dir.clone());
+        let key = program_key("vs", "fs", &driver());
+        let binary = ProgramBinary { format: 0x8740, data: vec![1, 2, 3, 4, 5] };
+
+        assert!(cache.load(key).is_none());
+        cache.store(key, &binary);
+        assert_eq!(cache.load(key), Some(binary));
+        // A different key never reads another program's entry
+        assert!(cache.load(key ^ 1).is_none());
+
+        cache.invalidate(key);
+        assert!(cache.load(key).is_none());
+        let _ = std::fs::remove_dir_all(dir);
+    }
+
+    #[test]
+    fn test_worker_lookups() {
+        let dir = std::env::temp_dir().join(format!("flick-shader-worker-{}", std::process::id()));
+        let mut worker = CacheWorker::spawn(ShaderCache::with_dir(dir.clone()));
+        let binary = ProgramBinary { format: 0x8740, data: vec![7; 16] };
+
+        // Never requested
+        assert_eq!(worker.take(1, Duration::ZERO), Lookup::Pending);
+
+        // Jobs run in order, so a load queued after a store sees it
+        worker.prefetch(1);
+        worker.store(2, binary.clone());
+        worker.prefetch(2);
+        assert_eq!(worker.take(1, Duration::from_secs(5)), Lookup::Miss);
+        assert_eq!(worker.take(2, Duration::from_secs(5)), Lookup::Hit(binary));
+        // A result is handed out once
+        assert!(!worker.is_ready(2));
+
+        worker.invalidate(2);
+        worker.prefetch(2);
+        assert_eq!(worker.take(2, Duration::from_secs(5)), Lookup::Miss);
+        let _ = std::fs::remove_dir_all(dir);
+    }
+
+    #[test]
+    fn test_rejects_truncated_entry() {
+        let binary = ProgramBinary { format: 1, data: vec![9; 32] };
+        let mut bytes = encode(7, &binary);
+        bytes.truncate(bytes.len() - 1);
+        assert!(decode(&bytes, 7).is_none());
+    }
+}
@@ -537,6 +537,12 @@ pub fn run() -> Result<()> {
         // Check for focus requests from shell
         state.check_focus_request();
 
+        // Freeze backgrounded apps, thaw focused / switcher-visible ones
+        state.update_app_cgroups();
+
+        // Trim or kill background apps under PSI memory pressure
+        state.handle_memory_pressure();
+
         // Check for long press (periodic check since touch_motion may not fire if finger is still)
         if state.shell.view == crate::shell::ShellView::Home {
             state.shell.check_and_show_long_press();
@@ -554,6 +560,7 @@ pub fn run() -> Result<()> {
             for window in windows_to_close {
                 // Remove window from space
                 state.space.unmap_elem(&window);
+                state.scene_changed();
                 // Send close request to the window (if it has a toplevel surface)
                 if let Some(toplevel) = window.toplevel() {
                     toplevel.send_close();
@@ -950,9 +957,7 @@ fn render_surface(
                     info!("RENDER: ShellView::Home - setting up home view in Slint");
                     slint_ui.set_view("home");
                     // Update categories with real icons
-                    let slint_categories = state.shell.get_categories_with_icons();
-                    info!("RENDER: Home view has {} categories", slint_categories.len());
-                    slint_ui.set_categories(slint_categories);
+                    state.shell.sync_slint_categories();
 
                     // Sync popup state
                     slint_ui.set_show_popup(state.shell.popup_showing);
@@ -999,8 +1004,7 @@ fn render_surface(
                     // During QS home gesture, render home grid behind sliding QS
                     if qs_home_gesture_active {
                         slint_ui.set_view("home");
-                        let slint_categories = state.shell.get_categories_with_icons();
-                        slint_ui.set_categories(slint_categories);
+                        state.shell.sync_slint_categories();
                         slint_ui.set_show_popup(false);
                         slint_ui.set_wiggle_mode(false);
                     } else {
@@ -1026,8 +1030,7 @@ fn render_surface(
                     // During switcher home gesture, render home grid behind sliding switcher
                     if switcher_home_gesture_active {
                         slint_ui.set_view("home");
-                        let slint_categories = state.shell.get_categories_with_icons();
-                        slint_ui.set_categories(slint_categories);
+                        state.shell.sync_slint_categories();
                         slint_ui.set_show_popup(false);
                         slint_ui.set_wiggle_mode(false);
                     } else {
@@ -1059,11 +1062,10 @@ fn render_surface(
                                     .map(|x11| x11.class())
                                     .unwrap_or_default();
                                 // For udev backend, preview capture not implemented yet
-                                let preview: Option<slint::Image> = None;
-                                (id, title, app_class, i as i32, preview)
+                                (id, title, app_class, i as i32, None)
                             })
                             .collect();
-                        slint_ui.set_switcher_windows(windows);
+                        slint_ui.set_switcher_windows(windows, |_| None);
                     }
                 }
                 ShellView::App => {
@@ -1071,8 +1073,7 @@ fn render_surface(
                     if home_gesture_active {
                         slint_ui.set_view("home");
                         // Update categories with real icons
-                        let slint_categories = state.shell.get_categories_with_icons();
-                        slint_ui.set_categories(slint_categories);
+                        state.shell.sync_slint_categories();
                         slint_ui.set_show_popup(false);
                         slint_ui.set_wiggle_mode(false);
                     }
@@ -1987,10 +1988,9 @@ fn render_surface(
         // If we're on home screen, render the home grid at offset position
         if shell_view == ShellView::Home {
             // Render home grid at offset position
-            let slint_categories = state.shell.get_categories_with_icons();
             if let Some(ref slint_ui) = state.shell.slint_ui {
                 slint_ui.set_view("home");
-                slint_ui.set_categories(slint_categories);
+                state.shell.sync_slint_categories();
                 slint_ui.set_show_popup(false);
                 slint_ui.set_wiggle_mode(false);
                 slint_ui.process_events();
@@ -2475,7 +2475,7 @@ fn handle_input_event(
 
                     if state.shell.view != crate::shell::ShellView::LockScreen {
                         info!("Power button pressed, locking screen");
-                        state.shell.lock();
+                        state.lock_session();
                         if let Some(socket) = state.socket_name.to_str() {
                             state.shell.launch_lock_screen_app(socket);
                         }
@@ -2495,7 +2495,7 @@ fn handle_input_event(
                     drop(mods); // Release borrow before calling lock()
                     if state.shell.view != crate::shell::ShellView::LockScreen {
                         info!("Super+L pressed, locking screen");
-                        state.shell.lock();
+                        state.lock_session();
                         if let Some(socket) = state.socket_name.to_str() {
                             state.shell.launch_lock_screen_app(socket);
                         }
@@ -2773,7 +2773,11 @@ fn handle_input_event(
                       touch_pos.y,
                       state.gesture_recognizer.screen_size.h as f64 - state.gesture_recognizer.config.edge_threshold);
 
-                if let Some(gesture_event) = state.gesture_recognizer.touch_down(slot_id, touch_pos) {
+                // Edge bindings only apply to app windows
+                state.gesture_recognizer.edge_bindings_enabled =
+                    state.shell.view == crate::shell::ShellView::App && !state.shell.lock_screen_active;
+
+                if let Some(gesture_event) = state.gesture_recognizer.touch_down(slot_id, touch_pos, event.time()) {
                     info!("Gesture touch_down returned: {:?}", gesture_event);
 
                     // SECURITY: Block most edge gestures on lock screen to prevent bypass
@@ -3092,7 +3096,7 @@ fn handle_input_event(
             // Update touch effect (adds circles on swipe)
             state.update_touch_effect(touch_pos.x, touch_pos.y, slot_id as u64);
 
-            if let Some(gesture_event) = state.gesture_recognizer.touch_motion(slot_id, touch_pos) {
+            if let Some(gesture_event) = state.gesture_recognizer.touch_motion(slot_id, touch_pos, event.time()) {
                 debug!("Gesture update: {:?}", gesture_event);
                 // Update integrated shell state
                 state.shell.handle_gesture(&gesture_event);
@@ -3518,7 +3522,7 @@ fn handle_input_event(
             // Track if an EDGE SWIPE gesture was handled so we don't also process as app tap
             // Note: Tap and LongPress gestures should NOT block app launch processing
             let mut edge_gesture_handled = false;
-            if let Some(gesture_event) = state.gesture_recognizer.touch_up(slot_id) {
+            if let Some(gesture_event) = state.gesture_recognizer.touch_up(slot_id, event.time()) {
                 info!("Gesture completed: {:?}", gesture_event);
 
                 // Update integrated shell state
@@ -3582,6 +3586,9 @@ fn handle_input_event(
                 state.handle_gesture_complete(&action);
             }
 
+            // Deliver a completed bound edge swipe to the focused client
+            state.dispatch_edge_binding();
+
             // Handle lock screen touch up - forward to Slint and process lock actions
             if state.shell.view == crate::shell::ShellView::LockScreen {
                 use crate::shell::slint_ui::LockScreenAction;
@@ -3792,6 +3799,7 @@ fn handle_input_event(
                             }
                         }
                         state.space.raise_element(window, true);
+                        state.scene_changed();
                         state.shell.switch_to_app();
 
                         // Restore keyboard state for the newly focused window
@@ -3876,7 +3884,7 @@ fn handle_input_event(
                                 }
                                 QuickSettingsAction::Lock => {
                                     info!("Lock button pressed - locking screen");
-                                    state.shell.lock();
+                                    state.lock_session();
                                     if let Some(socket) = state.socket_name.to_str() {
                                         state.shell.launch_lock_screen_app(socket);
                                     }
@@ -0,0 +1,222 @@
+//! Configurable edge-swipe bindings
+//!
+//! Replaces the external lisgd daemon: bindings use lisgd's `-g` syntax so
+//! existing configs carry over, but they are matched by the compositor's own
+//! gesture recogniser and delivered as key events to the focused client
+//! through the seat keyboard, with no second evdev reader and no fork per
+//! gesture.
+//!
+//! Config: `~/.local/state/flick/edge_gestures.conf`, one binding per line:
+//!
+//! ```text
+//! # fingers,gesture,edge,distance,actmode,action
+//! 1,LR,L,*,R,key XF86Back
+//! 1,RL,R,*,R,wtype -k XF86Forward
+//! ```
+//!
+//! Only inward swipes from an edge are supported (LR from L, RL from R, UD
+//! from T, DU from B) and only single-finger swipes, since that is what the
+//! recogniser tracks per slot. Distance and actmode are accepted for
+//! compatibility; a binding fires on release once the swipe passes the
+//! normal completion threshold. Actions are `key A+B` or `wtype -k A`;
+//! anything else would need a fork and is rejected. Bindings only apply in
+//! App view and take precedence over the built-in action for that edge.
+
+use super::gestures::Edge;
+use std::path::{Path, PathBuf};
+use std::time::SystemTime;
+
+/// Config file name inside `~/.local/state/flick`
+const CONFIG_FILE: &str = "edge_gestures.conf";
+
+/// One edge binding: a key chord sent to the focused client
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct EdgeBinding {
+    pub edge: Edge,
+    pub fingers: u32,
+    /// Linux input keycodes (without the XKB +8 offset), pressed in order
+    /// and released in reverse
+    pub keys: Vec<u32>,
+}
+
+/// Loaded set of edge bindings, reloaded when the config file changes
+#[derive(Debug, Default)]
+pub struct EdgeBindings {
+    path: Option<PathBuf>,
+    mtime: Option<SystemTime>,
+    bindings: Vec<EdgeBinding>,
+}
+
+impl EdgeBindings {
+    /// Load bindings from the user's config file (empty if absent)
+    pub fn load() -> Self {
+        Self::load_from(&crate::state::Flick::user_state_file(CONFIG_FILE))
+    }
+
+    pub fn load_from(path: &Path) -> Self {
+        let mut bindings = Self {
+            path: Some(path.to_path_buf()),
+            mtime: None,
+            bindings: Vec::new(),
+        };
+        bindings.reload_if_changed();
+        bindings
+    }
+
+    /// Re-read the config if its modification time changed. Cheap enough to
+    /// call from the settings poll.
+    pub fn reload_if_changed(&mut self) {
+        let Some(path) = self.path.clone() else { return };
+        let mtime = std::fs::metadata(&path).and_then(|m| m.modified()).ok();
+        if mtime == self.mtime {
+            return;
+        }
+        self.mtime = mtime;
+        self.bindings = match std::fs::read_to_string(&path) {
+            Ok(contents) => parse_config(&contents),
+            Err(_) => Vec::new(),
+        };
+        tracing::info!("Edge bindings: loaded {} from {:?}", self.bindings.len(), path);
+    }
+
+    /// Binding for a single-finger swipe from `edge`, if any
+    pub fn find(&self, edge: Edge, fingers: u32) -> Option<&EdgeBinding> {
+        self.bindings.iter().find(|b| b.edge == edge && b.fingers == fingers)
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.bindings.is_empty()
+    }
+}
+
+/// Parse a whole config file, logging and skipping bad lines
+pub fn parse_config(contents: &str) -> Vec<EdgeBinding> {
+    contents
+        .lines()
+        .map(str::trim)
+        .filter(|line| !line.is_empty() && !line.starts_with('#'))
+        .filter_map(|line| match parse_binding(line) {
+            Ok(binding) => Some(binding),
+            Err(e) => {
+                tracing::warn!("Edge bindings: ignoring '{}': {}", line, e);
+                None
+            }
+        })
+        .collect()
+}
+
+/// Parse one lisgd-style binding: `fingers,gesture,edge,distance,actmode,action`
+pub fn parse_binding(line: &str) -> Result<EdgeBinding, String> {
+    let line = line.strip_prefix("-g").unwrap_or(line).trim().trim_matches('"');
+    let fields: Vec<&str> = line.splitn(6, ',').map(str::trim).collect();
+    if fields.len() != 6 {
+        return Err("expected 6 comma-separated fields".into());
+    }
+
+    let fingers: u32 = fields[0].parse().map_err(|_| "bad finger count")?;
+    if fingers != 1 {
+        return Err("only single-finger edge swipes are supported".into());
+    }
+
+    let edge = match (fields[2], fields[1]) {
+        ("L", "LR") => Edge::Left,
+        ("R", "RL") => Edge::Right,
+        ("T", "UD") => Edge::Top,
+        ("B", "DU") => Edge::Bottom,
+        _ => return Err("only inward swipes from an edge are supported".into()),
+    };
+
+    if !matches!(fields[3], "*" | "S" | "M" | "L") {
+        return Err("bad distance".into());
+    }
+    if !matches!(fields[4], "R" | "P") {
+        return Err("bad actmode".into());
+    }
+
+    Ok(EdgeBinding { edge, fingers, keys: parse_action(fields[5])? })
+}
+
+/// Parse `key A+B` or lisgd's usual `wtype -k A` into keycodes
+fn parse_action(action: &str) -> Result<Vec<u32>, String> {
+    let mut words = action.split_whitespace();
+    let chord = match (words.next(), words.next(), words.next(), words.next()) {
+        (Some("key"), Some(chord), None, None) => chord,
+        (Some("wtype"), Some("-k"), Some(key), None) => key,
+        _ => return Err("action must be 'key NAME[+NAME]' or 'wtype -k NAME'".into()),
+    };
+    chord
+        .split('+')
+        .map(|name| keycode(name).ok_or_else(|| format!("unknown key '{}'", name)))
+        .collect()
+}
+
+/// Linux input keycode for a keysym name
+fn keycode(name: &str) -> Option<u32> {
+    let code = match name {
+        "XF86Back" => 158,
+        "XF86Forward" => 159,
+        "XF86Reload" => 173,
+        "XF86Search" => 217,
+        "XF86AudioMute" => 113,
+        "XF86AudioLowerVolume" => 114,
+        "XF86AudioRaiseVolume" => 115,
+        "XF86AudioNext" => 163,
+        "XF86AudioPlay" => 164,
+        "XF86AudioPrev" => 165,
+        "Escape" => 1,
+        "BackSpace" => 14,
+        "Tab" => 15,
+        "Return" => 28,
+        "space" => 57,
+        "Menu" => 139,
+        "Home" => 102,
+        "End" => 107,
+        "Prior" | "Page_Up" => 104,
+        "Next" | "Page_Down" => 109,
+        "Up" => 103,
+        "Left" => 105,
+        "Right" => 106,
+        "Down" => 108,
+        "Ctrl" | "Control_L" | "ctrl" => 29,
+        "Shift" | "Shift_L" | "shift" => 42,
+        "Alt" | "Alt_L" | "alt" => 56,
+        "Super" | "Super_L" | "logo" => 125,
+        _ => return letter_keycode(name),
+    };
+    Some(code)
+}
+
+fn letter_keycode(name: &str) -> Option<u32> {
+    const ROWS: [(&str, u32); 3] = [("qwertyuiop", 16), ("asdfghjkl", 30), ("zxcvbnm", 44)];
+    let mut chars = name.chars();
+    let c = chars.next()?.to_ascii_lowercase();
+    if chars.next().is_some() {
+        return None;
+    }
+    ROWS.iter().find_map(|(row, base)| row.find(c).map(|i| base + i as u32))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_lisgd_defaults() {
+        let bindings = parse_config(
+            "# lisgd.sh defaults\n\
+             1,LR,L,*,R,wtype -k XF86Back\n\
+             -g \"1,RL,R,*,R,key XF86Forward\"\n",
+        );
+        assert_eq!(bindings.len(), 2);
+        assert_eq!(bindings[0], EdgeBinding { edge: Edge::Left, fingers: 1, keys: vec![158] });
+        assert_eq!(bindings[1], EdgeBinding { edge: Edge::Right, fingers: 1, keys: vec![159] });
+    }
+
+    #[test]
+    fn test_reject_unsupported_bindings() {
+        assert!(parse_binding("2,LR,L,*,R,key XF86Back").is_err());
+        assert!(parse_binding("1,RL,L,*,R,key XF86Back").is_err());
+        assert!(parse_binding("1,LR,L,*,R,notify-send hi").is_err());
+        assert_eq!(parse_binding("1,DU,B,*,R,key Ctrl+w").unwrap().keys, vec![29, 17]);
+    }
+}
@@ -12,10 +12,15 @@
 //! - Pan/drag
 //! - Long press
 //! - Tap
+//!
+//! Touch calls take the kernel event time in microseconds (smithay's
+//! `Event::time()`), so velocity and tap/long-press durations reflect when
+//! the finger moved rather than when the event loop got around to it.
 
+use super::edge_bindings::EdgeBindings;
 use smithay::utils::{Logical, Point, Size};
 use std::collections::HashMap;
-use std::time::{Duration, Instant};
+use std::time::Duration;
 
 /// Edge of the screen
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
@@ -151,26 +156,27 @@ pub struct TouchPoint {
     pub id: i32,
     pub start_pos: Point<f64, Logical>,
     pub current_pos: Point<f64, Logical>,
-    pub start_time: Instant,
-    pub last_time: Instant,
+    /// Event time of touch down (microseconds)
+    pub start_time_usec: u64,
+    /// Event time of the latest sample (microseconds)
+    pub last_time_usec: u64,
     pub velocity: Point<f64, Logical>,
 }
 
 impl TouchPoint {
-    pub fn new(id: i32, pos: Point<f64, Logical>) -> Self {
+    pub fn new(id: i32, pos: Point<f64, Logical>, time_usec: u64) -> Self {
         Self {
             id,
             start_pos: pos,
             current_pos: pos,
-            start_time: Instant::now(),
-            last_time: Instant::now(),
+            start_time_usec: time_usec,
+            last_time_usec: time_usec,
             velocity: Point::from((0.0, 0.0)),
         }
     }
 
-    pub fn update(&mut self, pos: Point<f64, Logical>) {
-        let now = Instant::now();
-        let dt = now.duration_since(self.last_time).as_secs_f64();
+    pub fn update(&mut self, pos: Point<f64, Logical>, time_usec: u64) {
+        let dt = time_usec.saturating_sub(self.last_time_usec) as f64 / 1_000_000.0;
 
         if dt > 0.001 {
             self.velocity = Point::from((
@@ -180,7 +186,12 @@ impl TouchPoint {
         }
 
         self.current_pos = pos;
-        self.last_time = now;
+        self.last_time_usec = time_usec;
+    }
+
+    /// Time from touch down to `time_usec`
+    pub fn duration_at(&self, time_usec: u64) -> Duration {
+        Duration::from_micros(time_usec.saturating_sub(self.start_time_usec))
     }
 
     pub fn delta(&self) -> Point<f64, Logical> {
@@ -207,6 +218,8 @@ pub enum SlotGesture {
     PotentialEdgeSwipe { edge: Edge },
     /// Edge swipe in progress (activated after min drag distance)
     EdgeSwipe { edge: Edge },
+    /// Edge swipe claimed by a user binding - no shell animation, fires on release
+    BoundEdgeSwipe { edge: Edge },
     /// Regular swipe (not from edge)
     Swipe,
     /// This slot is part of a multi-touch gesture (pinch/pan)
@@ -227,6 +240,13 @@ pub struct GestureRecognizer {
     pub multi_touch_active: bool,
     /// Initial distance for pinch gesture
     pub pinch_initial_distance: Option<f64>,
+    /// User edge-swipe bindings (see edge_bindings.rs)
+    pub edge_bindings: EdgeBindings,
+    /// Whether edge bindings may claim swipes; set by the backend per touch
+    /// down since bindings only apply in App view
+    pub edge_bindings_enabled: bool,
+    /// Key chord from a completed bound swipe, waiting to be sent
+    pub pending_edge_keys: Option<Vec<u32>>,
 }
 
 #[derive(Debug, Clone)]
@@ -249,6 +269,9 @@ impl GestureRecognizer {
             active_gesture: None,
             multi_touch_active: false,
             pinch_initial_distance: None,
+            edge_bindings: EdgeBindings::load(),
+            edge_bindings_enabled: false,
+            pending_edge_keys: None,
         }
     }
 
@@ -299,8 +322,8 @@ impl GestureRecognizer {
     }
 
     /// Handle touch down event - returns gesture event for this slot
-    pub fn touch_down(&mut self, id: i32, pos: Point<f64, Logical>) -> Option<GestureEvent> {
-        let point = TouchPoint::new(id, pos);
+    pub fn touch_down(&mut self, id: i32, pos: Point<f64, Logical>, time_usec: u64) -> Option<GestureEvent> {
+        let point = TouchPoint::new(id, pos, time_usec);
         self.points.insert(id, point);
 
         // Check for edge zone - but don't start swipe yet, wait for movement
@@ -336,10 +359,10 @@ impl GestureRecognizer {
     }
 
     /// Handle touch motion event - returns gesture event
-    pub fn touch_motion(&mut self, id: i32, pos: Point<f64, Logical>) -> Option<GestureEvent> {
+    pub fn touch_motion(&mut self, id: i32, pos: Point<f64, Logical>, time_usec: u64) -> Option<GestureEvent> {
         // Update the touch point
         if let Some(point) = self.points.get_mut(&id) {
-            point.update(pos);
+            point.update(pos, time_usec);
         } else {
             return None;
         }
@@ -359,6 +382,12 @@ impl GestureRecognizer {
                 };
 
                 if swipe_distance >= self.config.edge_swipe_min_distance {
+                    // A user binding claims the swipe instead of the shell gesture
+                    if self.edge_bindings_enabled && self.edge_bindings.find(edge, 1).is_some() {
+                        self.slot_gestures.insert(id, SlotGesture::BoundEdgeSwipe { edge });
+                        return None;
+                    }
+
                     // Activate the edge swipe
                     self.slot_gestures.insert(id, SlotGesture::EdgeSwipe { edge });
                     self.active_gesture = Some(ActiveGesture::EdgeSwipe { edge });
@@ -391,6 +420,10 @@ impl GestureRecognizer {
                     },
                 });
             }
+            Some(SlotGesture::BoundEdgeSwipe { .. }) => {
+                // Nothing to animate - the binding fires on release
+                return None;
+            }
             Some(SlotGesture::MultiTouch) => {
                 // Handle multi-touch gestures (pinch/pan)
                 if let Some(initial_distance) = self.pinch_initial_distance {
@@ -485,7 +518,7 @@ impl GestureRecognizer {
     }
 
     /// Handle touch up event - returns gesture event for this slot
-    pub fn touch_up(&mut self, id: i32) -> Option<GestureEvent> {
+    pub fn touch_up(&mut self, id: i32, time_usec: u64) -> Option<GestureEvent> {
         let point = self.points.remove(&id)?;
         let slot_gesture = self.slot_gestures.remove(&id);
 
@@ -505,10 +538,17 @@ impl GestureRecognizer {
                 })
             }
 
+            Some(SlotGesture::BoundEdgeSwipe { edge }) => {
+                if point.distance() > self.config.swipe_complete_threshold {
+                    self.pending_edge_keys = self.edge_bindings.find(edge, 1).map(|b| b.keys.clone());
+                }
+                None
+            }
+
             Some(SlotGesture::PotentialEdgeSwipe { .. }) => {
                 // Touch ended in edge zone without enough movement to be a swipe
                 // Treat as a tap instead
-                let duration = point.start_time.elapsed();
+                let duration = point.duration_at(time_usec);
                 if duration < self.config.tap_duration && point.distance() < 20.0 {
                     Some(GestureEvent::Tap {
                         position: point.start_pos,
@@ -520,7 +560,7 @@ impl GestureRecognizer {
             }
 
             Some(SlotGesture::PotentialTap) => {
-                let duration = point.start_time.elapsed();
+                let duration = point.duration_at(time_usec);
                 if duration < self.config.tap_duration && point.distance() < 10.0 {
                     Some(GestureEvent::Tap {
                         position: point.start_pos,
@@ -578,8 +618,15 @@ impl GestureRecognizer {
 
     /// Check if any touch is in a potential edge swipe state
     /// (touch started in edge zone but hasn't moved enough to activate yet)
+    /// or is a swipe claimed by an edge binding - neither goes to the client
     pub fn has_potential_edge_swipe(&self) -> bool {
-        self.slot_gestures.values().any(|g| matches!(g, SlotGesture::PotentialEdgeSwipe { .. }))
+        self.slot_gestures.values().any(|g| matches!(g,
+            SlotGesture::PotentialEdgeSwipe { .. } | SlotGesture::BoundEdgeSwipe { .. }))
+    }
+
+    /// Take the key chord of a bound swipe completed by the last touch up
+    pub fn take_edge_keys(&mut self) -> Option<Vec<u32>> {
+        self.pending_edge_keys.take()
     }
 }
 
@@ -1,5 +1,6 @@
 //! Input handling - touch, gestures, keyboard
 
+mod edge_bindings;
 mod gestures;
 mod touch;
 
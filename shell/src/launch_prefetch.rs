@@ -0,0 +1,319 @@
+//! Per-app page cache prefetch for cold launches
+//!
+//! A cold QML app launch is mostly page faults: Qt libraries, QML files,
+//! fonts and icons come off eMMC one 4K read at a time. The first launch of
+//! an app (and any launch whose trace went stale) records every file the
+//! app's cgroup opens during its first seconds with fanotify. Later
+//! launches replay that list with `readahead()` on a few worker threads,
+//! started in `spawn_app_with_logging` before the fork, so the reads are
+//! queued back to back while the app is still exec'ing. Reading and
+//! checking the trace happens on those threads too; the compositor thread
+//! only stats the trace file. Hidden prelaunches are not replayed: they
+//! start in the background, and their reads should not compete with what
+//! the user is doing.
+//!
+//! Traces live in `~/.local/state/flick/launch_traces/<group>.trace`, one
+//! `<size> <mtime> <path>` line per file. A trace is recorded again when it
+//! is older than MAX_TRACE_AGE, or on the launch after one that found a
+//! fifth of its files changed (an app or system update).
+//!
+//! Recording needs CAP_SYS_ADMIN and the app cgroups (to tell the app's
+//! opens from everyone else's); without them launches just go unprefetched.
+
+use std::collections::{HashMap, HashSet};
+use std::ffi::CString;
+use std::os::unix::fs::MetadataExt;
+use std::os::unix::io::AsRawFd;
+use std::path::{Path, PathBuf};
+use std::sync::Mutex;
+use std::time::{Duration, Instant, SystemTime};
+
+/// How long after launch opens are recorded
+const RECORD_FOR: Duration = Duration::from_secs(8);
+/// Files kept per trace
+const MAX_FILES: usize = 2000;
+/// Readahead per file (large libraries are only partly touched)
+const MAX_FILE_BYTES: u64 = 32 * 1024 * 1024;
+/// Readahead per launch
+const MAX_TOTAL_BYTES: u64 = 256 * 1024 * 1024;
+/// Parallel readahead workers (keeps the eMMC queue busy)
+const WORKERS: usize = 4;
+/// Traces older than this are recorded again
+const MAX_TRACE_AGE: Duration = Duration::from_secs(14 * 86400);
+/// Opens under these are not worth prefetching
+const SKIP_PREFIXES: [&str; 5] = ["/proc/", "/sys/", "/dev/", "/run/", "/tmp/"];
+
+lazy_static::lazy_static! {
+    /// Groups with a recording in progress
+    static ref RECORDING: Mutex<HashSet<String>> = Mutex::new(HashSet::new());
+}
+
+/// One file of a trace
+#[derive(Debug, Clone, PartialEq)]
+struct TraceEntry {
+    size: u64,
+    mtime: i64,
+    path: PathBuf,
+}
+
+fn trace_path(group: &str) -> PathBuf {
+    crate::shell::get_state_dir().join("launch_traces").join(format!("{}.trace", group))
+}
+
+fn parse_trace(contents: &str) -> Vec<TraceEntry> {
+    contents
+        .lines()
+        .filter(|line| !line.starts_with('#'))
+        .filter_map(|line| {
+            let mut fields = line.splitn(3, ' ');
+            Some(TraceEntry {
+                size: fields.next()?.parse().ok()?,
+                mtime: fields.next()?.parse().ok()?,
+                path: PathBuf::from(fields.next()?),
+            })
+        })
+        .collect()
+}
+
+fn format_trace(entries: &[TraceEntry]) -> String {
+    let mut out = String::from("# flick launch trace v1: size mtime path\n");
+    for entry in entries {
+        out.push_str(&format!("{} {} {}\n", entry.size, entry.mtime, entry.path.display()));
+    }
+    out
+}
+
+/// Current size/mtime of a file, None if it is gone or not a regular file
+fn stat_entry(path: &Path) -> Option<TraceEntry> {
+    let meta = std::fs::metadata(path).ok()?;
+    meta.is_file().then(|| TraceEntry { size: meta.size(), mtime: meta.mtime(), path: path.to_path_buf() })
+}
+
+/// Files still worth reading, and whether too much changed to trust the trace
+fn check_trace(entries: &[TraceEntry]) -> (Vec<TraceEntry>, bool) {
+    let current: Vec<TraceEntry> = entries.iter().filter(|e| stat_entry(&e.path).as_ref() == Some(*e)).cloned().collect();
+    let changed = entries.len() - current.len();
+    (current, changed * 5 > entries.len())
+}
+
+/// Called right before an app is spawned: start recording a trace if there
+/// is none or it is old, and replay the existing one unless `replay` is off
+pub fn on_launch(app_id: &str, replay: bool) {
+    let group = crate::app_cgroups::group_name(app_id);
+    let path = trace_path(&group);
+    let age = std::fs::metadata(&path)
+        .and_then(|m| m.modified())
+        .ok()
+        .and_then(|mtime| SystemTime::now().duration_since(mtime).ok());
+
+    if replay && age.is_some() {
+        let (group, path) = (group.clone(), path.clone());
+        std::thread::spawn(move || replay_trace(&group, &path));
+    }
+    if age.map_or(true, |age| age > MAX_TRACE_AGE) {
+        start_recording(group, path);
+    }
+}
+
+/// Replay the files of a trace that are unchanged. A trace with too many
+/// changes is removed so the next launch records it again.
+fn replay_trace(group: &str, path: &Path) {
+    let entries = parse_trace(&std::fs::read_to_string(path).unwrap_or_default());
+    let (current, stale) = check_trace(&entries);
+    let recording = RECORDING.lock().map(|r| r.contains(group)).unwrap_or(true);
+    if stale && !recording {
+        tracing::info!("Launch trace for '{}' is stale, recording it next launch", group);
+        let _ = std::fs::remove_file(path);
+    }
+    replay(group, current);
+}
+
+/// Read the files into the page cache on worker threads, biggest first
+/// within each worker so the queue is never idle on small files
+fn replay(group: &str, mut entries: Vec<TraceEntry>) {
+    if entries.is_empty() {
+        return;
+    }
+    let mut budget = MAX_TOTAL_BYTES;
+    entries.retain(|e| {
+        let take = e.size.min(MAX_FILE_BYTES);
+        if take > budget {
+            return false;
+        }
+        budget -= take;
+        true
+    });
+    let total = MAX_TOTAL_BYTES - budget;
+    tracing::info!("Prefetching {} files ({} KiB) for '{}'", entries.len(), total / 1024, group);
+
+    let mut shards: Vec<Vec<TraceEntry>> = vec![Vec::new(); WORKERS];
+    for (i, entry) in entries.into_iter().enumerate() {
+        shards[i % WORKERS].push(entry);
+    }
+    for mut shard in shards.into_iter().filter(|s| !s.is_empty()) {
+        shard.sort_by(|a, b| b.size.cmp(&a.size));
+        std::thread::spawn(move || {
+            for entry in shard {
+                let Ok(file) = std::fs::File::open(&entry.path) else { continue };
+                // readahead() waits for the reads, which is what the worker is for
+                unsafe { libc::readahead(file.as_raw_fd(), 0, entry.size.min(MAX_FILE_BYTES) as usize) };
+            }
+        });
+    }
+}
+
+/// True if /proc/<pid>/cgroup content puts the process in app `group`
+/// (or a group below it) under the app groups' root `rel_root`
+fn in_group(cgroup: &str, rel_root: &str, group: &str) -> bool {
+    !rel_root.is_empty()
+        && crate::app_cgroups::parse_proc_cgroup(cgroup, rel_root).as_deref() == Some(group)
+}
+
+/// Set up fanotify now (so nothing the app opens early is missed) and
+/// collect on a thread
+fn start_recording(group: String, path: PathBuf) {
+    if !crate::app_cgroups::groups_enabled() {
+        return;
+    }
+    if let Ok(mut recording) = RECORDING.lock() {
+        if !recording.insert(group.clone()) {
+            return;
+        }
+    }
+    let fd = unsafe {
+        libc::fanotify_init(libc::FAN_CLASS_NOTIF | libc::FAN_CLOEXEC | libc::FAN_NONBLOCK, (libc::O_RDONLY | libc::O_LARGEFILE) as u32)
+    };
+    if fd < 0 {
+        tracing::debug!("Launch trace: fanotify unavailable: {}", std::io::Error::last_os_error());
+        RECORDING.lock().map(|mut r| r.remove(&group)).ok();
+        return;
+    }
+    // Root plus wherever apps and user data live, once per filesystem
+    let mut devices = HashSet::new();
+    for mount in ["/", "/usr", "/home", "/opt"] {
+        let Ok(meta) = std::fs::metadata(mount) else { continue };
+        if !devices.insert(meta.dev()) {
+            continue;
+        }
+        let Ok(cpath) = CString::new(mount) else { continue };
+        unsafe {
+            libc::fanotify_mark(fd, libc::FAN_MARK_ADD | libc::FAN_MARK_MOUNT, libc::FAN_OPEN, libc::AT_FDCWD, cpath.as_ptr());
+        }
+    }
+
+    tracing::info!("Recording launch trace for '{}'", group);
+    std::thread::spawn(move || {
+        let entries = collect_opens(fd, &group);
+        unsafe { libc::close(fd) };
+        if !entries.is_empty() {
+            let _ = std::fs::create_dir_all(path.parent().unwrap_or(Path::new("/")));
+            match std::fs::write(&path, format_trace(&entries)) {
+                Ok(()) => tracing::info!("Launch trace for '{}': {} files", group, entries.len()),
+                Err(e) => tracing::warn!("Could not write launch trace {:?}: {}", path, e),
+            }
+        }
+        RECORDING.lock().map(|mut r| r.remove(&group)).ok();
+    });
+}
+
+/// Read fanotify events for RECORD_FOR, keeping files opened by the group
+fn collect_opens(fd: i32, group: &str) -> Vec<TraceEntry> {
+    let deadline = Instant::now() + RECORD_FOR;
+    let mut pids: HashMap<i32, bool> = HashMap::new();
+    let mut seen: HashSet<PathBuf> = HashSet::new();
+    let mut entries = Vec::new();
+    let mut buf = vec![0u8; 16 * 1024];
+    let meta_size = std::mem::size_of::<libc::fanotify_event_metadata>();
+
+    while let Some(left) = deadline.checked_duration_since(Instant::now()) {
+        let mut pfd = libc::pollfd { fd, events: libc::POLLIN, revents: 0 };
+        if unsafe { libc::poll(&mut pfd, 1, left.as_millis().min(200) as i32) } <= 0 {
+            continue;
+        }
+        let len = unsafe { libc::read(fd, buf.as_mut_ptr() as *mut libc::c_void, buf.len()) };
+        if len <= 0 {
+            continue;
+        }
+        let mut offset = 0;
+        while offset + meta_size <= len as usize {
+            let event: libc::fanotify_event_metadata =
+                unsafe { std::ptr::read_unaligned(buf[offset..].as_ptr() as *const _) };
+            if event.event_len == 0 {
+                break;
+            }
+            offset += event.event_len as usize;
+            if event.fd < 0 {
+                continue;
+            }
+            let wanted = *pids.entry(event.pid).or_insert_with(|| {
+                std::fs::read_to_string(format!("/proc/{}/cgroup", event.pid))
+                    .map(|cgroup| in_group(&cgroup, crate::app_cgroups::groups_rel_root(), group))
+                    .unwrap_or(false)
+            });
+            if wanted && entries.len() < MAX_FILES {
+                if let Ok(path) = std::fs::read_link(format!("/proc/self/fd/{}", event.fd)) {
+                    let skip = SKIP_PREFIXES.iter().any(|p| path.starts_with(p));
+                    if !skip && seen.insert(path.clone()) {
+                        if let Some(entry) = stat_entry(&path) {
+                            entries.push(entry);
+                        }
+                    }
+                }
+            }
+            unsafe { libc::close(event.fd) };
+        }
+    }
+    entries
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_trace_roundtrip() {
+        let entries = vec![
+            TraceEntry { size: 1234, mtime: 1700000000, path: PathBuf::from("/usr/lib/libQt5Core.so.5") },
+            TraceEntry { size: 10, mtime: -1, path: PathBuf::from("/home/u/Flick/apps/my app/main.qml") },
+        ];
+        assert_eq!(parse_trace(&format_trace(&entries)), entries);
+    }
+
+    #[test]
+    fn test_stale_trace_detected() {
+        let dir = std::env::temp_dir().join(format!("flick-prefetch-test-{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let mut entries = Vec::new();
+        for i in 0..5 {
+            let path = dir.join(format!("f{}", i));
+            std::fs::write(&path, "x").unwrap();
+            entries.push(stat_entry(&path).unwrap());
+        }
+        assert_eq!(check_trace(&entries), (entries.clone(), false));
+
+        // One changed file in five is tolerated, two is an update
+        std::fs::write(dir.join("f0"), "changed").unwrap();
+        assert!(!check_trace(&entries).1);
+        std::fs::remove_file(dir.join("f1")).unwrap();
+        let (current, stale) = check_trace(&entries);
+        assert_eq!(current.len(), 3);
+        assert!(stale);
+        let _ = std::fs::remove_dir_all(&dir);
+    }
+
+    #[test]
+    fn test_in_group() {
+        let root = "/flick-apps";
+        assert!(in_group("0::/flick-apps/weather\n", root, "weather"));
+        assert!(in_group("0::/flick-apps/weather/sub\n", root, "weather"));
+        assert!(!in_group("0::/flick-apps/weather-beta\n", root, "weather"));
+        assert!(!in_group("0::/flick-apps/weather.old/sub\n", root, "weather"));
+        assert!(!in_group("0::/flick-apps/my.weather\n", root, "weather"));
+        assert!(!in_group("0::/system.slice/flick.service\n", root, "weather"));
+        // Only the group right under the root counts, not any path component
+        assert!(!in_group("0::/user.slice/weather\n", root, "weather"));
+        assert!(!in_group("0::/flick-apps/other/weather\n", root, "weather"));
+        assert!(!in_group("0::/flick-apps-old/weather\n", root, "weather"));
+        assert!(!in_group("0::/flick-apps/weather\n", "", "weather"));
+    }
+}
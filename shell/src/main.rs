@@ -18,6 +18,13 @@ pub mod system;
 pub mod text_input;
 pub mod android_wlegl;
 pub mod spawn_user;
+pub mod app_cgroups;
+pub mod memory_pressure;
+pub mod launch_prefetch;
+pub mod orientation;
+pub mod prelaunch;
+pub mod supervisor;
+pub mod sound;
 
 use std::path::PathBuf;
 
@@ -38,6 +45,11 @@ struct Args {
     /// Enable verbose debug output
     #[arg(short, long)]
     debug: bool,
+
+    /// Keep the Wayland socket in a parent process and restart the
+    /// compositor in place if it crashes
+    #[arg(long)]
+    supervise: bool,
 }
 
 fn main() -> Result<()> {
@@ -91,6 +103,11 @@ fn main() -> Result<()> {
 
     info!(log_path = %log_dir.display(), "Flick compositor starting");
 
+    if args.supervise {
+        info!("Running as supervisor");
+        return supervisor::run();
+    }
+
     if args.windowed {
         info!("Running in windowed mode (winit backend)");
         backend::winit::run()
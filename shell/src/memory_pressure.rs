@@ -0,0 +1,317 @@
+//! Memory pressure handling for app processes
+//!
+//! A worker thread registers PSI triggers on `/proc/pressure/memory` and
+//! forwards them to the main loop. The main loop escalates in two steps:
+//! first background apps are asked to give memory back (a trim request file
+//! for the app and `memory.reclaim` on its cgroup, see `app_cgroups`). Only
+//! if "some" stalls keep coming for KILL_GRACE after that, or tasks are
+//! fully stalled, is the least recently used background app killed before
+//! the system starts thrashing.
+//!
+//! The shell itself and Flick's daemons are shielded from the kernel OOM
+//! killer with a negative `oom_score_adj`; launched apps get a positive one
+//! so they are always picked first.
+
+use std::fs::OpenOptions;
+use std::io::Write;
+use std::os::unix::fs::OpenOptionsExt;
+use std::os::unix::io::AsRawFd;
+use std::os::unix::process::CommandExt;
+use std::process::Command;
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::time::{Duration, Instant};
+
+/// "some" stall of 150ms per second: a task is waiting on memory, trim
+const SOME_TRIGGER: (&str, u64) = ("some", 150_000);
+/// "full" stall of 100ms per second: everything is waiting, start killing
+const FULL_TRIGGER: (&str, u64) = ("full", 100_000);
+/// Trigger windows to try (us); without CAP_SYS_RESOURCE the kernel only
+/// accepts multiples of 2s
+const TRIGGER_WINDOWS: &[u64] = &[1_000_000, 2_000_000];
+/// "some" stalls must go on this long after the first trim before a kill,
+/// giving apps and the kernel time to give memory back
+const KILL_GRACE: Duration = Duration::from_secs(6);
+/// A stall-free gap this long ends a pressure episode (triggers fire about
+/// once per window while pressure lasts)
+const CALM_GAP: Duration = Duration::from_secs(5);
+/// Minimum gap between trims and between kills (let the kernel catch up)
+const TRIM_INTERVAL: Duration = Duration::from_secs(2);
+const KILL_INTERVAL: Duration = Duration::from_secs(3);
+/// How often the worker re-applies oom_score_adj to daemons
+const PROTECT_INTERVAL_MS: i32 = 10_000;
+
+/// oom_score_adj for the compositor (-1000 would make it unkillable)
+const SHELL_OOM_ADJ: i32 = -900;
+/// oom_score_adj for Flick's background daemons
+const DAEMON_OOM_ADJ: i32 = -500;
+/// oom_score_adj for launched apps (inherited from the shell otherwise)
+const APP_OOM_ADJ: i32 = 200;
+
+/// Process names / scripts that belong to the system, not to an app, and
+/// whether they are batch work to be clamped (see app_cgroups tiers)
+const DAEMONS: &[(&str, bool)] = &[
+    ("messaging_daemon.py", true),
+    ("email_backend.py", true),
+    ("contacts_store.py", true),
+    ("calendar_engine.py", true),
+    ("http_cache.py", true),
+    ("tile_server.py", true),
+    ("install_server.py", true),
+    // Call handling and sound playback must stay responsive
+    ("phone_helper.py", false),
+    ("flick-audio-engine", false),
+];
+
+/// PSI trigger that fired
+#[derive(Debug, Clone, Copy, PartialEq)]
+enum Stall {
+    Some,
+    Full,
+}
+
+/// What the main loop should do about the current pressure
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum PressureAction {
+    /// Ask background apps to reclaim memory
+    Trim,
+    /// Kill the least recently used background app
+    Kill,
+}
+
+/// Worker -> main loop messages
+enum Event {
+    Stall(Stall),
+    /// A daemon pid and whether it is clamped
+    Service(u32, bool),
+}
+
+fn write_oom_score_adj(pid: &str, adj: i32) -> bool {
+    std::fs::write(format!("/proc/{}/oom_score_adj", pid), adj.to_string()).is_ok()
+}
+
+/// Reset the child's oom_score_adj before exec, so apps do not inherit the
+/// shell's protection. Call before the privilege-dropping `pre_exec`:
+/// raising the value is always allowed, but the file must be opened as root.
+pub fn set_app_oom_score(command: &mut Command) {
+    let path = b"/proc/self/oom_score_adj\0";
+    let value = APP_OOM_ADJ.to_string().into_bytes();
+    unsafe {
+        command.pre_exec(move || {
+            let fd = libc::open(path.as_ptr() as *const libc::c_char, libc::O_WRONLY | libc::O_CLOEXEC);
+            if fd >= 0 {
+                libc::write(fd, value.as_ptr() as *const libc::c_void, value.len());
+                libc::close(fd);
+            }
+            Ok(())
+        });
+    }
+}
+
+/// Is this command line one of Flick's daemons? Returns its clamp flag.
+fn match_daemon(cmdline: &[u8]) -> Option<bool> {
+    cmdline
+        .split(|b| *b == 0)
+        .take(3) // interpreter, script, first argument
+        .filter_map(|arg| std::str::from_utf8(arg).ok())
+        .map(|arg| arg.rsplit('/').next().unwrap_or(arg))
+        .find_map(|name| DAEMONS.iter().find(|(daemon, _)| *daemon == name).map(|(_, clamp)| *clamp))
+}
+
+/// Give Flick's daemons a low oom_score_adj and report their pids, so they
+/// can be moved out of app cgroups and into their scheduling tier
+fn protect_daemons(tx: &Sender<Event>) {
+    let Ok(entries) = std::fs::read_dir("/proc") else { return };
+    for entry in entries.flatten() {
+        let name = entry.file_name();
+        let Some(pid) = name.to_str().filter(|p| p.bytes().all(|b| b.is_ascii_digit())) else { continue };
+        let Ok(cmdline) = std::fs::read(format!("/proc/{}/cmdline", pid)) else { continue };
+        let Some(clamp) = match_daemon(&cmdline) else { continue };
+        let current = std::fs::read_to_string(format!("/proc/{}/oom_score_adj", pid))
+            .ok()
+            .and_then(|s| s.trim().parse::<i32>().ok());
+        if current.map(|c| c > DAEMON_OOM_ADJ).unwrap_or(false) && write_oom_score_adj(pid, DAEMON_OOM_ADJ) {
+            tracing::info!("Protected daemon pid {} (oom_score_adj {})", pid, DAEMON_OOM_ADJ);
+        }
+        if let Ok(pid) = pid.parse() {
+            let _ = tx.send(Event::Service(pid, clamp));
+        }
+    }
+}
+
+/// Open /proc/pressure/memory with a trigger registered on it
+fn open_trigger((kind, stall_per_sec): (&str, u64)) -> Option<std::fs::File> {
+    for window in TRIGGER_WINDOWS {
+        let mut file = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .custom_flags(libc::O_NONBLOCK)
+            .open("/proc/pressure/memory")
+            .ok()?;
+        let trigger = format!("{} {} {}", kind, stall_per_sec * window / 1_000_000, window);
+        // The kernel expects the terminating NUL
+        let mut buf = trigger.clone().into_bytes();
+        buf.push(0);
+        match file.write_all(&buf) {
+            Ok(()) => return Some(file),
+            Err(e) => tracing::debug!("PSI trigger '{}' rejected: {}", trigger, e),
+        }
+    }
+    tracing::warn!("No PSI {} trigger accepted by the kernel", kind);
+    None
+}
+
+/// Worker: wait for PSI events, re-protect daemons between them
+fn monitor(tx: Sender<Event>) {
+    let some = open_trigger(SOME_TRIGGER);
+    let full = open_trigger(FULL_TRIGGER);
+    if some.is_none() && full.is_none() {
+        tracing::info!("PSI memory triggers unavailable, only protecting daemons");
+    }
+    let mut fds = [
+        libc::pollfd { fd: some.as_ref().map(|f| f.as_raw_fd()).unwrap_or(-1), events: libc::POLLPRI, revents: 0 },
+        libc::pollfd { fd: full.as_ref().map(|f| f.as_raw_fd()).unwrap_or(-1), events: libc::POLLPRI, revents: 0 },
+    ];
+
+    protect_daemons(&tx);
+    let mut last_protect = Instant::now();
+    loop {
+        let n = unsafe { libc::poll(fds.as_mut_ptr(), fds.len() as libc::nfds_t, PROTECT_INTERVAL_MS) };
+        if n < 0 {
+            if std::io::Error::last_os_error().kind() == std::io::ErrorKind::Interrupted {
+                continue;
+            }
+            tracing::warn!("PSI poll failed: {}", std::io::Error::last_os_error());
+            return;
+        }
+        for (fd, stall) in fds.iter_mut().zip([Stall::Some, Stall::Full]) {
+            if fd.revents & libc::POLLERR != 0 {
+                tracing::warn!("PSI {:?} trigger closed by the kernel", stall);
+                fd.fd = -1;
+            } else if fd.revents & libc::POLLPRI != 0 && tx.send(Event::Stall(stall)).is_err() {
+                return;
+            }
+            fd.revents = 0;
+        }
+        if last_protect.elapsed() >= Duration::from_millis(PROTECT_INTERVAL_MS as u64) {
+            last_protect = Instant::now();
+            protect_daemons(&tx);
+        }
+    }
+}
+
+/// Main-loop side of the pressure monitor
+#[derive(Default)]
+pub struct MemoryPressure {
+    events: Option<Receiver<Event>>,
+    /// Start of the current pressure episode (or of the wait since the last kill)
+    episode_start: Option<Instant>,
+    last_stall: Option<Instant>,
+    last_trim: Option<Instant>,
+    last_kill: Option<Instant>,
+}
+
+impl MemoryPressure {
+    pub fn new() -> Self {
+        if write_oom_score_adj("self", SHELL_OOM_ADJ) {
+            tracing::info!("Shell oom_score_adj set to {}", SHELL_OOM_ADJ);
+        }
+        let (tx, rx) = mpsc::channel();
+        let events = std::thread::Builder::new()
+            .name("flick-mempressure".into())
+            .spawn(move || monitor(tx))
+            .map(|_| rx)
+            .map_err(|e| tracing::warn!("Could not start memory pressure monitor: {}", e))
+            .ok();
+        Self { events, ..Default::default() }
+    }
+
+    /// Drain pending events; returns the action to take this frame, if any.
+    /// Daemon pids (and their clamp flag) are handed to `adopt_service`.
+    pub fn poll(&mut self, mut adopt_service: impl FnMut(u32, bool)) -> Option<PressureAction> {
+        let mut worst = None;
+        if let Some(rx) = self.events.as_ref() {
+            while let Ok(event) = rx.try_recv() {
+                match event {
+                    Event::Stall(Stall::Full) => worst = Some(Stall::Full),
+                    Event::Stall(Stall::Some) => { worst.get_or_insert(Stall::Some); }
+                    Event::Service(pid, clamp) => adopt_service(pid, clamp),
+                }
+            }
+        }
+        self.decide(worst?, Instant::now())
+    }
+
+    /// Escalation policy: trim while "some" stalls are new, kill on a
+    /// "full" stall or once "some" stalls have gone on for KILL_GRACE
+    fn decide(&mut self, stall: Stall, now: Instant) -> Option<PressureAction> {
+        let recently = |at: Option<Instant>, window: Duration| at.map(|t| now.duration_since(t) < window).unwrap_or(false);
+        if !recently(self.last_stall, CALM_GAP) {
+            self.episode_start = Some(now);
+        }
+        self.last_stall = Some(now);
+        let sustained = self.episode_start.is_some_and(|start| now.duration_since(start) >= KILL_GRACE);
+        let action = match stall {
+            Stall::Full => PressureAction::Kill,
+            Stall::Some if sustained => PressureAction::Kill,
+            Stall::Some => PressureAction::Trim,
+        };
+        match action {
+            PressureAction::Kill if recently(self.last_kill, KILL_INTERVAL) => None,
+            PressureAction::Trim if recently(self.last_trim, TRIM_INTERVAL) => None,
+            PressureAction::Kill => {
+                // The next kill needs another grace period of pressure
+                self.last_kill = Some(now);
+                self.episode_start = Some(now);
+                Some(action)
+            }
+            PressureAction::Trim => {
+                self.last_trim = Some(now);
+                Some(action)
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_match_daemon() {
+        assert_eq!(match_daemon(b"python3\0/home/u/Flick/apps/messages/messaging_daemon.py\0daemon\0"), Some(true));
+        assert_eq!(match_daemon(b"/home/u/Flick/services/flick-audio-engine/target/release/flick-audio-engine\0--samples\0"), Some(false));
+        assert_eq!(match_daemon(b"qmlscene\0/home/u/Flick/apps/messages/main.qml\0"), None);
+    }
+
+    #[test]
+    fn test_escalation() {
+        let mut pressure = MemoryPressure::default();
+        let t0 = Instant::now();
+        let at = |secs: u64| t0 + Duration::from_secs(secs);
+        assert_eq!(pressure.decide(Stall::Some, t0), Some(PressureAction::Trim));
+        // Still stalling within the grace period: trim again, rate limited
+        assert_eq!(pressure.decide(Stall::Some, at(1)), None);
+        assert_eq!(pressure.decide(Stall::Some, at(3)), Some(PressureAction::Trim));
+        assert_eq!(pressure.decide(Stall::Some, at(5)), Some(PressureAction::Trim));
+        // Pressure outlasted the grace period: kill
+        assert_eq!(pressure.decide(Stall::Some, at(6)), Some(PressureAction::Kill));
+        // Another kill needs another grace period, or a full stall
+        assert_eq!(pressure.decide(Stall::Some, at(8)), Some(PressureAction::Trim));
+        assert_eq!(pressure.decide(Stall::Full, at(8)), None);
+        assert_eq!(pressure.decide(Stall::Full, at(9)), Some(PressureAction::Kill));
+        // Calm period: back to trimming first
+        assert_eq!(pressure.decide(Stall::Some, at(30)), Some(PressureAction::Trim));
+    }
+
+    #[test]
+    fn test_gap_restarts_grace() {
+        let mut pressure = MemoryPressure::default();
+        let t0 = Instant::now();
+        let at = |secs: u64| t0 + Duration::from_secs(secs);
+        assert_eq!(pressure.decide(Stall::Some, t0), Some(PressureAction::Trim));
+        // The trim helped for a while; pressure returning is a new episode
+        assert_eq!(pressure.decide(Stall::Some, at(7)), Some(PressureAction::Trim));
+        assert_eq!(pressure.decide(Stall::Some, at(10)), Some(PressureAction::Trim));
+        assert_eq!(pressure.decide(Stall::Some, at(13)), Some(PressureAction::Kill));
+    }
+}
@@ -0,0 +1,343 @@
+//! Accelerometer-driven auto-rotation
+//!
+//! Orientation comes from iio-sensor-proxy. There is no D-Bus crate in the
+//! shell, so the claim is held by its `monitor-sensor` client: it calls
+//! `ClaimAccelerometer` on start, prints `AccelerometerOrientation` changes
+//! as they are signalled and releases the claim when it exits. A reader
+//! thread forwards parsed readings to the main loop; nothing polls.
+//!
+//! The sensor is only claimed while the policy in
+//! `Flick::update_auto_rotation` holds (screen on, rotatable app in front,
+//! rotation not locked); otherwise the child is killed and the sensor can
+//! power down. Readings are debounced and rate limited before a rotation is
+//! committed, and the `RotationPlan` for a candidate orientation is built
+//! as soon as the candidate appears so committing only swaps it in.
+//!
+//! Any service implementing `net.hadess.SensorProxy` on the system bus
+//! works, including a stub. `FLICK_SENSOR_MONITOR` replaces the monitor
+//! command entirely, e.g. with a script that prints
+//! `Accelerometer orientation changed: left-up` lines.
+
+use crate::system::Orientation;
+use std::io::{BufRead, BufReader};
+use std::process::{Child, Command, Stdio};
+use std::sync::mpsc::{self, Receiver, TryRecvError};
+use std::time::{Duration, Instant};
+
+/// Default monitor command (iio-sensor-proxy's client, accelerometer only)
+const MONITOR_COMMAND: &str = "monitor-sensor --accel";
+/// Environment override for the monitor command
+const MONITOR_ENV: &str = "FLICK_SENSOR_MONITOR";
+/// A new orientation must be reported this long before it is committed
+const DEBOUNCE: Duration = Duration::from_millis(400);
+/// Minimum gap between two committed rotations
+const MIN_INTERVAL: Duration = Duration::from_secs(1);
+/// Wait before restarting a monitor that failed or exited
+const RETRY_INTERVAL: Duration = Duration::from_secs(30);
+
+/// Orientation reported by iio-sensor-proxy
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Reading {
+    Normal,
+    BottomUp,
+    LeftUp,
+    RightUp,
+    Undefined,
+}
+
+impl Reading {
+    fn from_name(name: &str) -> Option<Self> {
+        Some(match name {
+            "normal" => Reading::Normal,
+            "bottom-up" => Reading::BottomUp,
+            "left-up" => Reading::LeftUp,
+            "right-up" => Reading::RightUp,
+            "undefined" => Reading::Undefined,
+            _ => return None,
+        })
+    }
+
+    /// Orientation to rotate to, None to keep the current one. Upside-down
+    /// is not supported and, like a flat device, keeps what is on screen.
+    pub fn orientation(self) -> Option<Orientation> {
+        match self {
+            Reading::Normal => Some(Orientation::Portrait),
+            // Left edge up: content turns 90 degrees (Transform::_90)
+            Reading::LeftUp => Some(Orientation::Landscape90),
+            Reading::RightUp => Some(Orientation::Landscape270),
+            Reading::BottomUp | Reading::Undefined => None,
+        }
+    }
+}
+
+/// Parse one line of `monitor-sensor` output
+pub fn parse_monitor_line(line: &str) -> Option<Reading> {
+    let line = line.trim();
+    // Initial state: "=== Has accelerometer (orientation: normal, tilt: ...)"
+    if let Some(rest) = line.strip_prefix("=== Has accelerometer (orientation: ") {
+        let name = rest.split(|c| c == ',' || c == ')').next()?;
+        return Reading::from_name(name.trim());
+    }
+    // Changes: "Accelerometer orientation changed: left-up"
+    let name = line.strip_prefix("Accelerometer orientation changed:")?;
+    Reading::from_name(name.trim())
+}
+
+/// Everything needed to show one orientation, computed ahead of the commit
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct RotationPlan {
+    pub orientation: Orientation,
+    /// Panel size in pixels
+    pub physical_size: (i32, i32),
+    /// Size clients and the shell lay out against
+    pub logical_size: (i32, i32),
+    /// Rows of the 2x2 matrix taking framebuffer texcoords (around the
+    /// centre) to scene texcoords, for the rotated blit
+    pub blit_rotation: [f32; 4],
+}
+
+impl RotationPlan {
+    pub fn new(orientation: Orientation, physical_size: (i32, i32)) -> Self {
+        let (w, h) = physical_size;
+        let (logical_size, blit_rotation) = match orientation {
+            Orientation::Portrait => ((w, h), [1.0, 0.0, 0.0, 1.0]),
+            Orientation::Landscape90 => ((h, w), [0.0, 1.0, -1.0, 0.0]),
+            Orientation::Landscape270 => ((h, w), [0.0, -1.0, 1.0, 0.0]),
+        };
+        Self { orientation, physical_size, logical_size, blit_rotation }
+    }
+
+    pub fn is_rotated(&self) -> bool {
+        self.orientation != Orientation::Portrait
+    }
+
+    /// Map a panel position (touch input) into logical coordinates
+    pub fn to_logical(&self, x: f64, y: f64) -> (f64, f64) {
+        let (w, h) = (self.physical_size.0 as f64, self.physical_size.1 as f64);
+        match self.orientation {
+            Orientation::Portrait => (x, y),
+            Orientation::Landscape90 => (h - y, x),
+            Orientation::Landscape270 => (y, w - x),
+        }
+    }
+}
+
+/// Debounce and rate limiting between raw readings and committed rotations
+#[derive(Debug, Default)]
+pub struct OrientationFilter {
+    /// Orientation waiting to become stable, with its plan and first sighting
+    candidate: Option<(RotationPlan, Instant)>,
+    last_commit: Option<Instant>,
+}
+
+impl OrientationFilter {
+    pub fn push(&mut self, reading: Reading, current: Orientation, physical_size: (i32, i32), now: Instant) {
+        match reading.orientation() {
+            // Flat or upside down: keep the current orientation and forget
+            // any half-settled candidate
+            None => self.candidate = None,
+            Some(orientation) if orientation == current => self.candidate = None,
+            Some(orientation) => {
+                if self.candidate.map(|(plan, _)| plan.orientation) != Some(orientation) {
+                    self.candidate = Some((RotationPlan::new(orientation, physical_size), now));
+                }
+            }
+        }
+    }
+
+    /// The candidate's plan once it has been stable long enough
+    pub fn poll(&mut self, now: Instant) -> Option<RotationPlan> {
+        let (plan, since) = self.candidate?;
+        if now.duration_since(since) < DEBOUNCE {
+            return None;
+        }
+        if self.last_commit.is_some_and(|t| now.duration_since(t) < MIN_INTERVAL) {
+            return None;
+        }
+        self.candidate = None;
+        self.last_commit = Some(now);
+        Some(plan)
+    }
+
+    pub fn reset(&mut self) {
+        self.candidate = None;
+    }
+}
+
+/// Running monitor process holding the accelerometer claim
+struct SensorClaim {
+    child: Child,
+    readings: Receiver<Reading>,
+}
+
+impl SensorClaim {
+    fn spawn() -> std::io::Result<Self> {
+        let command = std::env::var(MONITOR_ENV).unwrap_or_else(|_| MONITOR_COMMAND.to_string());
+        let mut child = Command::new("sh")
+            .arg("-c")
+            .arg(format!("exec {}", command))
+            .stdin(Stdio::null())
+            .stdout(Stdio::piped())
+            .stderr(Stdio::null())
+            .spawn()?;
+        let stdout = child.stdout.take().expect("piped stdout");
+
+        let (tx, readings) = mpsc::channel();
+        std::thread::Builder::new()
+            .name("flick-orientation".into())
+            .spawn(move || {
+                for line in BufReader::new(stdout).lines() {
+                    let Ok(line) = line else { break };
+                    if let Some(reading) = parse_monitor_line(&line) {
+                        if tx.send(reading).is_err() {
+                            break;
+                        }
+                    }
+                }
+            })?;
+
+        tracing::info!("Auto-rotation: accelerometer claimed ({})", command);
+        Ok(Self { child, readings })
+    }
+}
+
+impl Drop for SensorClaim {
+    fn drop(&mut self) {
+        // Exiting the monitor releases the claim; the reader thread ends at EOF
+        let _ = self.child.kill();
+        let _ = self.child.wait();
+        tracing::info!("Auto-rotation: accelerometer released");
+    }
+}
+
+/// Auto-rotation state owned by the compositor
+pub struct AutoRotation {
+    sensor: Option<SensorClaim>,
+    retry_at: Option<Instant>,
+    filter: OrientationFilter,
+    current: RotationPlan,
+}
+
+impl AutoRotation {
+    pub fn new() -> Self {
+        Self {
+            sensor: None,
+            retry_at: None,
+            filter: OrientationFilter::default(),
+            current: RotationPlan::new(Orientation::Portrait, (0, 0)),
+        }
+    }
+
+    /// Plan currently on screen
+    pub fn current(&self) -> &RotationPlan {
+        &self.current
+    }
+
+    /// Claim or release the sensor and return a rotation to apply, if any.
+    /// Releasing while rotated returns to portrait straight away.
+    pub fn update(&mut self, wanted: bool, physical_size: (i32, i32), now: Instant) -> Option<RotationPlan> {
+        if !wanted {
+            if self.sensor.take().is_some() {
+                self.filter.reset();
+            }
+            self.retry_at = None;
+            return self.current.is_rotated()
+                .then(|| RotationPlan::new(Orientation::Portrait, physical_size));
+        }
+
+        if self.sensor.is_none() && self.retry_at.map_or(true, |t| now >= t) {
+            match SensorClaim::spawn() {
+                Ok(sensor) => self.sensor = Some(sensor),
+                Err(e) => {
+                    tracing::warn!("Auto-rotation: cannot start sensor monitor: {}", e);
+                    self.retry_at = Some(now + RETRY_INTERVAL);
+                }
+            }
+        }
+
+        let sensor = self.sensor.as_mut()?;
+        loop {
+            match sensor.readings.try_recv() {
+                Ok(reading) => {
+                    tracing::debug!("Auto-rotation: sensor reports {:?}", reading);
+                    self.filter.push(reading, self.current.orientation, physical_size, now);
+                }
+                Err(TryRecvError::Empty) => break,
+                Err(TryRecvError::Disconnected) => {
+                    tracing::warn!("Auto-rotation: sensor monitor exited");
+                    self.sensor = None;
+                    self.retry_at = Some(now + RETRY_INTERVAL);
+                    break;
+                }
+            }
+        }
+
+        self.filter.poll(now)
+    }
+
+    /// Record that `plan` is now on screen
+    pub fn commit(&mut self, plan: RotationPlan) {
+        self.current = plan;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_monitor_output() {
+        assert_eq!(parse_monitor_line("=== Has accelerometer (orientation: left-up, tilt: vertical)"), Some(Reading::LeftUp));
+        assert_eq!(parse_monitor_line("=== Has accelerometer (orientation: normal)"), Some(Reading::Normal));
+        assert_eq!(parse_monitor_line("    Accelerometer orientation changed: right-up"), Some(Reading::RightUp));
+        assert_eq!(parse_monitor_line("    Tilt changed: tilted-down"), None);
+        assert_eq!(parse_monitor_line("+++ iio-sensor-proxy appeared"), None);
+    }
+
+    #[test]
+    fn test_debounce_and_hysteresis() {
+        let mut filter = OrientationFilter::default();
+        let t0 = Instant::now();
+        let ms = |n| t0 + Duration::from_millis(n);
+        let size = (1080, 2340);
+
+        // A brief wobble is ignored
+        filter.push(Reading::LeftUp, Orientation::Portrait, size, t0);
+        filter.push(Reading::Normal, Orientation::Portrait, size, ms(100));
+        assert_eq!(filter.poll(ms(600)), None);
+
+        // A stable reading commits with the plan precomputed
+        filter.push(Reading::LeftUp, Orientation::Portrait, size, ms(600));
+        filter.push(Reading::Undefined, Orientation::Portrait, size, ms(700));
+        filter.push(Reading::LeftUp, Orientation::Portrait, size, ms(800));
+        assert_eq!(filter.poll(ms(1100)), None);
+        let plan = filter.poll(ms(1200)).unwrap();
+        assert_eq!(plan.orientation, Orientation::Landscape90);
+        assert_eq!(plan.logical_size, (2340, 1080));
+
+        // Commits are rate limited
+        filter.push(Reading::Normal, Orientation::Landscape90, size, ms(1300));
+        assert_eq!(filter.poll(ms(1900)), None);
+        assert_eq!(filter.poll(ms(2200)).map(|p| p.orientation), Some(Orientation::Portrait));
+    }
+
+    #[test]
+    fn test_touch_and_blit_mapping_agree() {
+        let (w, h) = (1080.0, 2340.0);
+        for orientation in [Orientation::Portrait, Orientation::Landscape90, Orientation::Landscape270] {
+            let plan = RotationPlan::new(orientation, (w as i32, h as i32));
+            let (lw, lh) = (plan.logical_size.0 as f64, plan.logical_size.1 as f64);
+            for (px, py) in [(0.0, 0.0), (w, 0.0), (270.0, 1800.0)] {
+                let (lx, ly) = plan.to_logical(px, py);
+                assert!((0.0..=lw).contains(&lx) && (0.0..=lh).contains(&ly));
+                // The blit samples the scene (bottom-up) at the same point
+                let r = plan.blit_rotation.map(|v| v as f64);
+                let (ax, ay) = (px / w - 0.5, (1.0 - py / h) - 0.5);
+                let s = 0.5 + r[0] * ax + r[1] * ay;
+                let t = 0.5 + r[2] * ax + r[3] * ay;
+                assert!((s - lx / lw).abs() < 1e-9, "{:?} s", orientation);
+                assert!((t - (1.0 - ly / lh)).abs() < 1e-9, "{:?} t", orientation);
+            }
+        }
+    }
+}
@@ -0,0 +1,298 @@
+//! Predictive app prelaunch, compositor side
+//!
+//! The compositor logs every user launch and lock/unlock to `app_launches`
+//! in the state dir; services/flick-app-service learns from it and writes
+//! the apps it expects next to `prelaunch`. Each requested app is spawned
+//! into its cgroup at the lowest tier (see `app_cgroups`), its toplevel is
+//! configured but kept out of the space, and once it has had time to draw
+//! its first frame the group is frozen. A user launch of that app then only
+//! thaws and maps the window. Apps dropped from the request are killed.
+//!
+//! The request file is read when a watcher thread sees it replaced
+//! (inotify), not on a timer, so nothing is checked while the phone sleeps.
+
+use smithay::desktop::Window;
+use smithay::wayland::shell::xdg::ToplevelSurface;
+use std::collections::HashMap;
+use std::ffi::CString;
+use std::fs::File;
+use std::io::{Read, Write};
+use std::os::fd::FromRawFd;
+use std::os::unix::ffi::OsStrExt;
+use std::path::{Path, PathBuf};
+use std::sync::mpsc::{self, Receiver};
+use std::time::{Duration, Instant, SystemTime};
+
+/// Launch log read by the app service
+const LAUNCH_LOG: &str = "app_launches";
+/// App ids requested by the app service, one per line
+const REQUEST_FILE: &str = "prelaunch";
+/// The log is trimmed to its newer half past this size
+const MAX_LOG_BYTES: u64 = 256 * 1024;
+/// How often the request file is checked when inotify is unavailable
+const POLL_INTERVAL: Duration = Duration::from_secs(1);
+/// wd, mask, cookie, len of a `struct inotify_event`
+const INOTIFY_EVENT_HEADER: usize = 16;
+/// Time a hidden window gets to draw its first frame before it is frozen
+const FIRST_FRAME_GRACE: Duration = Duration::from_secs(3);
+/// A prelaunched app without a window after this long is given up
+const START_TIMEOUT: Duration = Duration::from_secs(30);
+/// Hidden apps kept at once, whatever the service asks for
+const MAX_HIDDEN: usize = 3;
+
+/// Append an event (`launch <app_id>`, `lock`, `unlock`) to the launch log
+fn record(event: &str) {
+    let path = crate::shell::get_state_dir().join(LAUNCH_LOG);
+    let now = chrono::Local::now();
+    let line = format!("{} {} {}\n", now.timestamp(), now.offset().local_minus_utc(), event);
+    trim_log(&path);
+    let written = std::fs::OpenOptions::new()
+        .create(true)
+        .append(true)
+        .open(&path)
+        .and_then(|mut f| f.write_all(line.as_bytes()));
+    if let Err(e) = written {
+        tracing::debug!("Could not append to launch log {:?}: {}", path, e);
+    }
+}
+
+/// Keep the newer half of an oversized log (the service rereads it)
+fn trim_log(path: &Path) {
+    let too_big = std::fs::metadata(path).map(|m| m.len() > MAX_LOG_BYTES).unwrap_or(false);
+    if !too_big {
+        return;
+    }
+    let Ok(contents) = std::fs::read_to_string(path) else { return };
+    let half = contents.len() / 2;
+    let start = contents[half..].find('\n').map(|i| half + i + 1).unwrap_or(contents.len());
+    let _ = std::fs::write(path, &contents[start..]);
+}
+
+/// App id of an exec line that runs a bundled app (`.../apps/<id>/...`)
+pub fn app_id_from_exec(exec: &str) -> Option<&str> {
+    exec.split("/apps/").nth(1)?.split('/').next().filter(|id| !id.is_empty())
+}
+
+/// Start a thread that reports each replacement of the request file.
+/// None if inotify is unavailable; the caller then polls.
+fn watch_requests(dir: &Path) -> Option<Receiver<()>> {
+    let _ = std::fs::create_dir_all(dir);
+    let path = CString::new(dir.as_os_str().as_bytes()).ok()?;
+    let fd = unsafe { libc::inotify_init1(libc::IN_CLOEXEC) };
+    if fd < 0 {
+        tracing::warn!("inotify unavailable, polling prelaunch requests: {}", std::io::Error::last_os_error());
+        return None;
+    }
+    // Owns the fd from here on
+    let mut inotify = unsafe { File::from_raw_fd(fd) };
+    // The app service writes a temp file and renames it over the request
+    if unsafe { libc::inotify_add_watch(fd, path.as_ptr(), libc::IN_CLOSE_WRITE | libc::IN_MOVED_TO) } < 0 {
+        tracing::warn!("Cannot watch {:?}, polling prelaunch requests: {}", dir, std::io::Error::last_os_error());
+        return None;
+    }
+    let (tx, rx) = mpsc::channel();
+    std::thread::Builder::new()
+        .name("flick-prelaunch-watch".into())
+        .spawn(move || {
+            let mut buf = [0u8; 4096];
+            loop {
+                let n = match inotify.read(&mut buf) {
+                    Ok(n) => n,
+                    Err(e) if e.kind() == std::io::ErrorKind::Interrupted => continue,
+                    Err(e) => {
+                        tracing::warn!("Prelaunch request watch failed: {}", e);
+                        return;
+                    }
+                };
+                if event_names(&buf[..n]).any(|name| name == REQUEST_FILE.as_bytes()) && tx.send(()).is_err() {
+                    return;
+                }
+            }
+        })
+        .map_err(|e| tracing::warn!("Could not start prelaunch request watch: {}", e))
+        .ok()?;
+    Some(rx)
+}
+
+/// File names of the events in one inotify read
+fn event_names(mut buf: &[u8]) -> impl Iterator<Item = &[u8]> {
+    std::iter::from_fn(move || {
+        if buf.len() < INOTIFY_EVENT_HEADER {
+            return None;
+        }
+        let len = u32::from_ne_bytes(buf[12..16].try_into().ok()?) as usize;
+        let end = (INOTIFY_EVENT_HEADER + len).min(buf.len());
+        // NUL-padded to the record length
+        let name = buf[INOTIFY_EVENT_HEADER..end].split(|b| *b == 0).next().unwrap_or(&[]);
+        buf = &buf[end..];
+        Some(name)
+    })
+}
+
+/// A prelaunched app that has not been shown yet
+pub struct HiddenApp {
+    pub app_id: String,
+    spawned_at: Instant,
+    /// Its toplevel once created, configured but not mapped
+    pub window: Option<Window>,
+    window_at: Option<Instant>,
+    frozen: bool,
+}
+
+/// Requested and hidden apps, keyed by cgroup name
+pub struct Prelaunch {
+    request_path: PathBuf,
+    /// Replacements of the request file, None when polling instead
+    changes: Option<Receiver<()>>,
+    mtime: Option<SystemTime>,
+    last_poll: Option<Instant>,
+    hidden: HashMap<String, HiddenApp>,
+    was_locked: bool,
+}
+
+impl Prelaunch {
+    pub fn new() -> Self {
+        let state_dir = crate::shell::get_state_dir();
+        Self {
+            request_path: state_dir.join(REQUEST_FILE),
+            changes: watch_requests(&state_dir),
+            mtime: None,
+            last_poll: None,
+            hidden: HashMap::new(),
+            was_locked: false,
+        }
+    }
+
+    /// New request list if the file changed since the last call
+    pub fn poll_requests(&mut self, now: Instant) -> Option<Vec<String>> {
+        let first = self.last_poll.is_none();
+        match self.changes.as_ref() {
+            Some(changes) => {
+                let mut changed = first;
+                while changes.try_recv().is_ok() {
+                    changed = true;
+                }
+                if !changed {
+                    return None;
+                }
+            }
+            None if self.last_poll.is_some_and(|at| now.duration_since(at) < POLL_INTERVAL) => return None,
+            None => {}
+        }
+        self.last_poll = Some(now);
+        let mtime = std::fs::metadata(&self.request_path).and_then(|m| m.modified()).ok();
+        if mtime == self.mtime {
+            return None;
+        }
+        self.mtime = mtime;
+        let contents = std::fs::read_to_string(&self.request_path).unwrap_or_default();
+        Some(parse_requests(&contents))
+    }
+
+    /// Record lock/unlock transitions in the launch log
+    pub fn note_lock_state(&mut self, locked: bool) {
+        if locked != self.was_locked {
+            self.was_locked = locked;
+            record(if locked { "lock" } else { "unlock" });
+        }
+    }
+
+    /// Record a user launch, after any lock change it follows
+    pub fn record_launch(&mut self, app_id: &str, locked: bool) {
+        self.note_lock_state(locked);
+        record(&format!("launch {}", app_id));
+    }
+
+    pub fn has_room(&self) -> bool {
+        self.hidden.len() < MAX_HIDDEN
+    }
+
+    pub fn is_hidden(&self, group: &str) -> bool {
+        self.hidden.contains_key(group)
+    }
+
+    pub fn groups(&self) -> Vec<String> {
+        self.hidden.keys().cloned().collect()
+    }
+
+    pub fn add(&mut self, group: String, app_id: String) {
+        self.hidden.insert(group, HiddenApp {
+            app_id,
+            spawned_at: Instant::now(),
+            window: None,
+            window_at: None,
+            frozen: false,
+        });
+    }
+
+    /// Keep the toplevel of a hidden app until it is shown
+    pub fn hold_window(&mut self, group: &str, window: Window) {
+        if let Some(app) = self.hidden.get_mut(group) {
+            app.window = Some(window);
+            app.window_at = Some(Instant::now());
+        }
+    }
+
+    pub fn take(&mut self, group: &str) -> Option<HiddenApp> {
+        self.hidden.remove(group)
+    }
+
+    /// Forget a hidden app whose toplevel went away (it exited on its own)
+    pub fn toplevel_destroyed(&mut self, surface: &ToplevelSurface) {
+        self.hidden.retain(|_, app| {
+            app.window.as_ref().and_then(|w| w.toplevel()).map(|t| t != surface).unwrap_or(true)
+        });
+    }
+
+    /// Groups that have had their first-frame grace and should be frozen
+    /// now, and groups that never produced a window
+    pub fn due(&mut self, now: Instant) -> (Vec<String>, Vec<String>) {
+        let mut freeze = Vec::new();
+        let mut expired = Vec::new();
+        for (group, app) in &mut self.hidden {
+            match app.window_at {
+                Some(at) if !app.frozen && now.duration_since(at) >= FIRST_FRAME_GRACE => {
+                    app.frozen = true;
+                    freeze.push(group.clone());
+                }
+                None if now.duration_since(app.spawned_at) >= START_TIMEOUT => expired.push(group.clone()),
+                _ => {}
+            }
+        }
+        (freeze, expired)
+    }
+}
+
+fn parse_requests(contents: &str) -> Vec<String> {
+    contents
+        .lines()
+        .map(str::trim)
+        .filter(|line| !line.is_empty() && !line.starts_with('#'))
+        .map(str::to_string)
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_requests_and_exec() {
+        assert_eq!(parse_requests("weather\n\n# x\n messages \n"), vec!["weather", "messages"]);
+        assert_eq!(app_id_from_exec("sh -c \"$HOME/Flick/apps/weather/run_weather.sh\""), Some("weather"));
+        assert_eq!(app_id_from_exec("/usr/bin/foot"), None);
+    }
+
+    #[test]
+    fn test_inotify_event_names() {
+        let mut buf = Vec::new();
+        for (name, padded) in [(&b"prelaunch.tmp"[..], 16usize), (&b"prelaunch"[..], 16)] {
+            let mut record = vec![0u8; INOTIFY_EVENT_HEADER];
+            record[12..16].copy_from_slice(&(padded as u32).to_ne_bytes());
+            record.extend_from_slice(name);
+            record.resize(INOTIFY_EVENT_HEADER + padded, 0);
+            buf.extend(record);
+        }
+        assert_eq!(event_names(&buf).collect::<Vec<_>>(), vec![&b"prelaunch.tmp"[..], &b"prelaunch"[..]]);
+    }
+}
@@ -1,7 +1,7 @@
 //! Dynamic app discovery - scans ~/Flick/apps/ for apps
 //!
 //! Each subdirectory in ~/Flick/apps/ is an app.
-//! Optional manifest.json for custom name/icon/color.
+//! Optional manifest.json for custom name/icon/color and auto-rotation.
 
 use std::collections::HashMap;
 use std::fs;
@@ -59,6 +59,9 @@ pub struct AppManifest {
     /// Whether to show in app grid (defaults to true)
     #[serde(default = "default_true")]
     pub visible: bool,
+    /// Whether the app follows the accelerometer into landscape
+    #[serde(default)]
+    pub rotatable: bool,
 }
 
 fn default_true() -> bool { true }
@@ -71,6 +74,7 @@ impl Default for AppManifest {
             color: None,
             exec: None,
             visible: true,  // Default to visible
+            rotatable: false,
         }
     }
 }
@@ -90,6 +94,8 @@ pub struct AppDef {
     pub exec: String,
     /// Path to app directory
     pub path: PathBuf,
+    /// Auto-rotates with the device (manifest `rotatable`)
+    pub rotatable: bool,
 }
 
 impl AppDef {
@@ -158,6 +164,7 @@ impl AppDef {
             color: manifest.color.unwrap_or(default_color),
             exec: manifest.exec.unwrap_or(default_exec),
             path: path.clone(),
+            rotatable: manifest.rotatable,
         })
     }
 }
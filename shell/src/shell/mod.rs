@@ -1223,33 +1223,38 @@ impl Shell {
         }
     }
 
-    /// Get categories with their icons as Slint images (uses already-cached icons)
-    /// Returns Vec of (name, slint::Image, color)
+    /// Push the home categories into the Slint UI (uses already-cached icons)
+    /// Rows are keyed by name, icon, color and whether the icon is loaded yet,
+    /// so icons are only converted to Slint images for rows that changed and
+    /// an unchanged grid does no model work.
     /// Note: Call preload_icons() first to ensure icons are cached
-    pub fn get_categories_with_icons(&self) -> Vec<(String, slint::Image, [f32; 4])> {
-        self.app_manager
-            .get_category_info()
-            .iter()
-            .map(|cat| {
-                let icon = if let Some(ref icon_name) = cat.icon {
-                    // Try to get the icon from cache (must be preloaded)
-                    if let Some(icon_data) = self.icon_cache.get_cached(icon_name) {
-                        // Convert RGBA bytes to Slint image
-                        let pixel_buffer = slint::SharedPixelBuffer::<slint::Rgba8Pixel>::clone_from_slice(
-                            &icon_data.data,
-                            icon_data.width,
-                            icon_data.height,
-                        );
-                        slint::Image::from_rgba8(pixel_buffer)
-                    } else {
-                        slint::Image::default()
-                    }
+    pub fn sync_slint_categories(&self) {
+        let Some(ref slint_ui) = self.slint_ui else { return };
+        let categories = self.app_manager.get_category_info();
+        let keys = categories.iter().map(|cat| {
+            let loaded = cat.icon.as_deref().is_some_and(|name| self.icon_cache.get_cached(name).is_some());
+            slint_ui::row_key((&cat.name, &cat.icon, cat.color.map(f32::to_bits), loaded))
+        });
+        slint_ui.set_categories(keys, |i| {
+            let cat = &categories[i];
+            let icon = if let Some(ref icon_name) = cat.icon {
+                // Try to get the icon from cache (must be preloaded)
+                if let Some(icon_data) = self.icon_cache.get_cached(icon_name) {
+                    // Convert RGBA bytes to Slint image
+                    let pixel_buffer = slint::SharedPixelBuffer::<slint::Rgba8Pixel>::clone_from_slice(
+                        &icon_data.data,
+                        icon_data.width,
+                        icon_data.height,
+                    );
+                    slint::Image::from_rgba8(pixel_buffer)
                 } else {
                     slint::Image::default()
-                };
-                (cat.name.clone(), icon, cat.color)
-            })
-            .collect()
+                }
+            } else {
+                slint::Image::default()
+            };
+            (cat.name.clone(), icon, cat.color)
+        });
     }
 
     /// Load UI icons for quick settings and other shell elements
@@ -4,18 +4,122 @@
 //! The Slint UI is rendered to a pixel buffer which is then composited as
 //! a texture element in Smithay's render pipeline.
 
-use std::cell::RefCell;
+use std::cell::{Cell, RefCell};
+use std::hash::{Hash, Hasher};
 use std::rc::Rc;
 
 use slint::platform::software_renderer::{MinimalSoftwareWindow, RepaintBufferType};
 use slint::platform::{Platform, WindowAdapter, PointerEventButton, WindowEvent};
-use slint::{LogicalPosition, PhysicalSize, Rgb8Pixel, SharedPixelBuffer};
+use slint::{LogicalPosition, Model, ModelRc, PhysicalSize, Rgb8Pixel, SharedPixelBuffer, VecModel};
 use smithay::utils::{Logical, Size};
 use tracing::{info, warn};
 
 // Include the generated Slint code
 slint::include_modules!();
 
+/// Set a scalar property only if it differs from what the component holds,
+/// so an unchanged frame does no property work (and no string allocation)
+macro_rules! set_if_changed {
+    ($shell:expr, $get:ident, $set:ident, $value:expr) => {{
+        let value = $value;
+        if $shell.$get() != value {
+            $shell.$set(value.into());
+        }
+    }};
+}
+
+/// Hash of everything a list row shows, used as its key in `RetainedModel`
+/// (and as the content key of pre-rendered gesture views)
+pub fn row_key(parts: impl Hash) -> u64 {
+    let mut hasher = std::collections::hash_map::DefaultHasher::new();
+    parts.hash(&mut hasher);
+    hasher.finish()
+}
+
+/// A list model bound to its property once and then updated in place
+///
+/// Each row carries a key (see `row_key`); only rows whose key changed are
+/// rebuilt and written, extra rows are pushed or removed at the tail. An
+/// unchanged list costs one key comparison per row and leaves the model,
+/// and everything Slint derived from it, untouched.
+struct RetainedModel<T: Clone + 'static> {
+    model: Rc<VecModel<T>>,
+    keys: RefCell<Vec<u64>>,
+}
+
+impl<T: Clone + 'static> RetainedModel<T> {
+    fn new() -> Self {
+        Self { model: Rc::new(VecModel::default()), keys: RefCell::new(Vec::new()) }
+    }
+
+    fn model_rc(&self) -> ModelRc<T> {
+        ModelRc::from(self.model.clone())
+    }
+
+    /// Bring the model to `keys`, calling `row(i)` only for rows that changed
+    fn update(&self, keys: impl IntoIterator<Item = u64>, mut row: impl FnMut(usize) -> T) {
+        let mut current = self.keys.borrow_mut();
+        let mut len = 0;
+        for (i, key) in keys.into_iter().enumerate() {
+            len = i + 1;
+            if i >= current.len() {
+                self.model.push(row(i));
+                current.push(key);
+            } else if current[i] != key {
+                self.model.set_row_data(i, row(i));
+                current[i] = key;
+            }
+        }
+        while current.len() > len {
+            current.pop();
+            self.model.remove(current.len());
+        }
+    }
+}
+
+/// Screen rectangle (x, y, width, height) in pixels
+type PixelRect = (u32, u32, u32, u32);
+
+/// Smallest rectangle covering both
+fn union_rect(a: Option<PixelRect>, b: PixelRect) -> PixelRect {
+    let Some(a) = a else { return b };
+    let x = a.0.min(b.0);
+    let y = a.1.min(b.1);
+    let right = (a.0 + a.2).max(b.0 + b.2);
+    let bottom = (a.1 + a.3).max(b.1 + b.3);
+    (x, y, right - x, bottom - y)
+}
+
+/// Overlap of two rectangles, None if they don't touch
+fn intersect_rect(a: PixelRect, b: PixelRect) -> Option<PixelRect> {
+    let x = a.0.max(b.0);
+    let y = a.1.max(b.1);
+    let right = (a.0 + a.2).min(b.0 + b.2);
+    let bottom = (a.1 + a.3).min(b.1 + b.3);
+    (right > x && bottom > y).then(|| (x, y, right - x, bottom - y))
+}
+
+/// Repainted pixels of a layer (RGBA, tightly packed rows)
+pub struct LayerDamage {
+    pub x: u32,
+    pub y: u32,
+    pub width: u32,
+    pub height: u32,
+    pub pixels: Vec<u8>,
+}
+
+/// The on-screen keyboard as a layer of its own (see `render_keyboard_layer`)
+pub struct KeyboardLayerFrame {
+    pub width: u32,
+    pub height: u32,
+    /// Screen y of the layer's top edge with the keyboard at rest
+    pub top: u32,
+    /// Slide offset to apply when compositing (positive moves it down)
+    pub offset: f32,
+    /// What changed since the last frame, in layer coordinates
+    pub damage: Option<LayerDamage>,
+}
+
 /// Actions that can be triggered from popup menu
 #[derive(Debug, Clone, Copy, PartialEq)]
 pub enum PopupAction {
@@ -125,6 +229,14 @@ pub struct SlintShell {
     size: Size<i32, Logical>,
     /// Pixel buffer for software rendering (RGBA8888)
     pixel_buffer: RefCell<Vec<u8>>,
+    /// Slint's render target, kept across frames so only dirty areas are repainted
+    rgb_buffer: RefCell<SharedPixelBuffer<Rgb8Pixel>>,
+    /// Screen area repainted since the keyboard layer last took it
+    keyboard_damage: Cell<Option<PixelRect>>,
+    /// Keyboard slide offset (a transform for the keyboard layer)
+    keyboard_y_offset: Cell<f32>,
+    /// Bumped by `set_wallpaper`, so offscreen shells know to copy it
+    wallpaper_serial: Cell<u64>,
     /// Pending app tap index (set by callback, polled by compositor)
     pending_app_tap: Rc<RefCell<Option<i32>>>,
     /// Pending Quick Settings actions (set by callbacks, polled by compositor)
@@ -159,6 +271,12 @@ pub struct SlintShell {
     pending_orbital_ring_rotation: Rc<RefCell<Option<(i32, f32)>>>,
     /// Pending orbital velocity (ring number, velocity) - per-ring for momentum
     pending_orbital_ring_velocity: Rc<RefCell<Option<(i32, f32)>>>,
+    /// Home screen categories, bound once and diffed per row
+    categories: RetainedModel<AppCategory>,
+    /// Switcher cards, bound once and diffed per row (shared with offscreen shells)
+    switcher_windows: Rc<RetainedModel<WindowCard>>,
+    /// Pick default app list, bound once and diffed per row
+    available_apps: RetainedModel<AvailableApp>,
 }
 
 impl SlintShell {
@@ -167,9 +285,9 @@ impl SlintShell {
         info!("Creating Slint shell with size {:?}", size);
 
         // Create the minimal software window
-        // IMPORTANT: Use NewBuffer because we create a fresh buffer each frame
-        // ReusedBuffer would only repaint damaged areas, leaving the rest black
-        let window = MinimalSoftwareWindow::new(RepaintBufferType::NewBuffer);
+        // ReusedBuffer: the RGB target persists in rgb_buffer, so Slint only
+        // repaints damaged areas and reports them (see draw)
+        let window = MinimalSoftwareWindow::new(RepaintBufferType::ReusedBuffer);
         window.set_size(PhysicalSize::new(size.w as u32, size.h as u32));
 
         // Set up the Slint platform
@@ -179,6 +297,40 @@ impl SlintShell {
         }))
         .expect("Failed to set Slint platform");
 
+        Self::with_window(window, size, Rc::new(RetainedModel::new()))
+    }
+
+    /// A second shell on its own offscreen window, for drawing a view the
+    /// screen isn't showing (gesture snapshots) without switching this one.
+    /// It shares this shell's switcher cards, so previews read back for it
+    /// are already in place when the live switcher opens.
+    pub fn offscreen(&self) -> Self {
+        let window = MinimalSoftwareWindow::new(RepaintBufferType::ReusedBuffer);
+        window.set_size(PhysicalSize::new(self.size.w as u32, self.size.h as u32));
+        NEXT_WINDOW.with(|next| *next.borrow_mut() = Some(window.clone()));
+        let mut offscreen = Self::with_window(window, self.size, self.switcher_windows.clone());
+        NEXT_WINDOW.with(|next| next.borrow_mut().take());
+        self.sync_offscreen(&mut offscreen);
+        offscreen
+    }
+
+    /// Bring an `offscreen` shell to this one's size and wallpaper
+    pub fn sync_offscreen(&self, offscreen: &mut Self) {
+        offscreen.set_size(self.size);
+        if offscreen.wallpaper_serial.get() != self.wallpaper_serial.get() {
+            offscreen.shell.set_wallpaper(self.shell.get_wallpaper());
+            offscreen.wallpaper_serial.set(self.wallpaper_serial.get());
+        }
+        set_if_changed!(offscreen.shell, get_has_wallpaper, set_has_wallpaper, self.shell.get_has_wallpaper());
+    }
+
+    /// Changes whenever the wallpaper is set or turned on or off
+    pub fn wallpaper_key(&self) -> u64 {
+        row_key((self.wallpaper_serial.get(), self.shell.get_has_wallpaper()))
+    }
+
+    fn with_window(window: Rc<MinimalSoftwareWindow>, size: Size<i32, Logical>,
+                   switcher_windows: Rc<RetainedModel<WindowCard>>) -> Self {
         // Create the shell component
         let shell = FlickShell::new().expect("Failed to create FlickShell component");
 
@@ -188,6 +340,7 @@ impl SlintShell {
         // Allocate pixel buffer (RGBA = 4 bytes per pixel)
         let buffer_size = (size.w * size.h * 4) as usize;
         let pixel_buffer = RefCell::new(vec![0u8; buffer_size]);
+        let rgb_buffer = RefCell::new(SharedPixelBuffer::new(size.w as u32, size.h as u32));
 
         // Create pending app tap storage for callback communication
         let pending_app_tap = Rc::new(RefCell::new(None));
@@ -423,11 +576,22 @@ impl SlintShell {
             *velocity_clone.borrow_mut() = Some((ring, velocity));
         });
 
+        // List models live as long as the shell; setters update them in place
+        let categories = RetainedModel::new();
+        shell.set_categories(categories.model_rc());
+        shell.set_switcher_windows(switcher_windows.model_rc());
+        let available_apps = RetainedModel::new();
+        shell.set_available_apps(available_apps.model_rc());
+
         Self {
             window,
             shell,
             size,
             pixel_buffer,
+            rgb_buffer,
+            keyboard_damage: Cell::new(None),
+            keyboard_y_offset: Cell::new(0.0),
+            wallpaper_serial: Cell::new(0),
             pending_app_tap,
             pending_qs_actions,
             pending_switcher_tap,
@@ -445,6 +609,9 @@ impl SlintShell {
             pending_status_bar_tap,
             pending_orbital_ring_rotation,
             pending_orbital_ring_velocity,
+            categories,
+            switcher_windows,
+            available_apps,
         }
     }
 
@@ -455,20 +622,22 @@ impl SlintShell {
             self.window
                 .set_size(PhysicalSize::new(size.w as u32, size.h as u32));
 
-            // Reallocate pixel buffer
+            // Reallocate pixel buffers
             let buffer_size = (size.w * size.h * 4) as usize;
             *self.pixel_buffer.borrow_mut() = vec![0u8; buffer_size];
+            *self.rgb_buffer.borrow_mut() = SharedPixelBuffer::new(size.w as u32, size.h as u32);
+            self.keyboard_damage.set(Some((0, 0, size.w as u32, size.h as u32)));
         }
     }
 
     /// Set the current view (lock, home, quick-settings, app)
     pub fn set_view(&self, view: &str) {
-        self.shell.set_current_view(view.into());
+        set_if_changed!(self.shell, get_current_view, set_current_view, view);
     }
 
     /// Set status bar time (for home screen)
     pub fn set_time(&self, time: &str) {
-        self.shell.set_time(time.into());
+        set_if_changed!(self.shell, get_time, set_time, time);
     }
 
     /// Poll for pending lock screen actions
@@ -478,22 +647,22 @@ impl SlintShell {
 
     /// Set orbital home side (true = left-handed, false = right-handed)
     pub fn set_orbital_is_left(&self, is_left: bool) {
-        self.shell.set_orbital_is_left(is_left);
+        set_if_changed!(self.shell, get_orbital_is_left, set_orbital_is_left, is_left);
     }
 
     /// Set orbital ring 1 rotation
     pub fn set_orbital_ring1_rotation(&self, rotation: f32) {
-        self.shell.set_orbital_ring1_rotation(rotation);
+        set_if_changed!(self.shell, get_orbital_ring1_rotation, set_orbital_ring1_rotation, rotation);
     }
 
     /// Set orbital ring 2 rotation
     pub fn set_orbital_ring2_rotation(&self, rotation: f32) {
-        self.shell.set_orbital_ring2_rotation(rotation);
+        set_if_changed!(self.shell, get_orbital_ring2_rotation, set_orbital_ring2_rotation, rotation);
     }
 
     /// Set orbital ring 3 rotation
     pub fn set_orbital_ring3_rotation(&self, rotation: f32) {
-        self.shell.set_orbital_ring3_rotation(rotation);
+        set_if_changed!(self.shell, get_orbital_ring3_rotation, set_orbital_ring3_rotation, rotation);
     }
 
     /// Poll for pending orbital ring rotation changes (ring number, rotation)
@@ -517,165 +686,166 @@ impl SlintShell {
 
     /// Set brightness value (0.0 to 1.0)
     pub fn set_brightness(&self, brightness: f32) {
-        self.shell.set_brightness(brightness);
+        set_if_changed!(self.shell, get_brightness, set_brightness, brightness);
     }
 
     /// Set volume value (0 to 100)
     pub fn set_volume(&self, volume: i32) {
-        self.shell.set_volume(volume);
+        set_if_changed!(self.shell, get_volume, set_volume, volume);
     }
 
     /// Set muted state
     pub fn set_muted(&self, muted: bool) {
-        self.shell.set_muted(muted);
+        set_if_changed!(self.shell, get_muted, set_muted, muted);
     }
 
     /// Show or hide volume overlay
     pub fn set_show_volume_overlay(&self, show: bool) {
-        self.shell.set_show_volume_overlay(show);
+        set_if_changed!(self.shell, get_show_volume_overlay, set_show_volume_overlay, show);
     }
 
     /// Set WiFi enabled state
     pub fn set_wifi_enabled(&self, enabled: bool) {
-        self.shell.set_wifi_enabled(enabled);
+        set_if_changed!(self.shell, get_wifi_enabled, set_wifi_enabled, enabled);
     }
 
     /// Set Bluetooth enabled state
     pub fn set_bluetooth_enabled(&self, enabled: bool) {
-        self.shell.set_bluetooth_enabled(enabled);
+        set_if_changed!(self.shell, get_bluetooth_enabled, set_bluetooth_enabled, enabled);
     }
 
     /// Set Do Not Disturb enabled state
     pub fn set_dnd_enabled(&self, enabled: bool) {
-        self.shell.set_dnd_enabled(enabled);
+        set_if_changed!(self.shell, get_dnd_enabled, set_dnd_enabled, enabled);
     }
 
     /// Set Flashlight enabled state
     pub fn set_flashlight_enabled(&self, enabled: bool) {
-        self.shell.set_flashlight_enabled(enabled);
+        set_if_changed!(self.shell, get_flashlight_enabled, set_flashlight_enabled, enabled);
     }
 
     /// Set Airplane mode enabled state
     pub fn set_airplane_enabled(&self, enabled: bool) {
-        self.shell.set_airplane_enabled(enabled);
+        set_if_changed!(self.shell, get_airplane_enabled, set_airplane_enabled, enabled);
     }
 
     /// Set Touch Effects enabled state
     pub fn set_touch_effects_enabled(&self, enabled: bool) {
-        self.shell.set_touch_effects_enabled(enabled);
+        set_if_changed!(self.shell, get_touch_effects_enabled, set_touch_effects_enabled, enabled);
     }
 
     /// Set Voice 2G mode enabled state
     pub fn set_voice2g_enabled(&self, enabled: bool) {
-        self.shell.set_voice2g_enabled(enabled);
+        set_if_changed!(self.shell, get_voice2g_enabled, set_voice2g_enabled, enabled);
     }
 
     /// Set WiFi SSID
     pub fn set_wifi_ssid(&self, ssid: &str) {
-        self.shell.set_wifi_ssid(ssid.into());
+        set_if_changed!(self.shell, get_wifi_ssid, set_wifi_ssid, ssid);
     }
 
     /// Set battery percentage
     pub fn set_battery_percent(&self, percent: i32) {
-        self.shell.set_battery_percent(percent);
+        set_if_changed!(self.shell, get_battery_percent, set_battery_percent, percent);
     }
 
     /// Set text scale factor for UI elements
     pub fn set_text_scale(&self, scale: f32) {
-        self.shell.set_text_scale(scale);
+        set_if_changed!(self.shell, get_text_scale, set_text_scale, scale);
     }
 
     /// Set wallpaper image
     pub fn set_wallpaper(&self, image: slint::Image) {
         info!("WALLPAPER: set_wallpaper called, image size: {:?}", image.size());
         self.shell.set_wallpaper(image);
+        self.wallpaper_serial.set(self.wallpaper_serial.get() + 1);
     }
 
     /// Set whether wallpaper is enabled
     pub fn set_has_wallpaper(&self, has: bool) {
         info!("WALLPAPER: set_has_wallpaper({})", has);
-        self.shell.set_has_wallpaper(has);
+        set_if_changed!(self.shell, get_has_wallpaper, set_has_wallpaper, has);
     }
 
     /// Show/hide the long press popup menu
     pub fn set_show_popup(&self, show: bool) {
         *self.popup_showing.borrow_mut() = show;
-        self.shell.set_show_popup(show);
+        set_if_changed!(self.shell, get_show_popup, set_show_popup, show);
     }
 
     /// Set the popup category name
     pub fn set_popup_category_name(&self, name: &str) {
-        self.shell.set_popup_category_name(name.into());
+        set_if_changed!(self.shell, get_popup_category_name, set_popup_category_name, name);
     }
 
     /// Set whether popup can pick default (false for Settings)
     pub fn set_popup_can_pick_default(&self, can_pick: bool) {
         *self.popup_can_pick.borrow_mut() = can_pick;
-        self.shell.set_popup_can_pick_default(can_pick);
+        set_if_changed!(self.shell, get_popup_can_pick_default, set_popup_can_pick_default, can_pick);
     }
 
     /// Show/hide the context menu (copy/paste circular menu)
     pub fn set_show_context_menu(&self, show: bool) {
-        self.shell.set_show_context_menu(show);
+        set_if_changed!(self.shell, get_show_context_menu, set_show_context_menu, show);
     }
 
     /// Set context menu position
     pub fn set_context_menu_position(&self, x: f32, y: f32) {
-        self.shell.set_context_menu_x(x);
-        self.shell.set_context_menu_y(y);
+        set_if_changed!(self.shell, get_context_menu_x, set_context_menu_x, x);
+        set_if_changed!(self.shell, get_context_menu_y, set_context_menu_y, y);
     }
 
     /// Set context menu highlight (0=none, 1=copy, 2=paste, 3=system)
     pub fn set_context_menu_highlight(&self, highlight: i32) {
-        self.shell.set_context_menu_highlight(highlight);
+        set_if_changed!(self.shell, get_context_menu_highlight, set_context_menu_highlight, highlight);
     }
 
     /// Set clipboard preview text
     pub fn set_clipboard_preview(&self, text: &str) {
-        self.shell.set_clipboard_preview(slint::SharedString::from(text));
+        set_if_changed!(self.shell, get_clipboard_preview, set_clipboard_preview, text);
     }
 
     /// Show/hide copied popup notification
     pub fn set_show_copied_popup(&self, show: bool) {
-        self.shell.set_show_copied_popup(show);
+        set_if_changed!(self.shell, get_show_copied_popup, set_show_copied_popup, show);
     }
 
     /// Set copied popup text
     pub fn set_copied_popup_text(&self, text: &str) {
-        self.shell.set_copied_popup_text(slint::SharedString::from(text));
+        set_if_changed!(self.shell, get_copied_popup_text, set_copied_popup_text, text);
     }
 
     /// Set copied popup position
     pub fn set_copied_popup_position(&self, x: f32, y: f32) {
-        self.shell.set_copied_popup_x(x);
-        self.shell.set_copied_popup_y(y);
+        set_if_changed!(self.shell, get_copied_popup_x, set_copied_popup_x, x);
+        set_if_changed!(self.shell, get_copied_popup_y, set_copied_popup_y, y);
     }
 
     /// Show/hide system menu
     pub fn set_show_system_menu(&self, show: bool) {
-        self.shell.set_show_system_menu(show);
+        set_if_changed!(self.shell, get_show_system_menu, set_show_system_menu, show);
     }
 
     /// Set wiggle mode state
     pub fn set_wiggle_mode(&self, wiggle: bool) {
         *self.wiggle_mode.borrow_mut() = wiggle;
-        self.shell.set_wiggle_mode(wiggle);
+        set_if_changed!(self.shell, get_wiggle_mode, set_wiggle_mode, wiggle);
     }
 
     /// Set wiggle animation time (updated each frame from Rust)
     pub fn set_wiggle_time(&self, time: f32) {
-        self.shell.set_wiggle_time(time);
+        set_if_changed!(self.shell, get_wiggle_time, set_wiggle_time, time);
     }
 
     /// Set the index of the tile being dragged (-1 if none)
     pub fn set_dragging_index(&self, index: i32) {
-        self.shell.set_dragging_index(index);
+        set_if_changed!(self.shell, get_dragging_index, set_dragging_index, index);
     }
 
     /// Set the drag position (screen coordinates)
     pub fn set_drag_position(&self, x: f32, y: f32) {
-        self.shell.set_drag_x(x);
-        self.shell.set_drag_y(y);
+        set_if_changed!(self.shell, get_drag_x, set_drag_x, x);
+        set_if_changed!(self.shell, get_drag_y, set_drag_y, y);
     }
 
     /// Check if popup is showing
@@ -726,111 +896,117 @@ impl SlintShell {
 
     /// Set the category name for pick default view
     pub fn set_pick_default_category(&self, name: &str) {
-        self.shell.set_pick_default_category(name.into());
+        set_if_changed!(self.shell, get_pick_default_category, set_pick_default_category, name);
     }
 
     /// Set the current app selection (exec command)
     pub fn set_current_app_selection(&self, exec: &str) {
-        self.shell.set_current_app_selection(exec.into());
+        set_if_changed!(self.shell, get_current_app_selection, set_current_app_selection, exec);
     }
 
     /// Set whether the current selection is a Flick default app
     pub fn set_using_flick_default(&self, is_default: bool) {
-        self.shell.set_using_flick_default(is_default);
+        set_if_changed!(self.shell, get_using_flick_default, set_using_flick_default, is_default);
     }
 
     /// Set available apps for pick default view
     pub fn set_available_apps(&self, apps: Vec<(String, String)>) {
-        let model: Vec<AvailableApp> = apps
-            .into_iter()
-            .map(|(name, exec)| AvailableApp {
-                name: name.into(),
-                exec: exec.into(),
-            })
-            .collect();
-
-        let model_rc = std::rc::Rc::new(slint::VecModel::from(model));
-        self.shell.set_available_apps(model_rc.into());
+        self.available_apps.update(apps.iter().map(row_key), |i| {
+            let (name, exec) = &apps[i];
+            AvailableApp {
+                name: name.as_str().into(),
+                exec: exec.as_str().into(),
+            }
+        });
     }
 
     /// Set app categories for home screen
-    pub fn set_categories(&self, categories: Vec<(String, slint::Image, [f32; 4])>) {
-        let model: Vec<AppCategory> = categories
-            .into_iter()
-            .map(|(name, icon, color)| AppCategory {
+    ///
+    /// `keys` identifies what each row shows (see `Shell::sync_slint_categories`);
+    /// `row(i)` builds a row, icon image included, only when its key changed.
+    pub fn set_categories(
+        &self,
+        keys: impl IntoIterator<Item = u64>,
+        mut row: impl FnMut(usize) -> (String, slint::Image, [f32; 4]),
+    ) {
+        self.categories.update(keys, |i| {
+            let (name, icon, color) = row(i);
+            AppCategory {
                 name: name.into(),
                 icon,
                 color: slint::Color::from_argb_f32(color[3], color[0], color[1], color[2]),
-            })
-            .collect();
-
-        let model_rc = std::rc::Rc::new(slint::VecModel::from(model));
-        self.shell.set_categories(model_rc.into());
+            }
+        });
     }
 
-    /// Set switcher window cards (id, title, app_class, original_index, preview_image)
+    /// Set switcher window cards (id, title, app_class, original_index, preview_serial)
     /// Windows should be sorted by render order (furthest from center first, center last)
-    pub fn set_switcher_windows(&self, windows: Vec<(i32, String, String, i32, Option<slint::Image>)>) {
-        let model: Vec<WindowCard> = windows
-            .into_iter()
-            .map(|(id, title, app_class, original_index, preview)| WindowCard {
-                id,
-                title: title.into(),
-                app_class: app_class.into(),
-                original_index,
-                preview: preview.unwrap_or_default(),
-            })
-            .collect();
-
-        let model_rc = std::rc::Rc::new(slint::VecModel::from(model));
-        self.shell.set_switcher_windows(model_rc.into());
+    ///
+    /// `preview_serial` changes whenever the window's content does (None for
+    /// no preview); `preview(i)` reads back the preview of row `i` and is only
+    /// called for cards that are new, moved or have new content.
+    pub fn set_switcher_windows(
+        &self,
+        windows: Vec<(i32, String, String, i32, Option<u64>)>,
+        mut preview: impl FnMut(usize) -> Option<slint::Image>,
+    ) {
+        self.switcher_windows.update(windows.iter().map(row_key), |i| {
+            let (id, title, app_class, original_index, _) = &windows[i];
+            WindowCard {
+                id: *id,
+                title: title.as_str().into(),
+                app_class: app_class.as_str().into(),
+                original_index: *original_index,
+                preview: preview(i).unwrap_or_default(),
+            }
+        });
     }
 
     /// Set switcher horizontal scroll offset
     pub fn set_switcher_scroll(&self, offset: f32) {
-        self.shell.set_switcher_scroll(offset);
+        set_if_changed!(self.shell, get_switcher_scroll, set_switcher_scroll, offset);
     }
 
     /// Set switcher horizontal push offset for edge swipe gestures
     pub fn set_switcher_push_offset(&self, offset: f32) {
-        self.shell.set_switcher_push_offset(offset);
+        set_if_changed!(self.shell, get_switcher_push_offset, set_switcher_push_offset, offset);
     }
 
     /// Set home screen vertical scroll offset
     pub fn set_home_scroll(&self, offset: f32) {
-        self.shell.set_home_scroll(offset);
+        set_if_changed!(self.shell, get_home_scroll, set_home_scroll, offset);
     }
 
     /// Set home screen horizontal push offset (-1.0 to 1.0)
     pub fn set_home_push_offset(&self, offset: f32) {
-        self.shell.set_home_push_offset(offset);
+        set_if_changed!(self.shell, get_home_push_offset, set_home_push_offset, offset);
     }
 
     /// Set return gesture active state (shows HomeScreen during return gestures)
     pub fn set_return_gesture_active(&self, active: bool) {
-        self.shell.set_return_gesture_active(active);
+        set_if_changed!(self.shell, get_return_gesture_active, set_return_gesture_active, active);
     }
 
     /// Set forward gesture active state (shows HomeScreen during Home → Switcher gesture)
     pub fn set_forward_gesture_active(&self, active: bool) {
-        self.shell.set_forward_gesture_active(active);
+        set_if_changed!(self.shell, get_forward_gesture_active, set_forward_gesture_active, active);
     }
 
     /// Set switcher enter animation progress (0.0 = full screen, 1.0 = card size)
     pub fn set_switcher_enter_progress(&self, progress: f32) {
-        self.shell.set_switcher_enter_progress(progress);
+        set_if_changed!(self.shell, get_switcher_enter_progress, set_switcher_enter_progress, progress);
     }
 
     /// Set incoming call state
     pub fn set_incoming_call(&self, incoming: bool, caller: &str) {
-        self.shell.set_incoming_call(incoming);
-        self.shell.set_incoming_caller(caller.into());
+        set_if_changed!(self.shell, get_incoming_call, set_incoming_call, incoming);
+        set_if_changed!(self.shell, get_incoming_caller, set_incoming_caller, caller);
     }
 
     /// Clear incoming call overlay
     pub fn clear_incoming_call(&self) {
-        self.shell.set_incoming_call(false);
-        self.shell.set_incoming_caller("".into());
+        set_if_changed!(self.shell, get_incoming_call, set_incoming_call, false);
+        set_if_changed!(self.shell, get_incoming_caller, set_incoming_caller, "");
     }
 
     /// Set UI icons for quick settings and other shell elements
@@ -904,32 +1080,35 @@ impl SlintShell {
         });
     }
 
-    /// Render the Slint UI and return the pixel buffer
-    /// Returns (width, height, RGBA pixel data)
-    pub fn render(&self) -> Option<(u32, u32, Vec<u8>)> {
+    /// Let Slint repaint whatever changed into rgb_buffer and convert only
+    /// that area to RGBA. Returns whether anything was drawn.
+    fn draw(&self) -> bool {
         let width = self.size.w as u32;
         let height = self.size.h as u32;
 
         // Track if we actually drew
         let drew = std::cell::Cell::new(false);
 
-        // ALWAYS force a redraw for debugging - bypass draw_if_needed check
-        // This ensures we render every frame regardless of Slint's "needs redraw" state
-        self.window.request_redraw();
-
         // Use draw_if_needed which renders if the window needs repainting
         self.window.draw_if_needed(|renderer| {
             drew.set(true);
 
-            // Create a SharedPixelBuffer for rendering (RGB888)
-            let mut buffer = SharedPixelBuffer::<Rgb8Pixel>::new(width, height);
-
-            // Render to the buffer
-            renderer.render(buffer.make_mut_slice(), width as usize);
+            // Render to the persistent buffer; Slint returns what it repainted
+            let mut rgb_buffer = self.rgb_buffer.borrow_mut();
+            let region = renderer.render(rgb_buffer.make_mut_slice(), width as usize);
+            let origin = region.bounding_box_origin();
+            let size = region.bounding_box_size();
+            let x0 = (origin.x.max(0) as u32).min(width);
+            let y0 = (origin.y.max(0) as u32).min(height);
+            let x1 = (x0 + size.width).min(width);
+            let y1 = (y0 + size.height).min(height);
+            if x1 <= x0 || y1 <= y0 {
+                return;
+            }
 
             // Convert RGB888 to RGBA8888 with chroma key for transparency
             // The shell uses #FF00FF (magenta) as the chroma key color for "app" view
-            let rgb_data = buffer.as_bytes();
+            let rgb_data = rgb_buffer.as_bytes();
             let mut pixel_buffer = self.pixel_buffer.borrow_mut();
 
             // Ensure buffer is correct size (RGBA = 4 bytes per pixel)
@@ -938,31 +1117,36 @@ impl SlintShell {
                 pixel_buffer.resize(expected_size, 0);
             }
 
-            // Convert RGB to RGBA with chroma key transparency
             // Magenta (#FF00FF) becomes transparent, everything else is opaque
-            for (i, chunk) in rgb_data.chunks(3).enumerate() {
-                if chunk.len() == 3 {
-                    let offset = i * 4;
-                    if offset + 3 < pixel_buffer.len() {
-                        let r = chunk[0];
-                        let g = chunk[1];
-                        let b = chunk[2];
-                        pixel_buffer[offset] = r;
-                        pixel_buffer[offset + 1] = g;
-                        pixel_buffer[offset + 2] = b;
-                        // Chroma key: magenta (#FF00FF) becomes transparent
-                        if r == 255 && g == 0 && b == 255 {
-                            pixel_buffer[offset + 3] = 0; // Transparent
-                        } else {
-                            pixel_buffer[offset + 3] = 255; // Opaque
-                        }
-                    }
+            for y in y0..y1 {
+                let row = (y * width) as usize;
+                for i in row + x0 as usize..row + x1 as usize {
+                    let (r, g, b) = (rgb_data[i * 3], rgb_data[i * 3 + 1], rgb_data[i * 3 + 2]);
+                    let a = if r == 255 && g == 0 && b == 255 { 0 } else { 255 };
+                    pixel_buffer[i * 4..i * 4 + 4].copy_from_slice(&[r, g, b, a]);
                 }
             }
+            let damage = union_rect(self.keyboard_damage.get(), (x0, y0, x1 - x0, y1 - y0));
+            self.keyboard_damage.set(Some(damage));
         });
+        drew.get()
+    }
+
+    /// Render the Slint UI and return the pixel buffer
+    /// Returns (width, height, RGBA pixel data)
+    pub fn render(&self) -> Option<(u32, u32, Vec<u8>)> {
+        let width = self.size.w as u32;
+        let height = self.size.h as u32;
+
+        // A full-screen frame shows the keyboard where it actually is
+        set_if_changed!(self.shell, get_keyboard_y_offset, set_keyboard_y_offset, self.keyboard_y_offset.get());
+
+        // ALWAYS force a redraw for debugging - bypass draw_if_needed check
+        // (with the reused buffer an undamaged frame repaints nothing)
+        self.window.request_redraw();
 
         // Log if we drew or not
-        if drew.get() {
+        if self.draw() {
             // Sample some pixels to verify content
             let buffer = self.pixel_buffer.borrow();
             let center = (width * height * 2) as usize; // Middle of buffer
@@ -981,6 +1165,41 @@ impl SlintShell {
         Some((width, height, buffer.clone()))
     }
 
+    /// Size of the keyboard layer: full width, keyboard height as in shell.slint
+    pub fn keyboard_layer_size(&self) -> (u32, u32) {
+        let height = (self.size.h as f32 * 0.32).max(280.0).ceil() as u32;
+        (self.size.w as u32, height.min(self.size.h as u32))
+    }
+
+    /// Render the on-screen keyboard as a layer the compositor keeps in a texture
+    ///
+    /// Slint holds the keyboard at rest and repaints only what changed (a
+    /// pressed key, the prediction bar, a new layout or shift state), so a
+    /// keystroke hands back a key-sized rectangle instead of a screen. The
+    /// slide offset is returned for the compositor to apply. `full` asks for
+    /// the whole layer, for when the compositor has no texture yet.
+    pub fn render_keyboard_layer(&self, full: bool) -> KeyboardLayerFrame {
+        set_if_changed!(self.shell, get_keyboard_y_offset, set_keyboard_y_offset, 0.0);
+        self.draw();
+
+        let (width, height) = self.keyboard_layer_size();
+        let top = self.size.h as u32 - height;
+        let band = (0, top, width, height);
+        let damage = self.keyboard_damage.take();
+        let rect = if full { Some(band) } else { damage.and_then(|d| intersect_rect(d, band)) };
+        let damage = rect.map(|(x, y, w, h)| {
+            let buffer = self.pixel_buffer.borrow();
+            let mut pixels = Vec::with_capacity((w * h * 4) as usize);
+            for row in y..y + h {
+                let start = ((row * width + x) * 4) as usize;
+                pixels.extend_from_slice(&buffer[start..start + (w * 4) as usize]);
+            }
+            LayerDamage { x, y: y - top, width: w, height: h, pixels }
+        });
+
+        KeyboardLayerFrame { width, height, top, offset: self.keyboard_y_offset.get(), damage }
+    }
+
     /// Request a redraw
     pub fn request_redraw(&self) {
         self.window.request_redraw();
@@ -1256,7 +1475,7 @@ impl SlintShell {
         self.shell.set_keyboard_visible(visible);
         // Reset y-offset when hiding
         if !visible {
-            self.shell.set_keyboard_y_offset(0.0);
+            self.keyboard_y_offset.set(0.0);
         }
     }
 
@@ -1266,8 +1485,9 @@ impl SlintShell {
     }
 
     /// Set keyboard y-offset for swipe-to-dismiss animation
+    /// (applied by the compositor to the keyboard layer, see render_keyboard_layer)
     pub fn set_keyboard_y_offset(&self, offset: f32) {
-        self.shell.set_keyboard_y_offset(offset);
+        self.keyboard_y_offset.set(offset);
     }
 
     /// Set keyboard shift state
@@ -1461,9 +1681,16 @@ struct FlickPlatform {
     window: Rc<MinimalSoftwareWindow>,
 }
 
+thread_local! {
+    /// Window for the next component created, set by `SlintShell::offscreen`;
+    /// every other component gets the live window
+    static NEXT_WINDOW: RefCell<Option<Rc<MinimalSoftwareWindow>>> = RefCell::new(None);
+}
+
 impl Platform for FlickPlatform {
     fn create_window_adapter(&self) -> Result<Rc<dyn WindowAdapter>, slint::PlatformError> {
-        Ok(self.window.clone())
+        let window = NEXT_WINDOW.with(|next| next.borrow_mut().take()).unwrap_or_else(|| self.window.clone());
+        Ok(window)
     }
 
     fn duration_since_start(&self) -> std::time::Duration {
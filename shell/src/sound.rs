@@ -0,0 +1,257 @@
+//! In-compositor system sounds: notifications, ringtone and key clicks
+//!
+//! Playing a sound used to fork `sudo -u <user> paplay` (or `aplay`), paying
+//! for a process, sudo, a file decode and a new stream on every sound. Here
+//! sounds are decoded once into mono f32 and mixed on an audio thread into a
+//! single long-lived playback stream, so a sound starts with the next block.
+//! The ringtone is a looping voice that plays until stopped.
+//!
+//! Decoding, mixing, pacing and the stream pipe are flick-audio-engine's,
+//! linked as a library. The stream is a `pacat` child run as the session's
+//! audio user (the shell runs as root), with `aplay` as a fallback. It is
+//! closed after IDLE without sound so the sink can suspend, and reopened
+//! with a little silent pre-roll by the next sound or `warm()`.
+//!
+//! Sound files are decoded on a loader thread, never on the compositor
+//! thread: a sound that is not cached yet plays once the loader has it.
+
+use std::collections::HashMap;
+use std::process::Command;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::mpsc::{self, Sender};
+use std::sync::{Arc, Mutex};
+use std::thread;
+use std::time::Duration;
+
+use flick_audio_engine::engine::Engine;
+use flick_audio_engine::mixer::Command as SoundCommand;
+pub use flick_audio_engine::output::Sink;
+use flick_audio_engine::synth::{decode_wav, Sample};
+
+/// Mixing and stream rate
+const RATE: u32 = 48000;
+/// Stream buffer requested from the sound server
+const LATENCY_MS: u32 = 10;
+/// Voices mixed at once; the one-shot closest to finishing is stolen beyond this
+const MAX_VOICES: usize = 8;
+/// Headroom so a few overlapping full-scale sounds don't hard-clip
+const MASTER_GAIN: f32 = 0.7;
+/// Close the stream after this long without sound
+const IDLE: Duration = Duration::from_secs(3);
+/// Name the synthesized key click is cached under
+const KEY_CLICK: &str = "<key-click>";
+
+/// Decoded sounds by file name
+type SoundCache = Arc<Mutex<HashMap<String, Arc<Sample>>>>;
+
+/// Requests to the loader thread
+enum Load {
+    Preload(String),
+    /// Play once decoded; a loop is dropped if `stop_looping` ran meanwhile
+    Play { name: String, gain: f32, looping: bool, generation: usize },
+}
+
+/// Stream for the shell's sounds: pacat as the audio user, or aplay
+pub fn stream_sink() -> Sink {
+    Sink::stream(stream_commands)
+}
+
+fn stream_commands() -> Vec<Command> {
+    let pacat_args = [
+        "--playback".to_string(),
+        "--raw".to_string(),
+        "--format=s16le".to_string(),
+        "--channels=1".to_string(),
+        format!("--rate={}", RATE),
+        format!("--latency-msec={}", LATENCY_MS),
+        "--client-name=flick".to_string(),
+        "--stream-name=Flick system sounds".to_string(),
+    ];
+    let pacat = match crate::system::SoundConfig::get_audio_user() {
+        // The shell runs as root; the sound server belongs to the session user
+        Some((uid, _)) if unsafe { libc::geteuid() } == 0 => {
+            let mut cmd = Command::new("sudo");
+            cmd.args(["-u", &format!("#{}", uid), "env", &format!("XDG_RUNTIME_DIR=/run/user/{}", uid), "pacat"])
+                .args(&pacat_args);
+            cmd
+        }
+        _ => {
+            let mut cmd = Command::new("pacat");
+            cmd.args(&pacat_args);
+            cmd
+        }
+    };
+    let mut aplay = Command::new("aplay");
+    aplay.args(["-q", "-t", "raw", "-f", "S16_LE", "-c", "1", "-r", &RATE.to_string()]);
+    vec![pacat, aplay]
+}
+
+/// Handle to the audio thread, the loader thread and the decoded sound cache
+pub struct SoundService {
+    engine: Arc<Engine>,
+    loads: Sender<Load>,
+    sounds: SoundCache,
+    /// Bumped by `stop_looping`, so a ringtone still being decoded is not
+    /// started after it was stopped
+    loop_generation: Arc<AtomicUsize>,
+}
+
+impl SoundService {
+    /// Start the audio thread on `sink` and decode `preload` in the background
+    pub fn start(sink: Sink, preload: Vec<String>) -> Self {
+        let engine = Arc::new(Engine::start(sink, RATE, MAX_VOICES, MASTER_GAIN, Some(IDLE)));
+        let sounds: SoundCache = Arc::new(Mutex::new(HashMap::new()));
+        sounds.lock().unwrap().insert(KEY_CLICK.to_string(), Sample::new(key_click()));
+        let loop_generation = Arc::new(AtomicUsize::new(0));
+
+        let (loads, rx) = mpsc::channel();
+        for name in preload {
+            let _ = loads.send(Load::Preload(name));
+        }
+        let (cache, thread_engine, generation) = (sounds.clone(), engine.clone(), loop_generation.clone());
+        let spawned = thread::Builder::new().name("flick-sound-load".into()).spawn(move || {
+            for load in rx {
+                match load {
+                    Load::Preload(name) => {
+                        cached_or_load(&cache, &name);
+                    }
+                    Load::Play { name, gain, looping, generation: requested } => {
+                        let Some(sample) = cached_or_load(&cache, &name) else { continue };
+                        if looping && generation.load(Ordering::SeqCst) != requested {
+                            continue;
+                        }
+                        start(&thread_engine, sample, gain, looping);
+                    }
+                }
+            }
+        });
+        if let Err(e) = spawned {
+            tracing::warn!("Sound: cannot start loader thread: {}", e);
+        }
+        Self { engine, loads, sounds, loop_generation }
+    }
+
+    /// Play now if decoded, otherwise once the loader has decoded it
+    fn request(&self, name: &str, gain: f32, looping: bool) {
+        let cached = self.sounds.lock().ok().and_then(|sounds| sounds.get(name).cloned());
+        match cached {
+            Some(sample) => start(&self.engine, sample, gain, looping),
+            None => {
+                let generation = self.loop_generation.load(Ordering::SeqCst);
+                let _ = self.loads.send(Load::Play { name: name.to_string(), gain, looping, generation });
+            }
+        }
+    }
+
+    /// Play a sound file once, overlapping whatever is playing
+    pub fn play(&self, name: &str) {
+        self.request(name, 1.0, false);
+    }
+
+    /// Loop a sound until `stop_looping` (the ringtone)
+    pub fn play_looping(&self, name: &str) {
+        self.request(name, 1.0, true);
+    }
+
+    pub fn stop_looping(&self) {
+        self.loop_generation.fetch_add(1, Ordering::SeqCst);
+        self.engine.send(SoundCommand::StopLooping);
+    }
+
+    /// Short synthesized click for keyboard feedback
+    pub fn key_click(&self) {
+        self.request(KEY_CLICK, 0.4, false);
+    }
+
+    /// Open the stream ahead of a likely sound (no-op while it is open)
+    pub fn warm(&self) {
+        if !self.engine.stats.streaming.load(Ordering::Relaxed) {
+            self.engine.send(SoundCommand::Warm);
+        }
+    }
+}
+
+/// Hand a decoded sound to the mixer; a loop replaces the current one
+fn start(engine: &Engine, sample: Arc<Sample>, gain: f32, looping: bool) {
+    if looping {
+        engine.send(SoundCommand::StopLooping);
+        engine.send(SoundCommand::Loop { sample, gain });
+    } else {
+        engine.send(SoundCommand::Play { sample, gain });
+    }
+}
+
+/// Decoded sound from the cache, decoding and caching it on a miss
+fn cached_or_load(cache: &SoundCache, name: &str) -> Option<Arc<Sample>> {
+    if let Some(sample) = cache.lock().ok()?.get(name) {
+        return Some(sample.clone());
+    }
+    let sample = load(name)?;
+    cache.lock().ok()?.insert(name.to_string(), sample.clone());
+    Some(sample)
+}
+
+/// Find and decode a sound file from the Flick sound directories
+fn load(name: &str) -> Option<Arc<Sample>> {
+    let Some(path) = crate::system::SoundConfig::get_sound_path(name) else {
+        tracing::warn!("Sound file not found: {}", name);
+        return None;
+    };
+    match std::fs::read(&path).map_err(|e| e.to_string()).and_then(|bytes| decode_wav(&bytes, RATE)) {
+        Ok(frames) => Some(Sample::new(frames)),
+        Err(e) => {
+            tracing::warn!("Sound: cannot decode {:?}: {}", path, e);
+            None
+        }
+    }
+}
+
+/// 10ms 2kHz blip with a fast decay, loud enough to hear over the haptic
+fn key_click() -> Vec<f32> {
+    let len = (RATE / 100) as usize;
+    (0..len)
+        .map(|i| {
+            let t = i as f32 / RATE as f32;
+            let envelope = (1.0 - i as f32 / len as f32).powi(3);
+            (t * 2000.0 * std::f32::consts::TAU).sin() * envelope
+        })
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_null_sink_service() {
+        let service = SoundService::start(Sink::Null, Vec::new());
+        let stats = service.engine.stats.clone();
+        service.key_click();
+        thread::sleep(Duration::from_millis(100));
+        assert!(stats.streaming.load(Ordering::Relaxed));
+        assert!(stats.blocks.load(Ordering::Relaxed) > 5);
+        // A 10ms click is long gone
+        assert_eq!(stats.active_voices.load(Ordering::Relaxed), 0);
+
+        service.sounds.lock().unwrap().insert("ring.wav".into(), Sample::new(vec![0.1; 480]));
+        service.play_looping("ring.wav");
+        thread::sleep(Duration::from_millis(100));
+        assert_eq!(stats.active_voices.load(Ordering::Relaxed), 1);
+        service.stop_looping();
+        thread::sleep(Duration::from_millis(50));
+        assert_eq!(stats.active_voices.load(Ordering::Relaxed), 0);
+    }
+
+    #[test]
+    fn test_stopped_loop_is_not_started_by_the_loader() {
+        let service = SoundService::start(Sink::Null, Vec::new());
+        let stats = service.engine.stats.clone();
+        // As if the ringtone were still being decoded when the call ended
+        let generation = service.loop_generation.load(Ordering::SeqCst);
+        service.stop_looping();
+        service.sounds.lock().unwrap().insert("ring.wav".into(), Sample::new(vec![0.1; 480]));
+        let _ = service.loads.send(Load::Play { name: "ring.wav".into(), gain: 1.0, looping: true, generation });
+        thread::sleep(Duration::from_millis(100));
+        assert_eq!(stats.active_voices.load(Ordering::Relaxed), 0);
+    }
+}
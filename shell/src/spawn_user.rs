@@ -8,6 +8,15 @@ use std::fs::{self, OpenOptions};
 use std::os::unix::process::CommandExt;
 use std::process::{Command, Stdio};
 
+/// Give a launched app its own cgroup and OOM priority. Every spawn path
+/// goes through here, so none can leave an app unmanaged. Must be called
+/// before the privilege-dropping `pre_exec`, which takes away the rights
+/// both need.
+fn attach_app(command: &mut Command, app_id: &str, cmd: &str) {
+    crate::app_cgroups::attach_command(command, app_id, cmd);
+    crate::memory_pressure::set_app_oom_score(command);
+}
+
 /// Get the target user for running apps
 /// Priority: FLICK_USER > SUDO_USER > "droidian" fallback
 pub fn get_target_user() -> Option<String> {
@@ -41,6 +50,26 @@ pub fn should_drop_privileges() -> bool {
     unsafe { libc::getuid() == 0 }
 }
 
+/// Hand a Wayland socket to the real user so apps running as that user can
+/// connect (the compositor runs as root)
+pub fn share_socket_with_user(socket_path: &std::path::Path) {
+    let Some(username) = get_target_user() else { return };
+    let Some((uid, gid, _home)) = get_user_info(&username) else { return };
+    let Ok(path_cstr) = CString::new(socket_path.to_string_lossy().as_bytes()) else { return };
+    unsafe {
+        // chown the socket to the real user
+        if libc::chown(path_cstr.as_ptr(), uid, gid) == 0 {
+            tracing::info!("Changed socket ownership to {}:{} ({})", uid, gid, username);
+        } else {
+            tracing::warn!("Failed to chown socket: {}", std::io::Error::last_os_error());
+        }
+        // Also chmod to allow group access
+        if libc::chmod(path_cstr.as_ptr(), 0o770) == 0 {
+            tracing::info!("Set socket permissions to 0770");
+        }
+    }
+}
+
 /// Get user info (uid, gid, home) for a username
 pub fn get_user_info(username: &str) -> Option<(u32, u32, String)> {
     let c_username = CString::new(username).ok()?;
@@ -99,6 +128,9 @@ pub fn spawn_as_user(cmd: &str, socket_name: &str, text_scale: f64) -> Result<()
         command.env("XDG_RUNTIME_DIR", xdg_runtime);
     }
 
+    // Must precede the privilege drop
+    attach_app(&mut command, &crate::app_cgroups::group_name_for_exec(cmd), cmd);
+
     // If running as root, set up privilege dropping
     if should_drop_privileges() {
         if let Some(username) = get_target_user() {
@@ -231,6 +263,30 @@ pub fn spawn_app_with_logging(
     socket_name: &str,
     text_scale: f64,
 ) -> Result<(), String> {
+    spawn_logged(cmd, app_id, socket_name, text_scale, true)
+}
+
+/// Spawn a hidden prelaunch like `spawn_app_with_logging`, without
+/// prefetching its files ahead of it
+pub fn prelaunch_app_with_logging(
+    cmd: &str,
+    app_id: &str,
+    socket_name: &str,
+    text_scale: f64,
+) -> Result<(), String> {
+    spawn_logged(cmd, app_id, socket_name, text_scale, false)
+}
+
+fn spawn_logged(
+    cmd: &str,
+    app_id: &str,
+    socket_name: &str,
+    text_scale: f64,
+    prefetch: bool,
+) -> Result<(), String> {
+    // Start reading the app's files in before the fork (see launch_prefetch)
+    crate::launch_prefetch::on_launch(app_id, prefetch);
+
     let qt_scale = format!("{}", text_scale);
     let gdk_scale = format!("{}", text_scale.round() as i32);
 
@@ -261,6 +317,9 @@ pub fn spawn_app_with_logging(
     // Set app ID for logging context
     command.env("FLICK_APP_ID", app_id);
 
+    // Must precede the privilege drop
+    attach_app(&mut command, app_id, cmd);
+
     // If running as root, set up privilege dropping and logging
     if should_drop_privileges() {
         if let Some(username) = get_target_user() {
@@ -386,6 +445,9 @@ pub fn spawn_as_user_hwcomposer(cmd: &str, socket_name: &str, text_scale: f64) -
         command.env("XDG_RUNTIME_DIR", xdg_runtime);
     }
 
+    // Must precede the privilege drop
+    attach_app(&mut command, &crate::app_cgroups::group_name_for_exec(cmd), cmd);
+
     // If running as root, set up privilege dropping
     if should_drop_privileges() {
         if let Some(username) = get_target_user() {
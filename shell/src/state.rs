@@ -87,6 +87,9 @@ pub struct SurfaceBufferData {
     pub wl_buffer_ptr: Option<*mut std::ffi::c_void>,
     /// The actual WlBuffer for releasing after import
     pub pending_buffer: Option<wl_buffer::WlBuffer>,
+    /// Bumped whenever `buffer` or `egl_texture` gets new content, so
+    /// readers like the switcher previews can tell when to copy it again
+    pub content_serial: u64,
 }
 
 use crate::input::{GestureRecognizer, GestureAction};
@@ -115,6 +118,10 @@ impl ClientData for ClientState {
 pub struct Flick {
     pub start_time: Instant,
     pub socket_name: OsString,
+    /// Listening socket handed over by a supervisor (polled in dispatch_clients)
+    inherited_socket: Option<std::os::unix::net::UnixListener>,
+    /// Link to the supervisor process when running under `--supervise`
+    pub supervised: Option<crate::supervisor::Supervised>,
     pub display_handle: DisplayHandle,
     pub display: Rc<RefCell<Display<Self>>>,
     pub clock: Clock<Monotonic>,
@@ -134,6 +141,9 @@ pub struct Flick {
 
     // Desktop
     pub space: Space<Window>,
+    /// Bumped when windows are mapped, unmapped, moved, restacked or retitled
+    /// (see `scene_changed`); renderers rebuild their render list when it moves
+    pub scene_serial: u64,
     pub popup_manager: PopupManager,
 
     // Outputs
@@ -247,6 +257,17 @@ pub struct Flick {
     // System status (hardware integration)
     pub system: SystemStatus,
 
+    // Per-app cgroups (background app freezer)
+    pub app_cgroups: crate::app_cgroups::AppCgroups,
+    // PSI memory pressure monitor (trims / kills background apps)
+    pub memory_pressure: crate::memory_pressure::MemoryPressure,
+    // Accelerometer claim and committed orientation
+    pub auto_rotation: crate::orientation::AutoRotation,
+    // App id resolved for the last foreground pid (see foreground_app_id)
+    pub foreground_app: Option<(u32, Option<String>)>,
+    // Apps started hidden on a prediction from flick-app-service
+    pub prelaunch: crate::prelaunch::Prelaunch,
+
     // Power button hold tracking (for emergency restart)
     pub power_button_pressed_at: Option<Instant>,
     // Last vibration time for power button hold feedback
@@ -291,53 +312,45 @@ impl Flick {
         // Add touch
         seat.add_touch();
 
-        // Create the Wayland socket
-        let socket = ListeningSocketSource::new_auto().expect("Failed to create socket");
-        let socket_name = socket.socket_name().to_os_string();
+        // Create the Wayland socket, or take over the one a supervisor holds
+        // across restarts (see supervisor)
+        let (socket_name, inherited_socket, supervised) = match crate::supervisor::handover() {
+            Some((listener, name, supervised)) => (name, Some(listener), Some(supervised)),
+            None => {
+                let socket = ListeningSocketSource::new_auto().expect("Failed to create socket");
+                let socket_name = socket.socket_name().to_os_string();
+
+                // Fix socket permissions so apps running as user can connect
+                // This is needed when the compositor runs as root but apps run as a normal user
+                if let Ok(runtime_dir) = std::env::var("XDG_RUNTIME_DIR") {
+                    crate::spawn_user::share_socket_with_user(&std::path::Path::new(&runtime_dir).join(&socket_name));
+                }
 
-        // Fix socket permissions so apps running as user can connect
-        // This is needed when the compositor runs as root but apps run as a normal user
-        if let Ok(runtime_dir) = std::env::var("XDG_RUNTIME_DIR") {
-            let socket_path = std::path::Path::new(&runtime_dir).join(&socket_name);
-            if let Some(username) = crate::spawn_user::get_target_user() {
-                if let Some((uid, gid, _home)) = crate::spawn_user::get_user_info(&username) {
-                    // chown the socket to the real user
-                    unsafe {
-                        let path_cstr = std::ffi::CString::new(socket_path.to_string_lossy().as_bytes())
-                            .expect("Invalid socket path");
-                        if libc::chown(path_cstr.as_ptr(), uid, gid) == 0 {
-                            tracing::info!("Changed socket ownership to {}:{} ({})", uid, gid, username);
+                loop_handle
+                    .insert_source(socket, move |client, _, state| {
+                        tracing::info!("New Wayland client connected!");
+                        if let Err(err) = state
+                            .display_handle
+                            .insert_client(client, Arc::new(ClientState::default()))
+                        {
+                            tracing::error!("Error inserting client: {}", err);
                         } else {
-                            tracing::warn!("Failed to chown socket: {}", std::io::Error::last_os_error());
+                            tracing::info!("Client successfully added");
                         }
-                        // Also chmod to allow group access
-                        if libc::chmod(path_cstr.as_ptr(), 0o770) == 0 {
-                            tracing::info!("Set socket permissions to 0770");
-                        }
-                    }
-                }
-            }
-        }
+                    })
+                    .expect("Failed to insert socket source");
 
-        loop_handle
-            .insert_source(socket, move |client, _, state| {
-                tracing::info!("New Wayland client connected!");
-                if let Err(err) = state
-                    .display_handle
-                    .insert_client(client, Arc::new(ClientState::default()))
-                {
-                    tracing::error!("Error inserting client: {}", err);
-                } else {
-                    tracing::info!("Client successfully added");
-                }
-            })
-            .expect("Failed to insert socket source");
+                (socket_name, None, None)
+            }
+        };
 
         tracing::info!("Wayland socket: {:?}", socket_name);
 
         Self {
             start_time,
             socket_name,
+            inherited_socket,
+            supervised,
             display_handle,
             display,
             clock,
@@ -353,6 +366,7 @@ impl Flick {
             seat_state,
             seat,
             space: Space::default(),
+            scene_serial: 0,
             popup_manager: PopupManager::default(),
             outputs: Vec::new(),
             viewports: HashMap::new(),
@@ -410,6 +424,11 @@ impl Flick {
             active_window: None,
             shell: Shell::new(screen_size),
             system: SystemStatus::new(),
+            app_cgroups: crate::app_cgroups::AppCgroups::new(),
+            memory_pressure: crate::memory_pressure::MemoryPressure::new(),
+            auto_rotation: crate::orientation::AutoRotation::new(),
+            foreground_app: None,
+            prelaunch: crate::prelaunch::Prelaunch::new(),
             power_button_pressed_at: None,
             power_button_last_vibe: None,
         }
@@ -441,6 +460,11 @@ impl Flick {
         }
     }
 
+    /// Record a change to the window stack (map, unmap, move, raise, title)
+    pub fn scene_changed(&mut self) {
+        self.scene_serial = self.scene_serial.wrapping_add(1);
+    }
+
     /// Handle a completed gesture action - manage windows and notify shell
     pub fn handle_gesture_complete(&mut self, action: &GestureAction) {
         // Handle window management based on gesture
@@ -472,6 +496,7 @@ impl Flick {
             // Raise to top by re-mapping with activate=true
             let loc = self.space.element_location(&window).unwrap_or_default();
             self.space.map_element(window.clone(), loc, true);
+            self.scene_changed();
             tracing::info!("Shell brought to front");
 
             // Set keyboard focus to shell
@@ -503,6 +528,7 @@ impl Flick {
                 toplevel.send_close();
             }
             self.space.unmap_elem(&window);
+            self.scene_changed();
 
             // Bring shell to front after closing
             self.bring_shell_to_front();
@@ -540,6 +566,7 @@ impl Flick {
             // Move the window in the space
             if let Some(loc) = self.space.element_location(window) {
                 self.space.map_element(window.clone(), (loc.x, new_y), false);
+                self.scene_changed();
             }
         }
     }
@@ -560,6 +587,7 @@ impl Flick {
                     toplevel.send_close();
                 }
                 self.space.unmap_elem(&window);
+                self.scene_changed();
 
                 // If no more app windows (excluding QML home), go to home screen
                 let has_app_windows = self.space.elements().any(|w| {
@@ -588,6 +616,7 @@ impl Flick {
                 tracing::info!("Close gesture cancelled - restoring position");
                 if let Some(loc) = self.space.element_location(&window) {
                     self.space.map_element(window, (loc.x, self.close_gesture_original_y), false);
+                    self.scene_changed();
                 }
             }
         }
@@ -760,6 +789,7 @@ impl Flick {
             // Move the window in the space
             if let Some(loc) = self.space.element_location(window) {
                 self.space.map_element(window.clone(), (loc.x, new_y), false);
+                self.scene_changed();
             }
         }
     }
@@ -804,6 +834,7 @@ impl Flick {
                 // Restore window to original position (it will be hidden anyway)
                 if let Some(loc) = self.space.element_location(&window) {
                     self.space.map_element(window, (loc.x, self.home_gesture_original_y), false);
+                    self.scene_changed();
                 }
             } else if actual_offset > 20 {
                 // Released within keyboard/buffer zone with some movement - snap keyboard into place
@@ -821,6 +852,7 @@ impl Flick {
                 // Restore window position
                 if let Some(loc) = self.space.element_location(&window) {
                     self.space.map_element(window.clone(), (loc.x, self.home_gesture_original_y), false);
+                    self.scene_changed();
                 }
 
                 // Resize windows for keyboard (this ensures proper layout)
@@ -838,6 +870,7 @@ impl Flick {
                 // Restore window position
                 if let Some(loc) = self.space.element_location(&window) {
                     self.space.map_element(window, (loc.x, self.home_gesture_original_y), false);
+                    self.scene_changed();
                 }
 
                 // Hide keyboard since gesture was cancelled
@@ -890,6 +923,7 @@ impl Flick {
                 // Restore window to original position
                 if let Some(loc) = self.space.element_location(&window) {
                     self.space.map_element(window, (loc.x, self.home_gesture_original_y), false);
+                    self.scene_changed();
                 }
             } else if actual_offset > 20 {
                 // Released within keyboard/buffer zone with some movement - snap keyboard into place
@@ -907,6 +941,7 @@ impl Flick {
                 // Restore window position
                 if let Some(loc) = self.space.element_location(&window) {
                     self.space.map_element(window.clone(), (loc.x, self.home_gesture_original_y), false);
+                    self.scene_changed();
                 }
 
                 // Resize windows for keyboard (this ensures proper layout)
@@ -924,6 +959,7 @@ impl Flick {
                 // Restore window position
                 if let Some(loc) = self.space.element_location(&window) {
                     self.space.map_element(window, (loc.x, self.home_gesture_original_y), false);
+                    self.scene_changed();
                 }
 
                 // Hide keyboard since gesture was cancelled
@@ -1140,6 +1176,7 @@ impl Flick {
             // Raise window to top
             let loc = self.space.element_location(&window).unwrap_or_default();
             self.space.map_element(window.clone(), loc, true);
+            self.scene_changed();
 
             // Set keyboard focus
             if let Some(x11) = window.x11_surface() {
@@ -1180,6 +1217,7 @@ impl Flick {
             // Raise to top
             let loc = self.space.element_location(&window).unwrap_or_default();
             self.space.map_element(window.clone(), loc, true);
+            self.scene_changed();
             tracing::info!("Focused window ID: {}", window_id);
 
             // Set keyboard focus
@@ -1194,9 +1232,466 @@ impl Flick {
         }
     }
 
+    /// Configure a toplevel fullscreen on our output; activated unless it
+    /// is a hidden prelaunched app
+    fn configure_fullscreen(&self, surface: &ToplevelSurface, activated: bool) {
+        if let Some(output) = self.outputs.first() {
+            let output_size = output
+                .current_mode()
+                .map(|m| m.size)
+                .unwrap_or((720, 1440).into());
+
+            surface.with_pending_state(|state| {
+                state.size = Some(output_size.to_logical(1));
+                // Set fullscreen and activated states - this tells the client
+                // not to draw decorations (title bar, borders)
+                state.states.set(xdg_toplevel::State::Fullscreen);
+                if activated {
+                    state.states.set(xdg_toplevel::State::Activated);
+                } else {
+                    state.states.unset(xdg_toplevel::State::Activated);
+                }
+            });
+        }
+
+        surface.send_configure();
+    }
+
+    /// Map a new (or prelaunched) app window on top, activate and focus it
+    fn map_app_window(&mut self, window: Window) {
+        let Some(surface) = window.toplevel().cloned() else { return };
+
+        // Cancel any ongoing touch sequences on existing windows
+        // This is critical - without this, the old app might still receive touch events
+        if let Some(touch) = self.seat.get_touch() {
+            touch.cancel(self);
+            tracing::info!("Cancelled touch sequences for existing windows");
+        }
+
+        // DEACTIVATE all existing windows first
+        for existing_window in self.space.elements() {
+            if let Some(toplevel) = existing_window.toplevel() {
+                toplevel.with_pending_state(|state| {
+                    state.states.unset(xdg_toplevel::State::Activated);
+                });
+                toplevel.send_configure();
+                tracing::info!("Deactivated existing window: {:?}", toplevel.wl_surface().id());
+            }
+        }
+
+        self.configure_fullscreen(&surface, true);
+
+        // Add to space at origin and raise to top (activate=true)
+        self.space.map_element(window.clone(), (0, 0), true);
+        self.scene_changed();
+
+        // Track this as the active window for touch input
+        let surface_id = surface.wl_surface().id();
+        self.active_window = Some(window);
+        tracing::info!("Active window set to new toplevel: {:?}", surface_id);
+
+        // Switch to App view now that we have a real window
+        // UNLESS we're on the lock screen, home screen with QML home, OR we recently unlocked
+        let current_view = self.shell.view;
+        if current_view == crate::shell::ShellView::LockScreen {
+            tracing::info!("New window on lock screen - staying in LockScreen view");
+        } else if current_view == crate::shell::ShellView::Home && self.shell.qml_home_launched {
+            // QML home window - stay on Home view, don't switch to App
+            tracing::info!("New window on home screen with QML home - staying in Home view");
+        } else if self.shell.unlock_app_launched {
+            // App was launched from notification tap - switch to App view
+            tracing::info!("New window from notification app launch - switching to App view");
+            self.shell.unlock_app_launched = false; // Reset flag
+            self.shell.set_view(crate::shell::ShellView::App);
+        } else if self.shell.is_recently_unlocked() {
+            tracing::info!("New window right after unlock - ignoring (likely dying lock app)");
+        } else {
+            self.shell.set_view(crate::shell::ShellView::App);
+            tracing::info!("Switched to App view for new window");
+        }
+
+        // Set keyboard focus to this window
+        let wl_surface = surface.wl_surface().clone();
+        let client_info = wl_surface.client().map(|c| format!("{:?}", c.id())).unwrap_or_else(|| "no-client".to_string());
+        tracing::info!("new_toplevel: Setting keyboard focus to {:?} (client: {})", wl_surface.id(), client_info);
+        let serial = smithay::utils::SERIAL_COUNTER.next_serial();
+        if let Some(keyboard) = self.seat.get_keyboard() {
+            keyboard.set_focus(self, Some(wl_surface), serial);
+            tracing::info!("Keyboard focus set to new toplevel");
+        }
+    }
+
+    /// Pid of the process owning a window (Wayland client or X11 _NET_WM_PID)
+    pub fn window_pid(&self, window: &Window) -> Option<u32> {
+        if let Some(x11) = window.x11_surface() {
+            return x11.pid();
+        }
+        let surface = window.toplevel()?.wl_surface();
+        let client = self.display_handle.get_client(surface.id()).ok()?;
+        client.get_credentials(&self.display_handle).ok().map(|c| c.pid as u32)
+    }
+
+    /// Window holding keyboard focus, else the last active one
+    pub fn foreground_window(&self) -> Option<Window> {
+        self.seat.get_keyboard()
+            .and_then(|kb| kb.current_focus())
+            .and_then(|surface| self.space.elements()
+                .find(|w| w.wl_surface().as_deref() == Some(&surface))
+                .cloned())
+            .or_else(|| self.active_window.clone())
+    }
+
+    /// Installed app the foreground window belongs to. A Wayland app_id or
+    /// X11 class naming an app wins; otherwise the FLICK_APP_ID every launch
+    /// is spawned with is read from the window's process, once per pid.
+    fn foreground_app_id(&mut self) -> Option<String> {
+        let window = self.foreground_window()?;
+        let class = match window.x11_surface() {
+            Some(x11) => Some(x11.class()),
+            None => window.toplevel().and_then(|toplevel| {
+                smithay::wayland::compositor::with_states(toplevel.wl_surface(), |states| {
+                    states
+                        .data_map
+                        .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
+                        .and_then(|data| data.lock().unwrap().app_id.clone())
+                })
+            }),
+        };
+        if let Some(id) = class.filter(|id| self.shell.app_manager.get_category_def(id).is_some()) {
+            return Some(id);
+        }
+
+        let pid = self.window_pid(&window)?;
+        match &self.foreground_app {
+            Some((cached, id)) if *cached == pid => id.clone(),
+            _ => {
+                let id = std::fs::read(format!("/proc/{}/environ", pid)).ok().and_then(|environ| {
+                    environ
+                        .split(|&b| b == 0)
+                        .find_map(|var| var.strip_prefix(b"FLICK_APP_ID="))
+                        .map(|id| String::from_utf8_lossy(id).into_owned())
+                });
+                self.foreground_app = Some((pid, id.clone()));
+                id
+            }
+        }
+    }
+
+    /// Freeze backgrounded apps / thaw visible ones (see app_cgroups)
+    /// Runs every loop iteration before frame callbacks are sent.
+    pub fn update_app_cgroups(&mut self) {
+        if !self.app_cgroups.enabled() {
+            return;
+        }
+        let view = self.shell.view;
+        // Switcher cards show live window content
+        let show_all = view == crate::shell::ShellView::Switcher
+            || self.switcher_gesture_active
+            || self.switcher_return_active;
+        let foreground = if view == crate::shell::ShellView::App {
+            self.foreground_window().and_then(|w| self.window_pid(&w))
+        } else {
+            None
+        };
+        let window_pids: Vec<u32> = self.space.elements()
+            .filter_map(|w| self.window_pid(w))
+            .collect();
+        self.app_cgroups.update(foreground, &window_pids, show_all);
+    }
+
+    /// Title shown for a window (X11 title, xdg title, then app_id)
+    pub fn window_title(window: &Window) -> String {
+        if let Some(x11) = window.x11_surface() {
+            let title = x11.title();
+            return if title.is_empty() { x11.class() } else { title };
+        }
+        window.toplevel()
+            .and_then(|toplevel| smithay::wayland::compositor::with_states(toplevel.wl_surface(), |states| {
+                states
+                    .data_map
+                    .get::<smithay::wayland::shell::xdg::XdgToplevelSurfaceData>()
+                    .and_then(|data| {
+                        let data = data.lock().unwrap();
+                        data.title.clone().filter(|t| !t.is_empty()).or(data.app_id.clone())
+                    })
+            }))
+            .unwrap_or_else(|| "App".to_string())
+    }
+
+    /// React to PSI memory pressure: trim background apps, then kill the
+    /// least recently used one (see memory_pressure)
+    pub fn handle_memory_pressure(&mut self) {
+        let app_cgroups = &mut self.app_cgroups;
+        let action = self.memory_pressure.poll(|pid, clamp| app_cgroups.adopt_service(pid, clamp));
+        match action {
+            Some(crate::memory_pressure::PressureAction::Trim) => {
+                self.app_cgroups.reclaim_background();
+            }
+            Some(crate::memory_pressure::PressureAction::Kill) => {
+                let Some(group) = self.app_cgroups.kill_candidate() else {
+                    tracing::warn!("Memory pressure: no background app left to kill");
+                    return;
+                };
+                let windows: Vec<(Window, Option<u32>)> = self.space.elements()
+                    .map(|w| (w.clone(), self.window_pid(w)))
+                    .collect();
+                let title = windows.iter()
+                    .find(|(_, pid)| pid.and_then(|pid| self.app_cgroups.group_of_pid(pid)).as_deref() == Some(group.as_str()))
+                    .map(|(w, _)| Self::window_title(w))
+                    .unwrap_or_else(|| group.clone());
+                self.app_cgroups.kill_group(&group, title);
+            }
+            None => {}
+        }
+    }
+
+    /// Claim the accelerometer while a rotatable app is in front of an
+    /// unlocked, lit screen and commit the rotations it settles on. Falls
+    /// back to portrait as soon as the policy stops holding.
+    pub fn update_auto_rotation(&mut self) {
+        let in_app = self.shell.view == crate::shell::ShellView::App;
+        let rotatable = in_app
+            && self.foreground_app_id()
+                .and_then(|id| self.shell.app_manager.get_category_def(&id))
+                .is_some_and(|app| app.rotatable);
+        let wanted = rotatable
+            && !self.shell.display_blanked
+            && !self.shell.lock_screen_active
+            && !self.system.rotation_lock.locked;
+        let physical = (self.physical_display_size.w, self.physical_display_size.h);
+        if let Some(plan) = self.auto_rotation.update(wanted, physical, Instant::now()) {
+            self.apply_rotation(plan.orientation);
+            self.system.rotation_lock.set_orientation(plan.orientation);
+            self.auto_rotation.commit(plan);
+        }
+    }
+
+    /// Start, freeze and cancel predicted apps (see prelaunch)
+    ///
+    /// Needs the app freezer: without cgroups a hidden app could neither be
+    /// parked nor told apart from a user launch.
+    pub fn update_prelaunch(&mut self) {
+        self.prelaunch.note_lock_state(self.shell.lock_screen_active);
+        if !self.app_cgroups.enabled() {
+            return;
+        }
+        let now = Instant::now();
+
+        if let Some(requested) = self.prelaunch.poll_requests(now) {
+            let wanted: Vec<String> = requested.iter().map(|id| crate::app_cgroups::group_name(id)).collect();
+            for group in self.prelaunch.groups() {
+                if !wanted.contains(&group) {
+                    self.cancel_prelaunch(&group);
+                }
+            }
+            let running: Vec<String> = self.space.elements()
+                .filter_map(|w| self.window_pid(w))
+                .collect::<Vec<_>>()
+                .into_iter()
+                .filter_map(|pid| self.app_cgroups.group_of_pid(pid))
+                .collect();
+            for app_id in requested {
+                let group = crate::app_cgroups::group_name(&app_id);
+                if self.prelaunch.is_hidden(&group) || running.contains(&group) || !self.prelaunch.has_room() {
+                    continue;
+                }
+                let Some(exec) = self.shell.app_manager.get_exec(&app_id) else { continue };
+                tracing::info!("Prelaunching '{}' hidden", app_id);
+                self.app_cgroups.start_prelaunch(&app_id);
+                let socket = self.socket_name.to_str().unwrap_or("wayland-1").to_string();
+                match crate::spawn_user::prelaunch_app_with_logging(&exec, &app_id, &socket, self.shell.text_scale as f64) {
+                    Ok(_) => self.prelaunch.add(group, app_id),
+                    Err(e) => tracing::warn!("Failed to prelaunch '{}': {}", app_id, e),
+                }
+            }
+        }
+
+        let (freeze, expired) = self.prelaunch.due(now);
+        for group in freeze {
+            self.app_cgroups.suspend_prelaunch(&group);
+        }
+        for group in expired {
+            tracing::info!("Prelaunched app group '{}' never showed a window", group);
+            self.cancel_prelaunch(&group);
+        }
+    }
+
+    fn cancel_prelaunch(&mut self, group: &str) {
+        if let Some(app) = self.prelaunch.take(group) {
+            if let Some(toplevel) = app.window.as_ref().and_then(|w| w.toplevel()) {
+                toplevel.send_close();
+            }
+            self.app_cgroups.cancel_prelaunch(group);
+        }
+    }
+
+    /// Show a prelaunched app instead of cold-starting it
+    ///
+    /// Returns false if the app is not prelaunched. An app that is still
+    /// starting is released from its limits and maps normally once its
+    /// toplevel appears.
+    pub fn reveal_prelaunched(&mut self, app_id: &str) -> bool {
+        let group = crate::app_cgroups::group_name(app_id);
+        let Some(app) = self.prelaunch.take(&group) else { return false };
+        self.app_cgroups.end_prelaunch(&group);
+        match app.window {
+            Some(window) => {
+                tracing::info!("Prelaunch hit: showing '{}' warm", app.app_id);
+                self.map_app_window(window);
+            }
+            None => tracing::info!("Prelaunch hit: '{}' still starting", app.app_id),
+        }
+        true
+    }
+
+    /// Launch an app the user asked for: log it for prediction, then show
+    /// it. Every user launch goes through here, so a prelaunched copy is
+    /// revealed instead of a second instance being started.
+    ///
+    /// Returns true if a prelaunched instance was shown.
+    pub fn launch_app(&mut self, app_id: &str, exec: &str) -> Result<bool, String> {
+        if let Some(bundled) = crate::prelaunch::app_id_from_exec(exec) {
+            self.prelaunch.record_launch(bundled, self.shell.lock_screen_active);
+        }
+        self.show_or_spawn_app(app_id, exec)
+    }
+
+    /// Show an app without logging it as a user launch (e.g. the phone app
+    /// on an incoming call): reveal a prelaunched instance, else spawn it
+    pub fn show_or_spawn_app(&mut self, app_id: &str, exec: &str) -> Result<bool, String> {
+        if self.reveal_prelaunched(app_id) {
+            return Ok(true);
+        }
+        let socket = self.socket_name.to_str().unwrap_or("wayland-1").to_string();
+        crate::spawn_user::spawn_app_with_logging(exec, app_id, &socket, self.shell.text_scale as f64)?;
+        Ok(false)
+    }
+
+    /// Number of switcher cards: live windows followed by apps killed under
+    /// memory pressure (shown as placeholders for a cold relaunch)
+    pub fn switcher_card_count(&self) -> usize {
+        self.space.elements().count() + self.app_cgroups.killed_apps().len()
+    }
+
+    /// Placeholder switcher cards for killed apps, numbered from `first_index`
+    pub fn killed_app_cards(&self, first_index: usize) -> Vec<(i32, String, String, i32, Option<u64>)> {
+        self.app_cgroups.killed_apps()
+            .iter()
+            .enumerate()
+            .map(|(i, killed)| {
+                let index = (first_index + i) as i32;
+                (index, format!("{} (tap to reopen)", killed.title), killed.app_id.clone(), index, None)
+            })
+            .collect()
+    }
+
+    /// Cold-launch a killed app from its switcher placeholder
+    pub fn relaunch_killed_app(&mut self, index: usize) {
+        let Some(killed) = self.app_cgroups.take_killed(index) else { return };
+        tracing::info!("Relaunching '{}' killed under memory pressure", killed.app_id);
+        if let Err(e) = self.launch_app(&killed.app_id, &killed.exec) {
+            tracing::error!("Failed to relaunch app: {}", e);
+        }
+        self.shell.set_view(crate::shell::ShellView::App);
+    }
+
+    /// Tell the supervisor what to restore if the compositor dies: lock
+    /// state, view and the launcher apps in the window stack. Checked every
+    /// couple of seconds (at once when the lock state changed), sent on
+    /// change and periodically while unlocked so it does not go stale.
+    pub fn update_session_snapshot(&mut self) {
+        let locked = self.shell.lock_screen_active;
+        let due = self.supervised.as_mut().is_some_and(|s| s.snapshot_due(Instant::now(), locked));
+        if !due {
+            return;
+        }
+        let snapshot = self.session_snapshot();
+        if let Some(supervised) = self.supervised.as_mut() {
+            supervised.send(snapshot);
+        }
+    }
+
+    /// Lock the session. The supervisor is told before the lock screen is
+    /// shown, so a crash right after cannot restore the session unlocked.
+    pub fn lock_session(&mut self) {
+        self.shell.lock();
+        if !self.shell.lock_screen_active || self.supervised.is_none() {
+            return;
+        }
+        let snapshot = self.session_snapshot();
+        if let Some(supervised) = self.supervised.as_mut() {
+            supervised.send_lock(snapshot);
+        }
+    }
+
+    fn session_snapshot(&self) -> crate::supervisor::Snapshot {
+        let pids: Vec<u32> = self.space.elements()
+            .filter_map(|w| self.window_pid(w))
+            .collect();
+        let mut apps: Vec<crate::supervisor::SnapshotApp> = Vec::new();
+        for pid in pids {
+            let Some(group) = self.app_cgroups.group_of_pid(pid) else { continue };
+            let Some((app_id, exec)) = crate::app_cgroups::launch_of_group(&group) else { continue };
+            // Only launcher apps, not home or the lock screen
+            if self.shell.app_manager.get_exec(&app_id).is_none() || apps.iter().any(|a| a.app_id == app_id) {
+                continue;
+            }
+            apps.push(crate::supervisor::SnapshotApp { app_id, exec });
+        }
+        crate::supervisor::Snapshot {
+            locked: self.shell.lock_screen_active,
+            in_app: self.shell.view == crate::shell::ShellView::App,
+            apps,
+            sent_at: 0,
+        }
+    }
+
+    /// After a supervised restart, put the session back: skip the lock
+    /// screen if it was unlocked and relaunch the apps that were open
+    /// (their clients died with the previous compositor). A missing or
+    /// stale snapshot leaves the session locked.
+    pub fn restore_session(&mut self) {
+        let Some(snapshot) = self.supervised.as_mut().and_then(|s| s.take_restore()) else { return };
+        let unlocked = snapshot.restores_unlocked(crate::supervisor::unix_now());
+        tracing::info!("Restoring session: {} app(s), locked={}", snapshot.apps.len(), !unlocked);
+        if !snapshot.locked && !unlocked {
+            tracing::warn!("Session snapshot from {} is stale, restoring locked", snapshot.sent_at);
+        }
+        if unlocked && self.shell.lock_screen_active {
+            self.shell.lock_screen_active = false;
+            self.shell.set_view(crate::shell::ShellView::Home);
+        }
+        let text_scale = self.shell.text_scale as f64;
+        let socket = self.socket_name.to_str().unwrap_or("wayland-1").to_string();
+        for app in &snapshot.apps {
+            if let Err(e) = crate::spawn_user::spawn_app_with_logging(&app.exec, &app.app_id, &socket, text_scale) {
+                tracing::error!("Failed to relaunch '{}': {}", app.app_id, e);
+            }
+        }
+        if !unlocked {
+            self.shell.pre_lock_had_app = !snapshot.apps.is_empty();
+        } else if snapshot.in_app && !snapshot.apps.is_empty() {
+            self.shell.set_view(crate::shell::ShellView::App);
+        }
+    }
+
+    /// Accept clients on a socket handed over by the supervisor (calloop
+    /// only watches the socket when we created it ourselves)
+    fn accept_inherited_clients(&mut self) {
+        let Some(listener) = self.inherited_socket.as_ref() else { return };
+        while let Ok((stream, _)) = listener.accept() {
+            tracing::info!("New Wayland client connected!");
+            if let Err(err) = self.display_handle.insert_client(stream, Arc::new(ClientState::default())) {
+                tracing::error!("Error inserting client: {}", err);
+            }
+        }
+    }
+
     /// Dispatch Wayland clients - processes incoming client requests
     /// This must be called regularly for the compositor to respond to clients
     pub fn dispatch_clients(&mut self) {
+        self.accept_inherited_clients();
+
         // SAFETY: We use raw pointers to work around the borrow checker.
         // This is safe because dispatch_clients only accesses protocol state,
         // not the display field itself.
@@ -1304,7 +1799,13 @@ impl Flick {
 
     /// Get path to effects config file (shared with Settings app)
     fn compositor_settings_path() -> std::path::PathBuf {
-        // Try multiple paths to find the config (same logic as touch_effects.rs)
+        Self::user_state_file("effects_config.json")
+    }
+
+    /// Resolve a file in the session user's `~/.local/state/flick` directory.
+    /// The compositor may run via sudo, so prefer SUDO_USER's home and fall back
+    /// to the first home where the file already exists (same logic as touch_effects.rs).
+    pub fn user_state_file(name: &str) -> std::path::PathBuf {
         let possible_homes = [
             std::env::var("SUDO_USER").ok().and_then(|user| {
                 std::fs::read_to_string("/etc/passwd").ok().and_then(|passwd| {
@@ -1320,13 +1821,14 @@ impl Flick {
 
         possible_homes.iter()
             .filter_map(|h| h.as_ref())
-            .map(|home| std::path::PathBuf::from(home).join(".local/state/flick/effects_config.json"))
+            .map(|home| std::path::PathBuf::from(home).join(".local/state/flick").join(name))
             .find(|p| p.exists())
             .unwrap_or_else(|| {
                 std::env::var("HOME")
                     .map(std::path::PathBuf::from)
                     .unwrap_or_else(|_| std::path::PathBuf::from("/tmp"))
-                    .join(".local/state/flick/effects_config.json")
+                    .join(".local/state/flick")
+                    .join(name)
             })
     }
 
@@ -1432,6 +1934,33 @@ impl Flick {
         }
     }
 
+    /// Send the key chord of a completed bound edge swipe to the focused client
+    pub fn dispatch_edge_binding(&mut self) {
+        use smithay::backend::input::KeyState;
+        use smithay::input::keyboard::{FilterResult, Keycode};
+
+        let Some(keys) = self.gesture_recognizer.take_edge_keys() else { return };
+        let Some(keyboard) = self.seat.get_keyboard() else { return };
+        tracing::info!("Edge binding: sending keycodes {:?}", keys);
+
+        let time = self.clock.now().as_millis() as u32;
+        // Linux keycodes + 8 for XKB; press in order, release in reverse
+        for &key in &keys {
+            let serial = smithay::utils::SERIAL_COUNTER.next_serial();
+            keyboard.input::<(), _>(self, Keycode::new(key + 8), KeyState::Pressed, serial, time, |_, _, _| {
+                FilterResult::Forward::<()>
+            });
+        }
+        for &key in keys.iter().rev() {
+            let serial = smithay::utils::SERIAL_COUNTER.next_serial();
+            keyboard.input::<(), _>(self, Keycode::new(key + 8), KeyState::Released, serial, time, |_, _, _| {
+                FilterResult::Forward::<()>
+            });
+        }
+
+        self.system.haptic_tap();
+    }
+
     /// Reload settings from config file if enough time has passed
     /// This allows the Settings app to change settings without restart
     pub fn reload_settings_if_needed(&mut self) {
@@ -1441,6 +1970,9 @@ impl Flick {
         }
         self.settings_last_check = Instant::now();
 
+        // Pick up edited edge-swipe bindings
+        self.gesture_recognizer.edge_bindings.reload_if_changed();
+
         // Reload touch effects setting
         let new_enabled = Self::load_compositor_settings();
         if new_enabled != self.touch_effects_enabled {
@@ -1479,8 +2011,11 @@ impl Flick {
         // Update logical screen size (apps see this size)
         self.screen_size = Size::from((new_width, new_height));
 
-        // Update gesture recognizer with new screen size
-        self.gesture_recognizer = crate::input::GestureRecognizer::new(self.screen_size);
+        // Update gesture recognizer and shell layout with new screen size
+        // (in place, so gesture config and edge bindings survive)
+        self.gesture_recognizer.screen_size = self.screen_size;
+        self.shell.screen_size = self.screen_size;
+        self.shell.quick_settings.screen_size = self.screen_size;
 
         // Resize all app windows to fit new screen dimensions
         for window in self.space.elements() {
@@ -1619,6 +2154,7 @@ impl CompositorHandler for Flick {
                             if let Some(buffer_data) = data.data_map.get::<RefCell<SurfaceBufferData>>() {
                                 let mut bd = buffer_data.borrow_mut();
                                 bd.buffer = Some(stored);
+                                bd.content_serial += 1;
                                 bd.needs_egl_import = false;
                             }
                             tracing::info!("Surface {:?} committed SHM buffer", surface.id());
@@ -1697,6 +2233,11 @@ impl SeatHandler for Flick {
 
         let dh = &self.display_handle;
         let client = focused.and_then(|s| dh.get_client(s.id()).ok());
+
+        // Thaw and boost the app before it gets its next frame callback
+        if let Some(pid) = client.as_ref().and_then(|c| c.get_credentials(dh).ok()).map(|c| c.pid as u32) {
+            self.app_cgroups.focus_pid(pid);
+        }
         set_data_device_focus(dh, seat, client);
 
         // Notify text input protocol of focus change (sends enter/leave events)
@@ -1785,79 +2326,21 @@ impl XdgShellHandler for Flick {
         tracing::info!("  Surface: {:?}", surface.wl_surface().id());
         tracing::info!("  Number of outputs: {}", self.outputs.len());
 
-        // Cancel any ongoing touch sequences on existing windows
-        // This is critical - without this, the old app might still receive touch events
-        if let Some(touch) = self.seat.get_touch() {
-            touch.cancel(self);
-            tracing::info!("Cancelled touch sequences for existing windows");
-        }
-
-        // DEACTIVATE all existing windows first
-        for existing_window in self.space.elements() {
-            if let Some(toplevel) = existing_window.toplevel() {
-                toplevel.with_pending_state(|state| {
-                    state.states.unset(xdg_toplevel::State::Activated);
-                });
-                toplevel.send_configure();
-                tracing::info!("Deactivated existing window: {:?}", toplevel.wl_surface().id());
-            }
-        }
-
-        // Configure for fullscreen on our output
-        if let Some(output) = self.outputs.first() {
-            let output_size = output
-                .current_mode()
-                .map(|m| m.size)
-                .unwrap_or((720, 1440).into());
-
-            surface.with_pending_state(|state| {
-                state.size = Some(output_size.to_logical(1));
-                // Set fullscreen and activated states - this tells the client
-                // not to draw decorations (title bar, borders)
-                state.states.set(xdg_toplevel::State::Fullscreen);
-                state.states.set(xdg_toplevel::State::Activated);
-            });
+        // A predicted app: let it draw its first frame offscreen, unfocused
+        let group = self.window_pid(&window).and_then(|pid| self.app_cgroups.group_of_pid(pid));
+        if let Some(group) = group.filter(|g| self.prelaunch.is_hidden(g)) {
+            tracing::info!("Holding toplevel of prelaunched app group '{}' hidden", group);
+            self.configure_fullscreen(&surface, false);
+            self.prelaunch.hold_window(&group, window);
+            return;
         }
 
-        surface.send_configure();
-
-        // Add to space at origin and raise to top (activate=true)
-        self.space.map_element(window.clone(), (0, 0), true);
-
-        // Track this as the active window for touch input
-        let surface_id = surface.wl_surface().id();
-        self.active_window = Some(window);
-        tracing::info!("Active window set to new toplevel: {:?}", surface_id);
-
-        // Switch to App view now that we have a real window
-        // UNLESS we're on the lock screen, home screen with QML home, OR we recently unlocked
-        let current_view = self.shell.view;
-        if current_view == crate::shell::ShellView::LockScreen {
-            tracing::info!("New window on lock screen - staying in LockScreen view");
-        } else if current_view == crate::shell::ShellView::Home && self.shell.qml_home_launched {
-            // QML home window - stay on Home view, don't switch to App
-            tracing::info!("New window on home screen with QML home - staying in Home view");
-        } else if self.shell.unlock_app_launched {
-            // App was launched from notification tap - switch to App view
-            tracing::info!("New window from notification app launch - switching to App view");
-            self.shell.unlock_app_launched = false; // Reset flag
-            self.shell.set_view(crate::shell::ShellView::App);
-        } else if self.shell.is_recently_unlocked() {
-            tracing::info!("New window right after unlock - ignoring (likely dying lock app)");
-        } else {
-            self.shell.set_view(crate::shell::ShellView::App);
-            tracing::info!("Switched to App view for new window");
-        }
+        self.map_app_window(window);
+    }
 
-        // Set keyboard focus to this window
-        let wl_surface = surface.wl_surface().clone();
-        let client_info = wl_surface.client().map(|c| format!("{:?}", c.id())).unwrap_or_else(|| "no-client".to_string());
-        tracing::info!("new_toplevel: Setting keyboard focus to {:?} (client: {})", wl_surface.id(), client_info);
-        let serial = smithay::utils::SERIAL_COUNTER.next_serial();
-        if let Some(keyboard) = self.seat.get_keyboard() {
-            keyboard.set_focus(self, Some(wl_surface), serial);
-            tracing::info!("Keyboard focus set to new toplevel");
-        }
+    fn title_changed(&mut self, _surface: ToplevelSurface) {
+        // Home and lock screen windows are recognised by title
+        self.scene_changed();
     }
 
     fn new_popup(&mut self, surface: PopupSurface, _positioner: PositionerState) {
@@ -1895,6 +2378,7 @@ impl XdgShellHandler for Flick {
 
     fn toplevel_destroyed(&mut self, surface: ToplevelSurface) {
         tracing::info!("Toplevel destroyed");
+        self.prelaunch.toplevel_destroyed(&surface);
 
         let window = self
             .space
@@ -1904,6 +2388,7 @@ impl XdgShellHandler for Flick {
 
         if let Some(window) = window {
             self.space.unmap_elem(&window);
+            self.scene_changed();
         }
 
         // Clear active window if it was this one
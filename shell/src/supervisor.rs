@@ -0,0 +1,425 @@
+//! Supervisor mode: restart the compositor in place after a crash
+//!
+//! `flick --supervise` runs a small parent process that owns the Wayland
+//! listening socket and starts the real compositor as its child. The child
+//! gets the socket over a UNIX socketpair (`SCM_RIGHTS`, see `handover`),
+//! so the socket name apps and services were given stays valid across a
+//! restart, and the Android composer service keeps running instead of being
+//! restarted by start.sh.
+//!
+//! While it runs, the child sends a snapshot of its session (lock state,
+//! view, the apps in the window stack) over the same socketpair whenever it
+//! changes. The supervisor only keeps the latest one in memory. If the child
+//! dies, the next one receives that snapshot with the socket: it skips the
+//! lock screen if the session was unlocked and relaunches the apps that were
+//! open. Keeping the snapshot in the supervisor rather than on disk means
+//! it cannot be forged to get past the lock screen.
+//!
+//! Restoring fails closed. A lock is sent synchronously before the lock
+//! screen is shown, unlocked snapshots are re-sent periodically, and one
+//! that is missing, unreadable or older than SNAPSHOT_MAX_AGE restores
+//! locked.
+//!
+//! A clean exit (status 0) ends the supervisor too. A crash loop (too many
+//! restarts in a short time) gives up so start.sh can report it.
+
+use serde::{Deserialize, Serialize};
+use std::collections::VecDeque;
+use std::ffi::OsString;
+use std::io::{BufRead, BufReader, Write};
+use std::os::unix::ffi::OsStringExt;
+use std::os::unix::io::{AsRawFd, FromRawFd, RawFd};
+use std::os::unix::net::{UnixListener, UnixStream};
+use std::os::unix::process::{CommandExt, ExitStatusExt};
+use std::path::PathBuf;
+use std::process::{Child, Command};
+use std::sync::{Arc, Mutex};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+
+/// Env var carrying the child's end of the socketpair
+const SUPERVISOR_FD_ENV: &str = "FLICK_SUPERVISOR_FD";
+/// Give up after this many restarts within CRASH_WINDOW
+const MAX_RESTARTS: usize = 5;
+const CRASH_WINDOW: Duration = Duration::from_secs(60);
+/// How often the child checks whether its session changed
+const SNAPSHOT_INTERVAL: Duration = Duration::from_secs(2);
+/// An unchanged unlocked snapshot is re-sent this often to stay fresh
+const SNAPSHOT_REFRESH: Duration = Duration::from_secs(30);
+/// An unlocked snapshot older than this restores locked
+const SNAPSHOT_MAX_AGE: Duration = Duration::from_secs(90);
+/// How long a lock snapshot may block on a full socket
+const LOCK_SEND_TIMEOUT: Duration = Duration::from_millis(200);
+/// Largest handover message (socket name + snapshot)
+const MAX_MESSAGE: usize = 64 * 1024;
+
+/// An app in the window stack
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct SnapshotApp {
+    pub app_id: String,
+    pub exec: String,
+}
+
+/// What a restarted compositor needs to put the session back
+#[derive(Debug, Clone, PartialEq, Default, Serialize, Deserialize)]
+pub struct Snapshot {
+    pub locked: bool,
+    /// An app was in front (App view)
+    pub in_app: bool,
+    /// Window stack, bottom first
+    pub apps: Vec<SnapshotApp>,
+    /// Unix time the child sent it (0 in snapshots not yet sent)
+    #[serde(default)]
+    pub sent_at: u64,
+}
+
+impl Snapshot {
+    /// Whether a restart may skip the lock screen: only for an unlocked
+    /// snapshot that was refreshed recently
+    pub fn restores_unlocked(&self, now: u64) -> bool {
+        !self.locked && self.sent_at > 0 && now.saturating_sub(self.sent_at) <= SNAPSHOT_MAX_AGE.as_secs()
+    }
+}
+
+/// Current Unix time in seconds, the clock of `Snapshot::sent_at`
+pub fn unix_now() -> u64 {
+    SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0)
+}
+
+/// Send `fd` and `payload` in one message
+fn send_fd(stream: &UnixStream, fd: RawFd, payload: &[u8]) -> std::io::Result<()> {
+    unsafe {
+        let mut iov = libc::iovec { iov_base: payload.as_ptr() as *mut libc::c_void, iov_len: payload.len() };
+        let space = libc::CMSG_SPACE(std::mem::size_of::<RawFd>() as u32) as usize;
+        let mut control = vec![0u8; space];
+        let mut msg: libc::msghdr = std::mem::zeroed();
+        msg.msg_iov = &mut iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.as_mut_ptr() as *mut libc::c_void;
+        msg.msg_controllen = space as _;
+        let cmsg = libc::CMSG_FIRSTHDR(&msg);
+        (*cmsg).cmsg_level = libc::SOL_SOCKET;
+        (*cmsg).cmsg_type = libc::SCM_RIGHTS;
+        (*cmsg).cmsg_len = libc::CMSG_LEN(std::mem::size_of::<RawFd>() as u32) as _;
+        std::ptr::write_unaligned(libc::CMSG_DATA(cmsg) as *mut RawFd, fd);
+        if libc::sendmsg(stream.as_raw_fd(), &msg, 0) < 0 {
+            return Err(std::io::Error::last_os_error());
+        }
+    }
+    Ok(())
+}
+
+/// Receive a message sent by `send_fd`
+fn recv_fd(stream: &UnixStream) -> std::io::Result<(RawFd, Vec<u8>)> {
+    let mut payload = vec![0u8; MAX_MESSAGE];
+    unsafe {
+        let mut iov = libc::iovec { iov_base: payload.as_mut_ptr() as *mut libc::c_void, iov_len: payload.len() };
+        let space = libc::CMSG_SPACE(std::mem::size_of::<RawFd>() as u32) as usize;
+        let mut control = vec![0u8; space];
+        let mut msg: libc::msghdr = std::mem::zeroed();
+        msg.msg_iov = &mut iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.as_mut_ptr() as *mut libc::c_void;
+        msg.msg_controllen = space as _;
+        let len = libc::recvmsg(stream.as_raw_fd(), &mut msg, libc::MSG_CMSG_CLOEXEC);
+        if len < 0 {
+            return Err(std::io::Error::last_os_error());
+        }
+        let cmsg = libc::CMSG_FIRSTHDR(&msg);
+        if cmsg.is_null() || (*cmsg).cmsg_type != libc::SCM_RIGHTS {
+            return Err(std::io::Error::new(std::io::ErrorKind::InvalidData, "no fd in handover"));
+        }
+        let fd = std::ptr::read_unaligned(libc::CMSG_DATA(cmsg) as *const RawFd);
+        payload.truncate(len as usize);
+        Ok((fd, payload))
+    }
+}
+
+/// Bind the next free `wayland-N` socket the way libwayland does (with a
+/// `.lock` file), since the supervisor has no Display to do it
+fn bind_wayland_socket() -> std::io::Result<(UnixListener, String, std::fs::File)> {
+    let runtime_dir = std::env::var("XDG_RUNTIME_DIR")
+        .map(PathBuf::from)
+        .map_err(|_| std::io::Error::new(std::io::ErrorKind::NotFound, "XDG_RUNTIME_DIR not set"))?;
+    for n in 1..33 {
+        let name = format!("wayland-{}", n);
+        let path = runtime_dir.join(&name);
+        let lock = std::fs::OpenOptions::new()
+            .create(true)
+            .write(true)
+            .open(runtime_dir.join(format!("{}.lock", name)))?;
+        if unsafe { libc::flock(lock.as_raw_fd(), libc::LOCK_EX | libc::LOCK_NB) } != 0 {
+            continue;
+        }
+        // Holding the lock means any socket file left there is stale
+        let _ = std::fs::remove_file(&path);
+        let listener = UnixListener::bind(&path)?;
+        crate::spawn_user::share_socket_with_user(&path);
+        return Ok((listener, name, lock));
+    }
+    Err(std::io::Error::new(std::io::ErrorKind::AddrInUse, "no free wayland socket name"))
+}
+
+/// Start the compositor child with `child_end` as its supervisor socket
+fn spawn_compositor(child_end: &UnixStream) -> std::io::Result<Child> {
+    let exe = std::env::current_exe()?;
+    let args: Vec<OsString> = std::env::args_os().skip(1).filter(|a| a != "--supervise").collect();
+    let fd = child_end.as_raw_fd();
+    let mut command = Command::new(exe);
+    command.args(args).env(SUPERVISOR_FD_ENV, fd.to_string());
+    unsafe {
+        command.pre_exec(move || {
+            // Keep the socketpair end across exec, and die with the supervisor
+            let flags = libc::fcntl(fd, libc::F_GETFD);
+            libc::fcntl(fd, libc::F_SETFD, flags & !libc::FD_CLOEXEC);
+            libc::prctl(libc::PR_SET_PDEATHSIG, libc::SIGTERM);
+            Ok(())
+        });
+    }
+    command.spawn()
+}
+
+/// Run children from `spawn` until one exits cleanly, restarting crashed
+/// ones; returns the number of restarts, or an error on a crash loop
+fn supervise(mut spawn: impl FnMut(u32) -> std::io::Result<Child>) -> std::io::Result<u32> {
+    let mut restarts = 0;
+    let mut crashes: VecDeque<Instant> = VecDeque::new();
+    loop {
+        let status = spawn(restarts)?.wait()?;
+        if status.success() {
+            return Ok(restarts);
+        }
+        match status.signal() {
+            Some(signal) => tracing::error!("Compositor killed by signal {}, restarting", signal),
+            None => tracing::error!("Compositor exited with {}, restarting", status),
+        }
+
+        let now = Instant::now();
+        crashes.push_back(now);
+        while crashes.front().is_some_and(|at| now.duration_since(*at) > CRASH_WINDOW) {
+            crashes.pop_front();
+        }
+        if crashes.len() > MAX_RESTARTS {
+            return Err(std::io::Error::other(format!("{} crashes within {:?}, giving up", crashes.len(), CRASH_WINDOW)));
+        }
+        restarts += 1;
+    }
+}
+
+/// `flick --supervise`: own the socket and keep a compositor running
+pub fn run() -> anyhow::Result<()> {
+    let (listener, name, _lock) = bind_wayland_socket()?;
+    tracing::info!("Supervisor: listening on {} for the compositor", name);
+    let snapshot: Arc<Mutex<Option<String>>> = Arc::new(Mutex::new(None));
+    let mut reader: Option<JoinHandle<()>> = None;
+
+    let restarts = supervise(|_| {
+        // Everything the previous child wrote before dying, such as a lock
+        // sent just before a crash, is read before its successor starts
+        if let Some(previous) = reader.take() {
+            let _ = previous.join();
+        }
+        let (parent_end, child_end) = UnixStream::pair()?;
+        let child = spawn_compositor(&child_end)?;
+        drop(child_end);
+
+        let mut payload = format!("{}\n", name);
+        if let Some(last) = snapshot.lock().ok().and_then(|s| s.clone()) {
+            payload.push_str(&last);
+        }
+        send_fd(&parent_end, listener.as_raw_fd(), payload.as_bytes())?;
+
+        // Keep the latest snapshot; the reader ends when the child does
+        let snapshot = snapshot.clone();
+        reader = Some(std::thread::spawn(move || {
+            for line in BufReader::new(parent_end).lines().map_while(Result::ok) {
+                if let Ok(mut last) = snapshot.lock() {
+                    *last = Some(line);
+                }
+            }
+        }));
+        Ok(child)
+    })?;
+    tracing::info!("Supervisor: compositor exited cleanly after {} restart(s)", restarts);
+    Ok(())
+}
+
+/// Child side of the supervisor link
+pub struct Supervised {
+    control: UnixStream,
+    /// Snapshot from before the restart, until restored
+    restore: Option<Snapshot>,
+    /// Last snapshot sent (without its send time) and when
+    last_sent: Option<Snapshot>,
+    last_sent_at: Option<Instant>,
+    last_check: Option<Instant>,
+}
+
+/// Take the socket handed over by a supervisor, if there is one
+///
+/// Returns the listener (nonblocking), its name and the link.
+pub fn handover() -> Option<(UnixListener, OsString, Supervised)> {
+    let fd: RawFd = std::env::var(SUPERVISOR_FD_ENV).ok()?.parse().ok()?;
+    std::env::remove_var(SUPERVISOR_FD_ENV);
+    let control = unsafe { UnixStream::from_raw_fd(fd) };
+    // Not inherited by apps
+    unsafe { libc::fcntl(fd, libc::F_SETFD, libc::FD_CLOEXEC) };
+    let (listener_fd, payload) = match recv_fd(&control) {
+        Ok(message) => message,
+        Err(e) => {
+            tracing::error!("Supervisor handover failed: {}", e);
+            return None;
+        }
+    };
+    let listener = unsafe { UnixListener::from_raw_fd(listener_fd) };
+    let _ = listener.set_nonblocking(true);
+    let _ = control.set_nonblocking(true);
+
+    let payload = String::from_utf8_lossy(&payload).into_owned();
+    let (name, snapshot) = payload.split_once('\n').unwrap_or((payload.as_str(), ""));
+    let restore = serde_json::from_str::<Snapshot>(snapshot).ok();
+    tracing::info!("Supervised: took over socket {} (restoring: {})", name, restore.is_some());
+    Some((listener, OsString::from_vec(name.as_bytes().to_vec()), Supervised {
+        control,
+        restore,
+        last_sent: None,
+        last_sent_at: None,
+        last_check: None,
+    }))
+}
+
+impl Supervised {
+    /// Snapshot to restore after a restart (only handed out once)
+    pub fn take_restore(&mut self) -> Option<Snapshot> {
+        self.restore.take()
+    }
+
+    /// True when it is time to compare the session with the last snapshot.
+    /// A lock state that differs from the last one sent is due at once.
+    pub fn snapshot_due(&mut self, now: Instant, locked: bool) -> bool {
+        let lock_changed = self.last_sent.as_ref().is_some_and(|s| s.locked != locked);
+        if !lock_changed && self.last_check.is_some_and(|at| now.duration_since(at) < SNAPSHOT_INTERVAL) {
+            return false;
+        }
+        self.last_check = Some(now);
+        true
+    }
+
+    /// Send a snapshot to the supervisor if it changed, or if it is an
+    /// unlocked one due for a refresh
+    pub fn send(&mut self, snapshot: Snapshot) {
+        let now = Instant::now();
+        let refresh = !snapshot.locked && self.last_sent_at.map_or(true, |at| now.duration_since(at) >= SNAPSHOT_REFRESH);
+        if self.last_sent.as_ref() == Some(&snapshot) && !refresh {
+            return;
+        }
+        // The supervisor reads continuously; a full buffer just skips one
+        match self.write(&snapshot) {
+            Ok(()) => {
+                self.last_sent = Some(snapshot);
+                self.last_sent_at = Some(now);
+            }
+            Err(e) => tracing::debug!("Could not send session snapshot: {}", e),
+        }
+    }
+
+    /// Send a lock snapshot before the lock screen is shown. Blocks briefly
+    /// on a full socket instead of skipping it.
+    pub fn send_lock(&mut self, snapshot: Snapshot) {
+        let _ = self.control.set_nonblocking(false);
+        let _ = self.control.set_write_timeout(Some(LOCK_SEND_TIMEOUT));
+        let result = self.write(&snapshot);
+        let _ = self.control.set_nonblocking(true);
+        match result {
+            Ok(()) => {
+                self.last_sent = Some(snapshot);
+                self.last_sent_at = Some(Instant::now());
+            }
+            Err(e) => tracing::warn!("Could not send lock snapshot: {}", e),
+        }
+    }
+
+    fn write(&mut self, snapshot: &Snapshot) -> std::io::Result<()> {
+        let stamped = Snapshot { sent_at: unix_now(), ..snapshot.clone() };
+        let mut line = serde_json::to_string(&stamped).map_err(std::io::Error::other)?;
+        line.push('\n');
+        self.control.write_all(line.as_bytes())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_fd_handover() {
+        let path = std::env::temp_dir().join(format!("flick-supervisor-test-{}", std::process::id()));
+        let _ = std::fs::remove_file(&path);
+        let listener = UnixListener::bind(&path).unwrap();
+        let (parent_end, child_end) = UnixStream::pair().unwrap();
+        send_fd(&parent_end, listener.as_raw_fd(), b"wayland-9\n{}").unwrap();
+        drop(listener);
+
+        let (fd, payload) = recv_fd(&child_end).unwrap();
+        assert_eq!(payload, b"wayland-9\n{}");
+        let received = unsafe { UnixListener::from_raw_fd(fd) };
+        let _client = UnixStream::connect(&path).unwrap();
+        assert!(received.accept().is_ok());
+        let _ = std::fs::remove_file(&path);
+    }
+
+    #[test]
+    fn test_restarts_killed_compositor() {
+        // Stand-in compositors: the first is SIGKILLed, the second exits cleanly
+        let restarts = supervise(|n| {
+            let script = if n == 0 { "kill -9 $$" } else { "exit 0" };
+            Command::new("sh").arg("-c").arg(script).spawn()
+        });
+        assert_eq!(restarts.unwrap(), 1);
+
+        // One that keeps crashing is given up on
+        let mut spawned = 0;
+        let result = supervise(|_| {
+            spawned += 1;
+            Command::new("sh").arg("-c").arg("kill -9 $$").spawn()
+        });
+        assert!(result.is_err());
+        assert_eq!(spawned, MAX_RESTARTS + 1);
+    }
+
+    #[test]
+    fn test_snapshot_roundtrip() {
+        let snapshot = Snapshot {
+            locked: false,
+            in_app: true,
+            apps: vec![SnapshotApp { app_id: "weather".into(), exec: "sh -c run_weather.sh".into() }],
+            sent_at: 1000,
+        };
+        let line = serde_json::to_string(&snapshot).unwrap();
+        assert_eq!(serde_json::from_str::<Snapshot>(&line).unwrap(), snapshot);
+    }
+
+    #[test]
+    fn test_restore_fails_closed() {
+        let unlocked = Snapshot { sent_at: 1000, ..Snapshot::default() };
+        assert!(unlocked.restores_unlocked(1000 + SNAPSHOT_MAX_AGE.as_secs()));
+        // Stale, never stamped, or locked
+        assert!(!unlocked.restores_unlocked(1001 + SNAPSHOT_MAX_AGE.as_secs()));
+        assert!(!Snapshot::default().restores_unlocked(1000));
+        assert!(!Snapshot { locked: true, ..unlocked.clone() }.restores_unlocked(1000));
+        // Snapshots from before sent_at existed parse, and restore locked
+        let old: Snapshot = serde_json::from_str(r#"{"locked":false,"in_app":false,"apps":[]}"#).unwrap();
+        assert!(!old.restores_unlocked(1000));
+    }
+
+    #[test]
+    fn test_lock_change_is_due_at_once() {
+        let (ours, _theirs) = UnixStream::pair().unwrap();
+        let mut supervised = Supervised { control: ours, restore: None, last_sent: None, last_sent_at: None, last_check: None };
+        let now = Instant::now();
+        assert!(supervised.snapshot_due(now, false));
+        supervised.send(Snapshot::default());
+        assert!(!supervised.snapshot_due(now, false));
+        assert!(supervised.snapshot_due(now, true));
+    }
+}
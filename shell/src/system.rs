@@ -449,7 +449,7 @@ impl VolumeManager {
     }
 
     /// Run pactl command as the audio user
-    fn run_pactl(args: &[&str]) -> Option<std::process::Output> {
+    pub(crate) fn run_pactl(args: &[&str]) -> Option<std::process::Output> {
         if let Some((uid, _username)) = Self::get_audio_user() {
             // Check if we're already running as the target user
             let current_uid = unsafe { libc::getuid() };
@@ -1096,6 +1096,62 @@ impl MediaStatus {
     }
 }
 
+/// Port of flick-audio-engine's localhost control interface
+const AUDIO_ENGINE_PORT: u16 = 7655;
+/// Minimum gap between warm-up requests (the engine keeps its stream open
+/// for a few seconds after each one)
+const AUDIO_WARM_INTERVAL: std::time::Duration = std::time::Duration::from_secs(1);
+
+/// Pre-roll for flick-audio-engine, which closes its stream when idle so
+/// the sink can suspend. A touch usually comes just before a UI sound, so
+/// touch down asks the engine to reopen its stream while the finger is
+/// still on the glass and the sink resumes before the click.
+pub struct AudioWarmup {
+    requests: Option<std::sync::mpsc::Sender<()>>,
+    last_warm: Option<Instant>,
+}
+
+impl AudioWarmup {
+    pub fn new() -> Self {
+        Self { requests: None, last_warm: None }
+    }
+
+    /// Ask the engine to open its stream (rate limited, never blocks)
+    pub fn warm(&mut self) {
+        if self.last_warm.is_some_and(|t| t.elapsed() < AUDIO_WARM_INTERVAL) {
+            return;
+        }
+        self.last_warm = Some(Instant::now());
+        let requests = self.requests.get_or_insert_with(Self::spawn_worker);
+        if requests.send(()).is_err() {
+            self.requests = None;
+        }
+    }
+
+    /// Worker doing the localhost round trips off the main thread
+    fn spawn_worker() -> std::sync::mpsc::Sender<()> {
+        let (tx, rx) = std::sync::mpsc::channel::<()>();
+        let _ = std::thread::Builder::new()
+            .name("flick-audio-warm".into())
+            .spawn(move || {
+                use std::io::{Read, Write};
+                let addr = std::net::SocketAddr::from(([127, 0, 0, 1], AUDIO_ENGINE_PORT));
+                let timeout = std::time::Duration::from_millis(200);
+                while rx.recv().is_ok() {
+                    // Engine not running: nothing to warm
+                    let Ok(mut stream) = std::net::TcpStream::connect_timeout(&addr, timeout) else {
+                        continue;
+                    };
+                    let _ = stream.set_read_timeout(Some(timeout));
+                    if stream.write_all(b"GET /warm HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n").is_ok() {
+                        let _ = stream.read(&mut [0u8; 256]);
+                    }
+                }
+            });
+        tx
+    }
+}
+
 /// System status aggregator
 pub struct SystemStatus {
     pub backlight: Option<Backlight>,
@@ -1130,6 +1186,10 @@ pub struct SystemStatus {
     pub media: MediaStatus,
     /// Last time we checked media status
     media_last_check: std::time::Instant,
+    /// Audio engine pre-roll on touch
+    pub audio_warmup: AudioWarmup,
+    /// In-process player for notification, ringtone and key click sounds
+    pub sounds: crate::sound::SoundService,
 }
 
 impl SystemStatus {
@@ -1138,6 +1198,11 @@ impl SystemStatus {
         if vibrator.is_some() {
             tracing::info!("Vibrator found and initialized");
         }
+        let sound_config = SoundConfig::load();
+        let sounds = crate::sound::SoundService::start(
+            crate::sound::stream_sink(),
+            vec![sound_config.notification_sound.clone(), sound_config.ringtone.clone()],
+        );
         Self {
             backlight: Backlight::new(),
             battery: BatteryStatus::read(),
@@ -1156,10 +1221,12 @@ impl SystemStatus {
             volume_key_held: None,
             volume_key_held_since: None,
             volume_key_last_repeat: None,
-            sound_config: SoundConfig::load(),
+            sound_config,
             voice_2g_enabled: check_voice_2g_mode(),
             media: MediaStatus::default(),
             media_last_check: std::time::Instant::now(),
+            audio_warmup: AudioWarmup::new(),
+            sounds,
         }
     }
 
@@ -1234,12 +1301,35 @@ impl SystemStatus {
 
     /// Play notification sound
     pub fn play_notification_sound(&self) {
-        self.sound_config.play_notification();
+        if self.sound_config.notification_enabled {
+            self.sounds.play(&self.sound_config.notification_sound);
+        }
     }
 
-    /// Play ringtone sound
+    /// Start the ringtone, looping until `stop_ringtone`
     pub fn play_ringtone(&self) {
-        self.sound_config.play_ringtone();
+        if self.sound_config.ringtone_enabled {
+            self.sounds.play_looping(&self.sound_config.ringtone);
+        }
+    }
+
+    pub fn stop_ringtone(&self) {
+        self.sounds.stop_looping();
+    }
+
+    /// Keyboard click, if enabled
+    pub fn play_key_click(&self) {
+        if self.sound_config.key_click_enabled {
+            self.sounds.key_click();
+        }
+    }
+
+    /// A touch usually comes just before a sound: get both audio paths ready
+    pub fn warm_audio(&mut self) {
+        self.audio_warmup.warm();
+        if self.sound_config.key_click_enabled {
+            self.sounds.warm();
+        }
     }
 
     /// Refresh all status values
@@ -1329,6 +1419,9 @@ impl SystemStatus {
 
         let old_state = self.phone.state.clone();
         self.phone = PhoneStatus::read();
+        if old_state == "incoming" && self.phone.state != "incoming" {
+            self.stop_ringtone();
+        }
 
         // Return true if we just got an incoming call
         old_state != "incoming" && self.phone.state == "incoming"
@@ -1352,6 +1445,7 @@ impl SystemStatus {
     /// Answer incoming call
     pub fn answer_call(&mut self) {
         PhoneStatus::answer();
+        self.stop_ringtone();
         // Haptic feedback
         self.haptic_click();
     }
@@ -1359,6 +1453,7 @@ impl SystemStatus {
     /// Reject/hangup call
     pub fn reject_call(&mut self) {
         PhoneStatus::hangup();
+        self.stop_ringtone();
         // Haptic feedback
         self.haptic_heavy();
     }
@@ -1441,6 +1536,8 @@ pub struct SoundConfig {
     pub ringtone: String,
     pub notification_enabled: bool,
     pub ringtone_enabled: bool,
+    /// Click on every on-screen keyboard key press
+    pub key_click_enabled: bool,
 }
 
 impl Default for SoundConfig {
@@ -1450,6 +1547,7 @@ impl Default for SoundConfig {
             ringtone: "ringtone_modern.wav".to_string(),
             notification_enabled: true,
             ringtone_enabled: true,
+            key_click_enabled: false,
         }
     }
 }
@@ -1492,6 +1590,9 @@ impl SoundConfig {
                     ringtone_enabled: json.get("ringtone_enabled")
                         .and_then(|v| v.as_bool())
                         .unwrap_or(true),
+                    key_click_enabled: json.get("key_click_enabled")
+                        .and_then(|v| v.as_bool())
+                        .unwrap_or(false),
                 };
             }
         }
@@ -1508,13 +1609,14 @@ impl SoundConfig {
             "ringtone": self.ringtone,
             "notification_enabled": self.notification_enabled,
             "ringtone_enabled": self.ringtone_enabled,
+            "key_click_enabled": self.key_click_enabled,
         });
 
         let _ = fs::write(&config_path, serde_json::to_string_pretty(&json).unwrap());
     }
 
     /// Get the full path to a sound file
-    fn get_sound_path(sound_name: &str) -> Option<std::path::PathBuf> {
+    pub(crate) fn get_sound_path(sound_name: &str) -> Option<std::path::PathBuf> {
         // Check user data directory first
         let home = if let Ok(sudo_user) = std::env::var("SUDO_USER") {
             format!("/home/{}", sudo_user)
@@ -1547,46 +1649,8 @@ impl SoundConfig {
         None
     }
 
-    /// Play a sound file using paplay (PulseAudio) or aplay (ALSA)
-    /// Runs as the audio user since shell runs as root
-    fn play_sound(sound_name: &str) {
-        if let Some(path) = Self::get_sound_path(sound_name) {
-            let path_str = path.to_string_lossy().to_string();
-            tracing::info!("Playing sound: {}", path_str);
-
-            // Need to run as audio user since shell runs as root
-            std::thread::spawn(move || {
-                // Find audio user
-                if let Some((uid, _)) = Self::get_audio_user() {
-                    let shell_cmd = format!(
-                        "XDG_RUNTIME_DIR=/run/user/{} paplay '{}'",
-                        uid, path_str
-                    );
-                    let result = std::process::Command::new("sudo")
-                        .args(["-u", &format!("#{}", uid), "sh", "-c", &shell_cmd])
-                        .spawn();
-
-                    if result.is_err() {
-                        // Fall back to aplay (doesn't need user session)
-                        let _ = std::process::Command::new("aplay")
-                            .arg("-q")
-                            .arg(&path_str)
-                            .spawn();
-                    }
-                } else {
-                    // No audio user found, try direct (may fail)
-                    let _ = std::process::Command::new("paplay")
-                        .arg(&path_str)
-                        .spawn();
-                }
-            });
-        } else {
-            tracing::warn!("Sound file not found: {}", sound_name);
-        }
-    }
-
     /// Find the audio user (same logic as VolumeManager)
-    fn get_audio_user() -> Option<(u32, String)> {
+    pub(crate) fn get_audio_user() -> Option<(u32, String)> {
         // First, check if FLICK_USER is set (from systemd service)
         if let Ok(flick_user) = std::env::var("FLICK_USER") {
             if let Ok(contents) = fs::read_to_string("/etc/passwd") {
@@ -1631,20 +1695,6 @@ impl SoundConfig {
         None
     }
 
-    /// Play notification sound
-    pub fn play_notification(&self) {
-        if self.notification_enabled {
-            Self::play_sound(&self.notification_sound);
-        }
-    }
-
-    /// Play ringtone (for incoming calls)
-    pub fn play_ringtone(&self) {
-        if self.ringtone_enabled {
-            Self::play_sound(&self.ringtone);
-        }
-    }
-
     /// Get list of available notification sounds
     pub fn list_notification_sounds() -> Vec<String> {
         Self::list_sounds_matching("notification_")
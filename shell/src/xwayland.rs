@@ -61,6 +61,7 @@ impl XwmHandler for Flick {
 
         // Use activate=true to bring X11 window to front (on top of shell)
         self.space.map_element(win.clone(), (0, 0), true);
+        self.scene_changed();
 
         // Track this as the active window for touch input
         self.active_window = Some(win);
@@ -93,6 +94,7 @@ impl XwmHandler for Flick {
         let win = Window::new_x11_window(window.clone());
         // Override redirect windows go on top
         self.space.map_element(win, (0, 0), true);
+        self.scene_changed();
         tracing::info!("X11 override redirect window added to space");
     }
 
@@ -110,6 +112,7 @@ impl XwmHandler for Flick {
 
         if let Some(win) = to_remove {
             self.space.unmap_elem(&win);
+            self.scene_changed();
 
             // If no more X11 windows, switch to Home view
             let has_windows = self.space.elements().any(|w| w.x11_surface().is_some());
@@ -25,6 +25,54 @@ start_daemons() {
     # Kill any existing daemons
     sudo -u "$REAL_USER" pkill -f "messaging_daemon.py" 2>/dev/null || true
     sudo pkill -f "phone_helper.py daemon" 2>/dev/null || true
+    sudo -u "$REAL_USER" pkill -x flick-audio-engine 2>/dev/null || true
+    sudo -u "$REAL_USER" pkill -f "flick-app-service" 2>/dev/null || true
+    sudo -u "$REAL_USER" pkill -f "contacts_store.py serve" 2>/dev/null || true
+    sudo -u "$REAL_USER" pkill -f "calendar_engine.py serve" 2>/dev/null || true
+    sudo -u "$REAL_USER" pkill -f "http_cache.py" 2>/dev/null || true
+
+    # Start shared HTTP cache (stale-while-revalidate for Weather, Store, ...) as the real user
+    if [ -f "$FLICK_DIR/services/flick-http-cache/http_cache.py" ]; then
+        echo "  Starting HTTP cache..."
+        sudo -u "$REAL_USER" \
+            python3 "$FLICK_DIR/services/flick-http-cache/http_cache.py" \
+            > /tmp/flick_http_cache.log 2>&1 &
+    fi
+
+    # Start calendar recurrence index (month views and next-event queries) as the real user
+    if [ -f "$FLICK_DIR/apps/calendar/calendar_engine.py" ]; then
+        echo "  Starting calendar engine..."
+        sudo -u "$REAL_USER" \
+            python3 "$FLICK_DIR/apps/calendar/calendar_engine.py" serve \
+            > /tmp/flick_calendar_engine.log 2>&1 &
+    fi
+
+    # Start contacts index (search + caller ID for QML apps) as the real user
+    if [ -f "$FLICK_DIR/apps/contacts/contacts_store.py" ]; then
+        echo "  Starting contacts store..."
+        sudo -u "$REAL_USER" \
+            python3 "$FLICK_DIR/apps/contacts/contacts_store.py" serve \
+            > /tmp/flick_contacts_store.log 2>&1 &
+    fi
+
+    # Start low-latency audio engine (sound effects for QML apps) as the real user
+    AUDIO_ENGINE="$FLICK_DIR/services/flick-audio-engine/target/release/flick-audio-engine"
+    if [ -x "$AUDIO_ENGINE" ]; then
+        echo "  Starting audio engine..."
+        sudo -u "$REAL_USER" \
+            XDG_RUNTIME_DIR="/run/user/$REAL_UID" \
+            "$AUDIO_ENGINE" --samples "$FLICK_DIR/apps/distract/app/sounds" \
+            > /tmp/flick_audio_engine.log 2>&1 &
+    fi
+
+    # Start app service (learns launch habits, requests hidden prelaunches) as the real user
+    APP_SERVICE="$FLICK_DIR/services/flick-app-service/target/release/flick-app-service"
+    if [ -x "$APP_SERVICE" ]; then
+        echo "  Starting app service..."
+        sudo -u "$REAL_USER" \
+            "$APP_SERVICE" --state-dir "$REAL_HOME/.local/state/flick" \
+            > /tmp/flick_app_service.log 2>&1 &
+    fi
 
     # Start messaging daemon as the real user
     if [ -f "$FLICK_DIR/apps/messages/messaging_daemon.py" ]; then
@@ -51,6 +99,11 @@ sudo killall -9 flick 2>/dev/null || true
 sudo systemctl stop phosh 2>/dev/null || true
 sudo -u "$REAL_USER" pkill -f "messaging_daemon.py" 2>/dev/null || true
 sudo pkill -f "phone_helper.py daemon" 2>/dev/null || true
+sudo -u "$REAL_USER" pkill -x flick-audio-engine 2>/dev/null || true
+sudo -u "$REAL_USER" pkill -f "flick-app-service" 2>/dev/null || true
+sudo -u "$REAL_USER" pkill -f "contacts_store.py serve" 2>/dev/null || true
+sudo -u "$REAL_USER" pkill -f "calendar_engine.py serve" 2>/dev/null || true
+sudo -u "$REAL_USER" pkill -f "http_cache.py" 2>/dev/null || true
 sleep 1
 
 echo "Restarting hwcomposer..."
@@ -87,7 +140,7 @@ start_daemons
 
 echo "Starting Flick..."
 if [ "$1" = "--bg" ]; then
-    sudo -E "$FLICK_BIN" > /tmp/flick.log 2>&1 &
+    sudo -E "$FLICK_BIN" --supervise > /tmp/flick.log 2>&1 &
     sleep 2
     # Fix Wayland socket permissions so apps running as user can connect
     REAL_USER="${SUDO_USER:-$USER}"
@@ -102,5 +155,5 @@ if [ "$1" = "--bg" ]; then
     echo "  Messages log: /tmp/flick_messages.log"
     echo "  Phone log: /tmp/flick_phone.log"
 else
-    sudo -E "$FLICK_BIN"
+    sudo -E "$FLICK_BIN" --supervise
 fi
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""
+Virtual touchscreen for measuring Flick's touch latency and jitter.
+
+Creates a multitouch uinput device and plays back vertical swipes at a
+fixed report rate. The compositor's input thread logs latency (kernel event
+time to handling time) every 512 touch events:
+
+    Touch latency over 512 events: p50=..us p99=..us max=..us jitter=..us
+
+Usage (as root, while Flick is running):
+    sudo ./uinput_touch.py --width 1080 --height 2340 --swipes 20 --rate 120
+"""
+
+import argparse
+import fcntl
+import os
+import struct
+import time
+
+# linux/uinput.h, linux/input-event-codes.h
+UI_SET_EVBIT = 0x40045564
+UI_SET_KEYBIT = 0x40045565
+UI_SET_ABSBIT = 0x40045567
+UI_SET_PROPBIT = 0x4004556E
+UI_DEV_CREATE = 0x5501
+UI_DEV_DESTROY = 0x5502
+
+EV_SYN, EV_KEY, EV_ABS = 0x00, 0x01, 0x03
+SYN_REPORT = 0
+BTN_TOUCH = 0x14A
+ABS_X, ABS_Y = 0x00, 0x01
+ABS_MT_SLOT = 0x2F
+ABS_MT_POSITION_X, ABS_MT_POSITION_Y = 0x35, 0x36
+ABS_MT_TRACKING_ID = 0x39
+INPUT_PROP_DIRECT = 0x01
+BUS_VIRTUAL = 0x06
+
+
+def create_device(fd, width, height):
+    """Register a direct-touch MT device sized to the screen."""
+    fcntl.ioctl(fd, UI_SET_EVBIT, EV_KEY)
+    fcntl.ioctl(fd, UI_SET_EVBIT, EV_ABS)
+    fcntl.ioctl(fd, UI_SET_KEYBIT, BTN_TOUCH)
+    fcntl.ioctl(fd, UI_SET_PROPBIT, INPUT_PROP_DIRECT)
+    for code in (ABS_X, ABS_Y, ABS_MT_SLOT, ABS_MT_POSITION_X, ABS_MT_POSITION_Y, ABS_MT_TRACKING_ID):
+        fcntl.ioctl(fd, UI_SET_ABSBIT, code)
+
+    absmax = [0] * 64
+    absmax[ABS_X] = absmax[ABS_MT_POSITION_X] = width - 1
+    absmax[ABS_Y] = absmax[ABS_MT_POSITION_Y] = height - 1
+    absmax[ABS_MT_SLOT] = 9
+    absmax[ABS_MT_TRACKING_ID] = 65535
+
+    # struct uinput_user_dev: name, input_id, ff_effects_max, absmax/min/fuzz/flat
+    dev = struct.pack("80sHHHHi", b"flick-uinput-touch", BUS_VIRTUAL, 0x1, 0x1, 1, 0)
+    dev += struct.pack("64i", *absmax) + struct.pack("64i", *([0] * 64)) * 3
+    os.write(fd, dev)
+    fcntl.ioctl(fd, UI_DEV_CREATE)
+
+
+def emit(fd, etype, code, value):
+    # struct input_event; the kernel stamps the time itself
+    os.write(fd, struct.pack("llHHi", 0, 0, etype, code, value))
+
+
+def swipe(fd, x, y0, y1, steps, interval, tracking_id):
+    """One finger swipe from (x, y0) to (x, y1) in `steps` reports."""
+    emit(fd, EV_ABS, ABS_MT_SLOT, 0)
+    emit(fd, EV_ABS, ABS_MT_TRACKING_ID, tracking_id)
+    for i in range(steps + 1):
+        y = int(y0 + (y1 - y0) * i / steps)
+        emit(fd, EV_ABS, ABS_MT_POSITION_X, x)
+        emit(fd, EV_ABS, ABS_MT_POSITION_Y, y)
+        if i == 0:
+            emit(fd, EV_KEY, BTN_TOUCH, 1)
+        emit(fd, EV_SYN, SYN_REPORT, 0)
+        time.sleep(interval)
+    emit(fd, EV_ABS, ABS_MT_TRACKING_ID, -1)
+    emit(fd, EV_KEY, BTN_TOUCH, 0)
+    emit(fd, EV_SYN, SYN_REPORT, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--width", type=int, default=1080)
+    parser.add_argument("--height", type=int, default=2340)
+    parser.add_argument("--swipes", type=int, default=20)
+    parser.add_argument("--steps", type=int, default=60, help="reports per swipe")
+    parser.add_argument("--rate", type=float, default=120.0, help="reports per second")
+    args = parser.parse_args()
+
+    fd = os.open("/dev/uinput", os.O_WRONLY | os.O_NONBLOCK)
+    try:
+        create_device(fd, args.width, args.height)
+        # Give udev/libinput time to pick up the new device
+        time.sleep(1.0)
+
+        interval = 1.0 / args.rate
+        x = args.width // 2
+        # Stay clear of the edge zones so swipes don't trigger shell gestures
+        y0, y1 = args.height * 3 // 4, args.height // 4
+        for n in range(args.swipes):
+            swipe(fd, x, y0, y1, args.steps, interval, n + 1)
+            time.sleep(0.2)
+
+        events = args.swipes * (args.steps + 2)
+        print(f"Sent {args.swipes} swipes ({events} touch events); see the compositor log for latency")
+    finally:
+        fcntl.ioctl(fd, UI_DEV_DESTROY)
+        os.close(fd)
+
+
+if __name__ == "__main__":
+    main()